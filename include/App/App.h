@@ -12,6 +12,8 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <deque>
+#include <utility>
 
 #define GLFW_INCLUDE_VULKAN
 #define GLM_FORCE_RADIANS
@@ -32,13 +34,24 @@
 #include "App/AppState.h" 
 
 class AudioController;
+class BandDecoder;
+class ClipAnalyzer;
+class ClipIndexer;
+class ClipPreloader;
 class DecoderWrapper;
 class PlaybackController;
+class ProxyGenerator;
 class Renderer_VK;
 
 #include "Gui/GuiOverlay.h"
 #include "Utils/ThreadSafeQueue.h"
+#include "Utils/PipelineMetrics.h"
+#include "Playback/AdaptiveQuality.h"
+#include "Utils/StartupTimer.h"
 #include "Decoder/DecoderTypes.h" 
+#include "Graphics/GpuScopes.h"
+#include "Graphics/PipelineCache.h"
+#include "Graphics/ThumbnailAtlas.h"
 
 class App {
 public:
@@ -54,6 +67,8 @@ public:
     friend void GuiOverlay::render(App* appInstance);
     friend void GuiOverlay::setup(GLFWwindow* window, App* appInstance);
 
+    StartupTimer m_startupTimer; // First member, so it starts with construction
+
     GLFWwindow* m_window = nullptr;
     VkInstance m_vkInstance = VK_NULL_HANDLE;
     VkDebugUtilsMessengerEXT m_debugMessenger = VK_NULL_HANDLE;
@@ -63,15 +78,21 @@ public:
     VmaAllocator m_vmaAllocator = VK_NULL_HANDLE;
     VkQueue m_graphicsQueue = VK_NULL_HANDLE;
     VkQueue m_presentQueue = VK_NULL_HANDLE;
+    VkQueue m_transferQueue = VK_NULL_HANDLE; // Only set on devices with a transfer-only queue family
+    uint32_t m_graphicsQueueFamily = 0;
+    uint32_t m_transferQueueFamily = 0;
+    bool m_timelineSemaphoresEnabled = false;
     VkDescriptorPool m_imguiDescriptorPool = VK_NULL_HANDLE;
     VkCommandPool m_commandPool = VK_NULL_HANDLE;
     VkRenderPass m_renderPass = VK_NULL_HANDLE;
+    PipelineCache m_pipelineCache;
 
     std::vector<std::string> m_fileList;
     int m_currentFileIndex = -1;
     std::optional<int> m_cfaOverride;
     std::string m_cfaStringFromMetadata;
     bool m_showMetrics = false;
+    bool m_showScopes = false;
     bool m_showHelpPage = false;
 
     double m_gpuWaitTimeMs = 0.0;
@@ -82,6 +103,8 @@ public:
     double m_guiRenderTimeMs = 0.0;
     double m_vkSubmitPresentTimeMs = 0.0;
     double m_appLogicTimeMs = 0.0;
+    PipelineMetrics m_pipelineMetrics;
+    uint64_t m_audioUnderrunsSeen = 0;
 
     int m_decodedWidth = 0;
     int m_decodedHeight = 0;
@@ -92,6 +115,7 @@ public:
     struct QueueFamilyIndices {
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
+        std::optional<uint32_t> transferFamily; // Transfer-capable family without graphics, if any
         bool isComplete() const {
             return graphicsFamily.has_value() && presentFamily.has_value();
         }
@@ -132,10 +156,23 @@ private:
 
 
     ThreadSafeQueue<GpuUploadPacket> m_gpuUploadQueue{ GpuUploadQueueCapacity };
-    ThreadSafeQueue<CompressedFramePacket> m_decodeQueue{ kNumPersistentStagingBuffers * DecodeQueueCapacityMultiplier };
-    ThreadSafeQueue<size_t> m_availableStagingBufferIndices{ kNumPersistentStagingBuffers + AvailableStagingIndicesQueueSlack };
-
-    std::vector<std::optional<size_t>> m_inFlightStagingBufferIndices;
+    ThreadSafeQueue<CompressedFramePacket> m_decodeQueue{ GpuUploadQueueCapacity * DecodeQueueCapacityMultiplier };
+
+    StagingRing m_stagingRing;
+    size_t m_stagingRingFrames = 0;     // Depth of the ring for the current clip
+    size_t m_stagingRingFrameBytes = 0; // Bytes per frame the ring was sized for
+    std::vector<std::optional<StagingSpan>> m_inFlightStagingSpans;
+    // StorageBuffer path and transfer uploads: the span or slot the demosaic pass reads. It
+    // outlives its frame so parameter changes can re-run the demosaic, and is released once
+    // every frame that could still read it has retired.
+    std::optional<RawSourceHold> m_retainedRawSource;
+    std::deque<std::pair<uint64_t, RawSourceHold>> m_deferredRawSourceReleases; // (frame serial, hold)
+    // Transfer uploads dropped before display, released once their copy has completed.
+    std::vector<RawSourceHold> m_pendingTransferReleases;
+    std::unique_ptr<TransferUploader> m_transferUploader; // Null on single-queue devices
+    bool m_gpuRawDecodeEnabled = false; // MOTIONCAM_GPU_DECODE=1: type 7 frames are expanded by GpuRawDecoder
+    std::vector<uint32_t> m_gpuDecodeBlockTable; // Decode thread only
+    uint64_t m_frameSerial = 0;
     std::atomic<bool> m_hasLastSuccessfullyUploadedPacket{ false };
     GpuUploadPacket m_lastSuccessfullyUploadedPacket;
 
@@ -164,9 +201,12 @@ private:
     std::unique_ptr<DecoderWrapper> m_decoderWrapper;
     std::unique_ptr<Renderer_VK> m_rendererVk;
     std::unique_ptr<PlaybackController> m_playbackController;
-
-    std::vector<StagingBufferInfo> m_persistentStagingBuffers;
-    std::vector<void*> m_persistentStagingBuffersMappedPtrs;
+    std::unique_ptr<ClipPreloader> m_clipPreloader; // Prepares the next playlist entry near the end of a clip
+    std::unique_ptr<ClipIndexer> m_clipIndexer;     // Playlist metadata and poster frames, indexed in the background
+    std::unique_ptr<ClipAnalyzer> m_clipAnalyzer;   // Per-frame exposure statistics of the open clip, for the heat-strip
+    std::unique_ptr<ProxyGenerator> m_proxyGenerator; // Writes the binned proxy of a clip that cannot be played in realtime
+    ThumbnailAtlas m_thumbnailAtlas;
+    GpuScopes m_scopes;             // Histogram, waveform, parade and vectorscope of the processed image
 
     std::thread m_ioThread;
     std::thread m_decodeThread;
@@ -176,6 +216,21 @@ private:
     std::mutex m_ioThreadFileMutex;
     std::condition_variable m_ioThreadFileCv;
     std::atomic<bool> m_ioThreadFileChanged{ false };
+    // Picked up by the IO thread with the file change.
+    std::shared_ptr<motioncam::Decoder> m_ioThreadDecoder; // The main decoder, shared rather than re-opened
+    size_t m_ioThreadPrerollFrames = 0; // Frames a gapless switch already queued for decode; the IO thread starts after them
+    std::shared_ptr<motioncam::Decoder> m_ioThreadProxyDecoder; // Proxy of the clip, or null; taken when m_ioThreadProxyChanged is set
+    std::atomic<bool> m_ioThreadProxyChanged{ false };
+    bool m_hasProxy = false; // A proxy decoder for the current clip was handed to the IO thread
+
+    // Adaptive quality (AppQuality.cpp): the main thread steps m_adaptiveQuality and publishes
+    // its level to the IO and decode threads.
+    AdaptiveQuality m_adaptiveQuality;
+    std::atomic<AdaptiveQuality::Level> m_qualityLevel{ AdaptiveQuality::Level::Full };
+    std::atomic<size_t> m_skipLateLeadFrames{ 1 }; // Frames closer to the playhead than this are skipped at SkipLate
+    std::unique_ptr<BandDecoder> m_bandDecoder;    // Decode thread only; splits frames from ParallelDecode on
+    // After a gapless switch the last presented frame stays up until the new clip's first frame is ready.
+    std::optional<std::chrono::steady_clock::time_point> m_holdPresentUntil;
 
     std::atomic<size_t> m_fileLoadIDGenerator{ 0 };
 
@@ -218,17 +273,26 @@ private:
     void createSyncObjects();
     void initImGuiVulkan();
 
-    void createPersistentStagingBuffers();
-    void destroyPersistentStagingBuffers();
+    void ensureStagingRingForClip(int frameWidth, int frameHeight);
+    void ensureTransferSlotsForClip(int frameWidth, int frameHeight);
+    void resetStagingState();
+    void destroyStagingRing();
+    void releaseRawSourceHold(const RawSourceHold& hold);
 
     void cleanupVulkan();
     void cleanupSwapChain();
     void recreateSwapChain();
 
     void drawFrame();
+    void prepareNextClipIfEnding();
+    std::shared_ptr<motioncam::Decoder> openProxyForClip(const std::string& clipPath) const;
+    void resetProxyPlayback(const std::string& clipPath, bool hasProxy);
+    void updateProxyPlayback();
+    void updateAdaptiveQuality();
 
     void ioWorkerLoop();
     void decodeWorkerLoop();
+    bool stageForGpuDecode(const CompressedFramePacket& packet, const StagingSpan& span, GpuRawDecoder::DecodeParams& outParams);
     void launchWorkerThreads();
 
     void handleDrop(int count, const char** paths);
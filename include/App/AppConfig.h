@@ -3,25 +3,37 @@
 #define APP_CONFIG_H
 
 #include <cstddef>
+#include <cstdint>
 
 const int MAX_FRAMES_IN_FLIGHT = 3;
 
 #ifdef NDEBUG
-constexpr size_t kNumPersistentStagingBuffers = 8;
 constexpr size_t GpuUploadQueueCapacity = 8; // Note: Your ThreadSafeQueue uses maxSize directly, this might be redundant if not used elsewhere
-constexpr size_t DecodeQueueCapacityMultiplier = 2; // Max items in decode queue relative to staging buffers
-constexpr size_t AvailableStagingIndicesQueueSlack = 4; // How many more items can ASI queue hold than buffers
+constexpr size_t DecodeQueueCapacityMultiplier = 2; // Max items in decode queue relative to the GPU upload queue
+constexpr size_t kMaxStagingRingFrames = 16;
 #else
-constexpr size_t kNumPersistentStagingBuffers = 24;
 constexpr size_t GpuUploadQueueCapacity = 24; // Note: Your ThreadSafeQueue uses maxSize directly
 constexpr size_t DecodeQueueCapacityMultiplier = 2;
-constexpr size_t AvailableStagingIndicesQueueSlack = 8;
+constexpr size_t kMaxStagingRingFrames = 24;
 #endif
 
+// Staging ring sizing. The ring holds as many frames of the loaded clip as fit in the
+// budget, clamped to [kMinStagingRingFrames, kMaxStagingRingFrames]. The budget can be
+// overridden at runtime with the MOTIONCAM_STAGING_BUDGET_MB environment variable.
+constexpr size_t kDefaultStagingBudgetMiB = 256;
+constexpr size_t kMinStagingRingFrames = MAX_FRAMES_IN_FLIGHT + 2;
+
 // Constants for IO worker pre-loading logic
 constexpr size_t MAX_LEAD_FRAMES_IO_WORKER = 8;
 constexpr size_t MAX_LAG_FRAMES_IO_WORKER = 4;
 
+// Gapless playlist transitions: the next entry is opened and its first frames read this long
+// before the current clip ends, and the last frame stays on screen for at most
+// kGaplessHoldMaxMs while the new clip's first frame decodes.
+constexpr int64_t kGaplessPrepareLeadNs = 2'000'000'000;
+constexpr size_t kGaplessPrerollFrames = MAX_LEAD_FRAMES_IO_WORKER;
+constexpr int kGaplessHoldMaxMs = 250;
+
 #ifndef NDEBUG
 const bool enableValidationLayers = true;
 #else
@@ -5,15 +5,11 @@
 #include <cstdint>
 #include <string>
 #include <optional>
-#include <vulkan/vulkan.h>      // For VkBuffer
-#include "vma_usage.h"          // For VmaAllocation
 #include <nlohmann/json.hpp>    // For nlohmann::json
 #include <motioncam/Decoder.hpp> // For motioncam::Timestamp
-
-struct StagingBufferInfo {
-    VkBuffer buffer = VK_NULL_HANDLE;
-    VmaAllocation allocation = VK_NULL_HANDLE;
-};
+#include "Graphics/StagingRing.h" // For StagingSpan
+#include "Graphics/TransferUploader.h" // For TransferUploader::Ticket
+#include "Graphics/GpuRawDecoder.h" // For GpuRawDecoder::DecodeParams
 
 struct CompressedFramePacket {
     motioncam::Timestamp timestamp;
@@ -24,16 +20,27 @@ struct CompressedFramePacket {
     int compressionType = 0;
     size_t frameIndex = 0;
     size_t fileLoadID = 0; // For stale packet identification
+    bool proxy = false;    // Read from the clip's proxy rather than the clip
 };
 
 struct GpuUploadPacket {
     motioncam::Timestamp timestamp;
-    size_t stagingBufferIndex;
+    StagingSpan staging;
+    std::optional<TransferUploader::Ticket> transfer; // Set when the frame was copied on the transfer queue
+    std::optional<GpuRawDecoder::DecodeParams> gpuDecode; // Set when the span holds the compressed frame for GpuRawDecoder
     nlohmann::json metadata;
     int width = 0;
     int height = 0;
     size_t frameIndex = 0;
     size_t fileLoadID = 0; // For stale packet identification
+    bool proxy = false;    // Read from the clip's proxy rather than the clip
+};
+
+/// Raw data a displayed frame is read from: a staging span (StorageBuffer path) and/or a
+/// transfer slot. Held until every frame that may still read it has retired.
+struct RawSourceHold {
+    std::optional<StagingSpan> staging;
+    std::optional<TransferUploader::Ticket> transfer;
 };
 
 #endif // APP_STATE_H
\ No newline at end of file
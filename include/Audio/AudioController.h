@@ -23,6 +23,8 @@ public:
     int64_t getLastQueuedTimestamp() const { return m_lastQueuedTimestamp; }
     int64_t getAudioAnchorTimestampNs() const { return m_firstVideoFrameTs; }
     int64_t latency() const { return m_latencyNs; }
+    // Times the device queue ran empty mid-stream. Never reset; callers diff it.
+    uint64_t underrunCount() const { return m_underrunCount; }
 
 private:
     SDL_AudioDeviceID            m_device = 0;
@@ -34,6 +36,10 @@ private:
     bool                         m_isPaused = false;
     bool                         m_isForceMuted = false;
     int64_t                      m_lastQueuedTimestamp = 0;
+    uint64_t                     m_underrunCount = 0;
+    bool                         m_queuedSinceClear = false;
+    bool                         m_loaderExhausted = false;
+    bool                         m_inUnderrun = false;
 
     void pause_internal();
     void resume_internal();
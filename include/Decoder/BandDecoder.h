@@ -0,0 +1,65 @@
+#ifndef BAND_DECODER_H
+#define BAND_DECODER_H
+
+#include <motioncam/RawData.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Decodes one type 7 frame on several threads by splitting it into bands of block rows
+ * (motioncam::raw::DecodeRows). The calling thread parses the frame's block metadata once
+ * (motioncam::raw::ParseFrameLayout), then decodes the first band while the helper threads
+ * decode the others from their own start offsets, so a frame takes roughly 1 / bandCount() of
+ * the single-threaded time.
+ *
+ * The helper threads are started once and wait between frames. decode() is called from one
+ * thread at a time (the decode thread).
+ */
+class BandDecoder {
+public:
+    /// numHelpers 0 selects half of std::thread::hardware_concurrency(), at most three.
+    explicit BandDecoder(unsigned numHelpers = 0);
+    ~BandDecoder();
+
+    BandDecoder(const BandDecoder&) = delete;
+    BandDecoder& operator=(const BandDecoder&) = delete;
+
+    /// Same contract as motioncam::raw::Decode(): returns the samples written, 0 on failure.
+    /// writeCombined is for output in mapped staging memory; see raw::DecodeToWriteCombined().
+    size_t decode(uint16_t* output, int width, int height, const uint8_t* input, size_t len, bool writeCombined = false);
+
+    unsigned bandCount() const { return static_cast<unsigned>(m_helpers.size()) + 1; }
+
+private:
+    struct Job {
+        uint16_t* output = nullptr;
+        int width = 0;
+        int height = 0;
+        const uint8_t* input = nullptr;
+        size_t len = 0;
+        unsigned bands = 0;
+        bool writeCombined = false;
+        const motioncam::raw::FrameLayout* layout = nullptr;
+    };
+
+    void helperLoop(unsigned band);
+    static size_t decodeBand(const Job& job, unsigned band);
+
+    motioncam::raw::FrameLayout m_layout; // Of the current frame; written before the helpers are woken
+    std::vector<std::thread> m_helpers;
+    std::mutex m_mutex;
+    std::condition_variable m_workCv;
+    std::condition_variable m_doneCv;
+    Job m_job;
+    uint64_t m_generation = 0;  // Bumped for every frame handed to the helpers
+    unsigned m_pending = 0;     // Helper bands of the current frame not yet decoded
+    std::vector<size_t> m_results;
+    bool m_stop = false;
+};
+
+#endif // BAND_DECODER_H
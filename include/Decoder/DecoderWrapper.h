@@ -19,7 +19,7 @@
     public:
         /**
          * @brief Constructs the DecoderWrapper and initializes the underlying motioncam::Decoder.
-         * @param filePath Path to the .mcraw file.
+         * @param filePath Path to the .mcraw file, or an http:// URL of one.
          * @throws std::runtime_error if the file cannot be opened or is invalid.
          */
         explicit DecoderWrapper(const std::string& filePath);
@@ -54,18 +54,40 @@
         motioncam::Decoder* getDecoder() { return m_decoder.get(); }
 
         /**
-         * @brief Creates a new motioncam::AudioChunkLoader instance for the current file.
-         * This typically involves re-opening the file to reset the audio stream.
-         * @return Pointer to a new AudioChunkLoader. Ownership might be an issue if
-         *         the decoder is destroyed; ensure lifetime management.
-         * @throws std::runtime_error if the decoder cannot be re-initialized.
+         * @brief Shares the decoder with another thread, e.g. the IO worker.
+         * @return The same instance getDecoder() returns; its const members are thread-safe.
+         */
+        std::shared_ptr<motioncam::Decoder> shareDecoder() const { return m_decoder; }
+
+        /**
+         * @brief Selects the read backend for decoders opened afterwards from MOTIONCAM_IO
+         *        (auto, mmap, pread, async or http), MOTIONCAM_IO_CACHE_MB and
+         *        MOTIONCAM_IO_QUEUE_DEPTH. Call once at startup, before any decoder is opened.
+         */
+        static void configureByteSourceFromEnvironment();
+
+        /**
+         * @brief Creates a new audio cursor positioned at the first chunk of the file.
+         * The file is not re-opened; the cursor reads the shared decoder's mapping.
+         * @return Pointer to the new AudioChunkLoader, owned by this wrapper. It replaces (and
+         *         invalidates) the loader returned by the previous call.
+         * @throws std::runtime_error if no decoder is open.
          */
         motioncam::AudioChunkLoader* makeFreshAudioLoader();
 
+        /**
+         * @brief Reads the metadata of one frame without decompressing its pixels.
+         * @param timestamp Frame timestamp from getDecoder()->getFrames().
+         * @return The parsed frame metadata.
+         * @throws std::runtime_error if the frame cannot be read.
+         */
+        nlohmann::json readFrameMetadata(motioncam::Timestamp timestamp) const;
+
     private:
         std::string                         m_filePath;
-        std::unique_ptr<motioncam::Decoder> m_decoder;
-        nlohmann::json                      m_containerMetadata;
+        std::shared_ptr<motioncam::Decoder>       m_decoder;
+        std::unique_ptr<motioncam::AudioChunkLoader> m_audioLoader; // Reads m_decoder; declared after it
+        nlohmann::json                            m_containerMetadata;
 };
 
 #endif // DECODER_WRAPPER_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+// FILE: include/Export/CompressedAnalysis.h
+#ifndef COMPRESSED_ANALYSIS_H
+#define COMPRESSED_ANALYSIS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Clip triage from the compressed domain only. For type 7 frames the decoder's per-block
+ * bits table says how many bits each 64-sample block's residuals needed, which is a coarse
+ * detail/noise map, and the refs table holds each block's base level, a coarse brightness map.
+ * Together with the record sizes from the container index they give a per-frame bitrate,
+ * detail and focus measure, and scene-change and duplicate-frame candidates without decoding
+ * a single pixel (Decoder::getBlockMetadata() reads a few percent of each record).
+ *
+ * Maps are kept per cell of 64x64 pixels: one 64-column block group by 16 row groups.
+ */
+namespace CompressedAnalysis {
+
+    struct FrameSummary {
+        int64_t timestamp = 0;
+        size_t compressedBytes = 0;
+        double mbps = 0.0;        // From the frame's size and the interval to the next frame
+        float meanBits = 0.0f;    // Over all blocks; 0 if the frame has no block tables
+        float focus = 0.0f;       // Mean bits over the most detailed 10% of cells
+        float sceneDelta = 0.0f;  // Change in the level and detail maps since the previous frame
+        bool hasTables = false;
+        bool sceneChange = false;
+        bool duplicate = false;   // Same size and identical tables as the previous frame
+        bool soft = false;        // Focus well below the clip's median
+    };
+
+    struct ClipReport {
+        std::string path;
+        bool valid = false;
+        std::string error;
+        std::vector<FrameSummary> frames;
+        double fps = 0.0;
+        double meanMbps = 0.0;
+        double peakMbps = 0.0;
+        int mapCols = 0;                 // Clip-mean detail map, mapCols x mapRows cells
+        int mapRows = 0;
+        std::vector<float> detailMap;
+        double elapsedSec = 0.0;         // Analysis time, for the frames/s figure
+    };
+
+    /// Analyses every frame of path on numThreads threads (0: hardware_concurrency()).
+    ClipReport analyzeClip(const std::string& path, unsigned numThreads = 0);
+
+} // namespace CompressedAnalysis
+
+#endif // COMPRESSED_ANALYSIS_H
@@ -0,0 +1,60 @@
+// FILE: include/Export/CpuImagePipeline.h
+#ifndef CPU_IMAGE_PIPELINE_H
+#define CPU_IMAGE_PIPELINE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * CPU implementation of shaders/demosaic.comp + image_process.frag for headless rendering.
+ * Same math, same order of operations: black/white level, bilinear or Malvar-He-Cutler demosaic
+ * per cfaType with mirrored borders, asShotNeutral gains, CCM, saturation and the sRGB curve. Work is split into row bands
+ * that are processed in parallel; the colour stage runs four pixels at a time (SSE via simde).
+ */
+namespace CpuImagePipeline {
+
+    /// Mirrors Renderer_VK::ShaderParamsUBO. CCM is row-major (out = CCM * rgb).
+    struct Params {
+        int   cfaType = 0; // 0:BGGR, 1:RGGB, 2:GBRG, 3:GRBG
+        int   algorithm = 1; // 0:bilinear, 1:Malvar-He-Cutler; same values and default as Renderer_VK::DemosaicAlgorithm
+        float exposure = 1.0f;
+        float blackLevel = 0.0f;
+        float whiteLevel = 65535.0f;
+        float invBlackWhiteRange = 1.0f / 65535.0f;
+        float gainR = 1.0f;
+        float gainG = 1.0f;
+        float gainB = 1.0f;
+        float ccm[9] = { 1,0,0, 0,1,0, 0,0,1 };
+        float saturation = 1.5f;
+    };
+
+    enum class Output {
+        SRGB_U16,    ///< Display-referred, sRGB-encoded 16-bit RGB (what the shader presents)
+        LINEAR_HALF  ///< Scene-linear RGB as IEEE half floats, before the sRGB curve (for EXR)
+    };
+
+    /// Same mapping as Renderer_VK::getCfaType, without pulling in Vulkan.
+    int cfaTypeFromString(const std::string& arrangement);
+
+    /// "bilinear" -> 0, "mhc" / "malvar-he-cutler" -> 1 (case-insensitive), -1 if unknown.
+    int algorithmFromString(const std::string& name);
+
+    /// Builds the parameters exactly as Renderer_VK::prepareAndUploadFrameData fills its UBO.
+    Params paramsFromMetadata(const nlohmann::json& frameMetadata,
+        const nlohmann::json& containerMetadata,
+        std::optional<int> cfaOverride = std::nullopt);
+
+    /**
+     * @brief Processes one Bayer frame into interleaved RGB (3 x uint16 per pixel).
+     * @param numThreads 0 selects std::thread::hardware_concurrency().
+     */
+    void process(const uint16_t* bayer, int width, int height, const Params& params,
+        Output output, uint16_t* outRgb, unsigned numThreads = 0);
+
+    uint16_t floatToHalf(float v);
+
+} // namespace CpuImagePipeline
+
+#endif // CPU_IMAGE_PIPELINE_H
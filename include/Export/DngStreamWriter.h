@@ -0,0 +1,72 @@
+// FILE: include/Export/DngStreamWriter.h
+#ifndef DNG_STREAM_WRITER_H
+#define DNG_STREAM_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <mio/mio.hpp>
+
+/**
+ * @class DngStreamWriter
+ * @brief Single-pass DNG writer. The TIFF header and IFD are laid out up front so the
+ *        pixel strip lands at a known offset; the decoder then writes rows straight into
+ *        the output (a memory-mapped file, or one frame-sized write buffer as fallback).
+ *        Peak memory per export job is bounded by roughly one frame.
+ */
+class DngStreamWriter {
+public:
+    /**
+     * @brief Builds the IFD for a single uncompressed 16-bit CFA image.
+     * @throws std::runtime_error on invalid dimensions or unsupported sensor arrangement.
+     */
+    DngStreamWriter(uint32_t width, uint32_t height,
+        const nlohmann::json& frameMetadata,
+        const nlohmann::json& containerMetadata);
+
+    ~DngStreamWriter();
+
+    DngStreamWriter(const DngStreamWriter&) = delete;
+    DngStreamWriter& operator=(const DngStreamWriter&) = delete;
+
+    /**
+     * @brief Decodes a compressed MCRAW payload directly into the DNG pixel strip and writes the file.
+     * @param compressionType 7 (current), 6 (legacy) or 0 (uncompressed).
+     * @return false with errorMsg populated on failure; a partially written file is removed.
+     */
+    bool writeFromCompressed(const std::string& outputPath,
+        const uint8_t* payload, size_t payloadSize, int compressionType,
+        std::string& errorMsg);
+
+    uint64_t fileSize() const { return m_pixelOffset + pixelBytes(); }
+
+private:
+    struct Entry {
+        uint16_t tag;
+        uint16_t type;
+        uint32_t count;
+        std::vector<uint8_t> data;
+    };
+
+    void buildLayout(const nlohmann::json& frameMetadata, const nlohmann::json& containerMetadata);
+    void serializeHeader();
+    bool beginOutput(const std::string& outputPath, std::string& errorMsg);
+    bool finishOutput(std::string& errorMsg);
+    void abortOutput();
+    uint16_t* pixelTarget();
+    uint64_t pixelBytes() const { return static_cast<uint64_t>(m_width) * m_height * sizeof(uint16_t); }
+
+    uint32_t             m_width = 0;
+    uint32_t             m_height = 0;
+    std::vector<Entry>   m_entries;
+    std::vector<uint8_t> m_header;       // TIFF header + IFD + out-of-line tag data
+    uint32_t             m_pixelOffset = 0;
+
+    std::string          m_outputPath;
+    mio::mmap_sink       m_map;
+    std::vector<uint16_t> m_fallbackBuffer; // Only used when the output can't be mapped
+    bool                 m_mapped = false;
+};
+
+#endif // DNG_STREAM_WRITER_H
@@ -0,0 +1,83 @@
+// FILE: include/Export/HeadlessExport.h
+#ifndef HEADLESS_EXPORT_H
+#define HEADLESS_EXPORT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <motioncam/Decoder.hpp>
+
+/**
+ * Command-line entry points that process MCRAW files without a window or GPU.
+ *
+ *   --export <tiff|png|exr|y4m> <input.mcraw> [output] [--demosaic bilinear|mhc] [--threads N]
+ *   --stream <rawvideo|y4m> <input.mcraw> [output|-] [--audio <wav path>] [--demosaic bilinear|mhc] [--threads N]
+ *   --verify-gpu-decode <input.mcraw> [--frames N]
+ *   --analyze <input.mcraw|folder> [output dir] [--threads N]
+ *   --verify <input.mcraw> [--full] [--threads N]
+ *   --remux <output.mcraw> <input.mcraw> [--frames A-B | --seconds S-E] [<input2.mcraw> [range]]...
+ *   --proxy <input.mcraw>... [--bin 2|4] [--threads N]
+ *
+ * Image formats write one file per frame into [output] (default: <stem>_<FMT>_Exports next to
+ * the input); y4m writes a single stream to [output] (default: <stem>.y4m), with a frame that
+ * fails to decode replaced by the previous one so the stream keeps the clip's timing.
+ * --demosaic picks the algorithm as the player's [D] key does; Malvar-He-Cutler by default, like playback.
+ * --stream writes processed frames to stdout ("-", the default) or a named pipe, with decode
+ * overlapped against the pipe write, and optionally the audio track as a WAV side stream.
+ * --verify-gpu-decode is the exception that needs Vulkan: it decodes each type 7 frame with
+ * mcraw_decode.comp on the first capable device (lavapipe works) and checks it is bit-exact
+ * with raw::Decode. Exit code 0 if every frame matched, 2 on a mismatch or failure, 3 if no
+ * Vulkan device can run the decoder.
+ * --analyze triages clips from the block tables and record sizes alone (CompressedAnalysis.h):
+ * per-frame CSV, a detail map and a JSON summary go to [output dir] (default: mcraw_analysis
+ * next to the input).
+ * --verify checks every record's item headers and metadata, decodes every frame and reads
+ * every audio chunk, in parallel, then writes per-frame XXH64 hashes of the compressed payloads
+ * to <input>.xxh64.json. Once that sidecar exists, --verify only hashes and compares, at disk
+ * speed; --full forces decoding again. Exit code 0 if the clip is intact, 2 otherwise.
+ * --remux writes a new MCRAW from a frame or time range of a clip, or several clips joined, by
+ * copying the compressed records and rebuilding the indexes (motioncam/Remux.hpp): no decoding.
+ * A range applies to the input before it; frame ranges are inclusive, times are from the clip's
+ * first frame.
+ * --proxy writes <stem>.proxy.mcraw next to each input (motioncam/Proxy.hpp): every frame binned
+ * 2x2 (default) or 4x4 per colour and re-encoded, with timestamps, metadata and audio kept. The
+ * player switches to it when the full-resolution clip cannot be played in realtime.
+ */
+namespace HeadlessExport {
+
+    /// True if argv[1] names one of the headless modes handled by run().
+    bool isHeadlessInvocation(int argc, char* argv[]);
+
+    /// True if the mode writes its payload to stdout, which must then not be redirected to a console.
+    bool writesToStdout(int argc, char* argv[]);
+
+    /// Decodes a type 7 / type 6 / uncompressed payload into width*height Bayer samples.
+    bool decodeFramePayload(const std::vector<uint8_t>& payload, int width, int height, int compressionType, std::vector<uint16_t>& bayer);
+
+    /// Frame rate as a rational from the median timestamp delta (timestamps are in ns).
+    void estimateFrameRate(const std::vector<motioncam::Timestamp>& frames, int& fpsNum, int& fpsDen);
+
+    /// Runs the requested mode; returns a process exit code.
+    int run(int argc, char* argv[]);
+
+    /// --stream implementation (StreamExport.cpp). args[0] is "--stream". Returns 1 on usage errors.
+    int runStream(const std::vector<std::string>& args);
+
+    /// --verify-gpu-decode implementation (GpuDecodeVerify.cpp). args[0] is "--verify-gpu-decode". Returns 1 on usage errors.
+    int runVerifyGpuDecode(const std::vector<std::string>& args);
+
+    /// --analyze implementation (CompressedAnalysis.cpp). args[0] is "--analyze". Returns 1 on usage errors.
+    int runAnalyze(const std::vector<std::string>& args);
+
+    /// --verify implementation (ContainerVerify.cpp). args[0] is "--verify". Returns 1 on usage errors.
+    int runVerify(const std::vector<std::string>& args);
+
+    /// --remux implementation (RemuxExport.cpp). args[0] is "--remux". Returns 1 on usage errors.
+    int runRemux(const std::vector<std::string>& args);
+
+    /// --proxy implementation (ProxyExport.cpp). args[0] is "--proxy". Returns 1 on usage errors.
+    int runProxy(const std::vector<std::string>& args);
+
+} // namespace HeadlessExport
+
+#endif // HEADLESS_EXPORT_H
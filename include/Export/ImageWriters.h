@@ -0,0 +1,59 @@
+// FILE: include/Export/ImageWriters.h
+#ifndef IMAGE_WRITERS_H
+#define IMAGE_WRITERS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal dependency-free writers for processed RGB frames produced by CpuImagePipeline.
+ * All inputs are interleaved RGB, 3 x uint16 per pixel.
+ */
+namespace ImageWriters {
+
+    /// Baseline 16-bit RGB TIFF, uncompressed, single strip.
+    bool writeTiff16(const std::string& path, int width, int height, const uint16_t* rgb, std::string& errorMsg);
+
+    /// 16-bit RGB PNG. No zlib in tree, so the IDAT stream uses stored deflate blocks.
+    bool writePng16(const std::string& path, int width, int height, const uint16_t* rgb, std::string& errorMsg);
+
+    /// Scanline OpenEXR, uncompressed, HALF channels. Input is already half-float bit patterns.
+    bool writeExrHalf(const std::string& path, int width, int height, const uint16_t* rgbHalf, std::string& errorMsg);
+
+    /**
+     * @class Y4mWriter
+     * @brief Writes YUV4MPEG2 (C444, 8-bit, BT.709 limited range) to a file or an already open stream.
+     */
+    class Y4mWriter {
+    public:
+        Y4mWriter() = default;
+        ~Y4mWriter();
+
+        Y4mWriter(const Y4mWriter&) = delete;
+        Y4mWriter& operator=(const Y4mWriter&) = delete;
+
+        bool open(const std::string& path, int width, int height, int fpsNum, int fpsDen, std::string& errorMsg);
+        /// Takes a stream it does not own (e.g. stdout or an opened named pipe).
+        bool attach(std::FILE* stream, int width, int height, int fpsNum, int fpsDen, std::string& errorMsg);
+        bool writeFrame(const uint16_t* rgb, std::string& errorMsg);
+        void close();
+        bool isOpen() const { return m_stream != nullptr; }
+
+        /// Converts one sRGB-encoded RGB16 frame into packed planar Y, U, V (8-bit each).
+        static void rgb16ToYuv444(const uint16_t* rgb, int width, int height, std::vector<uint8_t>& outPlanes);
+
+    private:
+        bool writeHeader(int fpsNum, int fpsDen, std::string& errorMsg);
+
+        std::FILE* m_stream = nullptr;
+        bool m_ownsStream = false;
+        int m_width = 0;
+        int m_height = 0;
+        std::vector<uint8_t> m_planes;
+    };
+
+} // namespace ImageWriters
+
+#endif // IMAGE_WRITERS_H
@@ -11,6 +11,7 @@ namespace Descriptor {
 	bool createDescriptorPool(Renderer_VK* renderer);
 	bool createDescriptorSets(Renderer_VK* renderer);
 	void updateDescriptorSetsWithNewRawImage(Renderer_VK* renderer);
+	void updateRawSourceBuffer(Renderer_VK* renderer);
 
 	// Uniform buffer functions are closely related to descriptors
 	bool createUniformBuffers(Renderer_VK* renderer);
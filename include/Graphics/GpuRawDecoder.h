@@ -0,0 +1,65 @@
+// FILE: include/Graphics/GpuRawDecoder.h
+#ifndef GPU_RAW_DECODER_H
+#define GPU_RAW_DECODER_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Decodes type 7 MCRAW payloads on the GPU (shaders/mcraw_decode.comp) into an R16_UINT
+ * storage image. The caller stages [block table][compressed payload] in a buffer, see
+ * raw::BuildBlockTable, so only the compressed bytes cross the bus instead of 2 bytes per pixel.
+ * Used by Renderer_VK for playback and by the --verify-gpu-decode headless check.
+ */
+class GpuRawDecoder {
+public:
+    /// Push constants of mcraw_decode.comp. Word offsets are into the bound source buffer.
+    struct DecodeParams {
+        uint32_t tableWordOffset = 0;
+        uint32_t payloadWordOffset = 0;
+        uint32_t blocksPerRow = 0;
+        uint32_t rowGroups = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+    };
+
+    GpuRawDecoder() = default;
+    ~GpuRawDecoder();
+
+    GpuRawDecoder(const GpuRawDecoder&) = delete;
+    GpuRawDecoder& operator=(const GpuRawDecoder&) = delete;
+
+    /// R16_UINT must be usable as a storage image, which also needs shaderStorageImageExtendedFormats
+    /// enabled on the device.
+    static bool isSupported(VkPhysicalDevice physicalDevice);
+
+    bool init(VkDevice device, const std::string& shaderPath, VkPipelineCache pipelineCache = VK_NULL_HANDLE);
+    void cleanup();
+
+    /// Rebinds the buffer frames are staged in. Range is clamped by the caller to
+    /// maxStorageBufferRange; nothing may be in flight.
+    void setSource(VkBuffer buffer, VkDeviceSize range);
+    /// Rebinds the R16_UINT image decoded into. Nothing may be in flight.
+    void setTarget(VkImageView targetView);
+    VkDeviceSize sourceRange() const { return m_sourceRange; }
+
+    /// Records the decode. The target goes SHADER_READ_ONLY -> GENERAL -> SHADER_READ_ONLY and is
+    /// readable by compute shaders afterwards. Host writes to the source must be flushed before submit.
+    /// Returns false, recording nothing, if the source or target has not been bound.
+    bool recordDecode(VkCommandBuffer commandBuffer, VkImage target, const DecodeParams& params) const;
+
+private:
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    VkDeviceSize m_sourceRange = 0;
+    bool m_hasSource = false;
+    bool m_hasTarget = false;
+};
+
+#endif // GPU_RAW_DECODER_H
@@ -0,0 +1,103 @@
+// FILE: include/Graphics/GpuScopes.h
+#ifndef GPU_SCOPES_H
+#define GPU_SCOPES_H
+
+#include <vulkan/vulkan.h>
+#include "Utils/vma_usage.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Luma/RGB histogram, luma waveform, RGB parade and vectorscope of the processed image,
+ * computed on the GPU by shaders/scopes.comp. A strided sample of at most kMaxSamples pixels
+ * is binned with atomics and the bins are drawn into one RGBA8 atlas of four panels, which
+ * ImGui samples directly; nothing is read back to the host. The work is recorded only when
+ * Renderer_VK has rewritten the processed image (new frame or changed parameters), and its
+ * GPU time is measured with timestamp queries.
+ *
+ * Main thread only. init() after ImGui_ImplVulkan_Init(), cleanup() before its shutdown.
+ */
+class GpuScopes {
+public:
+    enum class Panel { Histogram = 0, Waveform = 1, Parade = 2, Vectorscope = 3 };
+    static constexpr int kNumPanels = 4;
+    static constexpr uint32_t kPanelSize = 256;   // PANEL in scopes.comp
+    static constexpr uint32_t kMaxSamples = 1u << 19;
+    static constexpr uint32_t kBinCount = 4 * 256 + 256 * 256 + 3 * 128 * 256 + 256 * 256; // BIN_COUNT in scopes.comp
+
+    struct Uv {
+        float u0, v0, u1, v1;
+    };
+
+    GpuScopes() = default;
+    ~GpuScopes();
+
+    GpuScopes(const GpuScopes&) = delete;
+    GpuScopes& operator=(const GpuScopes&) = delete;
+
+    bool init(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator, uint32_t queueFamily,
+        uint32_t framesInFlight, const std::string& shaderPath, VkPipelineCache pipelineCache = VK_NULL_HANDLE);
+    void cleanup();
+
+    /// Records the scope update for the processed image if sourceGeneration differs from the
+    /// last one recorded; call outside a render pass, after the demosaic has been recorded.
+    /// frameSlot is the in-flight index whose fence has just been waited on.
+    void recordUpdate(VkCommandBuffer commandBuffer, uint32_t frameSlot,
+        VkImageView processedView, VkSampler processedSampler, uint64_t sourceGeneration,
+        int frameWidth, int frameHeight);
+
+    /// Cast to ImTextureID; VK_NULL_HANDLE until init() succeeded.
+    VkDescriptorSet texture() const { return m_textureSet; }
+    /// False until the atlas has been written once.
+    bool hasContent() const { return m_atlasInitialized; }
+    static Uv panelUv(Panel panel);
+
+    /// GPU time of the most recent completed update, or a negative value if not measured.
+    double lastGpuMs() const { return m_lastGpuMs; }
+    uint32_t lastSampleCount() const { return m_lastSampleCount; }
+
+private:
+    struct PushConstants {
+        int32_t width;
+        int32_t height;
+        int32_t stride;
+        float waveGain;
+        float paradeGain;
+        float vectorGain;
+    };
+
+    void collectTimestamps(uint32_t frameSlot);
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VmaAllocator m_allocator = VK_NULL_HANDLE;
+    uint32_t m_framesInFlight = 0;
+
+    VkBuffer m_bins = VK_NULL_HANDLE;
+    VmaAllocation m_binsAllocation = VK_NULL_HANDLE;
+    VkImage m_atlas = VK_NULL_HANDLE;
+    VmaAllocation m_atlasAllocation = VK_NULL_HANDLE;
+    VkImageView m_atlasView = VK_NULL_HANDLE;
+    VkSampler m_atlasSampler = VK_NULL_HANDLE;
+    VkDescriptorSet m_textureSet = VK_NULL_HANDLE; // ImGui's
+    bool m_atlasInitialized = false;
+
+    VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> m_sets;        // One per frame slot, rebound when the processed image is recreated
+    std::vector<VkImageView> m_boundSources;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_accumulatePipeline = VK_NULL_HANDLE;
+    VkPipeline m_resolvePipeline = VK_NULL_HANDLE;
+
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;   // Two timestamps per frame slot; null if unsupported
+    std::vector<bool> m_queryPending;
+    double m_timestampPeriodNs = 0.0;
+    double m_lastGpuMs = -1.0;
+
+    uint64_t m_lastGeneration = 0;
+    uint32_t m_lastSampleCount = 0;
+};
+
+#endif // GPU_SCOPES_H
@@ -10,6 +10,10 @@ namespace Pipeline {
 	bool createGraphicsPipeline(Renderer_VK* renderer, VkRenderPass renderPass);
 	void cleanupSwapChainResources(Renderer_VK* renderer); // This also cleans up pipeline and layout
 
+	// Demosaic compute pipeline. Independent of the swapchain, so it lives from init() to cleanup().
+	bool createComputePipeline(Renderer_VK* renderer);
+	void cleanupComputePipeline(Renderer_VK* renderer);
+
 } // namespace Pipeline
 
 #endif // PIPELINE_H
\ No newline at end of file
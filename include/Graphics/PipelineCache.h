@@ -0,0 +1,45 @@
+// FILE: include/Graphics/PipelineCache.h
+#ifndef PIPELINE_CACHE_H
+#define PIPELINE_CACHE_H
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+
+/**
+ * A VkPipelineCache kept on disk between runs, so the display, demosaic and decode pipelines
+ * and ImGui's pipeline are not recompiled from SPIR-V on every start. The file is only used
+ * if its header matches the current device and driver; otherwise the cache starts empty and
+ * is rewritten on exit.
+ *
+ * Main thread only.
+ */
+class PipelineCache {
+public:
+    static constexpr const char* kFileName = "motioncam_player_pipeline_cache.bin";
+
+    PipelineCache() = default;
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    /// Creates the cache, seeded from path when that file was written for this device. The app
+    /// keeps it next to the executable as kFileName, like shaders_spv.
+    /// Returns false (and handle() stays VK_NULL_HANDLE) if no cache could be created.
+    bool init(VkPhysicalDevice physicalDevice, VkDevice device, std::string path);
+
+    /// Writes the cache back to disk and destroys it. Call before vkDestroyDevice.
+    void cleanup();
+
+    VkPipelineCache handle() const { return m_cache; }
+
+private:
+    void save() const;
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkPipelineCache m_cache = VK_NULL_HANDLE;
+    std::string m_path;
+};
+
+#endif // PIPELINE_CACHE_H
@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <optional>
+#include <memory>
 
 #include <nlohmann/json.hpp>
 
@@ -21,6 +22,8 @@
 #include "Graphics/ImageResource.h" // ADD THIS LINE
 #include "Graphics/Pipeline.h"      // ADD THIS LINE
 #include "Graphics/Descriptor.h"    // ADD THIS LINE
+#include "Graphics/TransferUploader.h"
+#include "Graphics/GpuRawDecoder.h"
 // For VK_CHECK_RENDERER, if used, and helper function declarations
 // Other headers like ImageResource.h, Pipeline.h, Descriptor.h are not directly included here
 // as their functions are called from Renderer_VK.cpp via namespaces.
@@ -28,12 +31,26 @@
 
 class Renderer_VK {
 public:
+    /// Matches the ALGORITHM specialisation constant in demosaic.comp.
+    enum class DemosaicAlgorithm { Bilinear = 0, MalvarHeCutler = 1 };
+    static constexpr int kNumDemosaicAlgorithms = 2;
+    static constexpr int kNumCfaTypes = 4;
+
+    /// How decoded Bayer data reaches the demosaic pass. Matches RAW_SOURCE in demosaic.comp.
+    /// CopyToImage records vkCmdCopyBufferToImage into m_rawImage; StorageBuffer reads the
+    /// staging ring in place and is picked when that memory is cheap for the device to read.
+    enum class RawUploadPath { CopyToImage = 0, StorageBuffer = 1 };
+    static constexpr int kNumRawUploadPaths = 2;
+    /// Elements of the raw image binding: m_rawImage, then one per TransferUploader slot.
+    static constexpr uint32_t kNumRawImages = 1 + TransferUploader::kNumSlots;
+
     Renderer_VK(
         VkPhysicalDevice physicalDevice,
         VkDevice device,
         VmaAllocator allocator,
         VkQueue graphicsQueue,
-        VkCommandPool commandPool
+        VkCommandPool commandPool,
+        VkPipelineCache pipelineCache = VK_NULL_HANDLE
     );
     ~Renderer_VK();
 
@@ -45,7 +62,9 @@ public:
     void prepareAndUploadFrameData(
         VkCommandBuffer commandBuffer,
         uint32_t uboBindingIndex,
-        VkBuffer prefilledStagingBuffer,
+        VkBuffer prefilledStagingBuffer, VkDeviceSize stagingOffset,
+        std::optional<uint32_t> transferSlot,
+        const std::optional<GpuRawDecoder::DecodeParams>& gpuDecode,
         int frameWidth, int frameHeight,
         const nlohmann::json& frameMetadata,
         double staticBlack, double staticWhite, int cfaTypeOverride,
@@ -68,7 +87,26 @@ public:
     int getImageWidth() const;
     int getImageHeight() const;
     void resetDimensions();
-    void ensureRawImageCapacity(uint32_t w, uint32_t h);
+    void ensureRawImageSize(uint32_t w, uint32_t h);
+    void setDemosaicAlgorithm(DemosaicAlgorithm algorithm);
+    DemosaicAlgorithm getDemosaicAlgorithm() const;
+    /// Bumped every time the demosaic pass rewrites the processed image.
+    uint64_t getProcessedImageGeneration() const;
+
+    /// Points the demosaic pass at the staging buffer frames are decoded into and picks the
+    /// upload path for it. Call again whenever that buffer is recreated.
+    void setRawSourceBuffer(VkBuffer stagingBuffer, VkDeviceSize stagingSize, bool stagingIsDeviceLocal);
+    RawUploadPath getRawUploadPath() const;
+    /// Forgets the staging span the processed image was built from. Until the next upload,
+    /// parameter changes keep the existing processed image instead of re-running the demosaic.
+    void invalidateRawSource();
+    /// Binds the TransferUploader slot images behind m_rawImage. An empty list (single-queue
+    /// devices) binds m_rawImage in every element.
+    void setTransferSlotViews(const std::vector<VkImageView>& slotViews);
+    /// True if frames staged for GpuRawDecoder can be expanded into m_rawImage on this device.
+    bool supportsGpuRawDecode() const;
+    /// Bytes of the staging buffer the GPU decoder can address; staged frames must end within it.
+    VkDeviceSize getGpuRawDecodeSourceRange() const;
 
     // Public members needed by helper namespaces (e.g., ImageResource, Pipeline, Descriptor)
     // These allow the namespaced functions to operate on Renderer_VK's state.
@@ -77,11 +115,20 @@ public:
     VmaAllocator m_allocator_p;
     VkQueue m_graphicsQueue_p;
     VkCommandPool m_hostSiteCommandPool_p; // Command pool provided by App
+    VkPipelineCache m_pipelineCache_p;     // Owned by App; may be VK_NULL_HANDLE
 
     VkImage m_rawImage = VK_NULL_HANDLE;
     VmaAllocation m_rawImageAllocation = VK_NULL_HANDLE;
     VkImageView m_rawImageView = VK_NULL_HANDLE;
     VkSampler m_rawImageSampler = VK_NULL_HANDLE;
+    std::vector<VkImageView> m_transferSlotViews; // Owned by TransferUploader
+    std::unique_ptr<GpuRawDecoder> m_gpuRawDecoder; // Null unless m_rawImage can be a storage image
+
+    // Demosaiced RGBA16F result, sized with the raw image. Written by the compute pass, sampled for display.
+    VkImage m_processedImage = VK_NULL_HANDLE;
+    VmaAllocation m_processedImageAllocation = VK_NULL_HANDLE;
+    VkImageView m_processedImageView = VK_NULL_HANDLE;
+    VkSampler m_processedImageSampler = VK_NULL_HANDLE;
 
     std::vector<VkBuffer> m_uniformBuffers;
     std::vector<VmaAllocation> m_uniformBufferAllocations;
@@ -90,6 +137,15 @@ public:
     VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
     VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout m_computePipelineLayout = VK_NULL_HANDLE;
+    // One pipeline per (raw source, algorithm, CFA layout) specialisation.
+    VkPipeline m_demosaicPipelines[kNumRawUploadPaths][kNumDemosaicAlgorithms][kNumCfaTypes] = {};
+
+    // Bound at binding 4 until setRawSourceBuffer() provides the staging ring, so the
+    // descriptor is always valid for pipelines that statically reference it.
+    VkBuffer m_placeholderRawBuffer = VK_NULL_HANDLE;
+    VmaAllocation m_placeholderRawBufferAllocation = VK_NULL_HANDLE;
+    VkBuffer m_rawSourceBuffer = VK_NULL_HANDLE;
     std::vector<VkDescriptorSet> m_descriptorSets;
     VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
 
@@ -118,19 +174,39 @@ private:
     float m_panX = 0.0f;
     float m_panY = 0.0f;
 
+    // The processed image is only recomputed when a new frame is uploaded or the parameters change,
+    // so paused playback and pan/zoom only pay for the sampling pass.
+    bool m_processedImageValid = false;
+    uint64_t m_processedImageGeneration = 0;
+    DemosaicAlgorithm m_demosaicAlgorithm = DemosaicAlgorithm::MalvarHeCutler;
+    ShaderParamsUBO m_lastDemosaicParams{};
+
+    RawUploadPath m_rawUploadPath = RawUploadPath::CopyToImage;
+    VkDeviceSize m_rawSourceOffset = 0;
+    bool m_rawSourceValid = false; // Raw data for the current frame is readable by the demosaic pass
+    uint32_t m_rawImageIndex = 0;  // Element of the raw image binding holding the current frame
+    RawUploadPath m_rawSourceKind = RawUploadPath::CopyToImage; // Image or staging span the current frame is read from
+
     // Private methods that remain part of Renderer_VK class
     void updateUniformBuffer(uint32_t currentImageIndex, const ShaderParamsUBO& ubo);
+    void recordDemosaicDispatch(VkCommandBuffer commandBuffer, uint32_t uboBindingIndex, int frameWidth, int frameHeight);
+    bool createPlaceholderRawBuffer();
+    void destroyPlaceholderRawBuffer();
+    static bool sameDemosaicParams(const ShaderParamsUBO& a, const ShaderParamsUBO& b);
 
     // Friend declarations for helper namespaces to access private members if necessary,
     // or make members they need public (as done above with _p suffix).
     friend bool ImageResource::createRawImageResources(Renderer_VK* renderer, int width, int height);
     friend void ImageResource::cleanupRawImageResources(Renderer_VK* renderer);
     friend bool Pipeline::createGraphicsPipeline(Renderer_VK* renderer, VkRenderPass renderPass);
+    friend bool Pipeline::createComputePipeline(Renderer_VK* renderer);
+    friend void Pipeline::cleanupComputePipeline(Renderer_VK* renderer);
     friend void Pipeline::cleanupSwapChainResources(Renderer_VK* renderer);
     friend bool Descriptor::createDescriptorSetLayout(Renderer_VK* renderer);
     friend bool Descriptor::createDescriptorPool(Renderer_VK* renderer);
     friend bool Descriptor::createDescriptorSets(Renderer_VK* renderer);
     friend void Descriptor::updateDescriptorSetsWithNewRawImage(Renderer_VK* renderer);
+    friend void Descriptor::updateRawSourceBuffer(Renderer_VK* renderer);
     friend bool Descriptor::createUniformBuffers(Renderer_VK* renderer);
     friend void Descriptor::cleanupUniformBuffers(Renderer_VK* renderer);
 };
@@ -0,0 +1,83 @@
+// FILE: include/Graphics/StagingRing.h
+#ifndef STAGING_RING_H
+#define STAGING_RING_H
+
+#include <vulkan/vulkan.h>
+#include "Utils/vma_usage.h"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+
+/// A sub-allocated region of the staging ring. Carried by GpuUploadPacket from
+/// the decode thread to drawFrame and handed back via StagingRing::release().
+struct StagingSpan {
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void* mappedPtr = nullptr;
+    uint64_t generation = 0;
+};
+
+/**
+ * One persistently mapped, host-visible VkBuffer that decoded frames are
+ * sub-allocated from in FIFO order. Spans may be released out of order; the
+ * tail only advances past a span once everything older has been released too.
+ * acquire() blocks while the ring is full, like ThreadSafeQueue::wait_pop.
+ */
+class StagingRing {
+public:
+    StagingRing() = default;
+    ~StagingRing();
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    /// (Re)creates the backing buffer. Caller must guarantee the GPU is idle and
+    /// no thread holds a span. Throws std::runtime_error on allocation failure.
+    void create(VmaAllocator allocator, VkDeviceSize capacityBytes);
+    void destroy();
+
+    std::optional<StagingSpan> acquire(VkDeviceSize sizeBytes);
+    void release(const StagingSpan& span);
+    /// Makes the decoder's writes to a span visible to the device (non-coherent memory).
+    void flush(const StagingSpan& span);
+
+    /// Forgets every live span. Spans handed out before the reset are ignored by release().
+    void reset();
+
+    void stop_operations();
+    void resume_operations();
+
+    VkBuffer buffer() const { return m_buffer; }
+    VkDeviceSize capacity() const { return m_capacity; }
+    bool isDeviceLocal() const { return m_deviceLocal; }
+    size_t liveSpanCount() const;
+
+    static constexpr VkDeviceSize kAlignment = 256;
+
+private:
+    struct Entry {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+        bool released;
+    };
+
+    bool tryCarveLocked(VkDeviceSize sizeBytes, VkDeviceSize& outOffset) const;
+
+    VmaAllocator m_allocator = VK_NULL_HANDLE;
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    VmaAllocation m_allocation = VK_NULL_HANDLE;
+    uint8_t* m_mapped = nullptr;
+    VkDeviceSize m_capacity = 0;
+    bool m_deviceLocal = false;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Entry> m_entries; // Oldest first
+    uint64_t m_generation = 0;
+    bool m_stopped = false;
+};
+
+#endif // STAGING_RING_H
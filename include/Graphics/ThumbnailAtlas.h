@@ -0,0 +1,89 @@
+// FILE: include/Graphics/ThumbnailAtlas.h
+#ifndef THUMBNAIL_ATLAS_H
+#define THUMBNAIL_ATLAS_H
+
+#include <vulkan/vulkan.h>
+#include "Utils/vma_usage.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct ClipInfo;
+
+/**
+ * Playlist thumbnails packed into one RGBA8 image that ImGui samples through a single
+ * descriptor set, so a long playlist costs one texture rather than one per clip. Cells are
+ * assigned least-recently-used; a cell is only reused once no frame still in flight can be
+ * drawing it. Uploads are recorded into the frame's command buffer before the render pass
+ * from a small per-frame staging region, a few thumbnails per frame.
+ *
+ * Main thread only. cleanup() must run before ImGui_ImplVulkan_Shutdown().
+ */
+class ThumbnailAtlas {
+public:
+    static constexpr uint32_t kCellSize = 80; // ClipIndexer::kThumbnailSize
+    static constexpr uint32_t kCellsPerRow = 16;
+    static constexpr uint32_t kAtlasSize = kCellSize * kCellsPerRow;
+    static constexpr uint32_t kUploadsPerFrame = 8;
+
+    struct Uv {
+        float u0, v0, u1, v1;
+    };
+
+    ThumbnailAtlas() = default;
+    ~ThumbnailAtlas();
+
+    ThumbnailAtlas(const ThumbnailAtlas&) = delete;
+    ThumbnailAtlas& operator=(const ThumbnailAtlas&) = delete;
+
+    bool init(VkDevice device, VmaAllocator allocator, uint32_t framesInFlight);
+    void cleanup();
+
+    /// Cast to ImTextureID for ImGui::Image; VK_NULL_HANDLE until init() succeeded.
+    VkDescriptorSet descriptorSet() const { return m_descriptorSet; }
+
+    /// UVs of the clip's thumbnail if it is resident, otherwise queues it for upload (when the
+    /// clip has one) and returns nothing. Marks the cell as used by the current frame.
+    std::optional<Uv> lookup(const std::string& path, const std::shared_ptr<const ClipInfo>& info);
+
+    /// Records the queued uploads for this frame; call before vkCmdBeginRenderPass. frameSlot is
+    /// the in-flight index whose fence has just been waited on, frameSerial the submission count.
+    void recordUploads(VkCommandBuffer commandBuffer, uint32_t frameSlot, uint64_t frameSerial);
+
+private:
+    struct Cell {
+        std::string path;
+        uint64_t lastUsedSerial = 0;
+        Uv uv{};
+        bool resident = false;
+    };
+
+    std::optional<uint32_t> acquireCell();
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VmaAllocator m_allocator = VK_NULL_HANDLE;
+    VkImage m_image = VK_NULL_HANDLE;
+    VmaAllocation m_imageAllocation = VK_NULL_HANDLE;
+    VkImageView m_view = VK_NULL_HANDLE;
+    VkSampler m_sampler = VK_NULL_HANDLE;
+    VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+    VkBuffer m_staging = VK_NULL_HANDLE;
+    VmaAllocation m_stagingAllocation = VK_NULL_HANDLE;
+    uint8_t* m_stagingMapped = nullptr;
+    uint32_t m_framesInFlight = 0;
+    bool m_imageInitialized = false; // Layout is UNDEFINED until the first upload
+
+    std::vector<Cell> m_cells;
+    std::list<uint32_t> m_lru;                                  // Front = most recently used
+    std::unordered_map<std::string, std::list<uint32_t>::iterator> m_byPath;
+    std::vector<std::pair<uint32_t, std::shared_ptr<const ClipInfo>>> m_pendingUploads;
+    uint64_t m_frameSerial = 0;
+};
+
+#endif // THUMBNAIL_ATLAS_H
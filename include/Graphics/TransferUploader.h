@@ -0,0 +1,102 @@
+// FILE: include/Graphics/TransferUploader.h
+#ifndef TRANSFER_UPLOADER_H
+#define TRANSFER_UPLOADER_H
+
+#include <vulkan/vulkan.h>
+#include "Utils/vma_usage.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+/**
+ * Copies decoded frames from the staging ring into device-local R16_UINT slot images on a
+ * dedicated transfer queue, so uploads run ahead of display instead of inside drawFrame.
+ * Each copy signals a timeline semaphore; the render loop only consumes a slot once the
+ * semaphore has reached its value, and acquires queue-family ownership before sampling it.
+ * Only created when the device exposes a transfer-only queue family and timeline semaphores.
+ */
+class TransferUploader {
+public:
+    /// Must match RAW_IMAGE_SLOTS - 1 in demosaic.comp (element 0 is Renderer_VK::m_rawImage).
+    static constexpr uint32_t kNumSlots = 6;
+
+    struct Ticket {
+        uint32_t slot = 0;
+        uint64_t value = 0;      // Timeline value signalled once the copy has finished
+        uint64_t generation = 0; // Tickets from before a reset() are ignored by release()
+    };
+
+    TransferUploader() = default;
+    ~TransferUploader();
+
+    TransferUploader(const TransferUploader&) = delete;
+    TransferUploader& operator=(const TransferUploader&) = delete;
+
+    bool init(VkDevice device, VmaAllocator allocator,
+        VkQueue transferQueue, uint32_t transferFamily,
+        VkQueue graphicsQueue, uint32_t graphicsFamily, VkCommandPool graphicsCommandPool);
+    void cleanup();
+
+    /// (Re)creates the slot images for frames of the given size. Device must be idle.
+    bool ensureSlotImages(uint32_t width, uint32_t height);
+    std::vector<VkImageView> slotViews() const;
+    bool fits(uint32_t width, uint32_t height) const { return width <= m_slotWidth && height <= m_slotHeight; }
+
+    /// Decode thread only. Blocks until a slot is free; returns nothing once stopped.
+    std::optional<Ticket> submitUpload(VkBuffer stagingBuffer, VkDeviceSize stagingOffset, uint32_t width, uint32_t height);
+
+    bool isComplete(uint64_t value) const;
+    /// Records the graphics-side half of the ownership transfer for a completed upload.
+    void recordAcquire(VkCommandBuffer commandBuffer, uint32_t slot) const;
+    void release(const Ticket& ticket);
+
+    /// Marks every slot free. Tickets handed out before the reset are ignored by release().
+    void reset();
+    void stop_operations();
+    void resume_operations();
+    /// Slots holding an upload that has not been released yet.
+    size_t busySlotCount() const;
+
+    VkSemaphore timelineSemaphore() const { return m_timeline; }
+
+private:
+    struct Slot {
+        VkImage image = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        uint64_t lastValue = 0; // Last timeline value submitted from this slot's command buffer
+    };
+
+    void destroySlotImages();
+    VkImageMemoryBarrier ownershipBarrier(uint32_t slot) const;
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VmaAllocator m_allocator = VK_NULL_HANDLE;
+    VkQueue m_transferQueue = VK_NULL_HANDLE;
+    VkQueue m_graphicsQueue = VK_NULL_HANDLE;
+    VkCommandPool m_graphicsCommandPool = VK_NULL_HANDLE;
+    uint32_t m_transferFamily = 0;
+    uint32_t m_graphicsFamily = 0;
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    VkSemaphore m_timeline = VK_NULL_HANDLE;
+    PFN_vkGetSemaphoreCounterValueKHR m_getSemaphoreCounterValue = nullptr;
+    PFN_vkWaitSemaphoresKHR m_waitSemaphores = nullptr;
+
+    std::array<Slot, kNumSlots> m_slots{};
+    uint32_t m_slotWidth = 0;
+    uint32_t m_slotHeight = 0;
+    uint64_t m_nextValue = 0; // Decode thread only
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::array<bool, kNumSlots> m_slotBusy{};
+    uint64_t m_generation = 0;
+    bool m_stopped = false;
+};
+
+#endif // TRANSFER_UPLOADER_H
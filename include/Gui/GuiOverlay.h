@@ -31,6 +31,10 @@ namespace GuiOverlay {
         std::string avSyncDeltaStr;
         std::optional<int> cfaOverride;
         std::string cfaFromMetadataStr;
+        std::string demosaicAlgorithmStr;
+        std::string uploadPathStr;
+        std::string proxyStatusStr;
+        std::string qualityStr;
         bool isFullscreen = false;
         bool showMetrics = false;
         bool showHelpPage = false;
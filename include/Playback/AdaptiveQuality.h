@@ -0,0 +1,84 @@
+#ifndef ADAPTIVE_QUALITY_H
+#define ADAPTIVE_QUALITY_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Decides how much work playback may spend per frame. Once a second it compares the frames
+ * displayed against the frames the playhead passed (missed deadlines) and the mean decode time
+ * against the frame interval (decode load), and steps down one level after consecutive slow
+ * windows:
+ *
+ *   Full              - one thread decodes each frame at full resolution.
+ *   ParallelDecode    - each frame is decoded in bands on several threads.
+ *   ReducedResolution - frames are read from the clip's binned proxy (ProxyGenerator).
+ *   SkipLate          - frames that cannot be decoded before the playhead passes them are
+ *                       discarded undecoded.
+ *
+ * It steps back up after a run of windows with headroom. A step up that is soon undone doubles
+ * the run required for the next one, so a clip on the edge does not flip every few seconds.
+ *
+ * Pure logic, called from the main thread; the App publishes level() to the worker threads.
+ */
+class AdaptiveQuality {
+public:
+    enum class Level { Full, ParallelDecode, ReducedResolution, SkipLate, Count };
+
+    /// Cumulative counters sampled once per loop iteration while playing.
+    struct Sample {
+        uint64_t framesDisplayed = 0;
+        size_t playhead = 0;
+        uint64_t decodeCount = 0;
+        double decodeMsSum = 0.0;      // decodeCount times the mean decode time
+        size_t decodeQueueDepth = 0;
+        size_t decodeQueueCapacity = 0;
+        double frameIntervalMs = 0.0;  // Between the frames that are decoded (DisplaySchedule)
+        double frameStride = 1.0;      // Playhead frames per decoded frame
+        bool canReduceResolution = true; // False when the proxy cannot be used (remote clip, native zoom)
+    };
+
+    AdaptiveQuality();
+
+    static const char* levelName(Level level);
+
+    /// Returns true when the level changed; reason() says why.
+    bool update(std::chrono::steady_clock::time_point now, const Sample& sample);
+    /// The next update() opens a new window: after a pause or a seek the frames in flight say nothing about load.
+    void restartWindow() { m_windowStart = {}; }
+    /// New clip: back to Full.
+    void reset();
+
+    Level level() const { return m_level; }
+    const std::string& reason() const { return m_reason; }
+    double shownRatio() const { return m_shownRatio; }     // Of the last window, 1 before the first
+    double decodeLoad() const { return m_decodeLoad; }     // Mean decode time over the frame interval
+    double decodeBacklog() const { return m_decodeBacklog; } // Mean decode queue fill, 0 - 1
+    /// Mean decode time of the last window in frame intervals, at least 1.
+    size_t decodeLatencyFrames() const;
+
+private:
+    void step(Level to, const std::string& reason);
+
+    Level m_level = Level::Full;
+    std::string m_reason;
+
+    std::chrono::steady_clock::time_point m_windowStart; // Epoch: no window open
+    Sample m_windowFirst;
+    double m_depthSum = 0.0;
+    size_t m_depthSamples = 0;
+
+    int m_slowWindows = 0;
+    int m_goodWindows = 0;
+    int m_goodWindowsRequired = 0; // Doubles when a step up is soon undone
+    int m_windowsSinceStepUp = -1; // -1: no step up to undo
+
+    double m_shownRatio = 1.0;
+    double m_decodeLoad = 0.0;
+    double m_decodeBacklog = 0.0;
+    double m_frameIntervalMs = 0.0;
+};
+
+#endif // ADAPTIVE_QUALITY_H
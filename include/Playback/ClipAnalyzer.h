@@ -0,0 +1,110 @@
+#ifndef CLIP_ANALYZER_H
+#define CLIP_ANALYZER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace motioncam { class Decoder; }
+
+/// Exposure statistics of one decoded frame. Levels are normalised between the clip's black
+/// and white level.
+struct FrameStats {
+    float channelMean[4] = {}; // Per 2x2 CFA position, in mosaic order
+    float clippedPct = 0.0f;   // Photosites at or above the white level
+    float crushedPct = 0.0f;   // Photosites at or below the black level
+    float sharpness = 0.0f;    // Mean absolute difference between same-colour neighbours
+    bool valid = false;        // False if the frame could not be decoded
+
+    float maxMean() const;
+    /// Nothing but noise above black: lens cap, dropped frame, sensor not yet running.
+    bool isBlack() const { return valid && maxMean() < 0.02f; }
+};
+
+/// Per-frame statistics of a whole clip, filled in progressively by ClipAnalyzer.
+struct ClipStats {
+    std::string path;
+    uint64_t fileSize = 0;
+    int64_t modifiedTime = 0;    // With fileSize, the cache key
+    size_t frameCount = 0;
+    size_t stride = 1;           // samples[i] describes frame i * stride
+    std::vector<FrameStats> samples;
+    size_t analyzedCount = 0;
+    bool complete = false;
+    float medianSharpness = 0.0f; // Over the valid samples analysed so far
+
+    /// The sample covering frameIndex, or null if there is none yet.
+    const FrameStats* sampleForFrame(size_t frameIndex) const;
+    /// Noticeably softer than the clip as a whole (missed focus, motion blur).
+    bool isSoft(const FrameStats& stats) const;
+};
+
+/**
+ * Decodes every frame of the open clip (every stride-th one on long takes, so at most
+ * kMaxSamples are analysed) on low-priority background threads and records FrameStats for
+ * each, for the exposure heat-strip under the scrubber. The threads read through the decoder
+ * playback already has open (its reads are thread-safe) and claim frames from a shared
+ * counter, so the pass runs several times faster than realtime on a multi-core machine while
+ * playback keeps its decode thread. Completed clips are cached on disk keyed by path, size and
+ * modification time.
+ *
+ * analyze(), cancel() and current() are called from the main thread. One clip is analysed at
+ * a time; analysing another path cancels the previous one.
+ */
+class ClipAnalyzer {
+public:
+    static constexpr size_t kMaxSamples = 2048;
+    static constexpr const char* kCacheFileName = "motioncam_player_clip_stats.msgpack";
+
+    /// cachePath is where completed clips are kept; the app uses kCacheFileName next to the
+    /// executable. numThreads 0 selects a quarter of std::thread::hardware_concurrency().
+    explicit ClipAnalyzer(std::string cachePath, unsigned numThreads = 0);
+    ~ClipAnalyzer();
+
+    ClipAnalyzer(const ClipAnalyzer&) = delete;
+    ClipAnalyzer& operator=(const ClipAnalyzer&) = delete;
+
+    /// Starts analysing path, read through decoder (the one playback has open for it), unless it
+    /// is the clip already being analysed or shown. The decoder is held until the pass ends.
+    void analyze(const std::string& path, std::shared_ptr<const motioncam::Decoder> decoder);
+    /// Stops the analysis threads, e.g. before the clip is moved. The partial result stays.
+    void cancel();
+
+    /// Snapshot of the current clip's statistics, or null if none have been produced yet.
+    /// The returned object is immutable; progress replaces it rather than modifying it.
+    std::shared_ptr<const ClipStats> current() const;
+
+private:
+    void run(std::string path, std::shared_ptr<const motioncam::Decoder> decoder);
+    void analyzeFrames(
+        const motioncam::Decoder& decoder,
+        const ClipStats& layout,
+        std::atomic<size_t>& nextSample
+    );
+    void storeSample(size_t index, const FrameStats& stats);
+    void publishLocked();
+    void loadCache();
+    void saveCache();
+
+    const std::string m_cachePath;
+    const unsigned m_numThreads;
+    std::string m_requestedPath;
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{ false };
+
+    mutable std::mutex m_mutex;
+    ClipStats m_building;                         // Written by the analysis threads
+    std::shared_ptr<const ClipStats> m_current;   // Last published snapshot of m_building
+    size_t m_publishedCount = 0;
+    std::unordered_map<std::string, nlohmann::json> m_cache; // Completed clips, by path
+};
+
+#endif // CLIP_ANALYZER_H
@@ -0,0 +1,107 @@
+#ifndef CLIP_INDEXER_H
+#define CLIP_INDEXER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// What the playlist shows for a clip without opening it for playback.
+struct ClipInfo {
+    uint64_t fileSize = 0;
+    int64_t modifiedTime = 0; // fs::last_write_time ticks; with fileSize, the cache key
+    bool valid = false;       // False if the file could not be opened; error says why
+    std::string error;
+
+    int width = 0;
+    int height = 0;
+    size_t frameCount = 0;
+    double durationSec = 0.0;
+    double fps = 0.0;
+    int audioSampleRate = 0; // 0 when the clip has no audio
+    int audioChannels = 0;
+
+    // Poster frame (first frame), RGBA8, at most kThumbnailSize on its longer side.
+    int thumbnailWidth = 0;
+    int thumbnailHeight = 0;
+    std::vector<uint8_t> thumbnail;
+
+    bool hasAudio() const { return audioSampleRate > 0 && audioChannels > 0; }
+    bool hasThumbnail() const { return thumbnailWidth > 0 && thumbnailHeight > 0; }
+};
+
+/**
+ * Indexes playlist entries on a pool of background threads. Each file is indexed in two
+ * passes: container and first-frame metadata first (an open and an index read), then the
+ * poster-frame thumbnail (a full decode of the first frame), so every entry gets its metadata
+ * before any thumbnail is decoded. Results are cached on disk keyed by path, size and
+ * modification time, so reopening a card only touches files that changed.
+ *
+ * enqueue(), prioritize() and find() are called from the main thread.
+ */
+class ClipIndexer {
+public:
+    static constexpr int kThumbnailSize = 80;
+    static constexpr const char* kCacheFileName = "motioncam_player_clip_index.msgpack";
+
+    /// cachePath is where the index is kept; the app uses kCacheFileName next to the executable.
+    /// numThreads 0 selects half of std::thread::hardware_concurrency().
+    explicit ClipIndexer(std::string cachePath, unsigned numThreads = 0);
+    ~ClipIndexer();
+
+    ClipIndexer(const ClipIndexer&) = delete;
+    ClipIndexer& operator=(const ClipIndexer&) = delete;
+
+    /// Queues every path that is neither indexed nor cached with a matching size and mtime.
+    void enqueue(const std::vector<std::string>& paths);
+    /// Moves path to the front of whichever pass it is waiting for, e.g. for visible rows.
+    void prioritize(const std::string& path);
+
+    /// Null until the metadata pass for path has finished. The returned entry is immutable;
+    /// the thumbnail pass replaces it rather than modifying it.
+    std::shared_ptr<const ClipInfo> find(const std::string& path) const;
+
+    /// Files queued and finished in the metadata pass, for progress display.
+    size_t pendingCount() const;
+    size_t indexedCount() const;
+
+    /// Writes the cache if anything changed since the last save.
+    void saveCache();
+
+private:
+    struct Entry {
+        std::shared_ptr<const ClipInfo> info;
+        bool queued = false; // In m_metadataQueue or m_thumbnailQueue
+    };
+
+    void workerLoop();
+    void runMetadataPass(const std::string& path);
+    void runThumbnailPass(const std::string& path);
+    void loadCache();
+    void publish(const std::string& path, std::shared_ptr<const ClipInfo> info, bool countIndexed);
+
+    const std::string m_cachePath;
+    std::vector<std::thread> m_workers;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_map<std::string, std::shared_ptr<const ClipInfo>> m_cached; // From disk, not yet validated
+    std::deque<std::string> m_metadataQueue;
+    std::deque<std::string> m_thumbnailQueue;
+    size_t m_busyWorkers = 0;
+    size_t m_indexedCount = 0;
+    bool m_dirty = false;
+    bool m_stop = false;
+
+    std::mutex m_saveMutex;
+};
+
+#endif // CLIP_INDEXER_H
@@ -0,0 +1,67 @@
+#ifndef CLIP_PRELOADER_H
+#define CLIP_PRELOADER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <motioncam/Decoder.hpp>
+#include <nlohmann/json.hpp>
+
+#include "App/AppState.h"
+#include "Decoder/DecoderWrapper.h"
+
+/**
+ * Everything loadFileAtIndex would otherwise do on the main thread for a clip: the decoder
+ * opened and indexed, the audio loader created, the first frame's metadata parsed and the
+ * compressed payloads of the first frames read.
+ */
+struct PreparedClip {
+    std::string path;
+    std::unique_ptr<DecoderWrapper> decoder;          // Becomes App::m_decoderWrapper
+    motioncam::AudioChunkLoader* audioLoader = nullptr; // Owned by decoder
+    nlohmann::json firstFrameMetadata;
+    std::vector<CompressedFramePacket> prerollPackets; // Frames [0, N); fileLoadID is assigned on switch
+};
+
+/**
+ * Prepares the next playlist entry on a background thread while the current clip plays, so
+ * the switch at the end of the clip does not stall on file opening and indexing.
+ *
+ * Main thread only, apart from the worker it owns. One clip is prepared at a time; requesting
+ * another path cancels the previous one.
+ */
+class ClipPreloader {
+public:
+    explicit ClipPreloader(size_t prerollFrames);
+    ~ClipPreloader();
+
+    ClipPreloader(const ClipPreloader&) = delete;
+    ClipPreloader& operator=(const ClipPreloader&) = delete;
+
+    /// Starts preparing path unless it is already being prepared or ready.
+    void request(const std::string& path);
+
+    /// Hands over the prepared clip for path, waiting for the worker if it is still busy with it.
+    /// Returns nullptr (and drops whatever was prepared) if path was not requested or failed to open.
+    std::unique_ptr<PreparedClip> take(const std::string& path);
+
+    /// Stops the worker and drops any prepared clip.
+    void cancel();
+
+    const std::string& requestedPath() const { return m_requestedPath; }
+
+private:
+    void prepare(std::string path);
+
+    const size_t m_prerollFrames;
+    std::string m_requestedPath;
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{ false };
+    std::unique_ptr<PreparedClip> m_prepared; // Written by the worker; read only after joining it
+};
+
+#endif // CLIP_PRELOADER_H
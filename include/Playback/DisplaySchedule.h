@@ -0,0 +1,47 @@
+#ifndef DISPLAY_SCHEDULE_H
+#define DISPLAY_SCHEDULE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Which frames of a clip reach the screen during playback. When the clip's frame rate is well
+ * above the display's (120 or 240 fps footage on a 60 Hz display), the playhead lands on only
+ * some of the frames at each refresh; the others would be read and decoded only to be dropped
+ * in drawFrame. The IO thread walks the schedule with a Cursor and reads just the frames on it.
+ *
+ * Timestamps are the clip's frame timestamps in nanoseconds, ascending.
+ */
+namespace DisplaySchedule {
+
+// Below this ratio of display interval to frame interval every frame is read: the playhead
+// lands on nearly all of them and the refresh rate, measured from the render loop, is not
+// exact enough to tell which ones it misses.
+constexpr double kMinRateRatio = 1.25;
+
+struct Cursor {
+    size_t index = 0;         // Frame to read; timestamps.size() past the last one
+    int64_t mediaTimeNs = 0;  // Media time of the refresh it is scheduled for
+};
+
+/// Mean interval between the frames of the clip, 0 with fewer than two frames.
+int64_t frameIntervalNs(const std::vector<int64_t>& timestamps);
+
+/// Media time between scheduled frames for a display refreshing at displayFps, or 0 when every
+/// frame is scheduled (the clip is not sufficiently faster, or the refresh rate is not known yet).
+int64_t displayIntervalNs(int64_t frameIntervalNs, double displayFps);
+
+/// Clip frames per scheduled frame, 1 when every frame is scheduled.
+double frameStride(int64_t frameIntervalNs, int64_t displayIntervalNs);
+
+/// A schedule starting at frame index: a load, a seek or the playhead overtaking the reader.
+Cursor start(const std::vector<int64_t>& timestamps, size_t index);
+
+/// The frame on screen one refresh after cursor's: the last one whose timestamp the playhead
+/// has reached by then, and always a later frame than cursor's.
+Cursor next(const std::vector<int64_t>& timestamps, const Cursor& cursor, int64_t displayIntervalNs);
+
+} // namespace DisplaySchedule
+
+#endif // DISPLAY_SCHEDULE_H
@@ -6,6 +6,7 @@
 #include <optional>
 #include <cstddef> // For size_t
 #include <mutex>   // For std::mutex and std::scoped_lock
+#include <atomic>
 
 #include <nlohmann/json.hpp> // For nlohmann::json
 
@@ -52,6 +53,8 @@ public:
 
     static double getDisplayFps();
     inline int64_t getFrameDurationNs() const { return m_frameDurationNs; }
+    /// The clip's mean frame interval, set on load; 0 (too few frames) restores the default.
+    inline void setFrameDurationNs(int64_t ns) { m_frameDurationNs = ns > 0 ? ns : kDefaultFrameDurationNs; }
 
 
 private:
@@ -60,7 +63,8 @@ private:
     bool m_isPaused;
     size_t m_currentFrameIdx = 0;
     size_t m_totalFramesInCurrentSegment = 0; // Store total frames for current segment
-    int64_t m_frameDurationNs = 16666667; // Default to ~60 FPS (16.66 ms)
+    static constexpr int64_t kDefaultFrameDurationNs = 16666667; // ~60 FPS (16.66 ms)
+    int64_t m_frameDurationNs = kDefaultFrameDurationNs;
 
     // For time-based playback synchronization
     std::optional<int64_t> m_firstFrameMediaTimestampNs_currentSegment;
@@ -71,7 +75,7 @@ private:
     // For FPS calculation
     std::chrono::steady_clock::time_point m_fpsAvgStart;
     int m_framesForAvg = 0;
-    static double s_displayFps;
+    static std::atomic<double> s_displayFps; // Written by the main thread, read by the IO thread's DisplaySchedule
 };
 
 #endif // PLAYBACK_CONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef PROXY_GENERATOR_H
+#define PROXY_GENERATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/// Progress of the proxy being written, as shown in the overlay.
+struct ProxyStatus {
+    enum class State { Idle, Generating, Ready, Failed };
+
+    std::string clipPath;   // Clip the proxy is made from
+    std::string proxyPath;  // Where it is written; valid once state is Ready
+    State state = State::Idle;
+    size_t framesDone = 0;
+    size_t frameCount = 0;
+};
+
+/**
+ * Writes the binned proxy of a clip (motioncam::WriteProxy) on low-priority background
+ * threads, so the player can switch to it when the full-resolution clip cannot be decoded in
+ * realtime. The proxy is written next to the clip and picked up by the player the next time
+ * the clip is opened as well.
+ *
+ * generate(), cancel() and status() are called from the main thread. One proxy is written at
+ * a time; generating another clip's proxy cancels the previous one, whose partial output is
+ * removed.
+ */
+class ProxyGenerator {
+public:
+    /// numThreads 0 selects a quarter of std::thread::hardware_concurrency().
+    explicit ProxyGenerator(unsigned numThreads = 0);
+    ~ProxyGenerator();
+
+    ProxyGenerator(const ProxyGenerator&) = delete;
+    ProxyGenerator& operator=(const ProxyGenerator&) = delete;
+
+    /// Starts writing the proxy of path unless it is being written or was written already.
+    void generate(const std::string& path);
+    /// Stops the worker threads and removes the partial proxy.
+    void cancel();
+
+    ProxyStatus status() const;
+
+private:
+    void run(std::string path);
+
+    const unsigned m_numThreads;
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{ false };
+
+    mutable std::mutex m_mutex;
+    ProxyStatus m_status;
+};
+
+#endif // PROXY_GENERATOR_H
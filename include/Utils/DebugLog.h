@@ -2,8 +2,60 @@
 #define DEBUG_LOG_H
 
 #include <string>
+#include <utility>
 
-// Simple file logger declaration
-void LogToFile(const std::string& message);
+// Asynchronous file logger. Callers only move the message into a per-thread lock-free ring;
+// a background thread timestamps, formats and writes motioncam_player_log.txt.
 
-#endif // DEBUG_LOG_H
\ No newline at end of file
+enum class LogLevel : int {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4,
+};
+
+// Messages below this level are compiled out by the LOG_* macros, including building the
+// message string. Override with -DMOTIONCAM_LOG_MIN_LEVEL=0 to get per-frame trace lines.
+#ifndef MOTIONCAM_LOG_MIN_LEVEL
+#   ifdef NDEBUG
+#       define MOTIONCAM_LOG_MIN_LEVEL 2
+#   else
+#       define MOTIONCAM_LOG_MIN_LEVEL 1
+#   endif
+#endif
+
+// Enqueues a message. Never blocks on file I/O; if the calling thread's ring is full the
+// message is dropped and counted, and the count is written out with the next drained batch.
+// Error messages wake the writer and are flushed to disk immediately.
+void LogMessage(LogLevel level, std::string message);
+
+// Existing call sites log at Info.
+inline void LogToFile(std::string message) {
+    LogMessage(LogLevel::Info, std::move(message));
+}
+
+// Runtime threshold on top of the compile-time one, from MOTIONCAM_LOG_LEVEL
+// (trace|debug|info|warn|error) at first use. Defaults to Info.
+void SetLogLevel(LogLevel level);
+LogLevel GetLogLevel();
+
+// Blocks until everything enqueued so far is on disk.
+void FlushLog();
+// Drains, flushes and joins the writer thread. Later messages are written synchronously.
+void ShutdownLog();
+
+#define MOTIONCAM_LOG_AT(level, message)                                      \
+    do {                                                                      \
+        if constexpr (static_cast<int>(level) >= MOTIONCAM_LOG_MIN_LEVEL) {  \
+            LogMessage(level, message);                                       \
+        }                                                                     \
+    } while (0)
+
+#define LOG_TRACE(message) MOTIONCAM_LOG_AT(LogLevel::Trace, message)
+#define LOG_DEBUG(message) MOTIONCAM_LOG_AT(LogLevel::Debug, message)
+#define LOG_INFO(message)  MOTIONCAM_LOG_AT(LogLevel::Info, message)
+#define LOG_WARN(message)  MOTIONCAM_LOG_AT(LogLevel::Warn, message)
+#define LOG_ERROR(message) MOTIONCAM_LOG_AT(LogLevel::Error, message)
+
+#endif // DEBUG_LOG_H
@@ -0,0 +1,64 @@
+#ifndef FRAME_TRACE_H
+#define FRAME_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// In-memory trace of the per-frame pipeline stages (IO read, decode, staging acquire, upload,
+// render, present, audio queueing). Every thread records into its own fixed-size ring holding
+// its most recent events; writeChromeTrace() dumps them as Chrome trace JSON for
+// chrome://tracing or ui.perfetto.dev. Recording costs two clock reads and a few relaxed stores.
+//
+// Event and thread names must be string literals (or otherwise outlive the process).
+namespace FrameTrace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int64_t kNoFrame = -1;
+
+// Recording is on unless MOTIONCAM_TRACE=0.
+bool isEnabled();
+
+// Names the calling thread in the trace. Call once at thread start.
+void setThreadName(const char* name);
+
+void recordSpan(const char* name, Clock::time_point begin, Clock::time_point end,
+    int64_t frameIndex = kNoFrame, uint64_t loadId = 0);
+void recordInstant(const char* name, int64_t frameIndex = kNoFrame, uint64_t loadId = 0);
+
+// Writes everything still buffered. Safe to call while other threads keep recording.
+bool writeChromeTrace(const std::string& path);
+
+// motioncam_trace_YYYYmmdd_HHMMSS.json in the working directory, next to the log.
+std::string defaultTracePath();
+// MOTIONCAM_TRACE_FILE, if set: where to write the trace at exit.
+std::optional<std::string> exitTracePath();
+
+// Records [construction, destruction) as one span.
+class Scope {
+public:
+    explicit Scope(const char* name, int64_t frameIndex = kNoFrame, uint64_t loadId = 0)
+        : m_name(name), m_frameIndex(frameIndex), m_loadId(loadId), m_begin(Clock::now()) {}
+    ~Scope() { recordSpan(m_name, m_begin, Clock::now(), m_frameIndex, m_loadId); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    // For stages whose frame is only known once they finish, e.g. the render stage.
+    void setFrame(int64_t frameIndex, uint64_t loadId) {
+        m_frameIndex = frameIndex;
+        m_loadId = loadId;
+    }
+
+private:
+    const char* m_name;
+    int64_t m_frameIndex;
+    uint64_t m_loadId;
+    Clock::time_point m_begin;
+};
+
+} // namespace FrameTrace
+
+#endif // FRAME_TRACE_H
@@ -0,0 +1,131 @@
+#ifndef PIPELINE_METRICS_H
+#define PIPELINE_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+/**
+ * Playback health for the current file: per-stage latency histograms, queue depth history and
+ * dropped / repeated frame and audio underrun counters. Latencies and counters may be recorded
+ * from any thread (relaxed atomics); queue depths are sampled once per loop iteration on the
+ * main thread, which is also the only reader of the depth history. Shown in the METRICS window
+ * and summarised to motioncam_player_metrics.jsonl when the file is closed.
+ */
+class PipelineMetrics {
+public:
+    enum class Stage {
+        IoRead,
+        StagingAcquire,
+        Decode,
+        UploadSubmit, // Transfer queue submission from the decode thread
+        FenceWait,
+        Upload,       // Upload / GPU decode / demosaic recording in drawFrame
+        Render,
+        Present,
+        AudioQueue,
+        Count
+    };
+
+    enum class Counter {
+        FramesDisplayed,
+        FramesDroppedStale, // Left over from a previous load or seek
+        FramesDroppedLate,  // Reached drawFrame too far behind the playhead
+        FramesSkippedLate,  // Discarded undecoded at AdaptiveQuality's SkipLate level
+        FramesRepeated,     // Playhead advanced but no new frame was ready
+        AudioUnderruns,
+        Count
+    };
+
+    enum class Queue {
+        Decode,
+        GpuUpload,
+        StagingSpans,
+        TransferSlots,
+        Count
+    };
+
+    // Eight buckets per octave (~9% wide) from 10 us; the last bucket catches everything above ~650 ms.
+    static constexpr size_t kHistogramBuckets = 128;
+    static constexpr size_t kDepthHistory = 240;
+    static constexpr const char* kSummaryFileName = "motioncam_player_metrics.jsonl";
+
+    struct StageSummary {
+        uint64_t count = 0;
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    PipelineMetrics() = default;
+    PipelineMetrics(const PipelineMetrics&) = delete;
+    PipelineMetrics& operator=(const PipelineMetrics&) = delete;
+
+    static const char* stageName(Stage stage);
+    static const char* counterName(Counter counter);
+    static const char* queueName(Queue queue);
+    static double bucketUpperBoundMs(size_t bucket);
+
+    void recordLatency(Stage stage, double ms);
+    void recordLatency(Stage stage, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+        recordLatency(stage, std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+    void increment(Counter counter, uint64_t amount = 1) {
+        m_counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+    uint64_t counter(Counter counter) const {
+        return m_counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    /// Main thread only.
+    void sampleQueueDepth(Queue queue, size_t depth);
+    /// Main thread only. Oldest first, kDepthHistory entries (zero-filled until the history is full).
+    void copyDepthHistory(Queue queue, std::array<float, kDepthHistory>& out) const;
+    size_t currentDepth(Queue queue) const { return m_depths[static_cast<size_t>(queue)].current; }
+    size_t maxDepth(Queue queue) const { return m_depths[static_cast<size_t>(queue)].max; }
+
+    StageSummary summarize(Stage stage) const;
+    void copyHistogram(Stage stage, std::array<float, kHistogramBuckets>& out) const;
+
+    /// Starts a new file. Main thread, with the worker threads joined.
+    void reset(const std::string& fileName);
+    const std::string& fileName() const { return m_fileName; }
+
+    nlohmann::json summaryJson() const;
+    /// Appends summaryJson() as one line to path, unless nothing was displayed.
+    bool appendSummary(const std::string& path) const;
+
+private:
+    struct Histogram {
+        std::array<std::atomic<uint64_t>, kHistogramBuckets> buckets{};
+        std::atomic<uint64_t> count{ 0 };
+        std::atomic<uint64_t> sumUs{ 0 };
+        std::atomic<uint64_t> maxUs{ 0 };
+    };
+
+    struct DepthTrack {
+        std::array<float, kDepthHistory> history{};
+        size_t next = 0;
+        size_t current = 0;
+        size_t max = 0;
+        uint64_t samples = 0;
+        double sum = 0.0;
+    };
+
+    double percentileMs(const Histogram& histogram, double fraction) const;
+
+    std::array<Histogram, static_cast<size_t>(Stage::Count)> m_histograms{};
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> m_counters{};
+    std::array<DepthTrack, static_cast<size_t>(Queue::Count)> m_depths{};
+    std::string m_fileName;
+    std::chrono::steady_clock::time_point m_startTime = std::chrono::steady_clock::now();
+};
+
+#endif // PIPELINE_METRICS_H
@@ -0,0 +1,46 @@
+#ifndef STARTUP_TIMER_H
+#define STARTUP_TIMER_H
+
+#include <chrono>
+#include <vector>
+
+/**
+ * Breakdown of the time from App construction to the first frame on screen. Phases run on
+ * the main thread one after another are recorded with mark(); work done meanwhile on another
+ * thread is added with addConcurrent(). Each phase is also recorded as a FrameTrace span.
+ *
+ * Main thread only. Phase names must be string literals.
+ */
+class StartupTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    StartupTimer() : m_begin(Clock::now()), m_last(m_begin) {}
+
+    /// Closes the phase that began at the previous mark (or construction).
+    void mark(const char* phase);
+
+    /// A phase that ran on another thread, overlapping the main-thread phases.
+    void addConcurrent(const char* phase, Clock::time_point begin, Clock::time_point end);
+
+    double elapsedMs() const;
+
+    /// Logs every phase and the total once; later calls do nothing.
+    void logSummary(const char* milestone);
+    bool summaryLogged() const { return m_logged; }
+
+private:
+    struct Phase {
+        const char* name;
+        Clock::time_point begin;
+        Clock::time_point end;
+        bool concurrent;
+    };
+
+    Clock::time_point m_begin;
+    Clock::time_point m_last;
+    std::vector<Phase> m_phases;
+    bool m_logged = false;
+};
+
+#endif // STARTUP_TIMER_H
@@ -0,0 +1,20 @@
+#ifndef XXHASH64_H
+#define XXHASH64_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// XXH64 (Yann Collet's xxHash, 64-bit variant), for integrity sidecars: fast enough that
+// re-hashing a clip is bound by the disk, and the same values the xxhsum tool prints.
+namespace XxHash64 {
+
+uint64_t hash(const void* data, size_t size, uint64_t seed = 0);
+
+// 16 lower-case hex digits, as written by xxhsum.
+std::string toHex(uint64_t value);
+bool fromHex(const std::string& text, uint64_t& outValue);
+
+} // namespace XxHash64
+
+#endif // XXHASH64_H
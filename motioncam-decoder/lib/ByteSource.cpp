@@ -0,0 +1,853 @@
+// --- START OF FILE motioncam/ByteSource.cpp ---
+#include <motioncam/ByteSource.hpp>
+#include <motioncam/Decoder.hpp>
+
+#include <mio/mio.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <winsock2.h>
+#   include <ws2tcpip.h>
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <netdb.h>
+#   include <netinet/in.h>
+#   include <netinet/tcp.h>
+#   include <sys/socket.h>
+#   include <sys/stat.h>
+#   include <sys/time.h>
+#   include <unistd.h>
+#endif
+
+#ifdef MOTIONCAM_HAVE_IO_URING
+#   include <liburing.h>
+#endif
+
+namespace motioncam {
+
+    void ByteSource::readBatch(ReadRequest* requests, size_t count) const {
+        for (size_t i = 0; i < count; ++i) {
+            requests[i].bytesRead = read(requests[i].offset, requests[i].dst, requests[i].size);
+        }
+    }
+
+    namespace {
+        std::mutex gDefaultOptionsMutex;
+        ByteSourceOptions gDefaultOptions;
+
+        size_t clampToSource(uint64_t sourceSize, uint64_t offset, size_t size) {
+            if (offset >= sourceSize)
+                return 0;
+            return static_cast<size_t>((std::min)(static_cast<uint64_t>(size), sourceSize - offset));
+        }
+
+        //
+        // LRU cache of fixed-size blocks shared by every reader of a source. Misses are loaded
+        // outside the lock; two threads missing the same block both load it and one copy wins.
+        //
+
+        class BlockCache {
+        public:
+            typedef std::shared_ptr<const std::vector<uint8_t>> Block;
+
+            BlockCache(size_t blockSize, size_t capacityBytes) :
+                mBlockSize((std::max)(blockSize, size_t{ 4096 })),
+                mCapacity((std::max)(capacityBytes / mBlockSize, size_t{ 4 })) {
+            }
+
+            size_t blockSize() const { return mBlockSize; }
+
+            template<typename Loader>
+            size_t read(uint64_t sourceSize, uint64_t offset, void* dst, size_t size, Loader&& loadBlock) {
+                size = clampToSource(sourceSize, offset, size);
+                uint8_t* out = static_cast<uint8_t*>(dst);
+                size_t copied = 0;
+                while (copied < size) {
+                    const uint64_t position = offset + copied;
+                    const uint64_t blockIndex = position / mBlockSize;
+                    const size_t inBlock = static_cast<size_t>(position - blockIndex * mBlockSize);
+
+                    Block block = find(blockIndex);
+                    if (!block) {
+                        const uint64_t blockStart = blockIndex * mBlockSize;
+                        auto data = std::make_shared<std::vector<uint8_t>>(clampToSource(sourceSize, blockStart, mBlockSize));
+                        const size_t loaded = loadBlock(blockStart, data->data(), data->size());
+                        data->resize(loaded);
+                        block = insert(blockIndex, std::move(data));
+                    }
+                    if (inBlock >= block->size())
+                        break;
+
+                    const size_t n = (std::min)(size - copied, block->size() - inBlock);
+                    std::memcpy(out + copied, block->data() + inBlock, n);
+                    copied += n;
+                }
+                return copied;
+            }
+
+        private:
+            Block find(uint64_t blockIndex) {
+                std::lock_guard<std::mutex> lock(mMutex);
+                auto it = mIndex.find(blockIndex);
+                if (it == mIndex.end())
+                    return nullptr;
+                mLru.splice(mLru.begin(), mLru, it->second);
+                return it->second->second;
+            }
+
+            Block insert(uint64_t blockIndex, Block block) {
+                std::lock_guard<std::mutex> lock(mMutex);
+                auto it = mIndex.find(blockIndex);
+                if (it != mIndex.end())
+                    return it->second->second;
+
+                mLru.emplace_front(blockIndex, std::move(block));
+                mIndex[blockIndex] = mLru.begin();
+                while (mLru.size() > mCapacity) {
+                    mIndex.erase(mLru.back().first);
+                    mLru.pop_back();
+                }
+                return mLru.front().second;
+            }
+
+            const size_t mBlockSize;
+            const size_t mCapacity; // In blocks
+            std::mutex mMutex;
+            std::list<std::pair<uint64_t, Block>> mLru; // Front = most recently used
+            std::unordered_map<uint64_t, std::list<std::pair<uint64_t, Block>>::iterator> mIndex;
+        };
+
+        //
+        // Memory-mapped file. Page faults stand in for reads, so there is nothing to batch.
+        //
+
+        class MmapByteSource : public ByteSource {
+        public:
+            explicit MmapByteSource(const std::string& path) {
+                std::error_code error;
+                mMap.map(path, error);
+                if (error)
+                    throw IOException("Failed to memory map " + path);
+            }
+
+            uint64_t size() const override { return mMap.size(); }
+
+            size_t read(uint64_t offset, void* dst, size_t size) const override {
+                size = clampToSource(mMap.size(), offset, size);
+                if (!dst || size == 0)
+                    return 0;
+                std::memcpy(dst, mMap.data() + offset, size);
+                return size;
+            }
+
+            const char* name() const override { return "mmap"; }
+
+        private:
+            mio::mmap_source mMap;
+        };
+
+        //
+        // Positional reads. Small reads (headers, index, metadata) go through the block cache;
+        // reads spanning at least two blocks, i.e. frame payloads, go straight to the file.
+        //
+
+        class PreadByteSource : public ByteSource {
+        public:
+            PreadByteSource(const std::string& path, const ByteSourceOptions& options, bool overlapped = false) :
+                mCache(options.blockSize, options.cacheBytes)
+            {
+#ifdef _WIN32
+                mFile = CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | (overlapped ? FILE_FLAG_OVERLAPPED : 0), nullptr);
+                if (mFile == INVALID_HANDLE_VALUE)
+                    throw IOException("Failed to open " + path + " (error " + std::to_string(GetLastError()) + ")");
+                LARGE_INTEGER fileSize{};
+                if (!GetFileSizeEx(mFile, &fileSize)) {
+                    CloseHandle(mFile);
+                    throw IOException("Failed to get the size of " + path);
+                }
+                mSize = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+                (void)overlapped;
+                mFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (mFd < 0)
+                    throw IOException("Failed to open " + path + ": " + std::strerror(errno));
+                struct stat st {};
+                if (::fstat(mFd, &st) != 0) {
+                    ::close(mFd);
+                    throw IOException("Failed to get the size of " + path);
+                }
+                mSize = static_cast<uint64_t>(st.st_size);
+#endif
+            }
+
+            ~PreadByteSource() override {
+#ifdef _WIN32
+                CloseHandle(mFile);
+#else
+                ::close(mFd);
+#endif
+            }
+
+            uint64_t size() const override { return mSize; }
+
+            size_t read(uint64_t offset, void* dst, size_t size) const override {
+                if (!dst)
+                    return 0;
+                if (size >= 2 * mCache.blockSize())
+                    return readFully(offset, dst, size);
+                return mCache.read(mSize, offset, dst, size, [this](uint64_t blockOffset, uint8_t* out, size_t n) {
+                    return readFully(blockOffset, out, n);
+                });
+            }
+
+            const char* name() const override { return "pread"; }
+
+        protected:
+            size_t readFully(uint64_t offset, void* dst, size_t size) const {
+                size = clampToSource(mSize, offset, size);
+                uint8_t* out = static_cast<uint8_t*>(dst);
+                size_t done = 0;
+                while (done < size) {
+                    const size_t n = readAt(offset + done, out + done, size - done);
+                    if (n == 0)
+                        break;
+                    done += n;
+                }
+                return done;
+            }
+
+            size_t readAt(uint64_t offset, uint8_t* dst, size_t size) const {
+#ifdef _WIN32
+                // An event per call: the handle may be overlapped, and several threads read at once.
+                OVERLAPPED ov{};
+                ov.Offset = static_cast<DWORD>(offset & 0xffffffffu);
+                ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+                ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+                const DWORD request = static_cast<DWORD>((std::min)(size, size_t{ 1 } << 30));
+                DWORD bytesRead = 0;
+                BOOL ok = ReadFile(mFile, dst, request, nullptr, &ov);
+                if (ok || GetLastError() == ERROR_IO_PENDING)
+                    ok = GetOverlappedResult(mFile, &ov, &bytesRead, TRUE);
+                const DWORD error = ok ? 0 : GetLastError();
+                CloseHandle(ov.hEvent);
+                if (!ok && error != ERROR_HANDLE_EOF)
+                    throw IOException("Read failed at offset " + std::to_string(offset) + " (error " + std::to_string(error) + ")");
+                return bytesRead;
+#else
+                while (true) {
+                    const ssize_t n = ::pread(mFd, dst, size, static_cast<off_t>(offset));
+                    if (n >= 0)
+                        return static_cast<size_t>(n);
+                    if (errno != EINTR)
+                        throw IOException("Read failed at offset " + std::to_string(offset) + ": " + std::strerror(errno));
+                }
+#endif
+            }
+
+#ifdef _WIN32
+            HANDLE mFile = INVALID_HANDLE_VALUE;
+#else
+            int mFd = -1;
+#endif
+            uint64_t mSize = 0;
+            mutable BlockCache mCache;
+        };
+
+        //
+        // Pread with batches kept in flight by the kernel: io_uring on Linux, overlapped ReadFile
+        // on Windows. Single reads still go through the inherited cache.
+        //
+
+#if defined(MOTIONCAM_HAVE_IO_URING) || defined(_WIN32)
+        class AsyncByteSource : public PreadByteSource {
+        public:
+            AsyncByteSource(const std::string& path, const ByteSourceOptions& options) :
+                PreadByteSource(path, options, true),
+                mQueueDepth((std::max)(options.queueDepth, 1u))
+            {
+#ifdef MOTIONCAM_HAVE_IO_URING
+                const int result = io_uring_queue_init(mQueueDepth, &mRing, 0);
+                if (result < 0) {
+                    ::close(mFd);
+                    mFd = -1;
+                    throw IOException("io_uring_queue_init failed: " + std::string(std::strerror(-result)));
+                }
+#endif
+            }
+
+            ~AsyncByteSource() override {
+#ifdef MOTIONCAM_HAVE_IO_URING
+                io_uring_queue_exit(&mRing);
+#endif
+            }
+
+            void readBatch(ReadRequest* requests, size_t count) const override;
+
+            unsigned maxInFlight() const override { return mQueueDepth; }
+
+#ifdef MOTIONCAM_HAVE_IO_URING
+            const char* name() const override { return "io_uring"; }
+#else
+            const char* name() const override { return "overlapped"; }
+#endif
+
+        private:
+            const unsigned mQueueDepth;
+#ifdef MOTIONCAM_HAVE_IO_URING
+            mutable std::mutex mRingMutex; // The ring serves one batch at a time
+            mutable io_uring mRing{};
+#endif
+        };
+
+#ifdef MOTIONCAM_HAVE_IO_URING
+        void AsyncByteSource::readBatch(ReadRequest* requests, size_t count) const {
+            std::lock_guard<std::mutex> lock(mRingMutex);
+
+            std::vector<size_t> wanted(count);
+            for (size_t i = 0; i < count; ++i) {
+                requests[i].bytesRead = 0;
+                wanted[i] = clampToSource(mSize, requests[i].offset, requests[i].size);
+            }
+
+            auto submit = [&](size_t i) {
+                io_uring_sqe* sqe = io_uring_get_sqe(&mRing);
+                ReadRequest& r = requests[i];
+                io_uring_prep_read(sqe, mFd, static_cast<uint8_t*>(r.dst) + r.bytesRead,
+                    static_cast<unsigned>((std::min)(wanted[i] - r.bytesRead, size_t{ 1 } << 30)), r.offset + r.bytesRead);
+                io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+            };
+
+            size_t next = 0;
+            unsigned inFlight = 0;
+            int firstError = 0;
+            while (next < count || inFlight > 0) {
+                while (next < count && inFlight < mQueueDepth && firstError == 0) {
+                    if (wanted[next] > 0) {
+                        submit(next);
+                        ++inFlight;
+                    }
+                    ++next;
+                }
+                if (inFlight == 0)
+                    break;
+                io_uring_submit(&mRing);
+
+                io_uring_cqe* cqe = nullptr;
+                const int waitResult = io_uring_wait_cqe(&mRing, &cqe);
+                if (waitResult == -EINTR)
+                    continue;
+                if (waitResult < 0)
+                    throw IOException("io_uring_wait_cqe failed: " + std::string(std::strerror(-waitResult)));
+
+                const size_t i = static_cast<size_t>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+                const int result = cqe->res;
+                io_uring_cqe_seen(&mRing, cqe);
+                --inFlight;
+
+                if (result < 0) {
+                    // Keep reaping so no read still targets the caller's buffers when we throw.
+                    if (firstError == 0) firstError = -result;
+                    next = count;
+                    continue;
+                }
+                requests[i].bytesRead += static_cast<size_t>(result);
+                if (result > 0 && requests[i].bytesRead < wanted[i] && firstError == 0) {
+                    submit(i);
+                    ++inFlight;
+                }
+            }
+            if (firstError != 0)
+                throw IOException("io_uring read failed: " + std::string(std::strerror(firstError)));
+        }
+#else
+        void AsyncByteSource::readBatch(ReadRequest* requests, size_t count) const {
+            struct Pending {
+                OVERLAPPED ov{};
+                size_t index = 0;
+                DWORD length = 0;
+            };
+            std::vector<Pending> window(mQueueDepth);
+            for (Pending& p : window)
+                p.ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+            std::vector<size_t> wanted(count);
+            for (size_t i = 0; i < count; ++i) {
+                requests[i].bytesRead = 0;
+                wanted[i] = clampToSource(mSize, requests[i].offset, requests[i].size);
+            }
+
+            // Slots are reused in FIFO order: issue into slot (head + inFlight), complete slot head.
+            DWORD firstError = 0;
+            auto issue = [&](Pending& p, size_t i) {
+                ReadRequest& r = requests[i];
+                const uint64_t offset = r.offset + r.bytesRead;
+                p.index = i;
+                p.length = static_cast<DWORD>((std::min)(wanted[i] - r.bytesRead, size_t{ 1 } << 30));
+                p.ov.Offset = static_cast<DWORD>(offset & 0xffffffffu);
+                p.ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+                ResetEvent(p.ov.hEvent);
+                if (!ReadFile(mFile, static_cast<uint8_t*>(r.dst) + r.bytesRead, p.length, nullptr, &p.ov) && GetLastError() != ERROR_IO_PENDING) {
+                    if (firstError == 0) firstError = GetLastError();
+                    return false;
+                }
+                return true;
+            };
+
+            size_t next = 0;
+            size_t head = 0;
+            size_t inFlight = 0;
+            while (next < count || inFlight > 0) {
+                while (next < count && inFlight < window.size() && firstError == 0) {
+                    if (wanted[next] > 0 && issue(window[(head + inFlight) % window.size()], next))
+                        ++inFlight;
+                    ++next;
+                }
+                if (inFlight == 0)
+                    break;
+
+                Pending& p = window[head];
+                DWORD bytesRead = 0;
+                if (!GetOverlappedResult(mFile, &p.ov, &bytesRead, TRUE) && GetLastError() != ERROR_HANDLE_EOF) {
+                    if (firstError == 0) firstError = GetLastError();
+                }
+                head = (head + 1) % window.size();
+                --inFlight;
+
+                ReadRequest& r = requests[p.index];
+                r.bytesRead += bytesRead;
+                if (bytesRead > 0 && r.bytesRead < wanted[p.index] && firstError == 0) {
+                    if (issue(window[(head + inFlight) % window.size()], p.index))
+                        ++inFlight;
+                }
+            }
+            for (Pending& p : window)
+                CloseHandle(p.ov.hEvent);
+            if (firstError != 0)
+                throw IOException("Overlapped read failed (error " + std::to_string(firstError) + ")");
+        }
+#endif
+#endif
+
+        //
+        // HTTP/1.1 range requests over plain sockets with keep-alive connections. Small reads go
+        // through the block cache; a batch is coalesced into contiguous spans fetched in parallel.
+        //
+
+#ifdef _WIN32
+        typedef SOCKET SocketHandle;
+        const SocketHandle kInvalidSocket = INVALID_SOCKET;
+        void closeSocket(SocketHandle s) { closesocket(s); }
+
+        struct WinsockInit {
+            WinsockInit() { WSADATA data; WSAStartup(MAKEWORD(2, 2), &data); }
+            ~WinsockInit() { WSACleanup(); }
+        };
+#else
+        typedef int SocketHandle;
+        const SocketHandle kInvalidSocket = -1;
+        void closeSocket(SocketHandle s) { ::close(s); }
+#endif
+
+        // A send() on a connection the server has closed must fail with EPIPE, not kill the
+        // process. Linux takes a per-call flag; macOS has a socket option set in connect().
+#ifdef MSG_NOSIGNAL
+        const int kSendFlags = MSG_NOSIGNAL;
+#else
+        const int kSendFlags = 0;
+#endif
+
+        struct HttpUrl {
+            std::string host;
+            std::string port = "80";
+            std::string target = "/";
+        };
+
+        HttpUrl parseHttpUrl(const std::string& url) {
+            const std::string scheme = "http://";
+            if (url.compare(0, 8, "https://") == 0)
+                throw IOException("https is not supported; serve the files over plain http or mount the share: " + url);
+            if (url.compare(0, scheme.size(), scheme) != 0)
+                throw IOException("Not an http URL: " + url);
+
+            HttpUrl parsed;
+            const size_t hostStart = scheme.size();
+            const size_t slash = url.find('/', hostStart);
+            const std::string authority = url.substr(hostStart, slash == std::string::npos ? std::string::npos : slash - hostStart);
+            if (slash != std::string::npos)
+                parsed.target = url.substr(slash);
+
+            const size_t colon = authority.rfind(':');
+            if (colon != std::string::npos && authority.find(']') == std::string::npos) {
+                parsed.host = authority.substr(0, colon);
+                parsed.port = authority.substr(colon + 1);
+            }
+            else {
+                parsed.host = authority;
+            }
+            if (parsed.host.empty())
+                throw IOException("Missing host in URL: " + url);
+            return parsed;
+        }
+
+        class HttpByteSource : public ByteSource {
+        public:
+            HttpByteSource(const std::string& url, const ByteSourceOptions& options) :
+                mUrl(url),
+                mAddress(parseHttpUrl(url)),
+                mCache(options.blockSize, options.cacheBytes),
+                mMaxConnections((std::max)(options.queueDepth, 1u))
+            {
+#ifdef _WIN32
+                static WinsockInit winsock;
+#endif
+                // A one-byte range reports the total size in Content-Range.
+                uint8_t probe = 0;
+                fetch(0, &probe, 1, &mSize);
+            }
+
+            ~HttpByteSource() override {
+                for (SocketHandle s : mIdle)
+                    closeSocket(s);
+            }
+
+            uint64_t size() const override { return mSize; }
+
+            size_t read(uint64_t offset, void* dst, size_t size) const override {
+                if (!dst)
+                    return 0;
+                size = clampToSource(mSize, offset, size);
+                if (size == 0)
+                    return 0;
+                if (size >= 2 * mCache.blockSize())
+                    return fetch(offset, static_cast<uint8_t*>(dst), size, nullptr);
+                return mCache.read(mSize, offset, dst, size, [this](uint64_t blockOffset, uint8_t* out, size_t n) {
+                    return fetch(blockOffset, out, n, nullptr);
+                });
+            }
+
+            void readBatch(ReadRequest* requests, size_t count) const override;
+
+            unsigned maxInFlight() const override { return mMaxConnections; }
+
+            const char* name() const override { return "http"; }
+
+        private:
+            struct Span {
+                uint64_t begin = 0;
+                uint64_t end = 0;
+                std::vector<size_t> requests; // Indices into the batch, in offset order
+            };
+
+            SocketHandle connect() const;
+            SocketHandle acquire() const;
+            void release(SocketHandle s) const;
+            size_t fetch(uint64_t offset, uint8_t* dst, size_t size, uint64_t* outTotalSize) const;
+            size_t fetchOnce(SocketHandle s, uint64_t offset, uint8_t* dst, size_t size, uint64_t* outTotalSize, bool& keepAlive) const;
+
+            const std::string mUrl;
+            const HttpUrl mAddress;
+            uint64_t mSize = 0;
+            mutable BlockCache mCache;
+            const unsigned mMaxConnections;
+            mutable std::mutex mPoolMutex;
+            mutable std::vector<SocketHandle> mIdle;
+        };
+
+        SocketHandle HttpByteSource::connect() const {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo* addresses = nullptr;
+            if (getaddrinfo(mAddress.host.c_str(), mAddress.port.c_str(), &hints, &addresses) != 0 || !addresses)
+                throw IOException("Cannot resolve " + mAddress.host);
+
+            SocketHandle s = kInvalidSocket;
+            for (addrinfo* a = addresses; a; a = a->ai_next) {
+                s = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+                if (s == kInvalidSocket)
+                    continue;
+                if (::connect(s, a->ai_addr, static_cast<int>(a->ai_addrlen)) == 0)
+                    break;
+                closeSocket(s);
+                s = kInvalidSocket;
+            }
+            freeaddrinfo(addresses);
+            if (s == kInvalidSocket)
+                throw IOException("Cannot connect to " + mAddress.host + ":" + mAddress.port);
+
+            int noDelay = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+            int noSigPipe = 1;
+            setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+#ifdef _WIN32
+            DWORD timeoutMs = 30000;
+            setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutMs), sizeof(timeoutMs));
+#else
+            timeval timeout{ 30, 0 };
+            setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+            return s;
+        }
+
+        SocketHandle HttpByteSource::acquire() const {
+            {
+                std::lock_guard<std::mutex> lock(mPoolMutex);
+                if (!mIdle.empty()) {
+                    SocketHandle s = mIdle.back();
+                    mIdle.pop_back();
+                    return s;
+                }
+            }
+            return connect();
+        }
+
+        void HttpByteSource::release(SocketHandle s) const {
+            std::lock_guard<std::mutex> lock(mPoolMutex);
+            if (mIdle.size() < mMaxConnections)
+                mIdle.push_back(s);
+            else
+                closeSocket(s);
+        }
+
+        size_t HttpByteSource::fetch(uint64_t offset, uint8_t* dst, size_t size, uint64_t* outTotalSize) const {
+            // A pooled connection may have been closed by the server; retry once on a fresh one.
+            for (int attempt = 0; ; ++attempt) {
+                SocketHandle s = attempt == 0 ? acquire() : connect();
+                bool keepAlive = false;
+                try {
+                    const size_t n = fetchOnce(s, offset, dst, size, outTotalSize, keepAlive);
+                    if (keepAlive) release(s);
+                    else closeSocket(s);
+                    return n;
+                }
+                catch (const IOException&) {
+                    closeSocket(s);
+                    if (attempt > 0)
+                        throw;
+                }
+            }
+        }
+
+        size_t HttpByteSource::fetchOnce(SocketHandle s, uint64_t offset, uint8_t* dst, size_t size, uint64_t* outTotalSize, bool& keepAlive) const {
+            const std::string request =
+                "GET " + mAddress.target + " HTTP/1.1\r\n"
+                "Host: " + mAddress.host + "\r\n"
+                "Range: bytes=" + std::to_string(offset) + "-" + std::to_string(offset + size - 1) + "\r\n"
+                "Connection: keep-alive\r\n\r\n";
+            for (size_t sent = 0; sent < request.size(); ) {
+                const auto n = send(s, request.data() + sent, static_cast<int>(request.size() - sent), kSendFlags);
+                if (n <= 0)
+                    throw IOException("Failed to send request to " + mUrl);
+                sent += static_cast<size_t>(n);
+            }
+
+            // Headers, plus whatever part of the body arrived with them.
+            std::string header;
+            char buffer[16384];
+            size_t headerEnd = std::string::npos;
+            while (headerEnd == std::string::npos) {
+                const auto n = recv(s, buffer, sizeof(buffer), 0);
+                if (n <= 0)
+                    throw IOException("Connection closed while reading response from " + mUrl);
+                header.append(buffer, static_cast<size_t>(n));
+                headerEnd = header.find("\r\n\r\n");
+                if (headerEnd == std::string::npos && header.size() > 65536)
+                    throw IOException("Response header too large from " + mUrl);
+            }
+            std::string body = header.substr(headerEnd + 4);
+            header.resize(headerEnd + 2);
+
+            std::string lower = header;
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+            auto headerValue = [&](const char* name) -> std::string {
+                const std::string key = std::string("\r\n") + name + ":";
+                const size_t at = lower.find(key);
+                if (at == std::string::npos)
+                    return {};
+                size_t begin = at + key.size();
+                const size_t end = lower.find("\r\n", begin);
+                while (begin < end && header[begin] == ' ') ++begin;
+                return header.substr(begin, end - begin);
+            };
+
+            const size_t space = header.find(' ');
+            const int status = space == std::string::npos ? 0 : std::atoi(header.c_str() + space + 1);
+            if (status != 206)
+                throw IOException("Range request to " + mUrl + " returned HTTP " + std::to_string(status) + (status == 200 ? " (server ignores Range)" : ""));
+            if (!headerValue("transfer-encoding").empty())
+                throw IOException("Chunked range responses are not supported: " + mUrl);
+
+            const std::string lengthValue = headerValue("content-length");
+            if (lengthValue.empty())
+                throw IOException("Range response without Content-Length from " + mUrl);
+            const size_t contentLength = static_cast<size_t>(std::stoull(lengthValue));
+            if (outTotalSize) {
+                const std::string range = headerValue("content-range");
+                const size_t slash = range.find('/');
+                if (slash == std::string::npos || range.compare(slash + 1, 1, "*") == 0)
+                    throw IOException("Server did not report the size of " + mUrl);
+                *outTotalSize = std::stoull(range.substr(slash + 1));
+            }
+            if (contentLength > size)
+                throw IOException("Range response larger than requested from " + mUrl);
+
+            const size_t fromHeader = (std::min)(body.size(), contentLength);
+            std::memcpy(dst, body.data(), fromHeader);
+            size_t received = fromHeader;
+            while (received < contentLength) {
+                const auto n = recv(s, reinterpret_cast<char*>(dst) + received, static_cast<int>((std::min)(contentLength - received, size_t{ 1 } << 30)), 0);
+                if (n <= 0)
+                    throw IOException("Connection closed mid-body from " + mUrl);
+                received += static_cast<size_t>(n);
+            }
+            keepAlive = lower.find("\r\nconnection: close") == std::string::npos && body.size() <= contentLength;
+            return received;
+        }
+
+        void HttpByteSource::readBatch(ReadRequest* requests, size_t count) const {
+            std::vector<size_t> order;
+            order.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                requests[i].bytesRead = 0;
+                if (clampToSource(mSize, requests[i].offset, requests[i].size) > 0)
+                    order.push_back(i);
+            }
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return requests[a].offset < requests[b].offset; });
+
+            // Requests separated by less than a block are cheaper as one range than as two.
+            std::vector<Span> spans;
+            for (size_t i : order) {
+                const uint64_t begin = requests[i].offset;
+                const uint64_t end = begin + clampToSource(mSize, begin, requests[i].size);
+                if (!spans.empty() && begin <= spans.back().end + mCache.blockSize()) {
+                    spans.back().end = (std::max)(spans.back().end, end);
+                    spans.back().requests.push_back(i);
+                }
+                else {
+                    spans.push_back(Span{ begin, end, { i } });
+                }
+            }
+
+            std::atomic<size_t> nextSpan{ 0 };
+            std::mutex errorMutex;
+            std::string firstError;
+            auto worker = [&]() {
+                std::vector<uint8_t> scratch;
+                for (size_t k = nextSpan.fetch_add(1); k < spans.size(); k = nextSpan.fetch_add(1)) {
+                    const Span& span = spans[k];
+                    try {
+                        if (span.requests.size() == 1) {
+                            ReadRequest& r = requests[span.requests.front()];
+                            r.bytesRead = fetch(span.begin, static_cast<uint8_t*>(r.dst), static_cast<size_t>(span.end - span.begin), nullptr);
+                            continue;
+                        }
+                        scratch.resize(static_cast<size_t>(span.end - span.begin));
+                        const size_t got = fetch(span.begin, scratch.data(), scratch.size(), nullptr);
+                        for (size_t i : span.requests) {
+                            ReadRequest& r = requests[i];
+                            const size_t at = static_cast<size_t>(r.offset - span.begin);
+                            const size_t n = at < got ? (std::min)(clampToSource(mSize, r.offset, r.size), got - at) : 0;
+                            std::memcpy(r.dst, scratch.data() + at, n);
+                            r.bytesRead = n;
+                        }
+                    }
+                    catch (const std::exception& e) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        if (firstError.empty()) firstError = e.what();
+                    }
+                }
+            };
+
+            const size_t numWorkers = (std::min)(spans.size(), static_cast<size_t>(mMaxConnections));
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < numWorkers; ++i)
+                workers.emplace_back(worker);
+            worker();
+            for (std::thread& t : workers)
+                t.join();
+            if (!firstError.empty())
+                throw IOException(firstError);
+        }
+    }
+
+    //
+
+    bool isRemoteLocation(const std::string& location) {
+        return location.compare(0, 7, "http://") == 0 || location.compare(0, 8, "https://") == 0;
+    }
+
+    bool parseByteSourceKind(const std::string& name, ByteSourceKind& outKind) {
+        if (name == "auto") outKind = ByteSourceKind::Auto;
+        else if (name == "mmap") outKind = ByteSourceKind::Mmap;
+        else if (name == "pread") outKind = ByteSourceKind::Pread;
+        else if (name == "async" || name == "uring" || name == "io_uring") outKind = ByteSourceKind::Async;
+        else if (name == "http") outKind = ByteSourceKind::Http;
+        else return false;
+        return true;
+    }
+
+    bool asyncByteSourceAvailable() {
+#if defined(MOTIONCAM_HAVE_IO_URING) || defined(_WIN32)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::unique_ptr<ByteSource> openByteSource(const std::string& location, const ByteSourceOptions& options) {
+        if (isRemoteLocation(location))
+            return std::make_unique<HttpByteSource>(location, options);
+
+        switch (options.kind) {
+        case ByteSourceKind::Pread:
+            return std::make_unique<PreadByteSource>(location, options);
+        case ByteSourceKind::Async:
+#if defined(MOTIONCAM_HAVE_IO_URING) || defined(_WIN32)
+            return std::make_unique<AsyncByteSource>(location, options);
+#else
+            return std::make_unique<PreadByteSource>(location, options);
+#endif
+        case ByteSourceKind::Http:
+            throw IOException("Not an http URL: " + location);
+        case ByteSourceKind::Auto:
+        case ByteSourceKind::Mmap:
+        default:
+            return std::make_unique<MmapByteSource>(location);
+        }
+    }
+
+    void setDefaultByteSourceOptions(const ByteSourceOptions& options) {
+        std::lock_guard<std::mutex> lock(gDefaultOptionsMutex);
+        gDefaultOptions = options;
+    }
+
+    ByteSourceOptions defaultByteSourceOptions() {
+        std::lock_guard<std::mutex> lock(gDefaultOptionsMutex);
+        return gDefaultOptions;
+    }
+
+} // namespace motioncam
+// --- END OF FILE motioncam/ByteSource.cpp ---
@@ -13,59 +13,83 @@ namespace motioncam {
     namespace {
         class AudioChunkLoaderImpl : public AudioChunkLoader {
         public:
-            AudioChunkLoaderImpl(const mio::mmap_source& src, const std::vector<BufferOffset>& offsets);
+            AudioChunkLoaderImpl(const ByteSource& src, const std::vector<BufferOffset>& offsets);
             ~AudioChunkLoaderImpl() override = default; // Implement virtual destructor
             bool next(AudioChunk& output) override;
 
         private:
-            const mio::mmap_source& mSrc;
+            const ByteSource& mSrc;
             const std::vector<BufferOffset>& mOffsets;
 
             size_t mIdx;
         };
 
-        size_t read(const mio::mmap_source& src, size_t offset, void* dst, size_t size, size_t items = 1) {
-            // Calculate total bytes to read
-            size_t totalBytes = size * items;
-
-            // Check basic validity
-            if (!dst || offset >= src.size()) {
+        size_t read(const ByteSource& src, size_t offset, void* dst, size_t size, size_t items = 1) {
+            // Reads past the end of the source come back short rather than failing
+            if (!dst)
                 return 0;
-            }
 
-            // Calculate available bytes from offset to end of file
-            size_t availableBytes = src.size() - offset;
+            return src.read(offset, dst, size * items);
+        }
 
-            // Read only what's available
-            size_t bytesToRead = (std::min)(totalBytes, availableBytes);
-            if (bytesToRead == 0)
-                return 0;
+        // A frame record is a BUFFER item, its payload, a METADATA item and the metadata JSON.
+        // record holds the bytes read from the start of the record; on success it is reduced
+        // in place to the compressed payload.
+        bool splitFrameRecord(std::vector<uint8_t>& record, size_t bytesRead, std::vector<uint8_t>& outMetadata) {
+            if (bytesRead < sizeof(Item))
+                return false;
+
+            Item bufferItem{};
+            std::memcpy(&bufferItem, record.data(), sizeof(Item));
+            const size_t metadataItemAt = sizeof(Item) + static_cast<size_t>(bufferItem.size);
+            if (bufferItem.type != Type::BUFFER || metadataItemAt + sizeof(Item) > bytesRead)
+                return false;
+
+            Item metadataItem{};
+            std::memcpy(&metadataItem, record.data() + metadataItemAt, sizeof(Item));
+            const size_t metadataAt = metadataItemAt + sizeof(Item);
+            if (metadataItem.type != Type::METADATA || metadataAt + metadataItem.size > bytesRead)
+                return false;
 
-            // Get pointer to the data at the specified offset
-            const char* srcPtr = src.data() + offset;
+            outMetadata.assign(record.begin() + metadataAt, record.begin() + metadataAt + metadataItem.size);
+            std::memmove(record.data(), record.data() + sizeof(Item), bufferItem.size);
+            record.resize(bufferItem.size);
+            return true;
+        }
 
-            // Copy data from memory-mapped source to destination buffer
-            std::memcpy(dst, srcPtr, bytesToRead);
+        bool parseFrameInfo(const std::vector<uint8_t>& metadataPayload, int& outWidth, int& outHeight, int& outCompressionType) {
+            try {
+                nlohmann::json frameMeta = nlohmann::json::parse(
+                    std::string(metadataPayload.begin(), metadataPayload.end())
+                );
+                outWidth = frameMeta.value("width", 0);
+                outHeight = frameMeta.value("height", 0);
+                outCompressionType = frameMeta.value("compressionType", -1);
+            }
+            catch (const nlohmann::json::parse_error&) {
+                return false;
+            }
 
-            // Return bytes read
-            return bytesToRead;
+            // Essential metadata missing or invalid
+            return outWidth > 0 && outHeight > 0 && outCompressionType != -1;
         }
 
-        bool loadAudioChunk(const mio::mmap_source& src, const BufferOffset& o, AudioChunk& outChunk) {
+        bool loadAudioChunk(const ByteSource& src, const BufferOffset& o, AudioChunk& outChunk) {
             size_t offset = o.offset;
 
             // Get audio data header
             Item audioDataItem{};
-            offset += read(src, offset, &audioDataItem, sizeof(Item));
-
-            if (audioDataItem.type != Type::AUDIO_DATA)
+            if (read(src, offset, &audioDataItem, sizeof(Item)) != sizeof(Item) || audioDataItem.type != Type::AUDIO_DATA)
                 throw IOException("Invalid audio data");
+            offset += sizeof(Item);
 
-            // Read into temporary buffer
+            // Read into temporary buffer. A short read is a truncated file, not a short chunk.
             std::vector<int16_t> tmp;
 
             tmp.resize((audioDataItem.size + 1) / 2);
-            offset += read(src, offset, (void*)tmp.data(), audioDataItem.size);
+            if (read(src, offset, (void*)tmp.data(), audioDataItem.size) != audioDataItem.size)
+                throw IOException("Truncated audio data");
+            offset += audioDataItem.size;
 
             // Metadata should follow (this was added later so some files may not have it)
             Item audioMetadataItem{};
@@ -88,7 +112,7 @@ namespace motioncam {
     }
     //
 
-    AudioChunkLoaderImpl::AudioChunkLoaderImpl(const mio::mmap_source& src, const std::vector<BufferOffset>& offsets) :
+    AudioChunkLoaderImpl::AudioChunkLoaderImpl(const ByteSource& src, const std::vector<BufferOffset>& offsets) :
         mSrc(src), mOffsets(offsets), mIdx(0) {
     }
 
@@ -106,17 +130,22 @@ namespace motioncam {
 
     //
 
-    Decoder::Decoder(const std::string& path) {
-        // Memory map input file
-        std::error_code error;
+    Decoder::Decoder(const std::string& path) :
+        Decoder(openByteSource(path, defaultByteSourceOptions())) {
+    }
 
-        mMemoryMap.map(path, error);
-        if (error)
-            throw IOException("Failed to memory map " + path);
+    Decoder::Decoder(std::unique_ptr<ByteSource> source) :
+        mSource(std::move(source)) {
+        if (!mSource)
+            throw IOException("No byte source");
 
         init();
     }
 
+    const ByteSource& Decoder::getByteSource() const {
+        return *mSource;
+    }
+
     void Decoder::init() {
         Header header{};
         size_t offset = 0;
@@ -151,8 +180,18 @@ namespace motioncam {
 
         readExtra();
 
+        // Every record ends where the next one starts; the last one ends before the index
+        mRecordStarts.clear();
+        mRecordStarts.reserve(mOffsets.size() + mAudioOffsets.size() + 1);
+        for (const auto& o : mOffsets)
+            mRecordStarts.push_back(o.offset);
+        for (const auto& o : mAudioOffsets)
+            mRecordStarts.push_back(o.offset);
+        std::sort(mRecordStarts.begin(), mRecordStarts.end());
+        mRecordStarts.push_back(static_cast<int64_t>(mSource->size() - (sizeof(BufferIndex) + sizeof(Item))));
+
         // Create audio loader
-        mAudioLoader = std::make_unique<AudioChunkLoaderImpl>(mMemoryMap, mAudioOffsets);
+        mAudioLoader = std::make_unique<AudioChunkLoaderImpl>(*mSource, mAudioOffsets);
     }
 
     const std::vector<Timestamp>& Decoder::getFrames() const {
@@ -177,11 +216,11 @@ namespace motioncam {
         return 0; // Or some default, or throw
     }
 
-    void Decoder::loadAudio(std::vector<AudioChunk>& outAudioChunks) {
+    void Decoder::loadAudio(std::vector<AudioChunk>& outAudioChunks) const {
         for (const auto& o : mAudioOffsets) {
             AudioChunk chunk;
 
-            if (!loadAudioChunk(mMemoryMap, o, chunk))
+            if (!loadAudioChunk(*mSource, o, chunk))
                 continue;
 
             outAudioChunks.emplace_back(chunk);
@@ -195,10 +234,14 @@ namespace motioncam {
         return *mAudioLoader;
     }
 
+    std::unique_ptr<AudioChunkLoader> Decoder::makeAudioLoader() const {
+        return std::make_unique<AudioChunkLoaderImpl>(*mSource, mAudioOffsets);
+    }
+
     void Decoder::loadFrame(
         const Timestamp           timestamp,
         std::vector<uint8_t>& outData,
-        nlohmann::json& outMetadata)
+        nlohmann::json& outMetadata) const
     {
         // 1) Locate the frame in the index
         if (mFrameOffsetMap.find(timestamp) == mFrameOffsetMap.end())
@@ -255,7 +298,7 @@ namespace motioncam {
         const Timestamp  timestamp,
         uint16_t* externalOutputBuffer,
         size_t           externalBufferSize,
-        nlohmann::json& outMetadata)
+        nlohmann::json& outMetadata) const
     {
         // 1) Locate the frame in the index
         if (mFrameOffsetMap.find(timestamp) == mFrameOffsetMap.end())
@@ -315,7 +358,7 @@ namespace motioncam {
         std::vector<uint8_t>& outCompressedPayload,
         std::vector<uint8_t>& outMetadataPayload,
         int& outWidth, int& outHeight, int& outCompressionType
-    ) {
+    ) const {
         // 1) Locate the frame in the index
         auto it_offset = mFrameOffsetMap.find(timestamp);
         if (it_offset == mFrameOffsetMap.end()) {
@@ -352,31 +395,260 @@ namespace motioncam {
         }
 
         // 6) Parse essential info from metadata for the caller (optional, but useful)
-        try {
-            nlohmann::json frameMeta = nlohmann::json::parse(
-                std::string(outMetadataPayload.begin(), outMetadataPayload.end())
-            );
-            outWidth = frameMeta.value("width", 0);
-            outHeight = frameMeta.value("height", 0);
-            outCompressionType = frameMeta.value("compressionType", -1);
-
-            if (outWidth <= 0 || outHeight <= 0 || outCompressionType == -1) {
-                // Essential metadata missing or invalid
-                return false;
+        return parseFrameInfo(outMetadataPayload, outWidth, outHeight, outCompressionType);
+    }
+
+    void Decoder::getRawFramePayloads(
+        const std::vector<Timestamp>& timestamps,
+        std::vector<FramePayload>& outPayloads
+    ) const {
+        outPayloads.resize(timestamps.size());
+
+        std::vector<ReadRequest> requests;
+        std::vector<size_t> requestFrames;
+        requests.reserve(timestamps.size());
+        requestFrames.reserve(timestamps.size());
+
+        // 1) One read per frame covering its whole record
+        for (size_t i = 0; i < timestamps.size(); ++i) {
+            FramePayload& payload = outPayloads[i];
+            payload.timestamp = timestamps[i];
+            payload.valid = false;
+
+            auto it_offset = mFrameOffsetMap.find(timestamps[i]);
+            if (it_offset == mFrameOffsetMap.end())
+                continue;
+
+            const int64_t start = it_offset->second.offset;
+            auto next = std::upper_bound(mRecordStarts.begin(), mRecordStarts.end(), start);
+            if (next == mRecordStarts.end() || *next - start < static_cast<int64_t>(2 * sizeof(Item)))
+                continue;
+
+            payload.compressedPayload.resize(static_cast<size_t>(*next - start));
+
+            ReadRequest request;
+            request.offset = static_cast<uint64_t>(start);
+            request.dst = payload.compressedPayload.data();
+            request.size = payload.compressedPayload.size();
+            requests.push_back(request);
+            requestFrames.push_back(i);
+        }
+
+        // 2) Issue them together
+        mSource->readBatch(requests.data(), requests.size());
+
+        // 3) Split each record into payload and metadata
+        for (size_t k = 0; k < requests.size(); ++k) {
+            FramePayload& payload = outPayloads[requestFrames[k]];
+            if (splitFrameRecord(payload.compressedPayload, requests[k].bytesRead, payload.metadataPayload)) {
+                payload.valid = parseFrameInfo(payload.metadataPayload, payload.width, payload.height, payload.compressionType);
+            }
+            else {
+                // Records not laid out back to back; take the item-by-item path
+                payload.valid = getRawFramePayloads(payload.timestamp, payload.compressedPayload, payload.metadataPayload,
+                    payload.width, payload.height, payload.compressionType);
             }
         }
-        catch (const nlohmann::json::parse_error& e) {
-            // Failed to parse metadata JSON
-            return false;
+    }
+
+    void Decoder::getBlockMetadata(
+        const std::vector<Timestamp>& timestamps,
+        std::vector<FrameBlockMetadata>& outFrames
+    ) const {
+        constexpr size_t kPayloadHeaderSize = 16;
+        constexpr size_t kHeadSize = sizeof(Item) + kPayloadHeaderSize;
+
+        outFrames.assign(timestamps.size(), FrameBlockMetadata());
+        std::vector<uint8_t> heads(timestamps.size() * kHeadSize);
+        std::vector<int64_t> recordStarts(timestamps.size(), 0);
+        std::vector<ReadRequest> requests;
+        std::vector<size_t> requestFrames;
+        requests.reserve(timestamps.size());
+        requestFrames.reserve(timestamps.size());
+
+        // 1) The BUFFER item and payload header of every frame
+        for (size_t i = 0; i < timestamps.size(); ++i) {
+            outFrames[i].timestamp = timestamps[i];
+
+            auto it_offset = mFrameOffsetMap.find(timestamps[i]);
+            if (it_offset == mFrameOffsetMap.end())
+                continue;
+
+            const int64_t start = it_offset->second.offset;
+            auto next = std::upper_bound(mRecordStarts.begin(), mRecordStarts.end(), start);
+            if (next == mRecordStarts.end() || *next - start < static_cast<int64_t>(2 * sizeof(Item)))
+                continue;
+
+            recordStarts[i] = start;
+            outFrames[i].recordSize = static_cast<size_t>(*next - start);
+
+            ReadRequest request;
+            request.offset = static_cast<uint64_t>(start);
+            request.dst = heads.data() + i * kHeadSize;
+            request.size = std::min(kHeadSize, outFrames[i].recordSize);
+            requests.push_back(request);
+            requestFrames.push_back(i);
         }
+        mSource->readBatch(requests.data(), requests.size());
+
+        // 2) Each payload from its bits/refs tables to the end of the record, which also
+        //    covers the METADATA item and the frame's JSON
+        std::vector<std::vector<uint8_t>> tails(timestamps.size());
+        std::vector<size_t> tailStarts(timestamps.size(), 0);
+        std::vector<ReadRequest> tailRequests;
+        std::vector<size_t> tailFrames;
+        for (size_t k = 0; k < requests.size(); ++k) {
+            const size_t i = requestFrames[k];
+            FrameBlockMetadata& frame = outFrames[i];
+            if (requests[k].bytesRead < sizeof(Item))
+                continue;
 
-        return true;
+            Item bufferItem{};
+            std::memcpy(&bufferItem, heads.data() + i * kHeadSize, sizeof(Item));
+            if (bufferItem.type != Type::BUFFER || 2 * sizeof(Item) + bufferItem.size > frame.recordSize)
+                continue;
+            frame.compressedSize = bufferItem.size;
+
+            // Frames that are not type 7 (or whose header is damaged) only get their metadata read
+            size_t tailStart = bufferItem.size;
+            if (requests[k].bytesRead < kHeadSize ||
+                !raw::BlockMetadataStart(heads.data() + i * kHeadSize + sizeof(Item), bufferItem.size, tailStart)) {
+                tailStart = bufferItem.size;
+            }
+            tailStarts[i] = tailStart;
+            tails[i].resize(frame.recordSize - sizeof(Item) - tailStart);
+
+            ReadRequest request;
+            request.offset = static_cast<uint64_t>(recordStarts[i]) + sizeof(Item) + tailStart;
+            request.dst = tails[i].data();
+            request.size = tails[i].size();
+            tailRequests.push_back(request);
+            tailFrames.push_back(i);
+        }
+        mSource->readBatch(tailRequests.data(), tailRequests.size());
+
+        // 3) Parse the frame metadata, then the tables of type 7 frames
+        for (size_t k = 0; k < tailRequests.size(); ++k) {
+            const size_t i = tailFrames[k];
+            FrameBlockMetadata& frame = outFrames[i];
+            const std::vector<uint8_t>& tail = tails[i];
+            const size_t tableBytes = frame.compressedSize - tailStarts[i];
+            if (tailRequests[k].bytesRead != tail.size() || tableBytes + sizeof(Item) > tail.size())
+                continue;
+
+            Item metadataItem{};
+            std::memcpy(&metadataItem, tail.data() + tableBytes, sizeof(Item));
+            const size_t metadataAt = tableBytes + sizeof(Item);
+            if (metadataItem.type != Type::METADATA || metadataAt + metadataItem.size > tail.size())
+                continue;
+
+            const std::vector<uint8_t> metadataPayload(tail.begin() + metadataAt, tail.begin() + metadataAt + metadataItem.size);
+            if (!parseFrameInfo(metadataPayload, frame.width, frame.height, frame.compressionType))
+                continue;
+            frame.valid = true;
+
+            if (frame.compressionType == MOTIONCAM_COMPRESSION_TYPE && tableBytes > 0) {
+                if (!raw::DecodeBlockMetadata(frame.width, frame.height, heads.data() + i * kHeadSize + sizeof(Item),
+                        tail.data(), tailStarts[i], tableBytes, frame.bits, frame.refs, frame.blocksPerRow, frame.rowGroups)) {
+                    frame.bits.clear();
+                    frame.refs.clear();
+                }
+            }
+        }
+    }
+
+    void Decoder::getRecordExtents(
+        std::vector<RecordExtent>& outFrames,
+        std::vector<RecordExtent>& outAudio
+    ) const {
+        // Frame records are BUFFER + payload + METADATA + JSON; audio records AUDIO_DATA + samples,
+        // optionally followed by AUDIO_DATA_METADATA + AudioMetadata. Two rounds of header reads.
+        std::vector<RecordExtent> extents;
+        extents.reserve(mOffsets.size() + mAudioOffsets.size());
+        for (const auto& o : mOffsets) {
+            RecordExtent e;
+            e.timestamp = o.timestamp;
+            e.indexTimestamp = o.timestamp;
+            e.offset = o.offset;
+            extents.push_back(e);
+        }
+        for (const auto& o : mAudioOffsets) {
+            RecordExtent e;
+            e.timestamp = -1;
+            e.indexTimestamp = o.timestamp;
+            e.offset = o.offset;
+            extents.push_back(e);
+        }
+        const size_t numFrames = mOffsets.size();
+
+        std::vector<Item> heads(extents.size());
+        std::vector<ReadRequest> requests(extents.size());
+        for (size_t i = 0; i < extents.size(); ++i) {
+            requests[i].offset = static_cast<uint64_t>(extents[i].offset);
+            requests[i].dst = &heads[i];
+            requests[i].size = sizeof(Item);
+        }
+        mSource->readBatch(requests.data(), requests.size());
+
+        struct Trailer {
+            Item item;
+            AudioMetadata metadata;
+        };
+        std::vector<Trailer> trailers(extents.size());
+        for (size_t i = 0; i < extents.size(); ++i) {
+            RecordExtent& e = extents[i];
+            const Type expected = i < numFrames ? Type::BUFFER : Type::AUDIO_DATA;
+            if (requests[i].bytesRead != sizeof(Item) || heads[i].type != expected)
+                throw IOException("Corrupted file: bad item header at offset " + std::to_string(e.offset));
+            e.payloadSize = heads[i].size;
+            e.size = static_cast<int64_t>(sizeof(Item)) + heads[i].size;
+
+            requests[i].offset = static_cast<uint64_t>(e.offset + e.size);
+            requests[i].dst = &trailers[i];
+            requests[i].size = sizeof(Trailer);
+        }
+        mSource->readBatch(requests.data(), requests.size());
+
+        for (size_t i = 0; i < extents.size(); ++i) {
+            RecordExtent& e = extents[i];
+            const Trailer& t = trailers[i];
+            auto next = std::upper_bound(mRecordStarts.begin(), mRecordStarts.end(), e.offset);
+            const int64_t limit = next == mRecordStarts.end() ? static_cast<int64_t>(mSource->size()) : *next;
+
+            if (i < numFrames) {
+                if (requests[i].bytesRead < sizeof(Item) || t.item.type != Type::METADATA)
+                    throw IOException("Corrupted file: frame " + std::to_string(e.timestamp) + " has no metadata item");
+                e.size += static_cast<int64_t>(sizeof(Item)) + t.item.size;
+            }
+            else if (requests[i].bytesRead == sizeof(Trailer) && t.item.type == Type::AUDIO_DATA_METADATA &&
+                     e.offset + e.size + static_cast<int64_t>(sizeof(Trailer)) <= limit) {
+                // Older files have no audio metadata; the next item then belongs to another record
+                e.timestamp = t.metadata.timestampNs;
+                e.timestampOffset = e.offset + e.size + static_cast<int64_t>(sizeof(Item));
+                e.size += static_cast<int64_t>(sizeof(Trailer));
+            }
+
+            if (e.offset + e.size > limit)
+                throw IOException("Corrupted file: record at offset " + std::to_string(e.offset) + " overruns the next one");
+        }
+
+        outFrames.assign(extents.begin(), extents.begin() + numFrames);
+        std::sort(outFrames.begin(), outFrames.end(), [](const RecordExtent& a, const RecordExtent& b) {
+            return a.timestamp < b.timestamp;
+        });
+        outAudio.assign(extents.begin() + numFrames, extents.end());
     }
 
+    int64_t Decoder::audioStartTimestampMs() const {
+        return mAudioStartTimestampMs;
+    }
 
     void Decoder::readIndex() {
+        if (mSource->size() < sizeof(Header) + sizeof(BufferIndex) + sizeof(Item))
+            throw IOException("Invalid file: Too small to hold a buffer index.");
+
         // Seek to index item
-        size_t offset = mMemoryMap.size() - static_cast<long>(sizeof(BufferIndex) + sizeof(Item));
+        size_t offset = mSource->size() - static_cast<long>(sizeof(BufferIndex) + sizeof(Item));
 
         Item bufferIndexItem{};
         offset += read(offset, &bufferIndexItem, sizeof(Item));
@@ -465,7 +737,7 @@ namespace motioncam {
         }
 
 
-        const size_t fileEndOffset = mMemoryMap.size() - (sizeof(BufferIndex) + sizeof(Item));
+        const size_t fileEndOffset = mSource->size() - (sizeof(BufferIndex) + sizeof(Item));
 
         while (curOffset < fileEndOffset) { // Ensure we don't read past where the main index is expected
             Item item{};
@@ -489,6 +761,7 @@ namespace motioncam {
                     break;
                 }
 
+                mAudioStartTimestampMs = index.startTimestampMs;
                 mAudioOffsets.resize(static_cast<size_t>(index.numOffsets));
                 if (index.numOffsets > 0) {
                     if (read(curOffset, mAudioOffsets.data(), sizeof(BufferOffset), mAudioOffsets.size()) != (sizeof(BufferOffset) * mAudioOffsets.size())) {
@@ -511,7 +784,7 @@ namespace motioncam {
     }
 
     size_t Decoder::read(size_t offset, void* dst, size_t size, size_t items) const {
-        return ::motioncam::read(mMemoryMap, offset, dst, size, items);
+        return ::motioncam::read(*mSource, offset, dst, size, items);
     }
 
 } // namespace motioncam
@@ -0,0 +1,111 @@
+// --- START OF FILE motioncam/OutputFile.cpp ---
+#include "OutputFile.hpp"
+
+#include <motioncam/ByteSource.hpp>
+#include <motioncam/Decoder.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace motioncam {
+
+    namespace {
+        constexpr size_t kCopyBufferSize = size_t{ 8 } << 20;
+    }
+
+    OutputFile::OutputFile(const std::string& path) {
+#ifdef _WIN32
+        mFile = CreateFileW(std::filesystem::path(path).c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (mFile == INVALID_HANDLE_VALUE)
+            throw IOException("Failed to create " + path + " (error " + std::to_string(GetLastError()) + ")");
+#else
+        mFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (mFd < 0)
+            throw IOException("Failed to create " + path + ": " + std::strerror(errno));
+#endif
+    }
+
+    OutputFile::~OutputFile() {
+        close();
+    }
+
+    void OutputFile::write(const void* data, size_t size) {
+        const uint8_t* in = static_cast<const uint8_t*>(data);
+        while (size > 0) {
+#ifdef _WIN32
+            DWORD written = 0;
+            const DWORD request = static_cast<DWORD>((std::min)(size, size_t{ 1 } << 30));
+            if (!WriteFile(mFile, in, request, &written, nullptr) || written == 0)
+                throw IOException("Write failed at offset " + std::to_string(mPosition) + " (error " + std::to_string(GetLastError()) + ")");
+            const size_t n = written;
+#else
+            const ssize_t r = ::write(mFd, in, size);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                throw IOException("Write failed at offset " + std::to_string(mPosition) + ": " + std::strerror(errno));
+            const size_t n = static_cast<size_t>(r);
+#endif
+            in += n;
+            size -= n;
+            mPosition += n;
+        }
+    }
+
+    void OutputFile::copyFrom(const ByteSource& source, int sourceFd, uint64_t offset, uint64_t size, std::vector<uint8_t>& buffer) {
+#ifdef __linux__
+        while (sourceFd >= 0 && mKernelCopy && size > 0) {
+            loff_t in = static_cast<loff_t>(offset);
+            const ssize_t n = ::copy_file_range(sourceFd, &in, mFd, nullptr, static_cast<size_t>(size), 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+                mKernelCopy = false; // Not supported between these files; fall back for the rest
+                break;
+            }
+            if (n <= 0)
+                throw IOException("Copy failed at offset " + std::to_string(offset) + ": " + (n == 0 ? "unexpected end of file" : std::strerror(errno)));
+            offset += static_cast<uint64_t>(n);
+            size -= static_cast<uint64_t>(n);
+            mPosition += static_cast<uint64_t>(n);
+            mKernelBytes += static_cast<uint64_t>(n);
+        }
+#else
+        (void)sourceFd;
+#endif
+        buffer.resize(kCopyBufferSize);
+        while (size > 0) {
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, buffer.size()));
+            if (source.read(offset, buffer.data(), chunk) != chunk)
+                throw IOException("Read failed at offset " + std::to_string(offset) + ": unexpected end of file");
+            write(buffer.data(), chunk);
+            offset += chunk;
+            size -= chunk;
+        }
+    }
+
+    void OutputFile::close() {
+#ifdef _WIN32
+        if (mFile != INVALID_HANDLE_VALUE) {
+            CloseHandle(mFile);
+            mFile = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (mFd >= 0) {
+            ::close(mFd);
+            mFd = -1;
+        }
+#endif
+    }
+
+} // namespace motioncam
+// --- END OF FILE motioncam/OutputFile.cpp ---
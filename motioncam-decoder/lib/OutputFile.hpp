@@ -0,0 +1,59 @@
+// --- START OF FILE motioncam/OutputFile.hpp ---
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#endif
+
+namespace motioncam {
+
+    class ByteSource;
+
+    //
+    // Sequential writer for containers produced by the library (Remux(), WriteProxy()). Copies
+    // from a local input go through copy_file_range() on Linux; everything else through a buffer.
+    // Throws IOException on errors.
+    //
+    class OutputFile {
+    public:
+        explicit OutputFile(const std::string& path);
+        ~OutputFile();
+
+        OutputFile(const OutputFile&) = delete;
+        OutputFile& operator=(const OutputFile&) = delete;
+
+        void write(const void* data, size_t size);
+
+        // Appends size bytes of source starting at offset. sourceFd is a descriptor of the same
+        // file for the kernel copy, or -1.
+        void copyFrom(const ByteSource& source, int sourceFd, uint64_t offset, uint64_t size, std::vector<uint8_t>& buffer);
+
+        uint64_t position() const { return mPosition; }
+        uint64_t kernelBytes() const { return mKernelBytes; }
+
+        void close();
+
+    private:
+#ifdef _WIN32
+        HANDLE mFile = INVALID_HANDLE_VALUE;
+#else
+        int mFd = -1;
+#endif
+        uint64_t mPosition = 0;
+        uint64_t mKernelBytes = 0;
+        bool mKernelCopy = true;
+    };
+
+} // namespace motioncam
+// --- END OF FILE motioncam/OutputFile.hpp ---
@@ -0,0 +1,375 @@
+// --- START OF FILE motioncam/Proxy.cpp ---
+#include <motioncam/Proxy.hpp>
+#include <motioncam/ByteSource.hpp>
+#include <motioncam/Container.hpp>
+#include <motioncam/Decoder.hpp>
+#include <motioncam/RawData.hpp>
+
+#include "OutputFile.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <system_error>
+#include <thread>
+
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace motioncam {
+
+    namespace {
+        constexpr int kCompressionType = 7;
+        constexpr int kCompressionTypeLegacy = 6;
+        constexpr size_t kFramesPerThreadAhead = 2; // Converted frames waiting for the writer, per thread
+
+        struct ProxyFrame {
+            std::vector<uint8_t> payload;
+            std::string metadata;
+            int width = 0;
+            int height = 0;
+            bool ready = false;
+        };
+
+        struct Scratch {
+            std::vector<uint8_t> payload;
+            std::vector<uint8_t> metadata;
+            std::vector<uint16_t> frame;
+            std::vector<uint16_t> binned;
+        };
+
+        void decodeFrame(const std::vector<uint8_t>& payload, int width, int height, int compressionType, std::vector<uint16_t>& out) {
+            const size_t pixels = static_cast<size_t>(width) * height;
+            out.resize(pixels);
+
+            if (compressionType == kCompressionType) {
+                if (raw::Decode(out.data(), width, height, payload.data(), payload.size()) <= 0)
+                    throw IOException("Failed to uncompress frame");
+            }
+            else if (compressionType == kCompressionTypeLegacy) {
+                if (raw::DecodeLegacy(out.data(), width, height, payload.data(), payload.size()) <= 0)
+                    throw IOException("Failed to uncompress legacy frame");
+            }
+            else if (compressionType == 0 && payload.size() == pixels * sizeof(uint16_t)) {
+                std::memcpy(out.data(), payload.data(), payload.size());
+            }
+            else {
+                throw IOException("Unsupported compression type " + std::to_string(compressionType));
+            }
+        }
+
+        // Averages binning x binning photosites of each colour into one. Output photosite (x, y)
+        // keeps the colour of (x & 1, y & 1), so the CFA layout is that of the input.
+        void binFrame(const uint16_t* in, int width, int height, int binning, std::vector<uint16_t>& out, int& outWidth, int& outHeight) {
+            outWidth = width / (2 * binning) * 2;
+            outHeight = height / (2 * binning) * 2;
+            out.resize(static_cast<size_t>(outWidth) * outHeight);
+
+            const uint32_t count = static_cast<uint32_t>(binning * binning);
+            for (int y = 0; y < outHeight; ++y) {
+                const int firstRow = (y >> 1) * 2 * binning + (y & 1);
+                uint16_t* dst = out.data() + static_cast<size_t>(y) * outWidth;
+                for (int x = 0; x < outWidth; ++x) {
+                    const int firstColumn = (x >> 1) * 2 * binning + (x & 1);
+                    uint32_t sum = 0;
+                    for (int j = 0; j < binning; ++j) {
+                        const uint16_t* row = in + static_cast<size_t>(firstRow + 2 * j) * width + firstColumn;
+                        for (int i = 0; i < binning; ++i)
+                            sum += row[2 * i];
+                    }
+                    dst[x] = static_cast<uint16_t>((sum + count / 2) / count);
+                }
+            }
+        }
+
+        void convertFrame(const Decoder& decoder, Timestamp timestamp, int binning, ProxyFrame& out, Scratch& scratch) {
+            int width = 0, height = 0, compressionType = -1;
+            if (!decoder.getRawFramePayloads(timestamp, scratch.payload, scratch.metadata, width, height, compressionType))
+                throw IOException("Cannot read frame " + std::to_string(timestamp));
+            if (width < 2 * binning || height < 2 * binning)
+                throw IOException("Frame " + std::to_string(timestamp) + " is too small to bin");
+
+            decodeFrame(scratch.payload, width, height, compressionType, scratch.frame);
+            binFrame(scratch.frame.data(), width, height, binning, scratch.binned, out.width, out.height);
+            raw::Encode(out.payload, scratch.binned.data(), out.width, out.height);
+
+            nlohmann::json metadata = nlohmann::json::parse(scratch.metadata.begin(), scratch.metadata.end());
+            metadata["width"] = out.width;
+            metadata["height"] = out.height;
+            metadata["compressionType"] = kCompressionType;
+            out.metadata = metadata.dump();
+        }
+
+        //
+        // Frames converted out of order by the workers, handed to the writer in order. A worker
+        // only claims a frame within window of the next one to be written, which bounds memory.
+        //
+        class FrameQueue {
+        public:
+            FrameQueue(size_t frameCount, size_t window) : mFrames(frameCount), mWindow(window) {}
+
+            // The next frame for a worker, or false once every frame is claimed or the queue stopped.
+            bool claim(size_t& outIndex) {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mSpace.wait(lock, [&] { return mStopped || mNextClaim >= mFrames.size() || mNextClaim < mNextWrite + mWindow; });
+                if (mStopped || mNextClaim >= mFrames.size())
+                    return false;
+                outIndex = mNextClaim++;
+                return true;
+            }
+
+            void complete(size_t index, ProxyFrame&& frame) {
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mFrames[index] = std::move(frame);
+                    mFrames[index].ready = true;
+                }
+                mReady.notify_all();
+            }
+
+            void fail(std::exception_ptr error) {
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    if (!mError)
+                        mError = error;
+                    mStopped = true;
+                }
+                mReady.notify_all();
+                mSpace.notify_all();
+            }
+
+            void stop() {
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mStopped = true;
+                }
+                mSpace.notify_all();
+            }
+
+            // Waits for frame mNextWrite; rethrows a worker's error.
+            ProxyFrame take() {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mReady.wait(lock, [&] { return mError || mFrames[mNextWrite].ready; });
+                if (mError)
+                    std::rethrow_exception(mError);
+                ProxyFrame frame = std::move(mFrames[mNextWrite]);
+                mFrames[mNextWrite] = ProxyFrame();
+                ++mNextWrite;
+                lock.unlock();
+                mSpace.notify_all();
+                return frame;
+            }
+
+        private:
+            std::mutex mMutex;
+            std::condition_variable mReady;
+            std::condition_variable mSpace;
+            std::vector<ProxyFrame> mFrames;
+            const size_t mWindow;
+            size_t mNextClaim = 0;
+            size_t mNextWrite = 0;
+            bool mStopped = false;
+            std::exception_ptr mError;
+        };
+
+        // Descriptor of a local input for OutputFile::copyFrom(), or -1.
+        struct SourceFile {
+            int fd = -1;
+
+            ~SourceFile() {
+#ifndef _WIN32
+                if (fd >= 0)
+                    ::close(fd);
+#endif
+            }
+        };
+
+        class Workers {
+        public:
+            ~Workers() {
+                join();
+            }
+
+            void add(std::thread thread) {
+                mThreads.push_back(std::move(thread));
+            }
+
+            void join() {
+                for (std::thread& t : mThreads) {
+                    if (t.joinable())
+                        t.join();
+                }
+            }
+
+        private:
+            std::vector<std::thread> mThreads;
+        };
+    }
+
+    std::string ProxyPath(const std::string& clipPath) {
+        std::filesystem::path path(clipPath);
+        path.replace_filename(path.stem().string() + ".proxy" + path.extension().string());
+        return path.string();
+    }
+
+    bool IsProxyPath(const std::string& path) {
+        const std::string stem = std::filesystem::path(path).stem().string();
+        return stem.size() > 6 && stem.compare(stem.size() - 6, 6, ".proxy") == 0;
+    }
+
+    bool IsProxyOf(const Decoder& proxy, const Decoder& clip) {
+        return proxy.getContainerMetadata().contains("proxy") && proxy.getFrames() == clip.getFrames();
+    }
+
+    ProxyStats WriteProxy(const std::string& inputPath, const std::string& outputPath, const ProxyOptions& options) {
+        namespace fs = std::filesystem;
+
+        if (options.binning != 2 && options.binning != 4)
+            throw MotionCamException("Proxy binning must be 2 or 4");
+        std::error_code ec;
+        if (fs::exists(outputPath, ec) && fs::equivalent(inputPath, outputPath, ec))
+            throw MotionCamException("The proxy would overwrite " + inputPath);
+
+        const Decoder decoder(inputPath);
+        std::vector<RecordExtent> frames, audio;
+        decoder.getRecordExtents(frames, audio);
+        if (frames.empty())
+            throw MotionCamException(inputPath + ": no frames");
+
+        // Audio goes back between the frames it was recorded between
+        std::vector<size_t> audioByOffset(audio.size());
+        std::iota(audioByOffset.begin(), audioByOffset.end(), size_t{ 0 });
+        std::sort(audioByOffset.begin(), audioByOffset.end(), [&](size_t a, size_t b) { return audio[a].offset < audio[b].offset; });
+
+        SourceFile source;
+#ifndef _WIN32
+        if (!isRemoteLocation(inputPath))
+            source.fd = ::open(inputPath.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+
+        const unsigned threads = std::max(1u, options.threads != 0 ? options.threads : std::thread::hardware_concurrency());
+        FrameQueue queue(frames.size(), threads * kFramesPerThreadAhead);
+
+        const std::string partPath = outputPath + ".part";
+        ProxyStats stats;
+        try {
+            Workers workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.add(std::thread([&] {
+                    try {
+                        if (options.threadStarted)
+                            options.threadStarted();
+                        Scratch scratch;
+                        size_t index = 0;
+                        while (queue.claim(index)) {
+                            ProxyFrame frame;
+                            convertFrame(decoder, frames[index].timestamp, options.binning, frame, scratch);
+                            queue.complete(index, std::move(frame));
+                        }
+                    }
+                    catch (...) {
+                        queue.fail(std::current_exception());
+                    }
+                }));
+            }
+
+            try {
+                OutputFile out(partPath);
+                std::vector<uint8_t> buffer;
+
+                Header header{};
+                if (decoder.getByteSource().read(0, &header, sizeof(Header)) != sizeof(Header))
+                    throw IOException(inputPath + ": cannot read the header");
+                out.write(&header, sizeof(Header));
+
+                nlohmann::json containerMetadata = decoder.getContainerMetadata();
+                containerMetadata["proxy"] = {
+                    { "source", fs::path(inputPath).filename().string() },
+                    { "binning", options.binning } };
+                const std::string containerJson = containerMetadata.dump();
+                const Item metadataItem{ Type::METADATA, static_cast<uint32_t>(containerJson.size()) };
+                out.write(&metadataItem, sizeof(Item));
+                out.write(containerJson.data(), containerJson.size());
+
+                std::vector<BufferOffset> frameIndex;
+                std::vector<BufferOffset> audioIndex(audio.size());
+                size_t nextAudio = 0;
+                auto copyAudioBefore = [&](int64_t sourceOffset) {
+                    while (nextAudio < audioByOffset.size() && audio[audioByOffset[nextAudio]].offset < sourceOffset) {
+                        const RecordExtent& chunk = audio[audioByOffset[nextAudio]];
+                        audioIndex[audioByOffset[nextAudio]] = { static_cast<int64_t>(out.position()), chunk.indexTimestamp };
+                        out.copyFrom(decoder.getByteSource(), source.fd, static_cast<uint64_t>(chunk.offset), static_cast<uint64_t>(chunk.size), buffer);
+                        ++nextAudio;
+                    }
+                };
+
+                for (size_t i = 0; i < frames.size(); ++i) {
+                    const ProxyFrame frame = queue.take();
+                    copyAudioBefore(frames[i].offset);
+
+                    frameIndex.push_back({ static_cast<int64_t>(out.position()), frames[i].timestamp });
+                    const Item bufferItem{ Type::BUFFER, static_cast<uint32_t>(frame.payload.size()) };
+                    out.write(&bufferItem, sizeof(Item));
+                    out.write(frame.payload.data(), frame.payload.size());
+                    const Item frameMetadataItem{ Type::METADATA, static_cast<uint32_t>(frame.metadata.size()) };
+                    out.write(&frameMetadataItem, sizeof(Item));
+                    out.write(frame.metadata.data(), frame.metadata.size());
+
+                    if (i == 0) {
+                        stats.width = frame.width;
+                        stats.height = frame.height;
+                    }
+                    if (options.progress && !options.progress(i + 1, frames.size()))
+                        throw MotionCamException("Proxy generation stopped");
+                }
+                copyAudioBefore(std::numeric_limits<int64_t>::max());
+
+                // Audio index, then the frame index data and the buffer index that points at it
+                const Item audioIndexItem{ Type::AUDIO_INDEX, static_cast<uint32_t>(sizeof(AudioIndex) + audioIndex.size() * sizeof(BufferOffset)) };
+                const AudioIndex audioIndexHeader{ static_cast<int64_t>(audioIndex.size()), decoder.audioStartTimestampMs() };
+                out.write(&audioIndexItem, sizeof(Item));
+                out.write(&audioIndexHeader, sizeof(AudioIndex));
+                out.write(audioIndex.data(), audioIndex.size() * sizeof(BufferOffset));
+
+                const Item indexDataItem{ Type::BUFFER_INDEX_DATA, static_cast<uint32_t>(frameIndex.size() * sizeof(BufferOffset)) };
+                out.write(&indexDataItem, sizeof(Item));
+                const int64_t indexDataOffset = static_cast<int64_t>(out.position());
+                out.write(frameIndex.data(), frameIndex.size() * sizeof(BufferOffset));
+
+                const Item bufferIndexItem{ Type::BUFFER_INDEX, static_cast<uint32_t>(sizeof(BufferIndex)) };
+                const BufferIndex bufferIndex{ static_cast<int32_t>(INDEX_MAGIC_NUMBER), static_cast<int32_t>(frameIndex.size()), indexDataOffset };
+                out.write(&bufferIndexItem, sizeof(Item));
+                out.write(&bufferIndex, sizeof(BufferIndex));
+
+                stats.frames = frameIndex.size();
+                stats.audioChunks = audioIndex.size();
+                stats.bytesWritten = out.position();
+            }
+            catch (...) {
+                queue.stop();
+                throw;
+            }
+            workers.join();
+        }
+        catch (...) {
+            std::error_code removeError;
+            fs::remove(partPath, removeError);
+            throw;
+        }
+
+        fs::rename(partPath, outputPath, ec);
+        if (ec)
+            throw IOException("Failed to rename " + partPath + " to " + outputPath + ": " + ec.message());
+        return stats;
+    }
+
+} // namespace motioncam
+// --- END OF FILE motioncam/Proxy.cpp ---
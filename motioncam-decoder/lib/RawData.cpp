@@ -1,6 +1,8 @@
 #include <motioncam/RawData.hpp>
 #include <vector>
 #include <cstring>
+#include <cstdint>
+#include <algorithm>
 
 #ifdef _WIN32
     #include <cmath>
@@ -501,6 +503,78 @@ namespace motioncam {
         return offset;
     }
     
+    // DecodeMetadata() for input that may be truncated or corrupt: every read is bounds-checked
+    // and the table is only returned whole.
+    bool DecodeMetadataChecked(
+        const uint8_t* input,
+        size_t offset,
+        const size_t len,
+        std::vector<uint16_t>& outMetadata)
+    {
+        if(offset + 4 > len)
+            return false;
+
+        const uint32_t numBlocks =
+                 static_cast<uint32_t>(input[offset])
+            |   (static_cast<uint32_t>(input[offset+1]) << 8)
+            |   (static_cast<uint32_t>(input[offset+2]) << 16)
+            |   (static_cast<uint32_t>(input[offset+3]) << 24);
+        offset += 4;
+
+        // Every encoded block of 64 entries takes at least its header
+        if(numBlocks / ENCODING_BLOCK > (len - offset) / HEADER_LENGTH)
+            return false;
+
+        outMetadata.resize((static_cast<size_t>(numBlocks) + ENCODING_BLOCK - 1) / ENCODING_BLOCK * ENCODING_BLOCK);
+
+        uint8_t bits;
+        uint16_t reference;
+        uint16_t* data = outMetadata.data();
+
+        for(uint32_t i = 0; i < numBlocks; i += ENCODING_BLOCK) {
+            if(offset + HEADER_LENGTH > len)
+                return false;
+
+            DecodeHeader(bits, reference, input+offset);
+            offset += HEADER_LENGTH;
+
+            if(offset + ENCODING_BLOCK_LENGTH[bits] > len)
+                return false;
+
+            offset += DecodeBlock(data, bits, input, offset, len);
+
+            for(int x = 0; x < ENCODING_BLOCK; x++)
+                data[x] += reference;
+
+            data += ENCODING_BLOCK;
+        }
+
+        outMetadata.resize(numBlocks);
+        return true;
+    }
+
+    // Copies a decoded row to the destination with non-temporal stores. Only for write-combined
+    // staging memory that the CPU never reads back: bypassing the cache there avoids evicting the
+    // input and the row buffers. Callers issue the store fence.
+    INLINE
+    void StreamRow(uint16_t* RESTRICT dst, const uint16_t* RESTRICT src, const int count) {
+        int i = 0;
+
+        // Scalar head until the destination is 16-byte aligned.
+        while(i < count && (reinterpret_cast<uintptr_t>(dst + i) & 15) != 0) {
+            dst[i] = src[i];
+            i++;
+        }
+
+        for(; i + 8 <= count; i += 8) {
+            simde__m128i v = simde_mm_loadu_si128(reinterpret_cast<const simde__m128i*>(src + i));
+            simde_mm_stream_si128(reinterpret_cast<simde__m128i*>(dst + i), v);
+        }
+
+        for(; i < count; i++)
+            dst[i] = src[i];
+    }
+
     void ReadMetadataHeader(const uint8_t* input, uint32_t& encodedWidth, uint32_t& encodedHeight, uint32_t& bitsOffset, uint32_t& refsOffset) {
         encodedWidth =
                  static_cast<uint32_t>(input[0])
@@ -527,52 +601,175 @@ namespace motioncam {
             |   (static_cast<uint32_t>(input[15]) << 24);
     }
     
-    } // unnamed namespace
+    // Smallest width the decoder has a block layout for that holds every value up to range.
+    int EncodedBits(const uint32_t range) {
+        int bits = 0;
+        while(bits < 16 && (range >> bits) != 0)
+            bits++;
+
+        if(bits <= 6)
+            return bits;
+        if(bits <= 8)
+            return 8;
+        if(bits <= 10)
+            return 10;
+        return 16;
+    }
 
-    size_t Decode(
+    // Inverse of DecodeBlock(): packs 64 values of at most bits wide. Lane j of register k of
+    // the decoders is value 8k + j.
+    void EncodeBlock(std::vector<uint8_t>& output, const uint16_t* v, const int bits) {
+        const size_t start = output.size();
+        output.resize(start + ENCODING_BLOCK_LENGTH[bits], 0);
+        uint8_t* out = output.data() + start;
+
+        switch (bits) {
+            case 0:
+                break;
+            case 1:
+                for(int j = 0; j < 8; j++)
+                    for(int k = 0; k < 8; k++)
+                        out[j] |= (v[8*k + j] & 1) << k;
+                break;
+            case 2:
+                for(int h = 0; h < 2; h++)
+                    for(int j = 0; j < 8; j++)
+                        for(int k = 0; k < 4; k++)
+                            out[8*h + j] |= (v[32*h + 8*k + j] & 3) << (2*k);
+                break;
+            case 3:
+                for(int j = 0; j < 8; j++) {
+                    const uint16_t* r = v + j;
+                    out[j]      = static_cast<uint8_t>(r[0] | (r[8] << 3)  | ((r[16] & 3) << 6));
+                    out[8 + j]  = static_cast<uint8_t>(r[24] | (r[32] << 3) | ((r[40] & 3) << 6));
+                    out[16 + j] = static_cast<uint8_t>(r[48] | (r[56] << 3) | ((r[16] >> 2) << 6) | ((r[40] >> 2) << 7));
+                }
+                break;
+            case 4:
+                for(int g = 0; g < 4; g++)
+                    for(int j = 0; j < 8; j++)
+                        out[8*g + j] = static_cast<uint8_t>(v[16*g + j] | (v[16*g + 8 + j] << 4));
+                break;
+            case 5:
+                for(int j = 0; j < 8; j++) {
+                    const uint16_t* r = v + j;
+                    out[j]      = static_cast<uint8_t>(r[0]  | ((r[40] & 7) << 5));
+                    out[8 + j]  = static_cast<uint8_t>(r[8]  | ((r[48] & 7) << 5));
+                    out[16 + j] = static_cast<uint8_t>(r[16] | ((r[56] & 7) << 5));
+                    out[24 + j] = static_cast<uint8_t>(r[24] | (((r[40] >> 3) & 3) << 5) | (((r[56] >> 3) & 1) << 7));
+                    out[32 + j] = static_cast<uint8_t>(r[32] | (((r[48] >> 3) & 3) << 5) | (((r[56] >> 4) & 1) << 7));
+                }
+                break;
+            case 6:
+                for(int j = 0; j < 8; j++) {
+                    const uint16_t* r = v + j;
+                    for(int k = 0; k < 3; k++) {
+                        out[8*k + j]     = static_cast<uint8_t>(r[8*k]     | (((r[48] >> (2*k)) & 3) << 6));
+                        out[24 + 8*k + j] = static_cast<uint8_t>(r[24 + 8*k] | (((r[56] >> (2*k)) & 3) << 6));
+                    }
+                }
+                break;
+            case 8:
+                for(int i = 0; i < ENCODING_BLOCK; i++)
+                    out[i] = static_cast<uint8_t>(v[i]);
+                break;
+            case 10:
+                for(int h = 0; h < 2; h++)
+                    for(int j = 0; j < 8; j++)
+                        for(int k = 0; k < 4; k++) {
+                            const uint16_t r = v[32*h + 8*k + j];
+                            out[40*h + 8*k + j] = static_cast<uint8_t>(r);
+                            out[40*h + 32 + j] |= ((r >> 8) & 3) << (2*k);
+                        }
+                break;
+            default:
+                for(int i = 0; i < ENCODING_BLOCK; i++) {
+                    out[2*i]     = static_cast<uint8_t>(v[i]);
+                    out[2*i + 1] = static_cast<uint8_t>(v[i] >> 8);
+                }
+                break;
+        }
+    }
+
+    // Inverse of DecodeMetadata(). values.size() must be a multiple of ENCODING_BLOCK: the
+    // decoder always writes whole blocks. References are 12 bits in the block header.
+    void EncodeMetadata(std::vector<uint8_t>& output, const std::vector<uint16_t>& values) {
+        const uint32_t numBlocks = static_cast<uint32_t>(values.size());
+        for(int i = 0; i < 4; i++)
+            output.push_back(static_cast<uint8_t>(numBlocks >> (8*i)));
+
+        uint16_t residuals[ENCODING_BLOCK];
+
+        for(size_t i = 0; i < values.size(); i += ENCODING_BLOCK) {
+            const uint16_t* block = values.data() + i;
+            const uint16_t lo = *std::min_element(block, block + ENCODING_BLOCK);
+            const uint16_t hi = *std::max_element(block, block + ENCODING_BLOCK);
+            const uint16_t reference = std::min<uint16_t>(lo, 0x0FFF);
+
+            // The header has four bits for the width; any of 11-15 selects the 16 bit layout
+            int bits = EncodedBits(static_cast<uint32_t>(hi - reference));
+            if(bits == 16)
+                bits = 15;
+
+            output.push_back(static_cast<uint8_t>((bits << 4) | (reference >> 8)));
+            output.push_back(static_cast<uint8_t>(reference & 0xFF));
+
+            for(int x = 0; x < ENCODING_BLOCK; x++)
+                residuals[x] = block[x] - reference;
+
+            EncodeBlock(output, residuals, bits);
+        }
+    }
+
+    void WriteU32(uint8_t* output, const uint32_t value) {
+        for(int i = 0; i < 4; i++)
+            output[i] = static_cast<uint8_t>(value >> (8*i));
+    }
+    
+    // Decodes the row groups of rows [firstRow, firstRow + rowCount), whose sample data starts at
+    // offset in input. bits and refs are the frame's metadata in block order.
+    size_t DecodeRowGroups(
         uint16_t* output,
         const int width,
         const int height,
         const uint8_t* input,
-        const size_t len)
+        const size_t len,
+        const uint32_t encodedWidth,
+        const uint32_t encodedHeight,
+        const std::vector<uint16_t>& bits,
+        const std::vector<uint16_t>& refs,
+        size_t offset,
+        const int firstRow,
+        const int rowCount,
+        const bool writeCombined)
     {
-        uint16_t* outputStart = output;
-        
         uint16_t p0[ENCODING_BLOCK];
         uint16_t p1[ENCODING_BLOCK];
         uint16_t p2[ENCODING_BLOCK];
         uint16_t p3[ENCODING_BLOCK];
 
-        std::vector<uint16_t> bits, refs;
-        uint32_t encodedWidth, encodedHeight, bitsOffset, refsOffset;
+        const int endRow = std::min(height, firstRow + rowCount);
+        const int endY = std::min<int64_t>(endRow, encodedHeight);
+        const size_t blocksPerRowGroup = encodedWidth / ENCODING_BLOCK * 4;
+        const size_t firstBlock = static_cast<size_t>(firstRow / 4) * blocksPerRowGroup;
+        const size_t endBlock = static_cast<size_t>((std::max(endY, firstRow) + 3) / 4) * blocksPerRowGroup;
 
-        ReadMetadataHeader(input, encodedWidth, encodedHeight, bitsOffset, refsOffset);
-        
-        if(bitsOffset > len || refsOffset > len)
-            return 0;
-        
-        if(encodedWidth % ENCODING_BLOCK > 0)
-            return 0;
-            
-        if(encodedWidth < width)
+        if(bits.size() < endBlock || refs.size() < endBlock)
             return 0;
 
-        // Decode bits
-        DecodeMetadata(input, bitsOffset, len, bits);
-        
-        // Decode refs
-        DecodeMetadata(input, refsOffset, len, refs);
-
-        size_t offset = METADATA_OFFSET;
+        if(offset > len)
+            return 0;
         
         std::vector<uint16_t> row0(encodedWidth);
         std::vector<uint16_t> row1(encodedWidth);
         std::vector<uint16_t> row2(encodedWidth);
         std::vector<uint16_t> row3(encodedWidth);
         
-        int metadataIdx = 0;
+        size_t metadataIdx = firstBlock;
+        uint16_t* outputStart = output + static_cast<size_t>(firstRow) * width;
+        output = outputStart;
 
-        for(int y = 0; y < encodedHeight; y+=4) {
+        for(int y = firstRow; y < endY; y+=4) {
             for(int x = 0; x < encodedWidth; x += ENCODING_BLOCK) {
                 uint16_t blockBits[4] = { bits[metadataIdx], bits[metadataIdx+1], bits[metadataIdx+2], bits[metadataIdx+3] };
                 uint16_t blockRef[4] = { refs[metadataIdx], refs[metadataIdx+1], refs[metadataIdx+2], refs[metadataIdx+3] };
@@ -599,19 +796,393 @@ namespace motioncam {
                 metadataIdx += 4;
             }
 
-            std::memcpy(output, row0.data(), width * 2);
-            output += width;
-
-            std::memcpy(output, row1.data(), width * 2);
-            output += width;
+            // Never write past the band, or the caller's height even if the encoder padded the frame.
+            const uint16_t* rows[4] = { row0.data(), row1.data(), row2.data(), row3.data() };
 
-            std::memcpy(output, row2.data(), width * 2);
-            output += width;
-
-            std::memcpy(output, row3.data(), width * 2);
-            output += width;
+            for(int r = 0; r < 4 && y + r < endRow; r++) {
+                if(writeCombined)
+                    StreamRow(output, rows[r], width);
+                else
+                    std::memcpy(output, rows[r], static_cast<size_t>(width) * sizeof(uint16_t));
+                output += width;
+            }
         }
+
+        // Order the non-temporal stores before the frame is handed to another thread.
+        if(writeCombined)
+            simde_mm_sfence();
         
         return (output - outputStart);
     }
+
+    } // unnamed namespace
+
+    size_t Decode(
+        uint16_t* output,
+        const int width,
+        const int height,
+        const uint8_t* input,
+        const size_t len)
+    {
+        return DecodeRows(output, width, height, input, len, 0, height);
+    }
+
+    size_t DecodeToWriteCombined(
+        uint16_t* output,
+        const int width,
+        const int height,
+        const uint8_t* input,
+        const size_t len)
+    {
+        return DecodeRows(output, width, height, input, len, 0, height, true);
+    }
+
+    size_t DecodeRows(
+        uint16_t* output,
+        const int width,
+        const int height,
+        const uint8_t* input,
+        const size_t len,
+        const int firstRow,
+        const int rowCount,
+        const bool writeCombined)
+    {
+        std::vector<uint16_t> bits, refs;
+        uint32_t encodedWidth, encodedHeight, bitsOffset, refsOffset;
+
+        if(firstRow < 0 || firstRow % 4 != 0 || rowCount <= 0 || len < METADATA_OFFSET)
+            return 0;
+
+        ReadMetadataHeader(input, encodedWidth, encodedHeight, bitsOffset, refsOffset);
+        
+        if(bitsOffset > len || refsOffset > len)
+            return 0;
+        
+        if(encodedWidth % ENCODING_BLOCK > 0)
+            return 0;
+            
+        if(encodedWidth < static_cast<uint32_t>(width))
+            return 0;
+
+        // Decode bits
+        DecodeMetadata(input, bitsOffset, len, bits);
+        
+        // Decode refs
+        DecodeMetadata(input, refsOffset, len, refs);
+
+        const size_t blocksPerRowGroup = encodedWidth / ENCODING_BLOCK * 4;
+        const size_t firstBlock = static_cast<size_t>(firstRow / 4) * blocksPerRowGroup;
+
+        if(bits.size() < firstBlock)
+            return 0;
+
+        // Skip the sample data of the row groups above the band
+        size_t offset = METADATA_OFFSET;
+
+        for(size_t i = 0; i < firstBlock; i++) {
+            if(bits[i] > 16)
+                return 0;
+            offset += ENCODING_BLOCK_LENGTH[bits[i]];
+        }
+
+        return DecodeRowGroups(output, width, height, input, len, encodedWidth, encodedHeight, bits, refs, offset, firstRow, rowCount, writeCombined);
+    }
+
+    bool ParseFrameLayout(
+        const int width,
+        const int height,
+        const uint8_t* input,
+        const size_t len,
+        FrameLayout& outLayout)
+    {
+        outLayout.rowGroupOffsets.clear();
+
+        if(width <= 0 || height <= 0 || len < METADATA_OFFSET)
+            return false;
+
+        uint32_t bitsOffset, refsOffset;
+        ReadMetadataHeader(input, outLayout.encodedWidth, outLayout.encodedHeight, bitsOffset, refsOffset);
+
+        // Same checks as DecodeRows()
+        if(bitsOffset > len || refsOffset > len)
+            return false;
+
+        if(outLayout.encodedWidth % ENCODING_BLOCK > 0)
+            return false;
+
+        if(outLayout.encodedWidth < static_cast<uint32_t>(width))
+            return false;
+
+        DecodeMetadata(input, bitsOffset, len, outLayout.bits);
+        DecodeMetadata(input, refsOffset, len, outLayout.refs);
+
+        const size_t blocksPerRowGroup = outLayout.encodedWidth / ENCODING_BLOCK * 4;
+        const size_t rowGroups = static_cast<size_t>(std::min<int64_t>(height, outLayout.encodedHeight) + 3) / 4;
+
+        if(outLayout.bits.size() < rowGroups * blocksPerRowGroup || outLayout.refs.size() < rowGroups * blocksPerRowGroup)
+            return false;
+
+        // Prefix sum of the block lengths, one entry per row group plus the end
+        outLayout.rowGroupOffsets.resize(rowGroups + 1);
+
+        size_t offset = METADATA_OFFSET;
+        size_t block = 0;
+
+        for(size_t group = 0; group < rowGroups; group++) {
+            outLayout.rowGroupOffsets[group] = offset;
+
+            for(size_t i = 0; i < blocksPerRowGroup; i++, block++) {
+                if(outLayout.bits[block] > 16)
+                    return false;
+                offset += ENCODING_BLOCK_LENGTH[outLayout.bits[block]];
+            }
+        }
+
+        outLayout.rowGroupOffsets[rowGroups] = offset;
+
+        return true;
+    }
+
+    size_t DecodeRows(
+        uint16_t* output,
+        const int width,
+        const int height,
+        const uint8_t* input,
+        const size_t len,
+        const FrameLayout& layout,
+        const int firstRow,
+        const int rowCount,
+        const bool writeCombined)
+    {
+        if(firstRow < 0 || firstRow % 4 != 0 || rowCount <= 0)
+            return 0;
+
+        // Rows past the encoded height have no sample data, as in DecodeRows() without a layout
+        const size_t firstGroup = static_cast<size_t>(firstRow / 4);
+        if(firstGroup >= layout.rowGroupOffsets.size())
+            return 0;
+
+        return DecodeRowGroups(output, width, height, input, len, layout.encodedWidth, layout.encodedHeight,
+            layout.bits, layout.refs, layout.rowGroupOffsets[firstGroup], firstRow, rowCount, writeCombined);
+    }
+
+    size_t BuildBlockTable(
+        const int width,
+        const int height,
+        const uint8_t* input,
+        const size_t len,
+        std::vector<uint32_t>& outTable,
+        uint32_t& outBlocksPerRow,
+        uint32_t& outRowGroups)
+    {
+        outTable.clear();
+        outBlocksPerRow = 0;
+        outRowGroups = 0;
+
+        if(width <= 0 || height <= 0 || len < METADATA_OFFSET)
+            return 0;
+
+        std::vector<uint16_t> bits, refs;
+        uint32_t encodedWidth, encodedHeight, bitsOffset, refsOffset;
+
+        ReadMetadataHeader(input, encodedWidth, encodedHeight, bitsOffset, refsOffset);
+
+        // Same checks as Decode(), plus the ones it leaves to luck: the GPU has no scratch
+        // rows to absorb a short frame, so anything Decode() would not fully write is rejected.
+        if(bitsOffset + 4 > len || refsOffset + 4 > len)
+            return 0;
+
+        if(encodedWidth % ENCODING_BLOCK > 0)
+            return 0;
+
+        if(encodedWidth < static_cast<uint32_t>(width) || encodedHeight < static_cast<uint32_t>(height))
+            return 0;
+
+        DecodeMetadata(input, bitsOffset, len, bits);
+        DecodeMetadata(input, refsOffset, len, refs);
+
+        const uint32_t blocksPerRow = encodedWidth / ENCODING_BLOCK;
+        const uint32_t rowGroups = (static_cast<uint32_t>(height) + 3) / 4;
+        const size_t numBlocks = static_cast<size_t>(blocksPerRow) * rowGroups * 4;
+
+        if(bits.size() < numBlocks || refs.size() < numBlocks)
+            return 0;
+
+        outTable.resize(numBlocks * 2);
+
+        size_t offset = METADATA_OFFSET;
+
+        for(size_t i = 0; i < numBlocks; i++) {
+            const uint16_t blockBits = bits[i];
+
+            if(blockBits > 16)
+                return 0;
+
+            if(offset + ENCODING_BLOCK_LENGTH[blockBits] > len)
+                return 0;
+
+            outTable[2*i]     = static_cast<uint32_t>(offset);
+            outTable[2*i + 1] = static_cast<uint32_t>(blockBits) | (static_cast<uint32_t>(refs[i]) << 16);
+
+            offset += ENCODING_BLOCK_LENGTH[blockBits];
+        }
+
+        outBlocksPerRow = blocksPerRow;
+        outRowGroups = rowGroups;
+
+        return offset;
+    }
+
+    bool BlockMetadataStart(const uint8_t* header, const size_t payloadLen, size_t& outStart)
+    {
+        if(payloadLen < METADATA_OFFSET)
+            return false;
+
+        uint32_t encodedWidth, encodedHeight, bitsOffset, refsOffset;
+
+        ReadMetadataHeader(header, encodedWidth, encodedHeight, bitsOffset, refsOffset);
+
+        if(bitsOffset < METADATA_OFFSET || refsOffset < METADATA_OFFSET)
+            return false;
+
+        if(bitsOffset + 4 > payloadLen || refsOffset + 4 > payloadLen)
+            return false;
+
+        outStart = std::min(bitsOffset, refsOffset);
+        return true;
+    }
+
+    bool DecodeBlockMetadata(
+        const int width,
+        const int height,
+        const uint8_t* header,
+        const uint8_t* tail,
+        const size_t tailStart,
+        const size_t tailLen,
+        std::vector<uint16_t>& outBits,
+        std::vector<uint16_t>& outRefs,
+        uint32_t& outBlocksPerRow,
+        uint32_t& outRowGroups)
+    {
+        outBlocksPerRow = 0;
+        outRowGroups = 0;
+
+        if(width <= 0 || height <= 0)
+            return false;
+
+        uint32_t encodedWidth, encodedHeight, bitsOffset, refsOffset;
+
+        ReadMetadataHeader(header, encodedWidth, encodedHeight, bitsOffset, refsOffset);
+
+        if(bitsOffset < tailStart || refsOffset < tailStart)
+            return false;
+
+        if(encodedWidth % ENCODING_BLOCK > 0)
+            return false;
+
+        if(encodedWidth < static_cast<uint32_t>(width) || encodedHeight < static_cast<uint32_t>(height))
+            return false;
+
+        if(!DecodeMetadataChecked(tail, bitsOffset - tailStart, tailLen, outBits))
+            return false;
+
+        if(!DecodeMetadataChecked(tail, refsOffset - tailStart, tailLen, outRefs))
+            return false;
+
+        const uint32_t blocksPerRow = encodedWidth / ENCODING_BLOCK;
+        const uint32_t rowGroups = (static_cast<uint32_t>(height) + 3) / 4;
+        const size_t numBlocks = static_cast<size_t>(blocksPerRow) * rowGroups * 4;
+
+        if(outBits.size() < numBlocks || outRefs.size() < numBlocks)
+            return false;
+
+        outBits.resize(numBlocks);
+        outRefs.resize(numBlocks);
+        outBlocksPerRow = blocksPerRow;
+        outRowGroups = rowGroups;
+
+        return true;
+    }
+
+    size_t Encode(
+        std::vector<uint8_t>& output,
+        const uint16_t* input,
+        const int width,
+        const int height)
+    {
+        output.clear();
+
+        if(width <= 0 || height <= 0)
+            return 0;
+
+        const int encodedWidth = (width + ENCODING_BLOCK - 1) / ENCODING_BLOCK * ENCODING_BLOCK;
+        const int encodedHeight = (height + 3) / 4 * 4;
+
+        // Padding repeats the last column and row of the same colour, so it costs no extra bits
+        auto sourceIndex = [](const int v, const int size) {
+            return v < size ? v : std::max(size - 1 - ((v - size + 1) & 1), 0);
+        };
+
+        std::vector<int> columns(encodedWidth);
+        for(int x = 0; x < encodedWidth; x++)
+            columns[x] = sourceIndex(x, width);
+
+        std::vector<uint16_t> bits, refs;
+
+        uint16_t p[4][ENCODING_BLOCK];
+        uint16_t residuals[ENCODING_BLOCK];
+
+        output.resize(METADATA_OFFSET);
+
+        for(int y = 0; y < encodedHeight; y += 4) {
+            const uint16_t* rows[4];
+            for(int r = 0; r < 4; r++)
+                rows[r] = input + static_cast<size_t>(sourceIndex(y + r, height)) * width;
+
+            for(int x = 0; x < encodedWidth; x += ENCODING_BLOCK) {
+                // Same layout as Decode(): p0/p1 hold the even/odd columns of rows 0 and 2,
+                // p2/p3 those of rows 1 and 3.
+                for(int i = 0; i < ENCODING_BLOCK/2; i++) {
+                    const int even = columns[x + 2*i];
+                    const int odd = columns[x + 2*i + 1];
+
+                    p[0][i] = rows[0][even];  p[0][ENCODING_BLOCK/2 + i] = rows[2][even];
+                    p[1][i] = rows[0][odd];   p[1][ENCODING_BLOCK/2 + i] = rows[2][odd];
+                    p[2][i] = rows[1][even];  p[2][ENCODING_BLOCK/2 + i] = rows[3][even];
+                    p[3][i] = rows[1][odd];   p[3][ENCODING_BLOCK/2 + i] = rows[3][odd];
+                }
+
+                for(int b = 0; b < 4; b++) {
+                    const uint16_t lo = *std::min_element(p[b], p[b] + ENCODING_BLOCK);
+                    const uint16_t hi = *std::max_element(p[b], p[b] + ENCODING_BLOCK);
+                    const int blockBits = EncodedBits(static_cast<uint32_t>(hi - lo));
+
+                    for(int i = 0; i < ENCODING_BLOCK; i++)
+                        residuals[i] = p[b][i] - lo;
+
+                    EncodeBlock(output, residuals, blockBits);
+                    bits.push_back(static_cast<uint16_t>(blockBits));
+                    refs.push_back(lo);
+                }
+            }
+        }
+
+        // Whole metadata blocks; the padding entries are never read
+        const size_t paddedBlocks = (bits.size() + ENCODING_BLOCK - 1) / ENCODING_BLOCK * ENCODING_BLOCK;
+        bits.resize(paddedBlocks, bits.back());
+        refs.resize(paddedBlocks, refs.back());
+
+        const size_t bitsOffset = output.size();
+        EncodeMetadata(output, bits);
+
+        const size_t refsOffset = output.size();
+        EncodeMetadata(output, refs);
+
+        WriteU32(output.data(),      static_cast<uint32_t>(encodedWidth));
+        WriteU32(output.data() + 4,  static_cast<uint32_t>(encodedHeight));
+        WriteU32(output.data() + 8,  static_cast<uint32_t>(bitsOffset));
+        WriteU32(output.data() + 12, static_cast<uint32_t>(refsOffset));
+
+        return output.size();
+    }
 }}
@@ -0,0 +1,241 @@
+// --- START OF FILE motioncam/Remux.cpp ---
+#include <motioncam/Remux.hpp>
+#include <motioncam/ByteSource.hpp>
+#include <motioncam/Container.hpp>
+#include <motioncam/Decoder.hpp>
+
+#include "OutputFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace motioncam {
+
+    namespace {
+        struct Segment {
+            std::unique_ptr<Decoder> decoder;
+            std::vector<RecordExtent> frames;
+            std::vector<RecordExtent> audio;
+            size_t first = 0;
+            size_t end = 0;
+            Timestamp interval = 1;  // Median frame interval
+            Timestamp shift = 0;     // Added to every timestamp of this segment in the output
+            int fd = -1;
+
+            ~Segment() {
+#ifndef _WIN32
+                if (fd >= 0)
+                    ::close(fd);
+#endif
+            }
+        };
+
+        Timestamp medianInterval(const std::vector<Timestamp>& frames, size_t first, size_t end) {
+            std::vector<Timestamp> deltas;
+            for (size_t i = first + 1; i < end; ++i) {
+                if (frames[i] > frames[i - 1])
+                    deltas.push_back(frames[i] - frames[i - 1]);
+            }
+            if (deltas.empty())
+                return 1;
+            std::nth_element(deltas.begin(), deltas.begin() + deltas.size() / 2, deltas.end());
+            return deltas[deltas.size() / 2];
+        }
+
+        void checkCompatible(const Segment& a, const Segment& b, const std::string& pathB) {
+            static const char* kKeys[] = { "blackLevel", "whiteLevel", "sensorArrangment" };
+            const nlohmann::json& ma = a.decoder->getContainerMetadata();
+            const nlohmann::json& mb = b.decoder->getContainerMetadata();
+            for (const char* key : kKeys) {
+                if (ma.contains(key) && mb.contains(key) && ma[key] != mb[key])
+                    throw MotionCamException(pathB + ": " + key + " differs from the first clip");
+            }
+
+            std::vector<FrameBlockMetadata> fa, fb;
+            a.decoder->getBlockMetadata({ a.frames[a.first].timestamp }, fa);
+            b.decoder->getBlockMetadata({ b.frames[b.first].timestamp }, fb);
+            if (!fa[0].valid || !fb[0].valid)
+                throw IOException(pathB + ": cannot read the first frame's metadata");
+            if (fa[0].width != fb[0].width || fa[0].height != fb[0].height || fa[0].compressionType != fb[0].compressionType)
+                throw MotionCamException(pathB + ": frame size or compression differs from the first clip");
+
+            if (!a.audio.empty() && !b.audio.empty() &&
+                (a.decoder->audioSampleRateHz() != b.decoder->audioSampleRateHz() || a.decoder->numAudioChannels() != b.decoder->numAudioChannels()))
+                throw MotionCamException(pathB + ": audio format differs from the first clip");
+        }
+
+        // Audio chunks that overlap the selected frames. A whole clip keeps all of its audio,
+        // including chunks without timestamps.
+        std::vector<RecordExtent> selectAudio(const Segment& s) {
+            if (s.first == 0 && s.end == s.frames.size())
+                return s.audio;
+
+            const Timestamp begin = s.frames[s.first].timestamp;
+            const Timestamp end = s.frames[s.end - 1].timestamp + s.interval;
+            const int rate = s.decoder->audioSampleRateHz();
+            const int channels = std::max(1, s.decoder->numAudioChannels());
+            std::vector<RecordExtent> selected;
+            for (const RecordExtent& chunk : s.audio) {
+                if (chunk.timestamp < 0)
+                    continue;
+                const int64_t samples = chunk.payloadSize / sizeof(int16_t) / channels;
+                const Timestamp duration = rate > 0 ? samples * 1000000000LL / rate : 0;
+                if (chunk.timestamp < end && chunk.timestamp + duration >= begin)
+                    selected.push_back(chunk);
+            }
+            return selected;
+        }
+    }
+
+    RemuxStats Remux(const std::vector<RemuxInput>& inputs, const std::string& outputPath) {
+        namespace fs = std::filesystem;
+
+        if (inputs.empty())
+            throw MotionCamException("Nothing to remux");
+
+        std::vector<std::unique_ptr<Segment>> segments;
+        for (const RemuxInput& input : inputs) {
+            std::error_code ec;
+            if (fs::exists(outputPath, ec) && fs::equivalent(input.path, outputPath, ec))
+                throw MotionCamException("The output would overwrite the input " + input.path);
+
+            auto s = std::make_unique<Segment>();
+            s->decoder = std::make_unique<Decoder>(input.path);
+            s->decoder->getRecordExtents(s->frames, s->audio);
+            s->first = std::min(input.firstFrame, s->frames.size());
+            s->end = s->first + std::min(input.frameCount, s->frames.size() - s->first);
+            if (s->first == s->end)
+                throw MotionCamException(input.path + ": no frames selected");
+            s->interval = medianInterval(s->decoder->getFrames(), s->first, s->end);
+#ifndef _WIN32
+            s->fd = ::open(input.path.c_str(), O_RDONLY | O_CLOEXEC); // -1 for http:// sources: buffered copy
+#endif
+            if (!segments.empty()) {
+                checkCompatible(*segments.front(), *s, input.path);
+
+                // Timestamps must keep increasing across clips
+                const Segment& prev = *segments.back();
+                const Timestamp prevLast = prev.frames[prev.end - 1].timestamp + prev.shift;
+                const Timestamp first = s->frames[s->first].timestamp;
+                if (first <= prevLast)
+                    s->shift = prevLast + prev.interval - first;
+            }
+            segments.push_back(std::move(s));
+        }
+
+        const std::string partPath = outputPath + ".part";
+        RemuxStats stats;
+        std::vector<BufferOffset> frameIndex;
+        std::vector<BufferOffset> audioIndex;
+        try {
+            OutputFile out(partPath);
+            std::vector<uint8_t> buffer;
+
+            // Header and camera metadata of the first clip
+            const Segment& head = *segments.front();
+            Item metadataItem{};
+            if (head.decoder->getByteSource().read(sizeof(Header), &metadataItem, sizeof(Item)) != sizeof(Item))
+                throw IOException(inputs.front().path + ": cannot read the camera metadata");
+            out.copyFrom(head.decoder->getByteSource(), head.fd, 0, sizeof(Header) + sizeof(Item) + metadataItem.size, buffer);
+
+            for (const auto& segment : segments) {
+                const Segment& s = *segment;
+
+                // In file order, so adjacent records coalesce into one copy
+                std::vector<std::pair<RecordExtent, bool>> records; // Extent, is audio
+                for (size_t i = s.first; i < s.end; ++i)
+                    records.emplace_back(s.frames[i], false);
+                for (const RecordExtent& chunk : selectAudio(s))
+                    records.emplace_back(chunk, true);
+                std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+                    return a.first.offset < b.first.offset;
+                });
+
+                // Audio index entries move with the segment too, unless the writer left them unset (-1)
+                auto audioIndexTimestamp = [&s](const RecordExtent& r) {
+                    return r.indexTimestamp == -1 ? r.indexTimestamp : r.indexTimestamp + s.shift;
+                };
+
+                size_t i = 0;
+                while (i < records.size()) {
+                    const RecordExtent& start = records[i].first;
+                    const bool patch = records[i].second && s.shift != 0 && start.timestampOffset >= 0;
+
+                    if (patch) {
+                        // Shifted audio chunk: its timestamp lives inside the record
+                        std::vector<uint8_t> record(static_cast<size_t>(start.size));
+                        if (s.decoder->getByteSource().read(static_cast<uint64_t>(start.offset), record.data(), record.size()) != record.size())
+                            throw IOException("Read failed at offset " + std::to_string(start.offset));
+                        const Timestamp timestamp = start.timestamp + s.shift;
+                        std::memcpy(record.data() + (start.timestampOffset - start.offset), &timestamp, sizeof(timestamp));
+                        audioIndex.push_back({ static_cast<int64_t>(out.position()), audioIndexTimestamp(start) });
+                        out.write(record.data(), record.size());
+                        ++i;
+                        continue;
+                    }
+
+                    size_t j = i;
+                    int64_t runEnd = start.offset;
+                    const int64_t runOutput = static_cast<int64_t>(out.position());
+                    while (j < records.size() && records[j].first.offset == runEnd &&
+                           !(records[j].second && s.shift != 0 && records[j].first.timestampOffset >= 0)) {
+                        const RecordExtent& r = records[j].first;
+                        const int64_t newOffset = runOutput + (r.offset - start.offset);
+                        if (records[j].second)
+                            audioIndex.push_back({ newOffset, audioIndexTimestamp(r) });
+                        else
+                            frameIndex.push_back({ newOffset, r.timestamp + s.shift });
+                        runEnd = r.offset + r.size;
+                        ++j;
+                    }
+                    out.copyFrom(s.decoder->getByteSource(), s.fd, static_cast<uint64_t>(start.offset),
+                        static_cast<uint64_t>(runEnd - start.offset), buffer);
+                    i = j;
+                }
+            }
+
+            // Audio index, then the frame index data and the buffer index that points at it
+            Item audioIndexItem{ Type::AUDIO_INDEX, static_cast<uint32_t>(sizeof(AudioIndex) + audioIndex.size() * sizeof(BufferOffset)) };
+            AudioIndex audioIndexHeader{ static_cast<int64_t>(audioIndex.size()), head.decoder->audioStartTimestampMs() };
+            out.write(&audioIndexItem, sizeof(Item));
+            out.write(&audioIndexHeader, sizeof(AudioIndex));
+            out.write(audioIndex.data(), audioIndex.size() * sizeof(BufferOffset));
+
+            Item indexDataItem{ Type::BUFFER_INDEX_DATA, static_cast<uint32_t>(frameIndex.size() * sizeof(BufferOffset)) };
+            out.write(&indexDataItem, sizeof(Item));
+            const int64_t indexDataOffset = static_cast<int64_t>(out.position());
+            out.write(frameIndex.data(), frameIndex.size() * sizeof(BufferOffset));
+
+            Item bufferIndexItem{ Type::BUFFER_INDEX, static_cast<uint32_t>(sizeof(BufferIndex)) };
+            BufferIndex bufferIndex{ static_cast<int32_t>(INDEX_MAGIC_NUMBER), static_cast<int32_t>(frameIndex.size()), indexDataOffset };
+            out.write(&bufferIndexItem, sizeof(Item));
+            out.write(&bufferIndex, sizeof(BufferIndex));
+
+            stats.frames = frameIndex.size();
+            stats.audioChunks = audioIndex.size();
+            stats.bytesWritten = out.position();
+            stats.bytesCopiedInKernel = out.kernelBytes();
+        }
+        catch (...) {
+            std::error_code removeError;
+            fs::remove(partPath, removeError);
+            throw;
+        }
+
+        std::error_code ec;
+        fs::rename(partPath, outputPath, ec);
+        if (ec)
+            throw IOException("Failed to rename " + partPath + " to " + outputPath + ": " + ec.message());
+        return stats;
+    }
+
+} // namespace motioncam
+// --- END OF FILE motioncam/Remux.cpp ---
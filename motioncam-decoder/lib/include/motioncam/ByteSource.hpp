@@ -0,0 +1,100 @@
+// --- START OF FILE motioncam/ByteSource.hpp ---
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace motioncam {
+
+    /**
+     * One positional read in a ByteSource::readBatch() call.
+     */
+    struct ReadRequest {
+        uint64_t offset = 0;
+        void* dst = nullptr;
+        size_t size = 0;
+        size_t bytesRead = 0; // Set by readBatch(); short only at the end of the source
+    };
+
+    /**
+     * Random-access, read-only view of a container. Every member is const and safe to call from
+     * several threads at once, so one source can back a Decoder shared between threads.
+     * Read failures throw IOException; reads past the end return fewer bytes.
+     */
+    class ByteSource {
+    public:
+        virtual ~ByteSource() = default;
+
+        virtual uint64_t size() const = 0;
+
+        /**
+         * Copy up to size bytes starting at offset into dst.
+         * @return Bytes copied.
+         */
+        virtual size_t read(uint64_t offset, void* dst, size_t size) const = 0;
+
+        /**
+         * Perform every request, keeping up to maxInFlight() of them outstanding at once.
+         * The default issues them one after another through read().
+         */
+        virtual void readBatch(ReadRequest* requests, size_t count) const;
+
+        /**
+         * How many reads the backend can usefully keep outstanding. Callers batch reads only
+         * when this is above 1.
+         */
+        virtual unsigned maxInFlight() const { return 1; }
+
+        /**
+         * Backend name for logs, e.g. "mmap".
+         */
+        virtual const char* name() const = 0;
+    };
+
+    enum class ByteSourceKind {
+        Auto,  ///< Http for http:// locations, Mmap otherwise
+        Mmap,  ///< Memory-mapped file (mio)
+        Pread, ///< Positional reads through a block cache
+        Async, ///< Pread, with batches issued through io_uring (Linux) or overlapped I/O (Windows)
+        Http   ///< HTTP/1.1 range requests through a block cache
+    };
+
+    struct ByteSourceOptions {
+        ByteSourceKind kind = ByteSourceKind::Auto;
+        size_t blockSize = size_t{ 1 } << 20;    // Cache granularity for Pread, Async and Http
+        size_t cacheBytes = size_t{ 256 } << 20; // Block cache budget per source
+        unsigned queueDepth = 32;               // Async: reads in flight; Http: parallel connections
+    };
+
+    /**
+     * True for locations that are not local paths (currently http:// and https:// URLs).
+     */
+    bool isRemoteLocation(const std::string& location);
+
+    /**
+     * Parse "auto", "mmap", "pread", "async" / "uring" or "http".
+     */
+    bool parseByteSourceKind(const std::string& name, ByteSourceKind& outKind);
+
+    /**
+     * True if this build can issue batched asynchronous file reads. When it cannot, Async
+     * sources fall back to Pread.
+     */
+    bool asyncByteSourceAvailable();
+
+    /**
+     * Open location with the backend options select. Remote locations always use Http.
+     * Throws IOException on error.
+     */
+    std::unique_ptr<ByteSource> openByteSource(const std::string& location, const ByteSourceOptions& options);
+
+    /**
+     * Options used by Decoder(const std::string&). Set once at startup, before any decoder is opened.
+     */
+    void setDefaultByteSourceOptions(const ByteSourceOptions& options);
+    ByteSourceOptions defaultByteSourceOptions();
+
+} // namespace motioncam
+// --- END OF FILE motioncam/ByteSource.hpp ---
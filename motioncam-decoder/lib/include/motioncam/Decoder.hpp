@@ -1,13 +1,14 @@
 // --- START OF FILE motioncam/Decoder.hpp ---
 #pragma once
 
+#include <motioncam/ByteSource.hpp>
 #include <motioncam/Container.hpp>
 #include <nlohmann/json.hpp>
-#include <mio/mio.hpp>
 
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <cstdint> // Required for std::vector<uint8_t> etc.
 
 namespace motioncam {
@@ -24,20 +25,82 @@ namespace motioncam {
         IOException(const std::string& error) : MotionCamException(error) {}
     };
 
+    /**
+     * Compressed payload and raw metadata of one frame, as returned by the batched
+     * getRawFramePayloads().
+     */
+    struct FramePayload {
+        Timestamp timestamp = 0;
+        std::vector<uint8_t> compressedPayload;
+        std::vector<uint8_t> metadataPayload;
+        int width = 0;
+        int height = 0;
+        int compressionType = -1;
+        bool valid = false;
+    };
+
+    /**
+     * The parts of a type 7 frame that describe it without decoding it, as returned by
+     * getBlockMetadata(): its size in the container and its per-block bits and refs tables.
+     */
+    struct FrameBlockMetadata {
+        Timestamp timestamp = 0;
+        size_t compressedSize = 0;  // Bytes of the compressed payload
+        size_t recordSize = 0;      // Bytes of the whole record: payload, metadata and item headers
+        int width = 0;
+        int height = 0;
+        int compressionType = -1;
+        std::vector<uint16_t> bits; // See raw::DecodeBlockMetadata for the layout
+        std::vector<uint16_t> refs;
+        uint32_t blocksPerRow = 0;
+        uint32_t rowGroups = 0;
+        bool valid = false;         // False if the record is unreadable; bits/refs are also empty for other compression types
+    };
+
+    /**
+     * Where one frame or audio record lies in the container, as returned by getRecordExtents(),
+     * so it can be copied verbatim into another container.
+     */
+    struct RecordExtent {
+        Timestamp timestamp = 0;        // Frames: the index timestamp. Audio: the chunk's AudioMetadata timestamp, or -1
+        int64_t indexTimestamp = 0;     // The timestamp stored in the index entry
+        int64_t offset = 0;
+        int64_t size = 0;               // Item headers included
+        int64_t timestampOffset = -1;   // Audio: file offset of AudioMetadata::timestampNs, -1 if the chunk has none
+        uint32_t payloadSize = 0;       // Bytes of the BUFFER or AUDIO_DATA payload
+    };
+
     class AudioChunkLoader {
     public:
         virtual bool next(AudioChunk& output) = 0;
         virtual ~AudioChunkLoader() = default; // Add virtual destructor
     };
 
+    /**
+     * The index and metadata are read once in the constructor and never change afterwards, and
+     * every const member only reads the ByteSource, whose members are thread-safe. One instance
+     * can therefore be shared between threads. The loader returned by loadAudio() is a single cursor; each reader of audio
+     * should take its own from makeAudioLoader().
+     */
     class Decoder {
     public:
         /**
-         * Open and memory-map the given file path.
+         * Open the given file path or http:// URL with defaultByteSourceOptions().
          * Throws IOException on error.
          */
         Decoder(const std::string& path);
 
+        /**
+         * Read the container from an already opened source.
+         * Throws IOException on error.
+         */
+        explicit Decoder(std::unique_ptr<ByteSource> source);
+
+        /**
+         * The source every read goes through.
+         */
+        const ByteSource& getByteSource() const;
+
         /**
          * Get container-level metadata (camera info, container params).
          */
@@ -56,7 +119,7 @@ namespace motioncam {
          */
         void loadFrame(const Timestamp timestamp,
             std::vector<uint8_t>& outData,
-            nlohmann::json& outMetadata);
+            nlohmann::json& outMetadata) const;
 
         /**
          * Load a single decoded frame directly into caller-provided buffer.
@@ -70,7 +133,7 @@ namespace motioncam {
         void loadFrame(const Timestamp timestamp,
             uint16_t* externalOutputBuffer,
             size_t externalBufferSize,
-            nlohmann::json& outMetadata);
+            nlohmann::json& outMetadata) const;
 
         /**
          * Gets raw compressed payload and raw metadata payload for a frame.
@@ -88,8 +151,48 @@ namespace motioncam {
             std::vector<uint8_t>& outCompressedPayload,
             std::vector<uint8_t>& outMetadataPayload,
             int& outWidth, int& outHeight, int& outCompressionType
-        );
+        ) const;
 
+        /**
+         * Batched getRawFramePayloads(): each frame record is fetched with a single read and
+         * all of them are handed to ByteSource::readBatch() together, so backends that keep
+         * reads in flight (io_uring, overlapped I/O, parallel HTTP ranges) overlap them.
+         * @param timestamps Frames to read.
+         * @param outPayloads Resized to timestamps.size(); entries that failed have valid == false.
+         */
+        void getRawFramePayloads(
+            const std::vector<Timestamp>& timestamps,
+            std::vector<FramePayload>& outPayloads
+        ) const;
+
+        /**
+         * Reads the block metadata of type 7 frames without their sample data: per frame, the
+         * payload header and the tail of the payload holding the bits and refs tables and the
+         * frame metadata, typically a few percent of the record. Both rounds of reads go
+         * through ByteSource::readBatch(). Frames of other compression types get their sizes
+         * and dimensions only.
+         * @param timestamps Frames to read.
+         * @param outFrames Resized to timestamps.size().
+         */
+        void getBlockMetadata(
+            const std::vector<Timestamp>& timestamps,
+            std::vector<FrameBlockMetadata>& outFrames
+        ) const;
+
+        /**
+         * Exact extents of every frame record (in timestamp order) and audio record (in index
+         * order), read from their item headers. Throws IOException if a record's items do not
+         * fit between it and the next record.
+         */
+        void getRecordExtents(
+            std::vector<RecordExtent>& outFrames,
+            std::vector<RecordExtent>& outAudio
+        ) const;
+
+        /**
+         * The AudioIndex start timestamp (ms), 0 if the container has no audio index.
+         */
+        int64_t audioStartTimestampMs() const;
 
         /**
          * Audio sample rate in Hz.
@@ -104,13 +207,19 @@ namespace motioncam {
         /**
          * Load all audio chunks into a vector.
          */
-        void loadAudio(std::vector<AudioChunk>& outAudioChunks);
+        void loadAudio(std::vector<AudioChunk>& outAudioChunks) const;
 
         /**
          * Get an AudioChunkLoader to iterate audio chunks lazily.
          */
         AudioChunkLoader& loadAudio() const;
 
+        /**
+         * Create an independent AudioChunkLoader starting at the first chunk.
+         * It reads this decoder's byte source and must not outlive it.
+         */
+        std::unique_ptr<AudioChunkLoader> makeAudioLoader() const;
+
     private:
         void init();
         size_t read(size_t offset, void* dst, size_t size, size_t items = 1) const;
@@ -120,11 +229,13 @@ namespace motioncam {
         // void uncompress(const std::vector<uint8_t>& src, std::vector<uint8_t>& dst); // Was unused, removed
 
     private:
-        mio::mmap_source mMemoryMap;
+        std::unique_ptr<ByteSource> mSource;
         std::vector<BufferOffset> mOffsets;
         std::vector<BufferOffset> mAudioOffsets;
         std::map<Timestamp, BufferOffset> mFrameOffsetMap;
         std::vector<Timestamp> mFrameList;
+        std::vector<int64_t> mRecordStarts; // Sorted offsets of every frame and audio record, then the end of the data
+        int64_t mAudioStartTimestampMs = 0;
         nlohmann::json mMetadata;
         std::unique_ptr<AudioChunkLoader> mAudioLoader;
     };
@@ -0,0 +1,63 @@
+// --- START OF FILE motioncam/Proxy.hpp ---
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace motioncam {
+
+    class Decoder;
+
+    struct ProxyOptions {
+        // Photosites of one colour averaged along each axis: 2 (1/4 of the area) or 4 (1/16)
+        int binning = 2;
+        // Decode and encode threads besides the writer; 0 selects hardware_concurrency()
+        unsigned threads = 0;
+        // Run first on every worker thread, e.g. to lower its priority
+        std::function<void()> threadStarted;
+        // On the calling thread; return false to stop
+        std::function<bool(size_t framesDone, size_t frameCount)> progress;
+    };
+
+    struct ProxyStats {
+        size_t frames = 0;
+        size_t audioChunks = 0;
+        int width = 0;          // Of the first proxy frame
+        int height = 0;
+        uint64_t bytesWritten = 0;
+    };
+
+    /**
+     * Where the proxy of clipPath lives: "<dir>/<stem>.proxy.mcraw" next to the clip.
+     */
+    std::string ProxyPath(const std::string& clipPath);
+
+    /**
+     * True if path is named like a proxy, so folder listings can leave it out.
+     */
+    bool IsProxyPath(const std::string& path);
+
+    /**
+     * True if proxy was written by WriteProxy() and has exactly the frames of clip.
+     */
+    bool IsProxyOf(const Decoder& proxy, const Decoder& clip);
+
+    /**
+     * Writes a downscaled copy of a clip that any reader of the format can play. Each frame is
+     * decoded, binned by averaging options.binning x options.binning photosites of the same
+     * colour (which keeps the CFA layout, black and white levels) and re-encoded as compression
+     * type 7. Frame timestamps, per-frame metadata (with the new width and height) and the camera
+     * metadata are kept; a "proxy" object is added to the latter. Audio records are copied byte
+     * for byte in their original place between the frames.
+     *
+     * Frames are converted on options.threads threads, all reading through one Decoder, and
+     * written in order by the calling thread. The output is written to outputPath + ".part" and
+     * renamed when complete. Throws MotionCamException on bad options or when progress() asks to
+     * stop, and IOException on I/O errors; the partial output is removed in both cases.
+     */
+    ProxyStats WriteProxy(const std::string& inputPath, const std::string& outputPath, const ProxyOptions& options = {});
+
+} // namespace motioncam
+// --- END OF FILE motioncam/Proxy.hpp ---
@@ -19,6 +19,7 @@
 
 #include <stddef.h>
 #include <cstdint>
+#include <vector>
 
 namespace BS {
     class thread_pool;
@@ -32,13 +33,123 @@ namespace motioncam {
             const int height,
             const uint8_t* input,
             const size_t len);
+
+        // Decode() into memory the CPU does not read back, such as a mapped write-combined
+        // staging buffer. Rows are written with non-temporal stores, which keep the input in the
+        // cache but make an immediate read of the output go to DRAM; use Decode() for that.
+        size_t DecodeToWriteCombined(
+            uint16_t* output,
+            const int width,
+            const int height,
+            const uint8_t* input,
+            const size_t len);
             
+        // Decode() of rows [firstRow, firstRow + rowCount) only, written to their place in the
+        // width x height output. firstRow must be a multiple of 4, the height of a block row.
+        // The sample data above the band is skipped using the bits table, so disjoint bands
+        // can be decoded on separate threads. Returns the number of samples written.
+        // writeCombined selects DecodeToWriteCombined()'s non-temporal stores.
+        size_t DecodeRows(
+            uint16_t* output,
+            const int width,
+            const int height,
+            const uint8_t* input,
+            const size_t len,
+            const int firstRow,
+            const int rowCount,
+            const bool writeCombined = false);
+
+        // A type 7 frame's bits and refs metadata and the byte offset in the payload at which each
+        // row group (4 rows) of sample data starts, with the end of the last one appended. Parsed
+        // once per frame by ParseFrameLayout() and shared by the DecodeRows() calls for its bands;
+        // reusing one instance across frames keeps its allocations.
+        struct FrameLayout {
+            uint32_t encodedWidth = 0;
+            uint32_t encodedHeight = 0;
+            std::vector<uint16_t> bits;
+            std::vector<uint16_t> refs;
+            std::vector<size_t> rowGroupOffsets;
+        };
+
+        // Returns false if the metadata is malformed or does not cover width x height; DecodeRows()
+        // would then fail on the same frame.
+        bool ParseFrameLayout(
+            const int width,
+            const int height,
+            const uint8_t* input,
+            const size_t len,
+            FrameLayout& outLayout);
+
+        // DecodeRows() with the metadata taken from layout, which ParseFrameLayout() filled from
+        // the same input. The band starts at its row group's offset, so nothing above it is read.
+        size_t DecodeRows(
+            uint16_t* output,
+            const int width,
+            const int height,
+            const uint8_t* input,
+            const size_t len,
+            const FrameLayout& layout,
+            const int firstRow,
+            const int rowCount,
+            const bool writeCombined = false);
+
         size_t DecodeLegacy(
             uint16_t* output,
             const int width,
             const int height,
             const uint8_t* input,
             const size_t len);
+
+        // Compresses a width x height frame of 16 bit samples as compression type 7, the
+        // inverse of Decode(). Every block gets the narrowest layout its range needs, so it is
+        // lossless; the encoded size is padded to whole blocks by repeating edge samples of the
+        // same colour. output is replaced by the payload. Returns its size, 0 if the size is empty.
+        size_t Encode(
+            std::vector<uint8_t>& output,
+            const uint16_t* input,
+            const int width,
+            const int height);
+
+        // Parses the bits/refs metadata of a type 7 frame into a table for decoding on the GPU.
+        // Two words per 64 sample block, in stream order: the byte offset of the block in input
+        // (a prefix sum over the block lengths) and bits | (reference << 16). Blocks are grouped
+        // in fours per 64 columns of 4 rows, outBlocksPerRow groups per row of groups.
+        // Returns the number of input bytes the frame's blocks span, or 0 if the frame is
+        // malformed or truncated and must go through Decode() instead.
+        size_t BuildBlockTable(
+            const int width,
+            const int height,
+            const uint8_t* input,
+            const size_t len,
+            std::vector<uint32_t>& outTable,
+            uint32_t& outBlocksPerRow,
+            uint32_t& outRowGroups);
+
+        // Offset within a type 7 payload from which its bits and refs metadata run to the end of
+        // the payload. header is the first 16 bytes of the payload. Returns false if the offsets
+        // do not fit in payloadLen.
+        bool BlockMetadataStart(
+            const uint8_t* header,
+            const size_t payloadLen,
+            size_t& outStart);
+
+        // Decodes only the bits and refs metadata of a type 7 frame, in BuildBlockTable's block
+        // order, without reading any sample data. header is the first 16 bytes of the payload and
+        // tail the tailLen bytes of it from tailStart (see BlockMetadataStart) on. A block's bits
+        // is the width its residuals needed, so the table doubles as a coarse detail/noise map;
+        // its reference is the block's base level. Returns false if the tables are truncated
+        // or do not cover width x height.
+        bool DecodeBlockMetadata(
+            const int width,
+            const int height,
+            const uint8_t* header,
+            const uint8_t* tail,
+            const size_t tailStart,
+            const size_t tailLen,
+            std::vector<uint16_t>& outBits,
+            std::vector<uint16_t>& outRefs,
+            uint32_t& outBlocksPerRow,
+            uint32_t& outRowGroups);
     }
 }
 
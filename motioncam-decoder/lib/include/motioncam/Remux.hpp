@@ -0,0 +1,48 @@
+// --- START OF FILE motioncam/Remux.hpp ---
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace motioncam {
+
+    /**
+     * One clip, or a contiguous run of its frames, to copy into the output of Remux().
+     */
+    struct RemuxInput {
+        std::string path;
+        size_t firstFrame = 0;                                     // Index into Decoder::getFrames()
+        size_t frameCount = std::numeric_limits<size_t>::max();   // Clamped to the end of the clip
+    };
+
+    struct RemuxStats {
+        size_t frames = 0;
+        size_t audioChunks = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t bytesCopiedInKernel = 0; // Of bytesWritten, moved with copy_file_range() rather than through memory
+    };
+
+    /**
+     * Writes a new container holding the given frame ranges of one or more clips, in order,
+     * without decoding: the first input's header and camera metadata, then each selected frame
+     * record (BUFFER and METADATA items) and each audio record overlapping the selection, copied
+     * byte for byte, then a rebuilt AudioIndex and BufferIndex. Adjacent records are copied as one
+     * range, so a trim of a single take is a handful of large copies. On Linux these use
+     * copy_file_range(), which stays in the kernel and on filesystems that support it (XFS,
+     * Btrfs, NFS 4.2, SMB) shares extents rather than copying data.
+     *
+     * Clips are concatenated only if their frame size, compression type, levels, CFA layout and
+     * audio format match. A clip whose timestamps do not follow on from the previous one is shifted
+     * to start one frame interval after it: its index entries and AudioMetadata timestamps are
+     * rewritten; the per-frame JSON is left as recorded.
+     *
+     * The output is written to outputPath + ".part" and renamed when complete.
+     * Throws MotionCamException on mismatched inputs and IOException on I/O errors.
+     */
+    RemuxStats Remux(const std::vector<RemuxInput>& inputs, const std::string& outputPath);
+
+} // namespace motioncam
+// --- END OF FILE motioncam/Remux.hpp ---
@@ -1,12 +1,19 @@
 // FILE: src/App/AppCleanup.cpp
 #include "App/App.h"
 #include "Audio/AudioController.h"
+#include "Decoder/BandDecoder.h"
 #include "Decoder/DecoderWrapper.h"
 #include "Playback/PlaybackController.h"
+#include "Playback/ClipAnalyzer.h"
+#include "Playback/ClipIndexer.h"
+#include "Playback/ClipPreloader.h"
+#include "Playback/ProxyGenerator.h"
 #include "Graphics/Renderer_VK.h"
 #include "Utils/DebugLog.h"
+#include "Utils/FrameTrace.h"
 #include "Gui/GuiOverlay.h"
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
@@ -40,7 +47,8 @@ App::~App() {
     m_ioThreadFileCv.notify_all();
     m_decodeQueue.stop_operations();
     m_gpuUploadQueue.stop_operations();
-    m_availableStagingBufferIndices.stop_operations();
+    m_stagingRing.stop_operations();
+    if (m_transferUploader) m_transferUploader->stop_operations();
 
     if (m_ioThread.joinable()) {
         LogToFile("[App::~App] Joining I/O thread...");
@@ -53,7 +61,20 @@ App::~App() {
         LogToFile("[App::~App] Decode thread joined.");
     }
 
-    destroyPersistentStagingBuffers();
+    m_clipPreloader.reset();
+    m_clipAnalyzer.reset();
+    m_proxyGenerator.reset(); // Removes a partly written proxy
+    m_bandDecoder.reset();
+    m_clipIndexer.reset(); // Joins the indexing threads and writes the cache
+
+    if (!m_pipelineMetrics.fileName().empty()) {
+        m_pipelineMetrics.appendSummary(PipelineMetrics::kSummaryFileName);
+    }
+    if (auto tracePath = FrameTrace::exitTracePath()) {
+        FrameTrace::writeChromeTrace(tracePath.value());
+    }
+
+    destroyStagingRing();
 
     cleanupVulkan();
 
@@ -103,21 +124,25 @@ App::~App() {
 #endif
 }
 
-void App::destroyPersistentStagingBuffers() {
-    LogToFile("[App::destroyPersistentStagingBuffers] Destroying persistent staging buffers.");
-    if (m_vmaAllocator == VK_NULL_HANDLE) return;
+void App::destroyStagingRing() {
+    LogToFile("[App::destroyStagingRing] Destroying staging ring.");
+    m_stagingRing.destroy();
+    m_stagingRingFrames = 0;
+    m_stagingRingFrameBytes = 0;
+    std::fill(m_inFlightStagingSpans.begin(), m_inFlightStagingSpans.end(), std::nullopt);
+    m_retainedRawSource.reset();
+    m_deferredRawSourceReleases.clear();
+    m_pendingTransferReleases.clear();
+    LogToFile("[App::destroyStagingRing] Staging ring destroyed.");
+}
 
-    for (size_t i = 0; i < m_persistentStagingBuffers.size(); ++i) {
-        if (m_persistentStagingBuffers[i].buffer != VK_NULL_HANDLE) {
-            vmaDestroyBuffer(m_vmaAllocator, m_persistentStagingBuffers[i].buffer, m_persistentStagingBuffers[i].allocation);
-            m_persistentStagingBuffers[i].buffer = VK_NULL_HANDLE;
-            m_persistentStagingBuffers[i].allocation = VK_NULL_HANDLE;
-        }
+void App::releaseRawSourceHold(const RawSourceHold& hold) {
+    if (hold.staging.has_value()) {
+        m_stagingRing.release(hold.staging.value());
+    }
+    if (hold.transfer.has_value() && m_transferUploader) {
+        m_transferUploader->release(hold.transfer.value());
     }
-    m_persistentStagingBuffers.clear();
-    m_persistentStagingBuffersMappedPtrs.clear();
-    m_availableStagingBufferIndices.clear();
-    LogToFile("[App::destroyPersistentStagingBuffers] Persistent staging buffers destroyed.");
 }
 
 
@@ -184,12 +209,23 @@ void App::cleanupVulkan() {
 
     cleanupSwapChain();
 
+    if (m_transferUploader) {
+        LogToFile("[App::cleanupVulkan] Cleaning up TransferUploader...");
+        // The decode thread may have submitted after the destructor's vkDeviceWaitIdle.
+        if (m_transferQueue != VK_NULL_HANDLE) vkQueueWaitIdle(m_transferQueue);
+        m_transferUploader->cleanup();
+        m_transferUploader.reset();
+    }
+
     if (m_rendererVk) {
         LogToFile("[App::cleanupVulkan] Cleaning up Renderer_VK (main resources)...");
         m_rendererVk->cleanup();
         m_rendererVk.reset();
     }
 
+    m_thumbnailAtlas.cleanup(); // Frees its ImGui descriptor set, so before the ImGui shutdown
+    m_scopes.cleanup();
+
     LogToFile("[App::cleanupVulkan] Cleaning up GuiOverlay (ImGui shutdown)...");
     GuiOverlay::cleanup();
 
@@ -229,6 +265,9 @@ void App::cleanupVulkan() {
         m_renderPass = VK_NULL_HANDLE;
     }
 
+    LogToFile("[App::cleanupVulkan] Saving pipeline cache...");
+    m_pipelineCache.cleanup();
+
     if (m_vmaAllocator != VK_NULL_HANDLE) {
         LogToFile("[App::cleanupVulkan] Destroying VMA Allocator...");
         vmaDestroyAllocator(m_vmaAllocator);
@@ -1,14 +1,22 @@
 #include "App/App.h"
+#include "Decoder/BandDecoder.h"
+#include "Graphics/Renderer_VK.h"
+#include "Playback/PlaybackController.h"
 #include "Utils/DebugLog.h"
+#include "Utils/FrameTrace.h"
 #include <motioncam/RawData.hpp> 
 #include <cstring> 
 #include <chrono>  
+#include <algorithm>
 
 void App::decodeWorkerLoop() {
     LogToFile("[App::decodeWorkerLoop] Decode thread started.");
+    FrameTrace::setThreadName("Decode");
 
     constexpr int LOCAL_MC_COMPRESSION_TYPE_NEW = 7;
     constexpr int LOCAL_MC_COMPRESSION_TYPE_LEGACY = 6;
+    // Frames further behind the playhead than this are the next loop's, not late ones.
+    constexpr size_t SKIP_LATE_WINDOW_FRAMES = 64;
 
     while (!m_threadsShouldStop.load()) {
         CompressedFramePacket compressedPacket;
@@ -18,18 +26,13 @@ void App::decodeWorkerLoop() {
                 LogToFile("[App::decodeWorkerLoop] Stop signal received while waiting for decode queue (wait_pop returned false), exiting.");
                 break;
             }
-#ifndef NDEBUG
-            LogToFile("[App::decodeWorkerLoop] wait_pop on m_decodeQueue returned false unexpectedly. Continuing.");
-#endif
+            LOG_DEBUG("[App::decodeWorkerLoop] wait_pop on m_decodeQueue returned false unexpectedly. Continuing.");
             continue;
         }
 
-        // Use global constant directly
-        const size_t gpuQueueThrottleLimit = kNumPersistentStagingBuffers + 4;
+        const size_t gpuQueueThrottleLimit = m_stagingRingFrames + 4;
         if (m_gpuUploadQueue.size() >= gpuQueueThrottleLimit) {
-#ifndef NDEBUG
-            LogToFile(std::string("[App::decodeWorkerLoop] GPU Upload Queue near capacity (") + std::to_string(m_gpuUploadQueue.size()) + "/" + std::to_string(gpuQueueThrottleLimit) + "). Throttling decode.");
-#endif
+            LOG_DEBUG(std::string("[App::decodeWorkerLoop] GPU Upload Queue near capacity (") + std::to_string(m_gpuUploadQueue.size()) + "/" + std::to_string(gpuQueueThrottleLimit) + "). Throttling decode.");
             std::this_thread::sleep_for(std::chrono::milliseconds(5));
             if (m_threadsShouldStop.load()) {
                 LogToFile("[App::decodeWorkerLoop] Stop signal received during GPU queue throttle. Re-pushing compressed packet TS " + std::to_string(compressedPacket.timestamp) + " and exiting.");
@@ -40,28 +43,49 @@ void App::decodeWorkerLoop() {
             continue;
         }
 
-        size_t stagingIdx;
-        if (!m_availableStagingBufferIndices.wait_pop(stagingIdx)) {
+        // At AdaptiveQuality's SkipLate level, a frame the playhead will have passed by the time it
+        // is decoded and uploaded is discarded here instead of being decoded and dropped in drawFrame.
+        const AdaptiveQuality::Level qualityLevel = m_qualityLevel.load(std::memory_order_relaxed);
+        if (qualityLevel == AdaptiveQuality::Level::SkipLate && m_playbackController_ptr && !m_playbackController_ptr->isPaused() &&
+            compressedPacket.fileLoadID == m_activeFileLoadID.load(std::memory_order_acquire)) {
+            const size_t playhead = m_playbackController_ptr->getCurrentFrameIndex();
+            const size_t leadFrames = m_skipLateLeadFrames.load(std::memory_order_relaxed);
+            if (compressedPacket.frameIndex < playhead + leadFrames && compressedPacket.frameIndex + SKIP_LATE_WINDOW_FRAMES > playhead) {
+                FrameTrace::recordInstant("late skip", static_cast<int64_t>(compressedPacket.frameIndex), compressedPacket.fileLoadID);
+                m_pipelineMetrics.increment(PipelineMetrics::Counter::FramesSkippedLate);
+                continue;
+            }
+        }
+
+        const VkDeviceSize frameBytes = static_cast<VkDeviceSize>(std::max(compressedPacket.width, 0)) * std::max(compressedPacket.height, 0) * sizeof(uint16_t);
+        if (frameBytes == 0 || frameBytes > m_stagingRing.capacity()) {
+            LOG_ERROR("[App::decodeWorkerLoop] ERROR: Frame of " + std::to_string(frameBytes) + " bytes does not fit staging ring of " + std::to_string(m_stagingRing.capacity()) + " bytes. Dropping packet TS " + std::to_string(compressedPacket.timestamp) + ".");
+            continue;
+        }
+
+        const int64_t traceFrame = static_cast<int64_t>(compressedPacket.frameIndex);
+        const FrameTrace::Clock::time_point acquireStart = FrameTrace::Clock::now();
+        std::optional<StagingSpan> stagingSpan = m_stagingRing.acquire(frameBytes);
+        const FrameTrace::Clock::time_point acquireEnd = FrameTrace::Clock::now();
+        FrameTrace::recordSpan("staging acquire", acquireStart, acquireEnd, traceFrame, compressedPacket.fileLoadID);
+        m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::StagingAcquire, acquireStart, acquireEnd);
+        if (!stagingSpan) {
             if (m_threadsShouldStop.load()) {
-                LogToFile("[App::decodeWorkerLoop] Stop signal: wait_pop for staging buffer returned false. Compressed packet TS " + std::to_string(compressedPacket.timestamp) + " will not be processed further.");
+                LogToFile("[App::decodeWorkerLoop] Stop signal: staging ring acquire returned nothing. Compressed packet TS " + std::to_string(compressedPacket.timestamp) + " will not be processed further.");
                 break;
             }
             else {
-                LogToFile("[App::decodeWorkerLoop] CRITICAL: wait_pop for staging buffer returned false unexpectedly without stop signal. Packet TS " + std::to_string(compressedPacket.timestamp) + ". Dropping.");
+                LOG_ERROR("[App::decodeWorkerLoop] CRITICAL: staging ring acquire failed without stop signal. Packet TS " + std::to_string(compressedPacket.timestamp) + ". Dropping.");
                 continue;
             }
         }
-
-        if (stagingIdx >= m_persistentStagingBuffersMappedPtrs.size() || !m_persistentStagingBuffersMappedPtrs[stagingIdx]) {
-            LogToFile("[App::decodeWorkerLoop] ERROR: Invalid stagingIdx " + std::to_string(stagingIdx) + " or null mapped ptr. Dropping packet TS " + std::to_string(compressedPacket.timestamp) + ".");
-            m_availableStagingBufferIndices.push(stagingIdx);
-            continue;
-        }
-        uint16_t* targetStagingU16Ptr = static_cast<uint16_t*>(m_persistentStagingBuffersMappedPtrs[stagingIdx]);
+        uint16_t* targetStagingU16Ptr = static_cast<uint16_t*>(stagingSpan->mappedPtr);
 
         bool decodeSuccess = false;
         nlohmann::json frameMeta;
+        std::optional<GpuRawDecoder::DecodeParams> gpuDecodeParams;
 
+        const FrameTrace::Clock::time_point decodeStart = FrameTrace::Clock::now();
         try {
             if (compressedPacket.width <= 0 || compressedPacket.height <= 0) {
                 LogToFile(std::string("[App::decodeWorkerLoop] Invalid dimensions in compressed packet TS ") + std::to_string(compressedPacket.timestamp) + ": " + std::to_string(compressedPacket.width) + "x" + std::to_string(compressedPacket.height));
@@ -73,8 +97,17 @@ void App::decodeWorkerLoop() {
                 LogToFile(std::string("[App::decodeWorkerLoop] Null target staging pointer for TS ") + std::to_string(compressedPacket.timestamp));
             }
             else if (compressedPacket.compressionType == LOCAL_MC_COMPRESSION_TYPE_NEW) {
-                if (motioncam::raw::Decode(targetStagingU16Ptr, compressedPacket.width, compressedPacket.height, compressedPacket.compressedPayload.data(), compressedPacket.compressedPayload.size()) > 0) decodeSuccess = true;
-                else LogToFile(std::string("[App::decodeWorkerLoop] motioncam::raw::Decode failed for TS ") + std::to_string(compressedPacket.timestamp));
+                GpuRawDecoder::DecodeParams stagedParams;
+                if (m_gpuRawDecodeEnabled && stageForGpuDecode(compressedPacket, *stagingSpan, stagedParams)) {
+                    gpuDecodeParams = stagedParams;
+                    decodeSuccess = true;
+                }
+                else if (qualityLevel >= AdaptiveQuality::Level::ParallelDecode && m_bandDecoder) {
+                    if (m_bandDecoder->decode(targetStagingU16Ptr, compressedPacket.width, compressedPacket.height, compressedPacket.compressedPayload.data(), compressedPacket.compressedPayload.size(), true) > 0) decodeSuccess = true;
+                    else LogToFile(std::string("[App::decodeWorkerLoop] BandDecoder::decode failed for TS ") + std::to_string(compressedPacket.timestamp));
+                }
+                else if (motioncam::raw::DecodeToWriteCombined(targetStagingU16Ptr, compressedPacket.width, compressedPacket.height, compressedPacket.compressedPayload.data(), compressedPacket.compressedPayload.size()) > 0) decodeSuccess = true;
+                else LogToFile(std::string("[App::decodeWorkerLoop] motioncam::raw::DecodeToWriteCombined failed for TS ") + std::to_string(compressedPacket.timestamp));
             }
             else if (compressedPacket.compressionType == LOCAL_MC_COMPRESSION_TYPE_LEGACY) {
                 if (motioncam::raw::DecodeLegacy(targetStagingU16Ptr, compressedPacket.width, compressedPacket.height, compressedPacket.compressedPayload.data(), compressedPacket.compressedPayload.size()) > 0) decodeSuccess = true;
@@ -117,32 +150,85 @@ void App::decodeWorkerLoop() {
             LogToFile(std::string("[App::decodeWorkerLoop] EXCEPTION during decode/metadata for TS ") + std::to_string(compressedPacket.timestamp) + ": " + e.what());
             decodeSuccess = false;
         }
-
+        const FrameTrace::Clock::time_point decodeEnd = FrameTrace::Clock::now();
+        FrameTrace::recordSpan("decode", decodeStart, decodeEnd, traceFrame, compressedPacket.fileLoadID);
+        m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::Decode, decodeStart, decodeEnd);
 
         if (decodeSuccess) {
+            m_stagingRing.flush(*stagingSpan);
+
             GpuUploadPacket gpuPacket;
             gpuPacket.timestamp = compressedPacket.timestamp;
-            gpuPacket.stagingBufferIndex = stagingIdx;
+            gpuPacket.staging = *stagingSpan;
+            gpuPacket.gpuDecode = gpuDecodeParams;
             gpuPacket.metadata = std::move(frameMeta);
             gpuPacket.width = compressedPacket.width;
             gpuPacket.height = compressedPacket.height;
             gpuPacket.frameIndex = compressedPacket.frameIndex;
             gpuPacket.fileLoadID = compressedPacket.fileLoadID;
+            gpuPacket.proxy = compressedPacket.proxy;
+
+            // With a transfer queue the copy into device memory starts now, ahead of display;
+            // drawFrame only picks the packet up once the timeline semaphore says it is done.
+            if (!gpuPacket.gpuDecode.has_value() && m_transferUploader && m_rendererVk && m_rendererVk->getRawUploadPath() == Renderer_VK::RawUploadPath::CopyToImage &&
+                m_transferUploader->fits(static_cast<uint32_t>(compressedPacket.width), static_cast<uint32_t>(compressedPacket.height))) {
+                const FrameTrace::Clock::time_point submitStart = FrameTrace::Clock::now();
+                gpuPacket.transfer = m_transferUploader->submitUpload(m_stagingRing.buffer(), stagingSpan->offset,
+                    static_cast<uint32_t>(compressedPacket.width), static_cast<uint32_t>(compressedPacket.height));
+                const FrameTrace::Clock::time_point submitEnd = FrameTrace::Clock::now();
+                FrameTrace::recordSpan("upload submit", submitStart, submitEnd, traceFrame, compressedPacket.fileLoadID);
+                m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::UploadSubmit, submitStart, submitEnd);
+            }
 
             if (m_threadsShouldStop.load()) {
-                m_availableStagingBufferIndices.push(stagingIdx);
-                LogToFile("[App::decodeWorkerLoop] Stop signal before pushing to GPU queue, returning staging buffer.");
+                if (gpuPacket.transfer.has_value()) m_transferUploader->release(gpuPacket.transfer.value());
+                m_stagingRing.release(*stagingSpan);
+                LogToFile("[App::decodeWorkerLoop] Stop signal before pushing to GPU queue, releasing staging span.");
                 break;
             }
             m_gpuUploadQueue.push(std::move(gpuPacket));
         }
         else {
-            LogToFile(std::string("[App::decodeWorkerLoop] Decode FAILED for TS ") + std::to_string(compressedPacket.timestamp) + ". Returning staging buffer " + std::to_string(stagingIdx) + ".");
-            m_availableStagingBufferIndices.push(stagingIdx);
+            LogToFile(std::string("[App::decodeWorkerLoop] Decode FAILED for TS ") + std::to_string(compressedPacket.timestamp) + ". Releasing staging span at offset " + std::to_string(stagingSpan->offset) + ".");
+            m_stagingRing.release(*stagingSpan);
         }
     }
     LogToFile("[App::decodeWorkerLoop] Decode thread finished.");
 }
+
+/// Stages a type 7 frame for GpuRawDecoder: the block table from raw::BuildBlockTable followed by
+/// the compressed payload. Returns false, leaving the frame to the CPU decoder, if the payload is
+/// malformed or truncated, or the staged frame does not fit the span or the decoder's buffer binding.
+bool App::stageForGpuDecode(const CompressedFramePacket& packet, const StagingSpan& span, GpuRawDecoder::DecodeParams& outParams) {
+    uint32_t blocksPerRow = 0;
+    uint32_t rowGroups = 0;
+    const size_t payloadBytes = motioncam::raw::BuildBlockTable(packet.width, packet.height,
+        packet.compressedPayload.data(), packet.compressedPayload.size(), m_gpuDecodeBlockTable, blocksPerRow, rowGroups);
+    if (payloadBytes == 0) {
+        LOG_DEBUG("[App::stageForGpuDecode] Block table rejected for TS " + std::to_string(packet.timestamp) + ". Decoding on the CPU.");
+        return false;
+    }
+
+    const VkDeviceSize tableBytes = m_gpuDecodeBlockTable.size() * sizeof(uint32_t);
+    const VkDeviceSize stagedBytes = tableBytes + ((static_cast<VkDeviceSize>(payloadBytes) + 3) & ~VkDeviceSize(3));
+    const VkDeviceSize sourceRange = m_rendererVk ? m_rendererVk->getGpuRawDecodeSourceRange() : 0;
+    if (stagedBytes > span.size || span.offset + stagedBytes > sourceRange) {
+        LOG_DEBUG("[App::stageForGpuDecode] Staged frame of " + std::to_string(stagedBytes) + " bytes at offset " + std::to_string(span.offset) + " exceeds the span or binding. Decoding on the CPU.");
+        return false;
+    }
+
+    uint8_t* dst = static_cast<uint8_t*>(span.mappedPtr);
+    std::memcpy(dst, m_gpuDecodeBlockTable.data(), static_cast<size_t>(tableBytes));
+    std::memcpy(dst + tableBytes, packet.compressedPayload.data(), payloadBytes);
+
+    outParams.tableWordOffset = static_cast<uint32_t>(span.offset / sizeof(uint32_t));
+    outParams.payloadWordOffset = static_cast<uint32_t>((span.offset + tableBytes) / sizeof(uint32_t));
+    outParams.blocksPerRow = blocksPerRow;
+    outParams.rowGroups = rowGroups;
+    outParams.width = packet.width;
+    outParams.height = packet.height;
+    return true;
+}
 // launchWorkerThreads is defined in AppInit.cpp as part of the constructor logic now
 // or should be called from there if it's meant to be run once.
 // If it's meant to be callable multiple times, its definition can stay in AppDecode.cpp or move to App.cpp (general part).
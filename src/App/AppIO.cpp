@@ -3,167 +3,85 @@
 #include "Audio/AudioController.h"
 #include "Decoder/DecoderWrapper.h"
 #include "Playback/PlaybackController.h"
+#include "Playback/ClipAnalyzer.h"
+#include "Playback/ClipIndexer.h"
+#include "Playback/ClipPreloader.h"
+#include "Playback/DisplaySchedule.h"
+#include "Playback/ProxyGenerator.h"
 #include "Graphics/Renderer_VK.h"
 #include "Utils/DebugLog.h"
+#include "Utils/FrameTrace.h"
 #include "Utils/RawFrameBuffer.h"
 #include <motioncam/Decoder.hpp>
+#include <motioncam/Proxy.hpp>
 #include <motioncam/RawData.hpp>
 
 #include "App/AppConfig.h" 
 
-#ifndef TINY_DNG_WRITER_IMPLEMENTATION
-#define TINY_DNG_WRITER_IMPLEMENTATION
-#endif
-#include <tinydng/tiny_dng_writer.h>
-
+#include "Export/DngStreamWriter.h"
 
 #include <filesystem>
 #include <iostream>
+#include <iterator>
 #include <numeric>
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <deque>
 #include <sstream> 
+#include <system_error>
+#include <utility>
 
 namespace fs = std::filesystem;
 
 namespace {
-    bool writeDngInternal(
-        const std::string& outputPath,
-        const RawBytes& data,
-        const nlohmann::json& frameMetadata,
+    // Streams one frame from the container into a DNG: the compressed payload is decoded
+    // directly into the output file's pixel strip, so no intermediate frame copies are kept.
+    bool exportFrameAsDng(
+        motioncam::Decoder& decoder,
+        motioncam::Timestamp ts,
         const nlohmann::json& containerMetadata,
+        const std::string& outputPath,
         std::string& errorMsg)
     {
-        const unsigned int width = frameMetadata.value("width", 0);
-        const unsigned int height = frameMetadata.value("height", 0);
-
-        if (width == 0 || height == 0) {
-            errorMsg = "Invalid frame dimensions (width or height is zero).";
-            return false;
-        }
+        std::vector<uint8_t> compressedPayload;
+        std::vector<uint8_t> metadataPayload;
+        int width = 0, height = 0, compressionType = -1;
 
-        if (data.size() < static_cast<size_t>(width) * height * sizeof(uint16_t)) {
-            errorMsg = "Insufficient image data for given dimensions. Expected bytes: " +
-                std::to_string(static_cast<size_t>(width) * height * sizeof(uint16_t)) +
-                ", Got: " + std::to_string(data.size());
+        if (!decoder.getRawFramePayloads(ts, compressedPayload, metadataPayload, width, height, compressionType)) {
+            errorMsg = "Failed to read frame payload for timestamp " + std::to_string(ts) + ".";
             return false;
         }
-        std::vector<double> asShotNeutralDouble = frameMetadata.value("asShotNeutral", std::vector<double>{1.0, 1.0, 1.0});
-        std::vector<float> asShotNeutral;
-        asShotNeutral.reserve(asShotNeutralDouble.size());
-        for (double val : asShotNeutralDouble) {
-            asShotNeutral.push_back(static_cast<float>(val));
-        }
 
-        std::vector<double> blackLevelDouble = containerMetadata.value("blackLevel", std::vector<double>{0.0, 0.0, 0.0, 0.0});
-        if (blackLevelDouble.empty()) {
-            blackLevelDouble = { 0.0, 0.0, 0.0, 0.0 };
-        }
-        else if (blackLevelDouble.size() == 1) {
-            double val = blackLevelDouble[0];
-            blackLevelDouble = { val, val, val, val };
-        }
-        else if (blackLevelDouble.size() != 4) {
-#ifndef NDEBUG
-            std::cerr << "Warning: Unexpected number of black levels (" << blackLevelDouble.size() << ") in metadata. Adjusting to 4." << std::endl;
-#endif
-            double fill_val = blackLevelDouble.empty() ? 0.0 : blackLevelDouble[0];
-            blackLevelDouble.resize(4, fill_val);
-        }
-        std::vector<uint16_t> blackLevelUint16;
-        blackLevelUint16.reserve(blackLevelDouble.size());
-        for (double d_val : blackLevelDouble) {
-            uint16_t u_val = 0;
-            if (d_val < 0.0) u_val = 0;
-            else if (d_val > 65535.0) u_val = 65535;
-            else u_val = static_cast<uint16_t>(std::round(d_val));
-            blackLevelUint16.push_back(u_val);
-        }
-        double whiteLevel = containerMetadata.value("whiteLevel", 65535.0);
-        std::string sensorArrangement = containerMetadata.value("sensorArrangement",
-            containerMetadata.value("sensorArrangment", "BGGR"));
-        nlohmann::json ccm1_json = containerMetadata.value("ColorMatrix", containerMetadata.value("colorMatrix1", nlohmann::json::array({ 1,0,0,0,1,0,0,0,1 })));
-        nlohmann::json ccm2_json = containerMetadata.value("ColorMatrix2", containerMetadata.value("colorMatrix2", nlohmann::json::array({ 1,0,0,0,1,0,0,0,1 })));
-        std::vector<float> colorMatrix1 = { 1,0,0, 0,1,0, 0,0,1 };
-        std::vector<float> colorMatrix2 = { 1,0,0, 0,1,0, 0,0,1 };
-        if (ccm1_json.is_array() && ccm1_json.size() == 9) {
-            for (size_t i = 0; i < 9; ++i) colorMatrix1[i] = ccm1_json[i].get<float>();
-        }
-        if (ccm2_json.is_array() && ccm2_json.size() == 9) {
-            for (size_t i = 0; i < 9; ++i) colorMatrix2[i] = ccm2_json[i].get<float>();
-        }
-        nlohmann::json fwd1_json = containerMetadata.value("ForwardMatrix1", containerMetadata.value("forwardMatrix1", nlohmann::json::array({ 1,0,0,0,1,0,0,0,1 })));
-        nlohmann::json fwd2_json = containerMetadata.value("ForwardMatrix2", containerMetadata.value("forwardMatrix2", nlohmann::json::array({ 1,0,0,0,1,0,0,0,1 })));
-        std::vector<float> forwardMatrix1 = { 1,0,0, 0,1,0, 0,0,1 };
-        std::vector<float> forwardMatrix2 = { 1,0,0, 0,1,0, 0,0,1 };
-        if (fwd1_json.is_array() && fwd1_json.size() == 9) {
-            for (size_t i = 0; i < 9; ++i) forwardMatrix1[i] = fwd1_json[i].get<float>();
-        }
-        if (fwd2_json.is_array() && fwd2_json.size() == 9) {
-            for (size_t i = 0; i < 9; ++i) forwardMatrix2[i] = fwd2_json[i].get<float>();
-        }
-        tinydngwriter::DNGImage dng;
-        dng.SetBigEndian(false);
-        dng.SetDNGVersion(1, 4, 0, 0);
-        dng.SetDNGBackwardVersion(1, 1, 0, 0);
-        dng.SetImageData(data.data(), data.size());
-        dng.SetImageWidth(width);
-        dng.SetImageLength(height);
-        dng.SetPlanarConfig(tinydngwriter::PLANARCONFIG_CONTIG);
-        dng.SetPhotometric(tinydngwriter::PHOTOMETRIC_CFA);
-        dng.SetRowsPerStrip(height);
-        dng.SetSamplesPerPixel(1);
-        dng.SetCFARepeatPatternDim(2, 2);
-        dng.SetBlackLevelRepeatDim(2, 2);
-        dng.SetBlackLevel(blackLevelUint16.size(), blackLevelUint16.data());
-        dng.SetWhiteLevel(static_cast<float>(whiteLevel));
-        dng.SetCompression(tinydngwriter::COMPRESSION_NONE);
-        std::vector<unsigned char> cfa_pattern_values;
-        std::string cfa_upper = sensorArrangement;
-        std::transform(cfa_upper.begin(), cfa_upper.end(), cfa_upper.begin(), ::toupper);
-        if (cfa_upper == "RGGB")        cfa_pattern_values = { 0, 1, 1, 2 };
-        else if (cfa_upper == "BGGR")   cfa_pattern_values = { 2, 1, 1, 0 };
-        else if (cfa_upper == "GRBG")   cfa_pattern_values = { 1, 0, 2, 1 };
-        else if (cfa_upper == "GBRG")   cfa_pattern_values = { 1, 2, 0, 1 };
-        else {
-            errorMsg = "Invalid or unsupported sensorArrangement for DNG CFA pattern: " + sensorArrangement;
-            return false;
+        try {
+            nlohmann::json frameMetadata = nlohmann::json::parse(metadataPayload.begin(), metadataPayload.end());
+            DngStreamWriter writer(static_cast<uint32_t>(width), static_cast<uint32_t>(height), frameMetadata, containerMetadata);
+            return writer.writeFromCompressed(outputPath, compressedPayload.data(), compressedPayload.size(), compressionType, errorMsg);
         }
-        dng.SetCFAPattern(cfa_pattern_values.size(), cfa_pattern_values.data());
-        dng.SetCFALayout(1);
-        const uint16_t bps[1] = { 16 };
-        dng.SetBitsPerSample(1, bps);
-        dng.SetColorMatrix1(3, colorMatrix1.data());
-        dng.SetColorMatrix2(3, colorMatrix2.data());
-        dng.SetForwardMatrix1(3, forwardMatrix1.data());
-        dng.SetForwardMatrix2(3, forwardMatrix2.data());
-        dng.SetAsShotNeutral(asShotNeutral.size(), asShotNeutral.data());
-        dng.SetCalibrationIlluminant1(21);
-        dng.SetCalibrationIlluminant2(17);
-        dng.SetUniqueCameraModel("MotionCam App Player Export");
-        dng.SetSubfileType(false, false, false);
-        const uint32_t activeArea[4] = { 0, 0, height, width };
-        dng.SetActiveArea(activeArea);
-
-        tinydngwriter::DNGWriter writer(false);
-        writer.AddImage(&dng);
-
-        if (!writer.WriteToFile(outputPath.c_str(), &errorMsg)) {
+        catch (const std::exception& e) {
+            errorMsg = e.what();
             return false;
         }
-        return true;
     }
 }
 
 
 void App::ioWorkerLoop() {
     LogToFile("[App::ioWorkerLoop] I/O thread started.");
-    std::unique_ptr<motioncam::Decoder> threadLocalDecoder;
+    FrameTrace::setThreadName("IO");
+    std::shared_ptr<motioncam::Decoder> threadLocalDecoder; // Shared with m_decoderWrapper
+    std::shared_ptr<motioncam::Decoder> proxyDecoder_io;    // Same frames at a fraction of the size, or null
     std::string currentFileBeingProcessed_io;
     std::vector<motioncam::Timestamp> frameTimestampsForCurrentFile_io;
     size_t frameIndexInCurrentFile_io = 0;
     size_t currentFileLoadID_io = 0;
+    size_t prerollFrames_io = 0;
+    // Frames read ahead in one batch when the byte source keeps several reads in flight, with
+    // their frame indices, in schedule order.
+    std::deque<std::pair<size_t, motioncam::FramePayload>> prefetched_io;
+    bool prefetchedFromProxy_io = false;
+    // While playing, only the frames the playhead lands on at a display refresh are read.
+    DisplaySchedule::Cursor schedule_io;
 
     while (!m_threadsShouldStop.load(std::memory_order_relaxed)) {
         bool fileStateChanged_io = false;
@@ -205,24 +123,35 @@ void App::ioWorkerLoop() {
                         "', NewLoadID: " + std::to_string(newAppLoadID));
                     currentFileBeingProcessed_io = nextFileToProcessIfChanged_io;
                     currentFileLoadID_io = newAppLoadID;
-                    threadLocalDecoder.reset();
+                    threadLocalDecoder = std::move(m_ioThreadDecoder);
                     frameTimestampsForCurrentFile_io.clear();
+                    prefetched_io.clear();
+                    prerollFrames_io = std::exchange(m_ioThreadPrerollFrames, 0);
                 }
                 else {
-                    LogToFile(std::string("[App::ioWorkerLoop] SEEK/STATE_CHANGE directive within current file: '") + (currentFileBeingProcessed_io.empty() ? "<EMPTY>" : fs::path(currentFileBeingProcessed_io).filename().string()) + "', Current LoadID: " + std::to_string(currentFileLoadID_io));
+                    LOG_DEBUG(std::string("[App::ioWorkerLoop] SEEK/STATE_CHANGE directive within current file: '") + (currentFileBeingProcessed_io.empty() ? "<EMPTY>" : fs::path(currentFileBeingProcessed_io).filename().string()) + "', Current LoadID: " + std::to_string(currentFileLoadID_io));
                 }
                 m_ioThreadFileChanged.store(false, std::memory_order_release);
             }
+
+            if (m_ioThreadProxyChanged.exchange(false, std::memory_order_acq_rel)) {
+                proxyDecoder_io = std::move(m_ioThreadProxyDecoder);
+                LOG_DEBUG(std::string("[App::ioWorkerLoop] Proxy decoder ") + (proxyDecoder_io ? "set." : "cleared."));
+            }
         }
 
         if (fileStateChanged_io) {
+            prefetched_io.clear();
             if (currentFileBeingProcessed_io.empty()) {
-                threadLocalDecoder.reset(); frameTimestampsForCurrentFile_io.clear(); frameIndexInCurrentFile_io = 0;
+                threadLocalDecoder.reset(); proxyDecoder_io.reset(); frameTimestampsForCurrentFile_io.clear(); frameIndexInCurrentFile_io = 0;
                 continue;
             }
-            if (!threadLocalDecoder) {
+            if (frameTimestampsForCurrentFile_io.empty()) {
                 try {
-                    threadLocalDecoder = std::make_unique<motioncam::Decoder>(currentFileBeingProcessed_io);
+                    if (!threadLocalDecoder) {
+                        LogToFile("[App::ioWorkerLoop] No shared decoder for '" + fs::path(currentFileBeingProcessed_io).filename().string() + "', opening one.");
+                        threadLocalDecoder = std::make_shared<motioncam::Decoder>(currentFileBeingProcessed_io);
+                    }
                     frameTimestampsForCurrentFile_io = threadLocalDecoder->getFrames();
                     std::ostringstream log_oss_dec;
                     log_oss_dec << "[App::ioWorkerLoop] Decoder setup complete for '" << fs::path(currentFileBeingProcessed_io).filename().string()
@@ -240,11 +169,14 @@ void App::ioWorkerLoop() {
             }
 
             if (m_playbackController_ptr && m_activeFileLoadID.load(std::memory_order_acquire) == currentFileLoadID_io) {
-                frameIndexInCurrentFile_io = m_playbackController_ptr->getCurrentFrameIndex();
-                LogToFile(std::string("[App::ioWorkerLoop] IO loop index synced to PlaybackController's index: ") + std::to_string(frameIndexInCurrentFile_io) + " for LoadID: " + std::to_string(currentFileLoadID_io));
+                // Frames pre-rolled by a gapless switch are already in the decode queue.
+                frameIndexInCurrentFile_io = std::max(m_playbackController_ptr->getCurrentFrameIndex(), prerollFrames_io);
+                prerollFrames_io = 0;
+                schedule_io = DisplaySchedule::start(frameTimestampsForCurrentFile_io, frameIndexInCurrentFile_io);
+                LOG_DEBUG(std::string("[App::ioWorkerLoop] IO loop index synced to PlaybackController's index: ") + std::to_string(frameIndexInCurrentFile_io) + " for LoadID: " + std::to_string(currentFileLoadID_io));
             }
             else if (m_playbackController_ptr) {
-                LogToFile(std::string("[App::ioWorkerLoop] Post-Change Signal: LoadID mismatch or no PB. IO LoadID: ") + std::to_string(currentFileLoadID_io) + ", App LoadID: " + std::to_string(m_activeFileLoadID.load(std::memory_order_acquire)) + ". Will not sync index from PB yet.");
+                LOG_DEBUG(std::string("[App::ioWorkerLoop] Post-Change Signal: LoadID mismatch or no PB. IO LoadID: ") + std::to_string(currentFileLoadID_io) + ", App LoadID: " + std::to_string(m_activeFileLoadID.load(std::memory_order_acquire)) + ". Will not sync index from PB yet.");
             }
         }
 
@@ -253,6 +185,12 @@ void App::ioWorkerLoop() {
             continue;
         }
 
+        // Reading ahead covers as many refreshes, not clip frames, when frames are skipped.
+        const int64_t frameIntervalNs_io = DisplaySchedule::frameIntervalNs(frameTimestampsForCurrentFile_io);
+        const int64_t displayIntervalNs_io = DisplaySchedule::displayIntervalNs(frameIntervalNs_io, PlaybackController::getDisplayFps());
+        const size_t leadFrames_io = MAX_LEAD_FRAMES_IO_WORKER *
+            static_cast<size_t>(std::ceil(DisplaySchedule::frameStride(frameIntervalNs_io, displayIntervalNs_io)));
+
         bool shouldLoadThisFrame_io = false;
         if (m_playbackController_ptr) {
             size_t pb_current_idx = m_playbackController_ptr->getCurrentFrameIndex();
@@ -268,11 +206,12 @@ void App::ioWorkerLoop() {
             }
             else {
                 if (frameIndexInCurrentFile_io < frameTimestampsForCurrentFile_io.size()) {
-                    if (frameIndexInCurrentFile_io >= pb_current_idx && frameIndexInCurrentFile_io < pb_current_idx + MAX_LEAD_FRAMES_IO_WORKER) {
+                    if (frameIndexInCurrentFile_io >= pb_current_idx && frameIndexInCurrentFile_io < pb_current_idx + leadFrames_io) {
                         shouldLoadThisFrame_io = true;
                     }
                     else if (frameIndexInCurrentFile_io < pb_current_idx) {
                         frameIndexInCurrentFile_io = pb_current_idx;
+                        schedule_io = DisplaySchedule::start(frameTimestampsForCurrentFile_io, frameIndexInCurrentFile_io);
                         if (frameIndexInCurrentFile_io < frameTimestampsForCurrentFile_io.size()) shouldLoadThisFrame_io = true;
                     }
                 }
@@ -293,13 +232,87 @@ void App::ioWorkerLoop() {
         packet.frameIndex = frameIndexInCurrentFile_io;
         packet.fileLoadID = currentFileLoadID_io;
 
+        const bool pb_is_playing = m_playbackController_ptr && !m_playbackController_ptr->isPaused();
+        // From AdaptiveQuality's reduced-resolution level on, playing frames come from the proxy.
+        // Paused frames and native-pixel zoom always show the clip itself.
+        const bool useProxy = proxyDecoder_io && pb_is_playing &&
+            m_qualityLevel.load(std::memory_order_relaxed) >= AdaptiveQuality::Level::ReducedResolution &&
+            !m_playbackController_ptr->isZoomNativePixels();
+        const motioncam::Decoder& sourceDecoder = useProxy ? *proxyDecoder_io : *threadLocalDecoder;
+        packet.proxy = useProxy;
+
+        if (schedule_io.index != frameIndexInCurrentFile_io) {
+            schedule_io = DisplaySchedule::start(frameTimestampsForCurrentFile_io, frameIndexInCurrentFile_io);
+        }
+        if (!prefetched_io.empty() && (prefetched_io.front().first != frameIndexInCurrentFile_io || prefetchedFromProxy_io != useProxy)) {
+            prefetched_io.clear(); // Seeked away from the batch, switched between clip and proxy, or the schedule changed
+        }
+
+        const unsigned readsInFlight = sourceDecoder.getByteSource().maxInFlight();
+        if (prefetched_io.empty() && pb_is_playing && readsInFlight > 1) {
+            const size_t batchSize = std::min(static_cast<size_t>(readsInFlight), MAX_LEAD_FRAMES_IO_WORKER);
+            std::vector<size_t> batchIndices;
+            std::vector<motioncam::Timestamp> batchTimestamps;
+            for (DisplaySchedule::Cursor c = schedule_io; batchIndices.size() < batchSize && c.index < frameTimestampsForCurrentFile_io.size();
+                c = DisplaySchedule::next(frameTimestampsForCurrentFile_io, c, displayIntervalNs_io)) {
+                batchIndices.push_back(c.index);
+                batchTimestamps.push_back(frameTimestampsForCurrentFile_io[c.index]);
+            }
+            std::vector<motioncam::FramePayload> batch;
+
+            const FrameTrace::Clock::time_point readStart = FrameTrace::Clock::now();
+            try {
+                sourceDecoder.getRawFramePayloads(batchTimestamps, batch);
+            }
+            catch (const std::exception& e) {
+                LogToFile(std::string("[App::ioWorkerLoop] EXCEPTION in batched getRawFramePayloads from idx ") + std::to_string(frameIndexInCurrentFile_io) + ": " + e.what());
+                batch.clear();
+            }
+            const FrameTrace::Clock::time_point readEnd = FrameTrace::Clock::now();
+            FrameTrace::recordSpan("io read", readStart, readEnd, static_cast<int64_t>(packet.frameIndex), packet.fileLoadID);
+            m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::IoRead, readStart, readEnd);
+
+            for (size_t i = 0; i < batch.size() && i < batchIndices.size(); ++i) {
+                prefetched_io.emplace_back(batchIndices[i], std::move(batch[i]));
+            }
+            prefetchedFromProxy_io = useProxy;
+        }
+
         bool payloadSuccess = false;
-        try {
-            payloadSuccess = threadLocalDecoder->getRawFramePayloads(ts, packet.compressedPayload, packet.metadataPayload, packet.width, packet.height, packet.compressionType);
+        if (!prefetched_io.empty()) {
+            motioncam::FramePayload& payload = prefetched_io.front().second;
+            payloadSuccess = payload.valid;
+            packet.compressedPayload = std::move(payload.compressedPayload);
+            packet.metadataPayload = std::move(payload.metadataPayload);
+            packet.width = payload.width;
+            packet.height = payload.height;
+            packet.compressionType = payload.compressionType;
+            prefetched_io.pop_front();
         }
-        catch (const std::exception& e) {
-            LogToFile(std::string("[App::ioWorkerLoop] EXCEPTION in getRawFramePayloads for TS ") + std::to_string(ts) + " (idx " + std::to_string(frameIndexInCurrentFile_io) + "): " + e.what());
-            payloadSuccess = false;
+        else {
+            const FrameTrace::Clock::time_point readStart = FrameTrace::Clock::now();
+            try {
+                payloadSuccess = sourceDecoder.getRawFramePayloads(ts, packet.compressedPayload, packet.metadataPayload, packet.width, packet.height, packet.compressionType);
+            }
+            catch (const std::exception& e) {
+                LogToFile(std::string("[App::ioWorkerLoop] EXCEPTION in getRawFramePayloads for TS ") + std::to_string(ts) + " (idx " + std::to_string(frameIndexInCurrentFile_io) + "): " + e.what());
+                payloadSuccess = false;
+            }
+            const FrameTrace::Clock::time_point readEnd = FrameTrace::Clock::now();
+            FrameTrace::recordSpan("io read", readStart, readEnd, static_cast<int64_t>(packet.frameIndex), packet.fileLoadID);
+            m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::IoRead, readStart, readEnd);
+        }
+
+        if (!payloadSuccess && packet.proxy) {
+            LogToFile(std::string("[App::ioWorkerLoop] Proxy frame ") + std::to_string(frameIndexInCurrentFile_io) + " unreadable, reading it from the clip.");
+            packet.proxy = false;
+            try {
+                payloadSuccess = threadLocalDecoder->getRawFramePayloads(ts, packet.compressedPayload, packet.metadataPayload, packet.width, packet.height, packet.compressionType);
+            }
+            catch (const std::exception& e) {
+                LogToFile(std::string("[App::ioWorkerLoop] EXCEPTION in getRawFramePayloads for TS ") + std::to_string(ts) + " (idx " + std::to_string(frameIndexInCurrentFile_io) + "): " + e.what());
+                payloadSuccess = false;
+            }
         }
 
         if (payloadSuccess) {
@@ -309,13 +322,9 @@ void App::ioWorkerLoop() {
             LogToFile(std::string("[App::ioWorkerLoop] Failed to get raw payloads for TS ") + std::to_string(ts) + " file '" + fs::path(currentFileBeingProcessed_io).filename().string() + "', frame " + std::to_string(frameIndexInCurrentFile_io) + ". Skipping.");
         }
 
-        if (m_playbackController_ptr) {
-            if (!m_playbackController_ptr->isPaused()) {
-                frameIndexInCurrentFile_io++;
-            }
-        }
-        else {
-            frameIndexInCurrentFile_io++;
+        if (!m_playbackController_ptr || !m_playbackController_ptr->isPaused()) {
+            schedule_io = DisplaySchedule::next(frameTimestampsForCurrentFile_io, schedule_io, pb_is_playing ? displayIntervalNs_io : 0);
+            frameIndexInCurrentFile_io = schedule_io.index;
         }
     }
     LogToFile("[App::ioWorkerLoop] I/O thread finished.");
@@ -348,6 +357,9 @@ void App::loadFileAtIndex(int index) {
     const std::string& newFilePath = m_fileList[m_currentFileIndex];
     LogToFile(std::string("[App::loadFileAtIndex] Target file: '") + fs::path(newFilePath).filename().string() + "', New LoadID: " + std::to_string(new_load_id));
 
+    // A clip prepared near the end of the previous one skips opening, indexing and the first reads below.
+    std::unique_ptr<PreparedClip> preparedClip = m_clipPreloader ? m_clipPreloader->take(newFilePath) : nullptr;
+
     if (m_audio) m_audio->setForceMute(true);
 
     LogToFile("App::loadFileAtIndex Stopping worker threads (if running)...");
@@ -355,7 +367,8 @@ void App::loadFileAtIndex(int index) {
     m_ioThreadFileCv.notify_all();
     m_decodeQueue.stop_operations();
     m_gpuUploadQueue.stop_operations();
-    m_availableStagingBufferIndices.stop_operations();
+    m_stagingRing.stop_operations();
+    if (m_transferUploader) m_transferUploader->stop_operations();
 
     auto joinStartTime = std::chrono::high_resolution_clock::now();
     if (m_ioThread.joinable())   m_ioThread.join();
@@ -370,17 +383,17 @@ void App::loadFileAtIndex(int index) {
         LogToFile(std::string("App::loadFileAtIndex vkDeviceWaitIdle completed in ") + std::to_string(std::chrono::duration<double, std::milli>(gpuIdleEndTime - gpuIdleStartTime).count()) + " ms");
     }
 
+    if (!m_pipelineMetrics.fileName().empty()) {
+        m_pipelineMetrics.appendSummary(PipelineMetrics::kSummaryFileName);
+    }
+    m_pipelineMetrics.reset(fs::path(newFilePath).filename().string());
+
     LogToFile("App::loadFileAtIndex Clearing queues and resetting states.");
     m_decodeQueue.clear();
     m_gpuUploadQueue.clear();
-    m_availableStagingBufferIndices.clear();
-
-    m_availableStagingBufferIndices.resume_operations();
-    for (size_t i = 0; i < kNumPersistentStagingBuffers; ++i) {
-        m_availableStagingBufferIndices.push(i);
-    }
-
-    std::fill(m_inFlightStagingBufferIndices.begin(), m_inFlightStagingBufferIndices.end(), std::nullopt);
+    resetStagingState();
+    m_stagingRing.resume_operations();
+    if (m_transferUploader) m_transferUploader->resume_operations();
     m_hasLastSuccessfullyUploadedPacket.store(false, std::memory_order_release);
 
     m_decodedWidth = 0;
@@ -392,7 +405,12 @@ void App::loadFileAtIndex(int index) {
     nlohmann::json containerMetaForFile;
 
     try {
-        m_decoderWrapper = std::make_unique<DecoderWrapper>(newFilePath);
+        if (preparedClip) {
+            m_decoderWrapper = std::move(preparedClip->decoder);
+        }
+        else {
+            m_decoderWrapper = std::make_unique<DecoderWrapper>(newFilePath);
+        }
         m_decoderWrapper_ptr = m_decoderWrapper.get();
         video_frames_from_main_decoder = m_decoderWrapper->getDecoder()->getFrames();
         containerMetaForFile = m_decoderWrapper->getContainerMetadata();
@@ -409,10 +427,16 @@ void App::loadFileAtIndex(int index) {
         m_decoderWrapper_ptr = nullptr;
         if (m_playbackController_ptr) {
             m_playbackController_ptr->processNewSegment({}, 0, std::chrono::steady_clock::now());
+            m_playbackController_ptr->setFrameDurationNs(0);
         }
+        resetProxyPlayback(newFilePath, false);
         {
             std::lock_guard<std::mutex> lock(m_ioThreadFileMutex);
             m_ioThreadCurrentFilePath = "";
+            m_ioThreadDecoder.reset();
+            m_ioThreadPrerollFrames = 0;
+            m_ioThreadProxyDecoder.reset();
+            m_ioThreadProxyChanged.store(true, std::memory_order_release);
             m_activeFileLoadID.store(new_load_id, std::memory_order_release);
             m_ioThreadFileChanged.store(true, std::memory_order_release);
         }
@@ -453,24 +477,44 @@ void App::loadFileAtIndex(int index) {
 
     if (!video_frames_from_main_decoder.empty()) {
         firstVideoFrameTimestampNs = video_frames_from_main_decoder.front();
-        RawBytes dummyPixelData;
-        try {
-            m_decoderWrapper_ptr->getDecoder()->loadFrame(firstVideoFrameTimestampNs, dummyPixelData, firstFrameMetaForPB);
+        if (preparedClip && !preparedClip->firstFrameMetadata.is_null()) {
+            firstFrameMetaForPB = std::move(preparedClip->firstFrameMetadata);
         }
-        catch (const std::exception& e) {
-            LogToFile(std::string("[App::loadFileAtIndex] Error loading first frame metadata for PB (main decoder): ") + e.what());
-            firstFrameMetaForPB["timestamp"] = firstVideoFrameTimestampNs;
+        else {
+            try {
+                firstFrameMetaForPB = m_decoderWrapper_ptr->readFrameMetadata(firstVideoFrameTimestampNs);
+            }
+            catch (const std::exception& e) {
+                LogToFile(std::string("[App::loadFileAtIndex] Error loading first frame metadata for PB (main decoder): ") + e.what());
+                firstFrameMetaForPB["timestamp"] = firstVideoFrameTimestampNs;
+            }
         }
     }
     else {
         LogToFile("[App::loadFileAtIndex] No frames in main decoder for PB::processNewSegment, passing empty meta.");
     }
     m_playbackController_ptr->processNewSegment(firstFrameMetaForPB, video_frames_from_main_decoder.size(), m_playbackStartTime);
+    m_playbackController_ptr->setFrameDurationNs(DisplaySchedule::frameIntervalNs(video_frames_from_main_decoder));
     LogToFile("[App::loadFileAtIndex] PlaybackController processed new segment.");
 
+    // Workers are joined and the device is idle here, so the ring can be resized safely.
+    try {
+        ensureStagingRingForClip(firstFrameMetaForPB.value("width", 0), firstFrameMetaForPB.value("height", 0));
+    }
+    catch (const std::exception& e) {
+        LogToFile(std::string("[App::loadFileAtIndex] ERROR sizing staging ring: ") + e.what() + ". Frames will not be uploaded.");
+    }
+
+    std::shared_ptr<motioncam::Decoder> proxyDecoder = openProxyForClip(newFilePath);
+    resetProxyPlayback(newFilePath, proxyDecoder != nullptr);
+
     {
         std::lock_guard<std::mutex> lock(m_ioThreadFileMutex);
         m_ioThreadCurrentFilePath = newFilePath;
+        m_ioThreadDecoder = m_decoderWrapper->shareDecoder();
+        m_ioThreadPrerollFrames = preparedClip ? preparedClip->prerollPackets.size() : 0;
+        m_ioThreadProxyDecoder = std::move(proxyDecoder);
+        m_ioThreadProxyChanged.store(true, std::memory_order_release);
         m_activeFileLoadID.store(new_load_id, std::memory_order_release);
         m_ioThreadFileChanged.store(true, std::memory_order_release);
         std::ostringstream log_oss_io_signal;
@@ -483,10 +527,21 @@ void App::loadFileAtIndex(int index) {
     m_threadsShouldStop.store(false, std::memory_order_release);
     m_decodeQueue.resume_operations();
     m_gpuUploadQueue.resume_operations();
+    if (preparedClip) {
+        // Queued ahead of the IO thread, which starts reading after them.
+        for (CompressedFramePacket& packet : preparedClip->prerollPackets) {
+            packet.fileLoadID = new_load_id;
+            m_decodeQueue.push(std::move(packet));
+        }
+        m_holdPresentUntil = std::chrono::steady_clock::now() + std::chrono::milliseconds(kGaplessHoldMaxMs);
+    }
+    else {
+        m_holdPresentUntil.reset();
+    }
     launchWorkerThreads();
 
     if (m_decoderWrapper_ptr && m_decoderWrapper_ptr->getDecoder() && m_audio) {
-        auto* audio_loader_ref_ptr = m_decoderWrapper_ptr->makeFreshAudioLoader();
+        auto* audio_loader_ref_ptr = (preparedClip && preparedClip->audioLoader) ? preparedClip->audioLoader : m_decoderWrapper_ptr->makeFreshAudioLoader();
         if (audio_loader_ref_ptr) {
             LogToFile(std::string("[App::loadFileAtIndex] -> AudioController::reset for '") + fs::path(newFilePath).filename().string() + "' with firstVideoFrameTsNs: " + std::to_string(firstVideoFrameTimestampNs));
             m_audio->setForceMute(false);
@@ -511,6 +566,10 @@ void App::loadFileAtIndex(int index) {
 
     m_ioThreadFileCv.notify_all();
 
+    if (m_clipAnalyzer && m_decoderWrapper_ptr) {
+        m_clipAnalyzer->analyze(newFilePath, m_decoderWrapper_ptr->shareDecoder());
+    }
+
     auto functionEndTime = std::chrono::high_resolution_clock::now();
     LogToFile(std::string("App::loadFileAtIndex Total execution time: ") + std::to_string(std::chrono::duration<double, std::milli>(functionEndTime - functionStartTime).count()) + " ms");
     LogToFile(std::string("[App::loadFileAtIndex] File loading setup complete for: '") + fs::path(newFilePath).filename().string() + "' with LoadID: " + std::to_string(new_load_id));
@@ -530,24 +589,19 @@ void App::performSeek(size_t new_frame_index) {
     }
 
     size_t current_load_id_on_entry = m_activeFileLoadID.load(std::memory_order_acquire);
-    LogToFile(std::string("[App::performSeek] START. TargetIdx: ") + std::to_string(new_frame_index) +
+    LOG_DEBUG(std::string("[App::performSeek] START. TargetIdx: ") + std::to_string(new_frame_index) +
         ", CurrentFileLoadID (before update): " + std::to_string(current_load_id_on_entry) +
         ". Current PB paused state: " + (m_playbackController_ptr->isPaused() ? "Paused" : "Playing"));
 
     m_playbackController_ptr->seekToFrame(new_frame_index, media_timestamps);
-    LogToFile(std::string("[App::performSeek] PB seekToFrame done. New PB WallClockAnchor: ") + std::to_string(m_playbackController_ptr->getWallClockAnchorForSegment().time_since_epoch().count()));
+    m_adaptiveQuality.restartWindow(); // The frames shown across a seek say nothing about load
+    LOG_DEBUG(std::string("[App::performSeek] PB seekToFrame done. New PB WallClockAnchor: ") + std::to_string(m_playbackController_ptr->getWallClockAnchorForSegment().time_since_epoch().count()));
 
-    LogToFile("[App::performSeek] Flushing queues and resetting packet state after PB update.");
+    LOG_DEBUG("[App::performSeek] Flushing queues and resetting packet state after PB update.");
     m_gpuUploadQueue.stop_operations(); m_gpuUploadQueue.clear(); m_gpuUploadQueue.resume_operations();
     m_decodeQueue.stop_operations(); m_decodeQueue.clear(); m_decodeQueue.resume_operations();
 
-    m_availableStagingBufferIndices.stop_operations();
-    m_availableStagingBufferIndices.clear();
-    m_availableStagingBufferIndices.resume_operations();
-    for (size_t i = 0; i < kNumPersistentStagingBuffers; ++i) {
-        m_availableStagingBufferIndices.push(i);
-    }
-    std::fill(m_inFlightStagingBufferIndices.begin(), m_inFlightStagingBufferIndices.end(), std::nullopt);
+    resetStagingState();
     m_hasLastSuccessfullyUploadedPacket.store(false, std::memory_order_release);
 
     size_t new_seek_load_id = m_fileLoadIDGenerator.fetch_add(1, std::memory_order_relaxed) + 1;
@@ -555,7 +609,7 @@ void App::performSeek(size_t new_frame_index) {
     {
         std::lock_guard<std::mutex> lock(m_ioThreadFileMutex);
         m_activeFileLoadID.store(new_seek_load_id, std::memory_order_release);
-        LogToFile(std::string("[App::performSeek] New ActiveFileLoadID for seek: ") + std::to_string(new_seek_load_id));
+        LOG_DEBUG(std::string("[App::performSeek] New ActiveFileLoadID for seek: ") + std::to_string(new_seek_load_id));
         m_ioThreadFileChanged.store(true, std::memory_order_release);
     }
     m_ioThreadFileCv.notify_all();
@@ -566,30 +620,30 @@ void App::performSeek(size_t new_frame_index) {
             // For seek, the audio anchor should be the timestamp of the *new current frame*.
             std::optional<int64_t> currentFrameMediaTsOpt = m_playbackController_ptr->getCurrentFrameMediaTimestamp(media_timestamps);
             if (currentFrameMediaTsOpt.has_value()) {
-                LogToFile(std::string("[App::performSeek] -> AudioController::reset with new current video frame TS: ") + std::to_string(currentFrameMediaTsOpt.value()));
+                LOG_DEBUG(std::string("[App::performSeek] -> AudioController::reset with new current video frame TS: ") + std::to_string(currentFrameMediaTsOpt.value()));
                 m_audio->reset(freshAudioLoader, currentFrameMediaTsOpt.value());
             }
             else {
                 // Fallback if somehow the current frame TS isn't available (should not happen if media_timestamps is not empty and new_frame_index is valid)
                 std::optional<int64_t> firstFrameMediaTsOpt = m_playbackController_ptr->getFirstFrameMediaTimestampOfSegment();
-                LogToFile("[App::performSeek] WARNING: currentFrameMediaTsOpt was null during seek for audio reset. Falling back to segment's first frame TS or 0.");
+                LOG_WARN("[App::performSeek] WARNING: currentFrameMediaTsOpt was null during seek for audio reset. Falling back to segment's first frame TS or 0.");
                 m_audio->reset(freshAudioLoader, firstFrameMediaTsOpt.value_or(0));
             }
             if (m_playbackController_ptr) {
                 m_audio->setPaused(m_playbackController_ptr->isPaused());
-                LogToFile(std::string("[App::performSeek] Audio pause state synced to PB: ") + (m_playbackController_ptr->isPaused() ? "Paused" : "Playing"));
+                LOG_DEBUG(std::string("[App::performSeek] Audio pause state synced to PB: ") + (m_playbackController_ptr->isPaused() ? "Paused" : "Playing"));
             }
         }
         else {
             LogToFile("[App::performSeek] Failed to get fresh audio loader for audio reset during seek.");
         }
     }
-    LogToFile(std::string("[App::performSeek] Seek processing complete. Current PB state (paused?): ") + (m_playbackController_ptr->isPaused() ? "Yes" : "No"));
+    LOG_DEBUG(std::string("[App::performSeek] Seek processing complete. Current PB state (paused?): ") + (m_playbackController_ptr->isPaused() ? "Yes" : "No"));
 }
 
 void App::recordPauseTime() {
     m_pauseBegan = std::chrono::steady_clock::now();
-    LogToFile(std::string("[App::recordPauseTime] Playback paused. Storing pause time. m_pauseBegan epoch ns: ") + std::to_string(m_pauseBegan.time_since_epoch().count()));
+    LOG_DEBUG(std::string("[App::recordPauseTime] Playback paused. Storing pause time. m_pauseBegan epoch ns: ") + std::to_string(m_pauseBegan.time_since_epoch().count()));
 }
 
 void App::anchorPlaybackTimeForResume() {
@@ -666,7 +720,7 @@ void App::anchorPlaybackTimeForResume() {
             log_stream << " | No decoder/frames & m_pauseBegan not set. Using current time as anchor.";
         }
     }
-    LogToFile(log_stream.str());
+    LOG_DEBUG(log_stream.str());
 
     m_playbackStartTime = new_wall_clock_anchor;
     m_playbackController_ptr->setWallClockAnchorForSegment(m_playbackStartTime);
@@ -676,14 +730,14 @@ void App::anchorPlaybackTimeForResume() {
         if (freshAudioLoader) {
             // currentFrameMediaTsOpt was populated above if has_decoder_and_frames was true
             if (currentFrameMediaTsOpt.has_value()) {
-                LogToFile(std::string("[App::anchorPlaybackTimeForResume] -> AudioController::reset with CURRENT (paused) video frame TS: ") + std::to_string(currentFrameMediaTsOpt.value()));
+                LOG_DEBUG(std::string("[App::anchorPlaybackTimeForResume] -> AudioController::reset with CURRENT (paused) video frame TS: ") + std::to_string(currentFrameMediaTsOpt.value()));
                 m_audio->reset(freshAudioLoader, currentFrameMediaTsOpt.value());
             }
             else {
                 // Fallback if currentFrameMediaTsOpt is not available 
                 // (e.g. no frames loaded yet, or some error in getting the current frame's TS)
                 // In this case, firstFrameMediaTsOpt (which is the segment's start) is the best guess.
-                LogToFile("[App::anchorPlaybackTimeForResume] WARNING: currentFrameMediaTsOpt was null for audio reset on resume. Falling back to segment's first frame TS or 0.");
+                LOG_WARN("[App::anchorPlaybackTimeForResume] WARNING: currentFrameMediaTsOpt was null for audio reset on resume. Falling back to segment's first frame TS or 0.");
                 m_audio->reset(freshAudioLoader, firstFrameMediaTsOpt.value_or(0));
             }
             if (m_playbackController_ptr) {
@@ -703,6 +757,11 @@ void App::softDeleteCurrentFile() {
         return;
     }
 
+    if (motioncam::isRemoteLocation(m_fileList[m_currentFileIndex])) {
+        LogToFile("[App::softDeleteCurrentFile] Remote clips cannot be deleted: " + m_fileList[m_currentFileIndex]);
+        return;
+    }
+
     fs::path currentFilePathFs = m_fileList[m_currentFileIndex];
     LogToFile(std::string("[App::softDeleteCurrentFile] Attempting to soft delete: ") + currentFilePathFs.string());
 
@@ -724,18 +783,14 @@ void App::softDeleteCurrentFile() {
     m_decodeQueue.stop_operations(); m_decodeQueue.clear(); m_decodeQueue.resume_operations();
     m_gpuUploadQueue.stop_operations(); m_gpuUploadQueue.clear(); m_gpuUploadQueue.resume_operations();
 
-    m_availableStagingBufferIndices.stop_operations();
-    m_availableStagingBufferIndices.clear();
-    m_availableStagingBufferIndices.resume_operations();
-    for (size_t i = 0; i < kNumPersistentStagingBuffers; ++i) {
-        m_availableStagingBufferIndices.push(i);
-    }
-    std::fill(m_inFlightStagingBufferIndices.begin(), m_inFlightStagingBufferIndices.end(), std::nullopt);
+    resetStagingState();
     m_hasLastSuccessfullyUploadedPacket.store(false, std::memory_order_release);
 
     m_decoderWrapper.reset();
     m_decoderWrapper_ptr = nullptr;
     if (m_audio) { m_audio->setForceMute(true); m_audio->reset(nullptr, 0); }
+    if (m_clipAnalyzer) m_clipAnalyzer->cancel(); // It holds a reference to the clip's decoder
+    if (m_proxyGenerator) m_proxyGenerator->cancel();
 
     fs::path folder = currentFilePathFs.parent_path();
     fs::path deletedFolder = folder / "_deleted_mcraw_files_";
@@ -762,6 +817,10 @@ void App::softDeleteCurrentFile() {
 
         fs::rename(currentFilePathFs, destinationPath);
         LogToFile(std::string("[App::softDeleteCurrentFile] Moved '") + currentFilePathFs.string() + "' to '" + destinationPath.string() + "'");
+        std::error_code proxyError; // The proxy is derived from the clip and written again on demand
+        if (fs::remove(motioncam::ProxyPath(currentFilePathFs.string()), proxyError)) {
+            LogToFile("[App::softDeleteCurrentFile] Removed the proxy of '" + currentFilePathFs.filename().string() + "'");
+        }
 #ifndef NDEBUG
         std::cout << "Moved " << currentFilePathFs.string() << " to " << destinationPath.string() << std::endl;
 #endif
@@ -809,11 +868,13 @@ void App::softDeleteCurrentFile() {
 
         LogToFile(std::string("[App::softDeleteCurrentFile] Rebuilding playlist from folder: ") + parent_folder_of_anchor.string());
         for (const auto& entry : fs::directory_iterator(parent_folder_of_anchor)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".mcraw") {
+            if (entry.is_regular_file() && entry.path().extension() == ".mcraw" &&
+                !motioncam::IsProxyPath(entry.path().string())) {
                 m_fileList.push_back(entry.path().string());
             }
         }
         std::sort(m_fileList.begin(), m_fileList.end());
+        if (m_clipIndexer) m_clipIndexer->enqueue(m_fileList);
 
         auto it = std::find(m_fileList.begin(), m_fileList.end(), anchorPathFs.string());
         if (it != m_fileList.end()) {
@@ -865,17 +926,6 @@ void App::saveCurrentFrameAsDng() {
     }
 
     motioncam::Timestamp ts = frameTimestamps[frameIdxToSave];
-    RawBytes rawFrameDataBuffer;
-    nlohmann::json frameMetadata;
-
-    try {
-        m_decoderWrapper_ptr->getDecoder()->loadFrame(ts, rawFrameDataBuffer, frameMetadata);
-    }
-    catch (const std::exception& e) {
-        LogToFile(std::string("[App::saveCurrentFrameAsDng] Failed to load frame data for DNG export: ") + e.what());
-        return;
-    }
-
     const auto& containerMetadata = m_decoderWrapper_ptr->getContainerMetadata();
     char dngFilename[256];
     const std::string stem_str = currentMcrawPath.stem().string();
@@ -888,7 +938,7 @@ void App::saveCurrentFrameAsDng() {
     std::string errorMsg;
 
     LogToFile(std::string("[App::saveCurrentFrameAsDng] Attempting to save to ") + outputDngPath.string());
-    if (writeDngInternal(outputDngPath.string(), rawFrameDataBuffer, frameMetadata, containerMetadata, errorMsg)) {
+    if (exportFrameAsDng(*m_decoderWrapper_ptr->getDecoder(), ts, containerMetadata, outputDngPath.string(), errorMsg)) {
         LogToFile(std::string("[App::saveCurrentFrameAsDng] Successfully saved DNG: ") + outputDngPath.string());
     }
     else {
@@ -943,11 +993,7 @@ void App::convertCurrentFileToDngs() {
         glfwPollEvents();
 
         motioncam::Timestamp ts = frameTimestamps[i];
-        RawBytes rawFrameDataBuffer;
-        nlohmann::json frameMetadata;
         try {
-            m_decoderWrapper_ptr->getDecoder()->loadFrame(ts, rawFrameDataBuffer, frameMetadata);
-
             char dngFilename[256];
             const std::string stem_str_all = currentMcrawPath.stem().string();
             snprintf(dngFilename, sizeof(dngFilename), "%s_frame_%06zu_ts_%lld.dng",
@@ -957,7 +1003,7 @@ void App::convertCurrentFileToDngs() {
             fs::path outputDngPath = dngOutputDir / dngFilename;
             std::string errorMsg;
 
-            if (!writeDngInternal(outputDngPath.string(), rawFrameDataBuffer, frameMetadata, containerMetadata, errorMsg)) {
+            if (!exportFrameAsDng(*m_decoderWrapper_ptr->getDecoder(), ts, containerMetadata, outputDngPath.string(), errorMsg)) {
                 LogToFile(std::string("[App::convertCurrentFileToDngs] Failed DNG write for frame ") + std::to_string(i) + ": " + errorMsg);
                 failCount++;
             }
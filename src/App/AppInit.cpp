@@ -16,10 +16,16 @@
 #endif
 
 #include "Audio/AudioController.h"
+#include "Decoder/BandDecoder.h"
 #include "Decoder/DecoderWrapper.h"
 #include <motioncam/Decoder.hpp>
+#include <motioncam/Proxy.hpp>
 
 #include "Playback/PlaybackController.h"
+#include "Playback/ClipAnalyzer.h"
+#include "Playback/ClipIndexer.h"
+#include "Playback/ClipPreloader.h"
+#include "Playback/ProxyGenerator.h"
 #include "Graphics/Renderer_VK.h"
 #include "Utils/DebugLog.h"
 #include "Utils/RawFrameBuffer.h"
@@ -37,6 +43,10 @@
 #include <thread>
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <future>
+#include <utility>
+#include <cstring>
 #include <set>
 #include <atomic>
 #include <condition_variable>
@@ -44,6 +54,8 @@
 
 namespace fs = std::filesystem;
 
+extern std::string g_AppBasePath;
+
 #ifdef _WIN32
 namespace DebugLogHelper {
     std::string wstring_to_utf8(const std::wstring& wstr) {
@@ -146,52 +158,76 @@ App::App(const std::string& filePath) :
     std::cout << "App::App Constructor called for file: " << this->m_filePath << std::endl;
 #endif
 
-    LogToFile(std::string("App::App Effective kNumPersistentStagingBuffers: ") + std::to_string(kNumPersistentStagingBuffers));
     LogToFile(std::string("App::App GpuUploadQueueCapacity (static const): ") + std::to_string(GpuUploadQueueCapacity));
-    LogToFile(std::string("App::App Decode Queue OLD CALC (kNumPersistentStagingBuffers * DecodeQueueCapacityMultiplier): ") + std::to_string(kNumPersistentStagingBuffers * DecodeQueueCapacityMultiplier));
-    LogToFile(std::string("App::App Available Staging Indices OLD CALC (kNumPersistentStagingBuffers + Slack): ") + std::to_string(kNumPersistentStagingBuffers + AvailableStagingIndicesQueueSlack));
+    LogToFile(std::string("App::App Staging ring frames: min ") + std::to_string(kMinStagingRingFrames) + ", max " + std::to_string(kMaxStagingRingFrames));
 
     LogToFile(std::string("App::App GPU Upload Queue MaxSize (actual from queue): ") + std::to_string(m_gpuUploadQueue.get_max_size_debug()));
     LogToFile(std::string("App::App Decode Queue MaxSize (actual from queue): ") + std::to_string(m_decodeQueue.get_max_size_debug()));
-    LogToFile(std::string("App::App Available Staging Buffer Indices Queue MaxSize (actual from queue): ") + std::to_string(m_availableStagingBufferIndices.get_max_size_debug()));
 
 
-    if (!fs::exists(this->m_filePath)) {
-        LogToFile(std::string("App::App ERROR: File does not exist: ") + this->m_filePath);
-        throw std::runtime_error("App::App File does not exist: " + this->m_filePath);
+    if (motioncam::isRemoteLocation(this->m_filePath)) {
+        // Nothing to scan next to a URL; the playlist is just this clip
+        m_fileList.push_back(this->m_filePath);
+        m_currentFileIndex = 0;
     }
-    auto target = fs::absolute(this->m_filePath);
-    auto folder = target.parent_path();
-    for (const auto& e : fs::directory_iterator(folder)) {
-        if (e.is_regular_file() && e.path().extension() == ".mcraw") {
-            m_fileList.push_back(e.path().string());
+    else {
+        if (!fs::exists(this->m_filePath)) {
+            LogToFile(std::string("App::App ERROR: File does not exist: ") + this->m_filePath);
+            throw std::runtime_error("App::App File does not exist: " + this->m_filePath);
+        }
+        auto target = fs::absolute(this->m_filePath);
+        auto folder = target.parent_path();
+        for (const auto& e : fs::directory_iterator(folder)) {
+            if (e.is_regular_file() && e.path().extension() == ".mcraw" &&
+                !motioncam::IsProxyPath(e.path().string())) {
+                m_fileList.push_back(e.path().string());
+            }
+        }
+        if (!m_fileList.empty()) {
+            std::sort(m_fileList.begin(), m_fileList.end());
         }
-    }
-    if (!m_fileList.empty()) {
-        std::sort(m_fileList.begin(), m_fileList.end());
-    }
 
-    auto it = std::find(m_fileList.begin(), m_fileList.end(), target.string());
-    if (it == m_fileList.end()) {
-        LogToFile("App::App Initial file not found in directory scan, adding it to list: " + target.string());
-        m_fileList.push_back(target.string());
-        std::sort(m_fileList.begin(), m_fileList.end());
-        it = std::find(m_fileList.begin(), m_fileList.end(), target.string());
+        auto it = std::find(m_fileList.begin(), m_fileList.end(), target.string());
         if (it == m_fileList.end()) {
-            LogToFile(std::string("App::App ERROR: Catastrophic: Initial file still not in playlist after adding: ") + this->m_filePath);
-            throw std::runtime_error("App::App Catastrophic: Initial file not in playlist: " + this->m_filePath);
+            LogToFile("App::App Initial file not found in directory scan, adding it to list: " + target.string());
+            m_fileList.push_back(target.string());
+            std::sort(m_fileList.begin(), m_fileList.end());
+            it = std::find(m_fileList.begin(), m_fileList.end(), target.string());
+            if (it == m_fileList.end()) {
+                LogToFile(std::string("App::App ERROR: Catastrophic: Initial file still not in playlist after adding: ") + this->m_filePath);
+                throw std::runtime_error("App::App Catastrophic: Initial file not in playlist: " + this->m_filePath);
+            }
         }
+        m_currentFileIndex = static_cast<int>(std::distance(m_fileList.begin(), it));
     }
-    m_currentFileIndex = static_cast<int>(std::distance(m_fileList.begin(), it));
 
-    m_inFlightStagingBufferIndices.resize(MAX_FRAMES_IN_FLIGHT, std::nullopt);
+    m_inFlightStagingSpans.resize(MAX_FRAMES_IN_FLIGHT, std::nullopt);
 
-    LogToFile(std::string("App::App Constructor section 1 finished. Current file index: ") + std::to_string(m_currentFileIndex) +
-        ". Persistent Staging Buffers planned: " + std::to_string(kNumPersistentStagingBuffers));
+    LogToFile(std::string("App::App Constructor section 1 finished. Current file index: ") + std::to_string(m_currentFileIndex));
+    m_startupTimer.mark("startup: playlist scan");
 
+    // Opening and indexing the first clip and reading its first frames need no GPU, so they
+    // run on the preloader's worker while Vulkan comes up; loadFileAtIndex() takes the result.
+    m_clipPreloader = std::make_unique<ClipPreloader>(std::min(kGaplessPrerollFrames, m_decodeQueue.get_max_size_debug()));
+    m_clipPreloader->request(m_fileList[m_currentFileIndex]);
+
+    // SDL audio device setup is independent of Vulkan too.
     m_audio = std::make_unique<AudioController>();
-    LogToFile("App::App constr AudioController created. Initializing audio...");
-    if (!m_audio->init()) {
+    LogToFile("App::App constr AudioController created. Initializing audio in the background...");
+    // The phase ends inside the task: get() returns only after initVulkan(), usually much later.
+    typedef std::pair<StartupTimer::Clock::time_point, StartupTimer::Clock::time_point> Span;
+    std::future<std::pair<bool, Span>> audioInit = std::async(std::launch::async, [this] {
+        const StartupTimer::Clock::time_point begin = StartupTimer::Clock::now();
+        const bool ok = m_audio->init();
+        return std::make_pair(ok, std::make_pair(begin, StartupTimer::Clock::now()));
+    });
+
+    LogToFile("App::App constr Initializing Vulkan...");
+    const bool vulkanReady = this->initVulkan();
+
+    const std::pair<bool, Span> audioResult = audioInit.get();
+    m_startupTimer.addConcurrent("startup: audio init", audioResult.second.first, audioResult.second.second);
+    if (!audioResult.first) {
         LogToFile("App::App constr ERROR: Failed to initialize audio!");
         std::cerr << "App::App constr Failed to initialize audio!" << std::endl;
     }
@@ -199,8 +235,7 @@ App::App(const std::string& filePath) :
         LogToFile("App::App constr Audio initialized.");
     }
 
-    LogToFile("App::App constr Initializing Vulkan...");
-    if (!this->initVulkan()) {
+    if (!vulkanReady) {
         LogToFile("App::App constr ERROR: initVulkan() failed. Aborting constructor.");
         throw std::runtime_error("Vulkan initialization failed in App constructor.");
     }
@@ -212,30 +247,67 @@ App::App(const std::string& filePath) :
     }
 
     LogToFile("App::App constr Creating Renderer_VK...");
-    m_rendererVk = std::make_unique<Renderer_VK>(m_physicalDevice, m_device, m_vmaAllocator, m_graphicsQueue, m_commandPool);
+    m_rendererVk = std::make_unique<Renderer_VK>(m_physicalDevice, m_device, m_vmaAllocator, m_graphicsQueue, m_commandPool, m_pipelineCache.handle());
     if (!m_rendererVk->init(m_renderPass, static_cast<uint32_t>(m_swapChainImages.size()))) {
         LogToFile("App::App constr ERROR: Failed to initialize Renderer_VK. Aborting constructor.");
         throw std::runtime_error("Failed to initialize Renderer_VK in App constructor.");
     }
     LogToFile("App::App constr Renderer_VK initialized.");
+    m_startupTimer.mark("startup: renderer + pipelines");
+
+    // Opt-in: decode type 7 payloads on the GPU instead of the decode thread.
+    if (const char* env = std::getenv("MOTIONCAM_GPU_DECODE")) {
+        if (std::strcmp(env, "1") == 0 && m_rendererVk->supportsGpuRawDecode()) {
+            m_gpuRawDecodeEnabled = true;
+            LogToFile("App::App constr GPU decoding of type 7 payloads enabled.");
+        }
+        else {
+            LogToFile(std::string("App::App constr MOTIONCAM_GPU_DECODE='") + env + "' ignored" + (m_rendererVk->supportsGpuRawDecode() ? "." : ": not supported by this device."));
+        }
+    }
+
+    if (m_transferQueue != VK_NULL_HANDLE) {
+        m_transferUploader = std::make_unique<TransferUploader>();
+        if (!m_transferUploader->init(m_device, m_vmaAllocator, m_transferQueue, m_transferQueueFamily, m_graphicsQueue, m_graphicsQueueFamily, m_commandPool)) {
+            LogToFile("App::App constr TransferUploader unavailable. Uploads stay on the graphics queue.");
+            m_transferUploader.reset();
+        }
+    }
 
     LogToFile("App::App constr Initializing ImGui Vulkan...");
     this->initImGuiVulkan();
     LogToFile("App::App constr ImGui Vulkan initialized.");
+    m_startupTimer.mark("startup: ImGui");
 
     m_playbackController = std::make_unique<PlaybackController>();
     m_playbackController_ptr = m_playbackController.get();
     LogToFile("App::App constr PlaybackController created.");
 
+    if (!m_thumbnailAtlas.init(m_device, m_vmaAllocator, MAX_FRAMES_IN_FLIGHT)) {
+        LogToFile("App::App constr Thumbnail atlas unavailable. The playlist shows no thumbnails.");
+    }
+    const std::string scopesShaderPath = (fs::path(g_AppBasePath) / "shaders_spv" / "scopes.comp.spv").string();
+    if (!m_scopes.init(m_physicalDevice, m_device, m_vmaAllocator, m_graphicsQueueFamily, MAX_FRAMES_IN_FLIGHT,
+        scopesShaderPath, m_pipelineCache.handle())) {
+        LogToFile("App::App constr Scopes unavailable.");
+    }
+    m_clipIndexer = std::make_unique<ClipIndexer>((fs::path(g_AppBasePath) / ClipIndexer::kCacheFileName).string());
+    m_clipIndexer->enqueue(m_fileList);
+    m_clipAnalyzer = std::make_unique<ClipAnalyzer>((fs::path(g_AppBasePath) / ClipAnalyzer::kCacheFileName).string());
+    m_proxyGenerator = std::make_unique<ProxyGenerator>();
+    m_bandDecoder = std::make_unique<BandDecoder>();
+    LogToFile("App::App constr Parallel decode uses " + std::to_string(m_bandDecoder->bandCount()) + " bands.");
+
     LogToFile("App::App constr Loading initial file...");
     this->loadFileAtIndex(m_currentFileIndex);
     m_firstFileLoaded = true;
     LogToFile("App::App constr Initial file load process initiated.");
+    m_startupTimer.mark("startup: first clip load");
     LogToFile(std::string("App::App Constructor fully finished. Current file index: ") + std::to_string(m_currentFileIndex));
 
 #ifndef NDEBUG
     std::cout << "App::App Constructor finished. Current file index: " << m_currentFileIndex
-        << ". Staging Buffers: " << kNumPersistentStagingBuffers << std::endl;
+        << ". Staging ring frames: " << m_stagingRingFrames << std::endl;
 #endif
 }
 
@@ -278,6 +350,7 @@ bool App::initVulkan() {
         return false;
     }
     LogToFile("App::initVulkan GLFW window created.");
+    m_startupTimer.mark("startup: window");
     glfwSetWindowUserPointer(m_window, this);
     glfwSetFramebufferSizeCallback(m_window, framebuffer_size_callback_static);
     glfwSetKeyCallback(m_window, key_callback_static);
@@ -324,6 +397,10 @@ bool App::initVulkan() {
         createSurface();
         pickPhysicalDevice();
         createLogicalDevice();
+        m_startupTimer.mark("startup: instance + device");
+        if (!m_pipelineCache.init(m_physicalDevice, m_device, (fs::path(g_AppBasePath) / PipelineCache::kFileName).string())) {
+            LogToFile("App::initVulkan Pipeline cache unavailable. Pipelines are compiled without one.");
+        }
         createSwapChain();
         createImageViews();
         createRenderPass();
@@ -331,13 +408,13 @@ bool App::initVulkan() {
         createFramebuffers();
         createCommandBuffers();
         createSyncObjects();
-        createPersistentStagingBuffers();
     }
     catch (const std::exception& e) {
         LogToFile(std::string("App::initVulkan ERROR: Vulkan initialization failed during setup: ") + e.what());
         return false;
     }
     LogToFile("App::initVulkan Vulkan core initialization complete.");
+    m_startupTimer.mark("startup: swapchain + sync");
     return true;
 }
 
@@ -487,16 +564,20 @@ App::QueueFamilyIndices App::findQueueFamilies(VkPhysicalDevice queryDevice) {
     vkGetPhysicalDeviceQueueFamilyProperties(queryDevice, &queueFamilyCount, queueFamilies.data());
     int i = 0;
     for (const auto& queueFamily : queueFamilies) {
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        // The demosaic compute pass is recorded into the graphics command buffers.
+        if (!indices.graphicsFamily.has_value() && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)) {
             indices.graphicsFamily = i;
         }
         VkBool32 presentSupport = false;
         vkGetPhysicalDeviceSurfaceSupportKHR(queryDevice, i, m_surface, &presentSupport);
-        if (presentSupport) {
+        if (!indices.presentFamily.has_value() && presentSupport) {
             indices.presentFamily = i;
         }
-        if (indices.isComplete()) {
-            break;
+        // Prefer a transfer-only family (DMA engine) over one that merely lacks graphics.
+        const bool transferOnly = (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+        const bool transferNoGraphics = (queueFamily.queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT)) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+        if (transferOnly || (transferNoGraphics && !indices.transferFamily.has_value())) {
+            indices.transferFamily = i;
         }
         i++;
     }
@@ -518,16 +599,57 @@ void App::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures{};
+    vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // The demosaic pass picks its raw image (m_rawImage or a transfer slot) by push constant.
+    // Without the feature, Pipeline::createComputePipeline specialises it to m_rawImage only.
+    deviceFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
+    // GPU decoding writes m_rawImage as an r16ui storage image (see GpuRawDecoder::isSupported).
+    deviceFeatures.shaderStorageImageExtendedFormats = supportedFeatures.shaderStorageImageExtendedFormats;
+
+    // Asynchronous uploads need a separate transfer family and timeline semaphores
+    // (VK_KHR_timeline_semaphore on our 1.1 baseline); otherwise drawFrame records the copy.
+    std::vector<const char*> deviceExtensions = g_deviceExtensions_AppInit;
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR };
+    m_timelineSemaphoresEnabled = false;
+    // The decode thread submits to this queue unsynchronised, so it must not be the present queue.
+    const bool separateTransferQueue = indices.transferFamily.has_value() && indices.transferFamily != indices.presentFamily;
+    if (separateTransferQueue && supportedFeatures.shaderSampledImageArrayDynamicIndexing) {
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+        const bool hasTimelineExtension = std::any_of(availableExtensions.begin(), availableExtensions.end(),
+            [](const VkExtensionProperties& e) { return std::string(e.extensionName) == VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME; });
+
+        if (hasTimelineExtension) {
+            VkPhysicalDeviceFeatures2 features2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features2.pNext = &timelineFeatures;
+            vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+            m_timelineSemaphoresEnabled = timelineFeatures.timelineSemaphore == VK_TRUE;
+        }
+    }
+    timelineFeatures.pNext = nullptr;
+    if (m_timelineSemaphoresEnabled) {
+        deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+        VkDeviceQueueCreateInfo queueCreateInfo{};
+        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueCreateInfo.queueFamilyIndex = indices.transferFamily.value();
+        queueCreateInfo.queueCount = 1;
+        queueCreateInfo.pQueuePriorities = &queuePriority;
+        queueCreateInfos.push_back(queueCreateInfo);
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = m_timelineSemaphoresEnabled ? &timelineFeatures : nullptr;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(g_deviceExtensions_AppInit.size());
-    createInfo.ppEnabledExtensionNames = g_deviceExtensions_AppInit.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
     if (enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(g_validationLayers_AppInit.size());
@@ -539,6 +661,16 @@ void App::createLogicalDevice() {
     VK_APP_CHECK(vkCreateDevice(m_physicalDevice, &createInfo, nullptr, &m_device));
     vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
     vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+    m_graphicsQueueFamily = indices.graphicsFamily.value();
+    m_transferQueue = VK_NULL_HANDLE;
+    if (m_timelineSemaphoresEnabled) {
+        m_transferQueueFamily = indices.transferFamily.value();
+        vkGetDeviceQueue(m_device, m_transferQueueFamily, 0, &m_transferQueue);
+        LogToFile("App::createLogicalDevice Transfer queue from family " + std::to_string(m_transferQueueFamily) + " with timeline semaphores.");
+    }
+    else {
+        LogToFile(std::string("App::createLogicalDevice No separate transfer queue") + (separateTransferQueue ? " (timeline semaphores unsupported)" : "") + ". Uploads stay on the graphics queue.");
+    }
     LogToFile("App::createLogicalDevice Logical device created.");
 
     VmaAllocatorCreateInfo allocatorInfo = {};
@@ -831,72 +963,81 @@ void App::initImGuiVulkan() {
     LogToFile("App::initImGuiVulkan GuiOverlay::setup() called.");
 }
 
-void App::createPersistentStagingBuffers() {
-    LogToFile(std::string("App::createPersistentStagingBuffers Creating ") + std::to_string(kNumPersistentStagingBuffers) + " persistent staging buffers.");
-    m_persistentStagingBuffers.resize(kNumPersistentStagingBuffers);
-    m_persistentStagingBuffersMappedPtrs.resize(kNumPersistentStagingBuffers);
-    m_availableStagingBufferIndices.clear();
+/**
+ * Sizes the staging ring for the clip about to play. Depth is whatever fits in the
+ * staging budget (MOTIONCAM_STAGING_BUDGET_MB, else kDefaultStagingBudgetMiB), clamped
+ * to [kMinStagingRingFrames, kMaxStagingRingFrames]. Must be called with the worker
+ * threads joined and the device idle; the ring is only reallocated when its size changes.
+ */
+void App::ensureStagingRingForClip(int frameWidth, int frameHeight) {
+    if (frameWidth <= 0 || frameHeight <= 0 || m_vmaAllocator == VK_NULL_HANDLE) {
+        LogToFile(std::string("App::ensureStagingRingForClip Invalid dimensions ") + std::to_string(frameWidth) + "x" + std::to_string(frameHeight) + " or no allocator. Keeping current ring.");
+        return;
+    }
 
-    const uint32_t MAX_EXPECTED_WIDTH = 8192;
-    const uint32_t MAX_EXPECTED_HEIGHT = 4608;
-    VkDeviceSize bufferSize = static_cast<VkDeviceSize>(MAX_EXPECTED_WIDTH) * MAX_EXPECTED_HEIGHT * sizeof(uint16_t);
+    size_t budgetMiB = kDefaultStagingBudgetMiB;
+    if (const char* env = std::getenv("MOTIONCAM_STAGING_BUDGET_MB")) {
+        char* end = nullptr;
+        unsigned long long parsed = std::strtoull(env, &end, 10);
+        if (end != env && parsed > 0) {
+            budgetMiB = static_cast<size_t>(parsed);
+        }
+        else {
+            LogToFile(std::string("App::ensureStagingRingForClip Ignoring invalid MOTIONCAM_STAGING_BUDGET_MB: '") + env + "'");
+        }
+    }
 
-#ifndef NDEBUG
-    LogToFile(std::string("App::createPersistentStagingBuffers Staging buffer individual size: ") + std::to_string(bufferSize) +
-        " bytes (for max " + std::to_string(MAX_EXPECTED_WIDTH) + "x" + std::to_string(MAX_EXPECTED_HEIGHT) + " R16_UINT images).");
-#endif
+    const VkDeviceSize frameBytes = (static_cast<VkDeviceSize>(frameWidth) * frameHeight * sizeof(uint16_t) + StagingRing::kAlignment - 1) & ~(StagingRing::kAlignment - 1);
+    const VkDeviceSize budgetBytes = static_cast<VkDeviceSize>(budgetMiB) * 1024 * 1024;
+    size_t frames = static_cast<size_t>(budgetBytes / frameBytes);
+    frames = std::clamp(frames, kMinStagingRingFrames, kMaxStagingRingFrames);
 
-    if (kNumPersistentStagingBuffers == 0) {
-        LogToFile("App::createPersistentStagingBuffers kNumPersistentStagingBuffers is 0. No buffers will be created.");
+    if (m_stagingRing.buffer() != VK_NULL_HANDLE && frames == m_stagingRingFrames && frameBytes == m_stagingRingFrameBytes) {
+        ensureTransferSlotsForClip(frameWidth, frameHeight);
         return;
     }
 
-    for (size_t i = 0; i < kNumPersistentStagingBuffers; ++i) {
-        VkBufferCreateInfo bufferInfo{};
-        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferInfo.size = bufferSize;
-        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-        VmaAllocationCreateInfo allocInfo{};
-        allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
-        allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-            VMA_ALLOCATION_CREATE_MAPPED_BIT;
-
-        VmaAllocationInfo allocationDetails;
-        VkResult result = vmaCreateBuffer(m_vmaAllocator, &bufferInfo, &allocInfo,
-            &m_persistentStagingBuffers[i].buffer,
-            &m_persistentStagingBuffers[i].allocation,
-            &allocationDetails);
-        if (result != VK_SUCCESS) {
-            LogToFile(std::string("App::createPersistentStagingBuffers FAILED to create persistent staging buffer ") + std::to_string(i) + ". Error: " + std::to_string(result));
-            for (size_t k = 0; k < i; ++k) {
-                if (m_persistentStagingBuffers[k].buffer != VK_NULL_HANDLE) {
-                    vmaDestroyBuffer(m_vmaAllocator, m_persistentStagingBuffers[k].buffer, m_persistentStagingBuffers[k].allocation);
-                }
-            }
-            m_persistentStagingBuffers.clear();
-            m_persistentStagingBuffersMappedPtrs.clear();
-            throw std::runtime_error("Failed to create persistent staging buffer " + std::to_string(i));
-        }
+    m_stagingRingFrames = 0;
+    m_stagingRingFrameBytes = 0;
+    m_stagingRing.create(m_vmaAllocator, frameBytes * frames);
+    m_stagingRingFrames = frames;
+    m_stagingRingFrameBytes = static_cast<size_t>(frameBytes);
+    if (m_rendererVk) {
+        m_rendererVk->setRawSourceBuffer(m_stagingRing.buffer(), m_stagingRing.capacity(), m_stagingRing.isDeviceLocal());
+    }
+    ensureTransferSlotsForClip(frameWidth, frameHeight);
+    LogToFile(std::string("App::ensureStagingRingForClip Staging ring sized for ") + std::to_string(frameWidth) + "x" + std::to_string(frameHeight) +
+        ": " + std::to_string(frames) + " frames, " + std::to_string((frameBytes * frames) / (1024 * 1024)) + " MiB (budget " + std::to_string(budgetMiB) + " MiB).");
+}
 
-        m_persistentStagingBuffersMappedPtrs[i] = allocationDetails.pMappedData;
-        if (!m_persistentStagingBuffersMappedPtrs[i]) {
-            LogToFile(std::string("App::createPersistentStagingBuffers ERROR: Failed to map persistent staging buffer ") + std::to_string(i));
-            for (size_t k = 0; k <= i; ++k) {
-                if (m_persistentStagingBuffers[k].buffer != VK_NULL_HANDLE) {
-                    vmaDestroyBuffer(m_vmaAllocator, m_persistentStagingBuffers[k].buffer, m_persistentStagingBuffers[k].allocation);
-                }
-            }
-            m_persistentStagingBuffers.clear();
-            m_persistentStagingBuffersMappedPtrs.clear();
-            throw std::runtime_error("Failed to map persistent staging buffer (pMappedData is null) " + std::to_string(i));
-        }
-        m_availableStagingBufferIndices.push(i);
-#ifndef NDEBUG
-        LogToFile(std::string("App::createPersistentStagingBuffers Created and mapped buffer ") + std::to_string(i) + " with size " + std::to_string(bufferSize) + ". Mapped ptr: " + (allocationDetails.pMappedData ? "VALID" : "NULL"));
-#endif
+/// Sizes the transfer slots for the clip. Only used on the CopyToImage path: where the demosaic
+/// pass reads the staging ring in place there is nothing to copy ahead of time.
+void App::ensureTransferSlotsForClip(int frameWidth, int frameHeight) {
+    if (!m_transferUploader || !m_rendererVk) {
+        return;
+    }
+    const bool useTransferQueue = m_rendererVk->getRawUploadPath() == Renderer_VK::RawUploadPath::CopyToImage;
+    if (useTransferQueue && m_transferUploader->ensureSlotImages(static_cast<uint32_t>(frameWidth), static_cast<uint32_t>(frameHeight))) {
+        m_rendererVk->setTransferSlotViews(m_transferUploader->slotViews());
+    }
+    else {
+        m_rendererVk->setTransferSlotViews({});
+    }
+}
+
+/// Drops every staging span (queued, in flight or retained). Callers flush the queues first.
+void App::resetStagingState() {
+    m_stagingRing.reset();
+    if (m_transferUploader) {
+        m_transferUploader->reset();
+    }
+    std::fill(m_inFlightStagingSpans.begin(), m_inFlightStagingSpans.end(), std::nullopt);
+    m_retainedRawSource.reset();
+    m_deferredRawSourceReleases.clear();
+    m_pendingTransferReleases.clear();
+    if (m_rendererVk) {
+        m_rendererVk->invalidateRawSource();
     }
-    LogToFile("App::createPersistentStagingBuffers All persistent staging buffers created and mapped.");
 }
 
 void App::launchWorkerThreads() {
@@ -2,8 +2,10 @@
 #include "Audio/AudioController.h"
 #include "Decoder/DecoderWrapper.h"
 #include "Playback/PlaybackController.h"
+#include "Playback/ClipIndexer.h"
 #include "Graphics/Renderer_VK.h"
 #include "Utils/DebugLog.h"
+#include "Utils/FrameTrace.h"
 #include "Gui/GuiOverlay.h"
 
 #include <imgui.h>
@@ -87,6 +89,18 @@ void App::handleKey(int key, int mods) {
         LogToFile(std::string("[App::handleKey] Metrics Toggled: ") + (m_showMetrics ? "ON" : "OFF"));
         return;
     }
+    if (key == GLFW_KEY_S && mods == 0) {
+        m_showScopes = !m_showScopes;
+        LogToFile(std::string("[App::handleKey] Scopes Toggled: ") + (m_showScopes ? "ON" : "OFF"));
+        return;
+    }
+    if (key == GLFW_KEY_T && mods == 0) {
+        const std::string tracePath = FrameTrace::defaultTracePath();
+        if (FrameTrace::writeChromeTrace(tracePath)) {
+            LogToFile("[App::handleKey] T pressed. Frame trace written to " + tracePath);
+        }
+        return;
+    }
     if ((key == GLFW_KEY_H && mods == 0) || key == GLFW_KEY_F1) {
         toggleHelpPage();
         if (m_showHelpPage) GuiOverlay::show_playlist_aux = false;
@@ -204,23 +218,17 @@ void App::handleKey(int key, int mods) {
                         float pan_x = (static_cast<float>(winW) - static_cast<float>(imgW)) / 2.0f;
                         float pan_y = (static_cast<float>(winH) - static_cast<float>(imgH)) / 2.0f;
                         m_rendererVk->setPanOffsets(pan_x, pan_y);
-#ifndef NDEBUG
-                        LogToFile(std::string("[App::handleKey] Zoom ON. Centered pan: ") + std::to_string(pan_x) + ", " + std::to_string(pan_y));
-#endif
+                        LOG_DEBUG(std::string("[App::handleKey] Zoom ON. Centered pan: ") + std::to_string(pan_x) + ", " + std::to_string(pan_y));
                     }
                     else {
                         m_rendererVk->resetPanOffsets();
-#ifndef NDEBUG
-                        LogToFile("[App::handleKey] Zoom ON. No valid image dims, pan reset.");
-#endif
+                        LOG_DEBUG("[App::handleKey] Zoom ON. No valid image dims, pan reset.");
                     }
                 }
                 else {
                     m_rendererVk->resetPanOffsets();
                     if (m_isPanning) { m_isPanning = false; }
-#ifndef NDEBUG
-                    LogToFile("[App::handleKey] Zoom OFF. Pan reset.");
-#endif
+                    LOG_DEBUG("[App::handleKey] Zoom OFF. Pan reset.");
                 }
             }
         }
@@ -235,6 +243,13 @@ void App::handleKey(int key, int mods) {
         m_cfaOverride = key - GLFW_KEY_1;
         LogToFile(std::string("[App::handleKey] ") + std::to_string(key - GLFW_KEY_0) + " pressed. CFA override set to: " + std::to_string(m_cfaOverride.value()));
     }
+    else if (key == GLFW_KEY_D && mods == 0) {
+        keyHandledByAppLogic = true;
+        if (m_rendererVk) {
+            const bool useMhc = m_rendererVk->getDemosaicAlgorithm() != Renderer_VK::DemosaicAlgorithm::MalvarHeCutler;
+            m_rendererVk->setDemosaicAlgorithm(useMhc ? Renderer_VK::DemosaicAlgorithm::MalvarHeCutler : Renderer_VK::DemosaicAlgorithm::Bilinear);
+        }
+    }
     else if (key == GLFW_KEY_F || key == GLFW_KEY_F11) {
         keyHandledByAppLogic = true;
         LogToFile(std::string("[App::handleKey] F/F11 pressed. Toggling fullscreen. Was: ") + (m_isFullscreen ? "ON" : "OFF"));
@@ -335,6 +350,7 @@ void App::handleDrop(int count, const char** paths) {
     if (newFilesAddedToPlaylist) {
         std::sort(m_fileList.begin(), m_fileList.end());
         LogToFile("[App::handleDrop] New files added to playlist and sorted.");
+        if (m_clipIndexer) m_clipIndexer->enqueue(m_fileList);
     }
 
     if (!firstValidPathDropped.empty()) {
@@ -420,6 +436,7 @@ void App::triggerOpenFileViaDialog() {
         if (it_existing == m_fileList.end()) {
             m_fileList.push_back(newPath);
             std::sort(m_fileList.begin(), m_fileList.end());
+            if (m_clipIndexer) m_clipIndexer->enqueue({ newPath });
             it_existing = std::find(m_fileList.begin(), m_fileList.end(), newPath);
         }
         if (it_existing != m_fileList.end()) {
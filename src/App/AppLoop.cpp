@@ -3,10 +3,13 @@
 #include "Audio/AudioController.h"
 #include "Decoder/DecoderWrapper.h"
 #include "Playback/PlaybackController.h"
+#include "Playback/ClipPreloader.h"
 #include "Graphics/Renderer_VK.h"
 #include "Utils/DebugLog.h"
+#include "Utils/FrameTrace.h"
 #include "Gui/GuiOverlay.h"
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <iostream>
@@ -36,6 +39,7 @@ static constexpr std::size_t MAX_LAG_FRAMES = 16;
 bool App::run() {
     LogToFile("[App::run] App::run() called and initialized.");
     LogToFile("[App::run] Entering main loop...");
+    FrameTrace::setThreadName("Render");
 
     using namespace std::chrono_literals;
     using steady_clock = std::chrono::steady_clock;
@@ -68,6 +72,7 @@ bool App::run() {
                 currentFrameTimestamps ? *currentFrameTimestamps : std::vector<motioncam::Timestamp>()
             );
             if (paused) segment_looped_or_ended = false;
+            else prepareNextClipIfEnding();
         }
         appLogicEndTime = steady_clock::now();
         auto appLogicDuration = std::chrono::duration<double, std::milli>(appLogicEndTime - appLogicStartTime);
@@ -75,6 +80,8 @@ bool App::run() {
 
 
         drawFrame();
+        updateAdaptiveQuality();
+        updateProxyPlayback();
 
 
         appLogicStartTime = steady_clock::now();
@@ -85,11 +92,17 @@ bool App::run() {
                 current_time_for_audio - wall_anchor
             ).count();
             // --- START: Detailed Logging for Audio Update Trigger ---
-            LogToFile(std::string("[App::run -> AudioUpdate] WallAnchorEpochNs (Playback): ") + std::to_string(wall_anchor.time_since_epoch().count()) +
+            LOG_TRACE(std::string("[App::run -> AudioUpdate] WallAnchorEpochNs (Playback): ") + std::to_string(wall_anchor.time_since_epoch().count()) +
                 ", CurrentTimeEpochNs: " + std::to_string(current_time_for_audio.time_since_epoch().count()) +
                 ", Passed ElapsedNsForAudio: " + std::to_string(elapsed_ns_since_segment_start));
             // --- END: Detailed Logging for Audio Update Trigger ---
             m_audio->updatePlayback(elapsed_ns_since_segment_start);
+            m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::AudioQueue, current_time_for_audio, steady_clock::now());
+            const uint64_t underruns = m_audio->underrunCount();
+            if (underruns > m_audioUnderrunsSeen) {
+                m_pipelineMetrics.increment(PipelineMetrics::Counter::AudioUnderruns, underruns - m_audioUnderrunsSeen);
+            }
+            m_audioUnderrunsSeen = underruns;
         }
         appLogicEndTime = steady_clock::now();
         double audioUpdateTimeMs = std::chrono::duration<double, std::milli>(appLogicEndTime - appLogicStartTime).count();
@@ -110,10 +123,8 @@ bool App::run() {
                     const auto& frames = m_decoderWrapper->getDecoder()->getFrames();
                     if (!frames.empty()) {
                         nlohmann::json firstFrameMetaForPB;
-                        RawBytes dummyPixelData; // Not used for metadata parsing here
                         try {
-                            // This call to loadFrame is just to get metadata, not actual pixels
-                            m_decoderWrapper->getDecoder()->loadFrame(frames.front(), dummyPixelData, firstFrameMetaForPB);
+                            firstFrameMetaForPB = m_decoderWrapper->readFrameMetadata(frames.front());
                         }
                         catch (const std::exception& e) {
                             LogToFile(std::string("[App::run] Error loading first frame metadata for loop reset (main decoder): ") + e.what());
@@ -211,24 +222,102 @@ void App::drawFrame() {
     using steady_clock = std::chrono::steady_clock;
     steady_clock::time_point timePoint_A, timePoint_B;
 
+    // Nothing of the new clip is decoded yet: skip this frame so the previous clip's last frame stays up.
+    if (m_holdPresentUntil.has_value()) {
+        if (m_gpuUploadQueue.size() == 0 && steady_clock::now() < m_holdPresentUntil.value()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return;
+        }
+        m_holdPresentUntil.reset();
+    }
+
     timePoint_A = steady_clock::now();
     VK_APP_CHECK(vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX));
     timePoint_B = steady_clock::now();
     m_gpuWaitTimeMs = std::chrono::duration<double, std::milli>(timePoint_B - timePoint_A).count();
+    FrameTrace::recordSpan("fence wait", timePoint_A, timePoint_B);
+    m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::FenceWait, timePoint_A, timePoint_B);
+
+    m_pipelineMetrics.sampleQueueDepth(PipelineMetrics::Queue::Decode, m_decodeQueue.size());
+    m_pipelineMetrics.sampleQueueDepth(PipelineMetrics::Queue::GpuUpload, m_gpuUploadQueue.size());
+    m_pipelineMetrics.sampleQueueDepth(PipelineMetrics::Queue::StagingSpans, m_stagingRing.liveSpanCount());
+    if (m_transferUploader) {
+        m_pipelineMetrics.sampleQueueDepth(PipelineMetrics::Queue::TransferSlots, m_transferUploader->busySlotCount());
+    }
 
 
+    const size_t currentActiveFileLoadID = m_activeFileLoadID;
     auto recycleStagingBufferLambda = [&](const GpuUploadPacket& packet) {
-        m_availableStagingBufferIndices.push(packet.stagingBufferIndex);
+        if (packet.fileLoadID != currentActiveFileLoadID) {
+            FrameTrace::recordInstant("stale drop", static_cast<int64_t>(packet.frameIndex), packet.fileLoadID);
+            m_pipelineMetrics.increment(PipelineMetrics::Counter::FramesDroppedStale);
+        }
+        else {
+            FrameTrace::recordInstant("late drop", static_cast<int64_t>(packet.frameIndex), packet.fileLoadID);
+            m_pipelineMetrics.increment(PipelineMetrics::Counter::FramesDroppedLate);
+        }
+        if (packet.transfer.has_value()) {
+            // The transfer queue may still be reading the span; both go back once the copy is done.
+            m_pendingTransferReleases.push_back({ packet.staging, packet.transfer });
+        }
+        else {
+            m_stagingRing.release(packet.staging);
+        }
         };
+    // Transfer uploads are consumed strictly in completion order; an unfinished one is left queued.
+    auto uploadCompletedLambda = [&](const GpuUploadPacket& packet) {
+        return !packet.transfer.has_value() || (m_transferUploader && m_transferUploader->isComplete(packet.transfer->value));
+        };
+
+    if (m_inFlightStagingSpans[m_currentFrame].has_value()) {
+        m_stagingRing.release(m_inFlightStagingSpans[m_currentFrame].value());
+        m_inFlightStagingSpans[m_currentFrame] = std::nullopt;
+    }
 
-    if (m_inFlightStagingBufferIndices[m_currentFrame].has_value()) {
-        size_t recycled_idx = m_inFlightStagingBufferIndices[m_currentFrame].value();
-        m_availableStagingBufferIndices.push(recycled_idx);
-        m_inFlightStagingBufferIndices[m_currentFrame] = std::nullopt;
+    // m_frameSerial counts submissions; this slot's fence covered submission frameSerial - MAX_FRAMES_IN_FLIGHT,
+    // and every earlier one was waited on when its own slot came round.
+    const uint64_t frameSerial = m_frameSerial;
+    while (!m_deferredRawSourceReleases.empty() && m_deferredRawSourceReleases.front().first + MAX_FRAMES_IN_FLIGHT <= frameSerial) {
+        releaseRawSourceHold(m_deferredRawSourceReleases.front().second);
+        m_deferredRawSourceReleases.pop_front();
     }
+    if (m_transferUploader && !m_pendingTransferReleases.empty()) {
+        auto firstPending = std::remove_if(m_pendingTransferReleases.begin(), m_pendingTransferReleases.end(), [&](const RawSourceHold& hold) {
+            if (!m_transferUploader->isComplete(hold.transfer->value)) return false;
+            releaseRawSourceHold(hold);
+            return true;
+            });
+        m_pendingTransferReleases.erase(firstPending, m_pendingTransferReleases.end());
+    }
+
+    // The copy path and GPU decoding are done with a span once this frame retires. The in-place
+    // path keeps reading the span, and a transfer upload its slot, until a newer frame replaces it.
+    const bool readsStagingInPlace = m_rendererVk && m_rendererVk->getRawUploadPath() == Renderer_VK::RawUploadPath::StorageBuffer;
+    auto holdStagingForUploadLambda = [&](const GpuUploadPacket& packet) {
+        RawSourceHold hold;
+        if (packet.transfer.has_value()) {
+            m_stagingRing.release(packet.staging); // Copy already completed on the transfer queue
+            hold.transfer = packet.transfer;
+        }
+        else if (readsStagingInPlace && !packet.gpuDecode.has_value()) {
+            hold.staging = packet.staging;
+        }
+        else {
+            m_inFlightStagingSpans[m_currentFrame] = packet.staging;
+        }
+        if (m_retainedRawSource.has_value()) {
+            m_deferredRawSourceReleases.emplace_back(frameSerial, m_retainedRawSource.value());
+            m_retainedRawSource.reset();
+        }
+        if (hold.staging.has_value() || hold.transfer.has_value()) {
+            m_retainedRawSource = hold;
+        }
+        };
 
     uint32_t imageIndex;
+    timePoint_A = steady_clock::now();
     VkResult result = vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &imageIndex);
+    FrameTrace::recordSpan("acquire image", timePoint_A, steady_clock::now());
 
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) { LogToFile("[App::drawFrame] vkAcquireNextImageKHR: VK_ERROR_OUT_OF_DATE_KHR, recreating swapchain."); recreateSwapChain(); return; }
@@ -243,9 +332,9 @@ void App::drawFrame() {
     VK_APP_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
 
     GpuUploadPacket packetToRender;
+    std::optional<uint64_t> transferWaitValue;
     bool renderContentFromPacket = false;
     bool needsFreshUploadFromStaging = false;
-    size_t currentActiveFileLoadID = m_activeFileLoadID;
 
 
     steady_clock::time_point RcvTimeStart = steady_clock::now();
@@ -254,7 +343,7 @@ void App::drawFrame() {
         GpuUploadPacket candidatePacket;
         size_t targetDisplayIndex = m_playbackController->getCurrentFrameIndex();
         bool foundSuitableNewPacketInQueue = false;
-        const int max_pop_attempts = kNumPersistentStagingBuffers;
+        const int max_pop_attempts = static_cast<int>(std::max<size_t>(m_stagingRingFrames, 1));
 
         for (int attempt = 0; attempt < max_pop_attempts && m_gpuUploadQueue.try_pop(candidatePacket); ++attempt) {
             if (candidatePacket.fileLoadID != currentActiveFileLoadID) {
@@ -269,6 +358,10 @@ void App::drawFrame() {
                     (candidatePacket.frameIndex < targetDisplayIndex && (targetDisplayIndex - candidatePacket.frameIndex) <= MAX_LAG_FRAMES + 4) ||
                     (candidatePacket.frameIndex > targetDisplayIndex && (candidatePacket.frameIndex - targetDisplayIndex) <= MAX_LEAD_FRAMES / 2 + 2))
                 {
+                    if (!uploadCompletedLambda(candidatePacket)) {
+                        m_gpuUploadQueue.push_front(std::move(candidatePacket));
+                        break;
+                    }
                     packetToRender = candidatePacket;
                     foundSuitableNewPacketInQueue = true;
                     break;
@@ -287,6 +380,10 @@ void App::drawFrame() {
                     m_gpuUploadQueue.push_front(std::move(candidatePacket));
                     continue;
                 }
+                if (!uploadCompletedLambda(candidatePacket)) {
+                    m_gpuUploadQueue.push_front(std::move(candidatePacket));
+                    break;
+                }
                 packetToRender = candidatePacket;
                 foundSuitableNewPacketInQueue = true;
                 break;
@@ -295,16 +392,22 @@ void App::drawFrame() {
 
 
         if (foundSuitableNewPacketInQueue) {
+            m_pipelineMetrics.increment(PipelineMetrics::Counter::FramesDisplayed);
             renderContentFromPacket = true;
             needsFreshUploadFromStaging = true;
             m_lastSuccessfullyUploadedPacket = packetToRender;
             m_hasLastSuccessfullyUploadedPacket.store(true, std::memory_order_release);
-            m_inFlightStagingBufferIndices[m_currentFrame] = packetToRender.stagingBufferIndex;
+            holdStagingForUploadLambda(packetToRender);
         }
         else if (m_hasLastSuccessfullyUploadedPacket.load(std::memory_order_acquire) && m_lastSuccessfullyUploadedPacket.fileLoadID == currentActiveFileLoadID) {
             packetToRender = m_lastSuccessfullyUploadedPacket;
             renderContentFromPacket = true;
             needsFreshUploadFromStaging = false;
+            // Showing the same frame again only matters once the playhead has moved past it.
+            if (m_lastSuccessfullyUploadedPacket.frameIndex != targetDisplayIndex) {
+                FrameTrace::recordInstant("repeat", static_cast<int64_t>(targetDisplayIndex), currentActiveFileLoadID);
+                m_pipelineMetrics.increment(PipelineMetrics::Counter::FramesRepeated);
+            }
         }
     }
     else if (m_playbackController && m_playbackController->isPaused()) {
@@ -312,13 +415,15 @@ void App::drawFrame() {
         bool foundSpecificPausedFrame = false;
         if (m_gpuUploadQueue.try_pop(candidatePausedPacket)) {
             if (candidatePausedPacket.fileLoadID == currentActiveFileLoadID &&
-                candidatePausedPacket.frameIndex == m_playbackController->getCurrentFrameIndex()) {
+                candidatePausedPacket.frameIndex == m_playbackController->getCurrentFrameIndex() &&
+                uploadCompletedLambda(candidatePausedPacket)) {
+                m_pipelineMetrics.increment(PipelineMetrics::Counter::FramesDisplayed);
                 packetToRender = candidatePausedPacket;
                 renderContentFromPacket = true;
                 needsFreshUploadFromStaging = true;
                 m_lastSuccessfullyUploadedPacket = packetToRender;
                 m_hasLastSuccessfullyUploadedPacket.store(true, std::memory_order_release);
-                m_inFlightStagingBufferIndices[m_currentFrame] = packetToRender.stagingBufferIndex;
+                holdStagingForUploadLambda(packetToRender);
                 foundSpecificPausedFrame = true;
             }
             else {
@@ -361,29 +466,51 @@ void App::drawFrame() {
     timePoint_A = steady_clock::now();
     if (renderContentFromPacket) {
         VkBuffer stagingBufferToUseForUpload = VK_NULL_HANDLE;
-        if (needsFreshUploadFromStaging) {
-            if (packetToRender.stagingBufferIndex < m_persistentStagingBuffers.size()) {
-                stagingBufferToUseForUpload = m_persistentStagingBuffers[packetToRender.stagingBufferIndex].buffer;
+        std::optional<uint32_t> transferSlotToUse;
+        if (needsFreshUploadFromStaging && packetToRender.transfer.has_value()) {
+            // Hand the slot from the transfer family to this queue; the submit waits on the timeline below.
+            m_transferUploader->recordAcquire(cmd, packetToRender.transfer->slot);
+            transferSlotToUse = packetToRender.transfer->slot;
+            transferWaitValue = packetToRender.transfer->value;
+        }
+        else if (needsFreshUploadFromStaging) {
+            if (m_stagingRing.buffer() != VK_NULL_HANDLE && packetToRender.staging.offset + packetToRender.staging.size <= m_stagingRing.capacity()) {
+                stagingBufferToUseForUpload = m_stagingRing.buffer();
             }
             else {
-                LogToFile("[App::drawFrame] ERROR: Invalid stagingBufferIndex " + std::to_string(packetToRender.stagingBufferIndex) + ". Will clear screen.");
+                LogToFile("[App::drawFrame] ERROR: Invalid staging span at offset " + std::to_string(packetToRender.staging.offset) + ". Will clear screen.");
                 renderContentFromPacket = false;
-                if (m_inFlightStagingBufferIndices[m_currentFrame].has_value() &&
-                    m_inFlightStagingBufferIndices[m_currentFrame].value() == packetToRender.stagingBufferIndex) {
-                    m_availableStagingBufferIndices.push(packetToRender.stagingBufferIndex);
-                    m_inFlightStagingBufferIndices[m_currentFrame] = std::nullopt;
+                if (m_inFlightStagingSpans[m_currentFrame].has_value()) {
+                    m_stagingRing.release(m_inFlightStagingSpans[m_currentFrame].value());
+                    m_inFlightStagingSpans[m_currentFrame] = std::nullopt;
+                }
+                if (m_retainedRawSource.has_value()) {
+                    m_deferredRawSourceReleases.emplace_back(frameSerial, m_retainedRawSource.value());
+                    m_retainedRawSource.reset();
+                    m_rendererVk->invalidateRawSource();
                 }
             }
         }
 
         if (renderContentFromPacket) {
+            const steady_clock::time_point uploadStart = steady_clock::now();
             m_rendererVk->prepareAndUploadFrameData(
                 cmd, m_currentFrame,
-                stagingBufferToUseForUpload,
+                stagingBufferToUseForUpload, packetToRender.staging.offset, transferSlotToUse, packetToRender.gpuDecode,
                 packetToRender.width, packetToRender.height, packetToRender.metadata,
                 m_staticBlack, m_staticWhite, m_cfaOverride.value_or(m_cfaTypeFromMetadata),
                 needsFreshUploadFromStaging
             );
+            const steady_clock::time_point uploadEnd = steady_clock::now();
+            FrameTrace::recordSpan(needsFreshUploadFromStaging ? "upload" : "upload (reuse)", uploadStart, uploadEnd,
+                static_cast<int64_t>(packetToRender.frameIndex), packetToRender.fileLoadID);
+            m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::Upload, uploadStart, uploadEnd);
+            if (m_showScopes) {
+                m_scopes.recordUpdate(cmd, m_currentFrame,
+                    m_rendererVk->m_processedImageView, m_rendererVk->m_processedImageSampler,
+                    m_rendererVk->getProcessedImageGeneration(),
+                    m_rendererVk->getImageWidth(), m_rendererVk->getImageHeight());
+            }
             clearColorValue.color = { {0.0f, 0.0f, 0.0f, 1.0f} };
         }
         else {
@@ -392,12 +519,14 @@ void App::drawFrame() {
     }
     else {
         clearColorValue.color = { {0.1f, 0.1f, 0.1f, 1.0f} };
-        if (m_inFlightStagingBufferIndices[m_currentFrame].has_value()) {
-            m_availableStagingBufferIndices.push(m_inFlightStagingBufferIndices[m_currentFrame].value());
-            m_inFlightStagingBufferIndices[m_currentFrame] = std::nullopt;
+        if (m_inFlightStagingSpans[m_currentFrame].has_value()) {
+            m_stagingRing.release(m_inFlightStagingSpans[m_currentFrame].value());
+            m_inFlightStagingSpans[m_currentFrame] = std::nullopt;
         }
     }
 
+    // Thumbnails queued by the previous frame's playlist; copies cannot be recorded inside the render pass.
+    m_thumbnailAtlas.recordUploads(cmd, m_currentFrame, frameSerial);
 
     rpInfo.clearValueCount = 1;
     rpInfo.pClearValues = &clearColorValue;
@@ -416,14 +545,27 @@ void App::drawFrame() {
 
     timePoint_B = steady_clock::now();
     m_renderPrepTimeMs = std::chrono::duration<double, std::milli>(timePoint_B - timePoint_A).count();
+    const int64_t traceFrame = renderContentFromPacket ? static_cast<int64_t>(packetToRender.frameIndex) : FrameTrace::kNoFrame;
+    FrameTrace::recordSpan("render", timePoint_A, timePoint_B, traceFrame, currentActiveFileLoadID);
+    m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::Render, timePoint_A, timePoint_B);
 
 
     VK_APP_CHECK(vkEndCommandBuffer(cmd));
 
     VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-    VkSemaphore waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    VkSemaphore waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE };
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+    const uint64_t waitValues[] = { 0, transferWaitValue.value_or(0) };
+    VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR };
     submitInfo.waitSemaphoreCount = 1;
+    if (transferWaitValue.has_value()) {
+        // Already reached on the host side; the wait orders the ownership acquire after the release.
+        waitSemaphores[1] = m_transferUploader->timelineSemaphore();
+        timelineSubmitInfo.waitSemaphoreValueCount = 2;
+        timelineSubmitInfo.pWaitSemaphoreValues = waitValues;
+        submitInfo.pNext = &timelineSubmitInfo;
+        submitInfo.waitSemaphoreCount = 2;
+    }
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
@@ -433,6 +575,7 @@ void App::drawFrame() {
 
     timePoint_A = steady_clock::now();
     VK_APP_CHECK(vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_inFlightFences[m_currentFrame]));
+    ++m_frameSerial;
 
     VkPresentInfoKHR presentInfo{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
     presentInfo.waitSemaphoreCount = 1;
@@ -443,6 +586,13 @@ void App::drawFrame() {
     result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
     timePoint_B = steady_clock::now();
     m_vkSubmitPresentTimeMs = std::chrono::duration<double, std::milli>(timePoint_B - timePoint_A).count();
+    FrameTrace::recordSpan("present", timePoint_A, timePoint_B, traceFrame, currentActiveFileLoadID);
+    m_pipelineMetrics.recordLatency(PipelineMetrics::Stage::Present, timePoint_A, timePoint_B);
+
+    if (!m_startupTimer.summaryLogged() && m_hasLastSuccessfullyUploadedPacket.load(std::memory_order_acquire)) {
+        m_startupTimer.mark("startup: first frame decode + present");
+        m_startupTimer.logSummary("First frame presented");
+    }
 
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized) {
@@ -456,4 +606,21 @@ void App::drawFrame() {
     }
 
     m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
-}
\ No newline at end of file
+}
+
+
+// Starts preparing the next playlist entry once the current clip is about to end.
+void App::prepareNextClipIfEnding() {
+    if (!m_clipPreloader || m_fileList.size() < 2 || !m_playbackController || !m_decoderWrapper || !m_decoderWrapper->getDecoder()) {
+        return;
+    }
+    const auto& frames = m_decoderWrapper->getDecoder()->getFrames();
+    if (frames.empty()) {
+        return;
+    }
+    const size_t currentIndex = std::min(m_playbackController->getCurrentFrameIndex(), frames.size() - 1);
+    if (frames.back() - frames[currentIndex] > kGaplessPrepareLeadNs) {
+        return;
+    }
+    m_clipPreloader->request(m_fileList[(m_currentFileIndex + 1) % static_cast<int>(m_fileList.size())]);
+}
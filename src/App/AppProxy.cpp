@@ -0,0 +1,91 @@
+// FILE: src/App/AppProxy.cpp
+#include "App/App.h"
+#include "Decoder/DecoderWrapper.h"
+#include "Playback/PlaybackController.h"
+#include "Playback/ProxyGenerator.h"
+#include "Utils/DebugLog.h"
+#include <motioncam/Decoder.hpp>
+#include <motioncam/Proxy.hpp>
+
+#include <exception>
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+/**
+ * Opens the proxy next to clipPath if there is one, it was written from this clip (same frames)
+ * and is not older than it. Must be called once m_decoderWrapper holds the clip.
+ */
+std::shared_ptr<motioncam::Decoder> App::openProxyForClip(const std::string& clipPath) const {
+    if (motioncam::isRemoteLocation(clipPath) || !m_decoderWrapper_ptr || !m_decoderWrapper_ptr->getDecoder()) {
+        return nullptr;
+    }
+    const std::string proxyPath = motioncam::ProxyPath(clipPath);
+    const std::string proxyName = fs::path(proxyPath).filename().string();
+    std::error_code ec;
+    if (!fs::exists(proxyPath, ec)) {
+        return nullptr;
+    }
+    const fs::file_time_type clipTime = fs::last_write_time(clipPath, ec);
+    const fs::file_time_type proxyTime = ec ? fs::file_time_type() : fs::last_write_time(proxyPath, ec);
+    if (ec || proxyTime < clipTime) {
+        LogToFile("[App::openProxyForClip] Ignoring '" + proxyName + "': older than the clip.");
+        return nullptr;
+    }
+
+    try {
+        auto proxy = std::make_shared<motioncam::Decoder>(proxyPath);
+        if (!motioncam::IsProxyOf(*proxy, *m_decoderWrapper_ptr->getDecoder())) {
+            LogToFile("[App::openProxyForClip] Ignoring '" + proxyName + "': not a proxy of the clip.");
+            return nullptr;
+        }
+        LogToFile("[App::openProxyForClip] Opened '" + proxyName + "'.");
+        return proxy;
+    }
+    catch (const std::exception& e) {
+        LogToFile("[App::openProxyForClip] Cannot open '" + proxyName + "': " + e.what());
+        return nullptr;
+    }
+}
+
+void App::resetProxyPlayback(const std::string& clipPath, bool hasProxy) {
+    if (m_proxyGenerator && m_proxyGenerator->status().clipPath != clipPath) {
+        m_proxyGenerator->cancel(); // Writing another clip's proxy would take decode time from this one
+    }
+    m_hasProxy = hasProxy;
+    m_adaptiveQuality.reset(); // Every clip starts at full quality
+    m_qualityLevel.store(AdaptiveQuality::Level::Full, std::memory_order_relaxed);
+}
+
+/**
+ * Called once per loop iteration. Hands a proxy written by m_proxyGenerator to the IO thread,
+ * which reads from it at AdaptiveQuality's reduced-resolution level; while paused, replaces a
+ * proxy frame on screen with the full-resolution one.
+ */
+void App::updateProxyPlayback() {
+    if (!m_playbackController || !m_proxyGenerator || m_currentFileIndex < 0 || static_cast<size_t>(m_currentFileIndex) >= m_fileList.size()) {
+        return;
+    }
+    const std::string& clipPath = m_fileList[m_currentFileIndex];
+
+    if (!m_hasProxy) {
+        const ProxyStatus status = m_proxyGenerator->status();
+        if (status.state == ProxyStatus::State::Ready && status.clipPath == clipPath) {
+            std::shared_ptr<motioncam::Decoder> proxy = openProxyForClip(clipPath);
+            {
+                std::lock_guard<std::mutex> lock(m_ioThreadFileMutex);
+                m_ioThreadProxyDecoder = std::move(proxy);
+                m_ioThreadProxyChanged.store(true, std::memory_order_release);
+            }
+            m_hasProxy = true; // Also when it could not be opened: do not retry every frame
+        }
+    }
+
+    if (m_playbackController->isPaused() && m_hasLastSuccessfullyUploadedPacket.load(std::memory_order_acquire) &&
+        m_lastSuccessfullyUploadedPacket.proxy && m_lastSuccessfullyUploadedPacket.fileLoadID == m_activeFileLoadID.load(std::memory_order_acquire)) {
+        // The IO thread reads paused frames from the clip.
+        LOG_DEBUG("[App::updateProxyPlayback] Paused on a proxy frame, reloading it at full resolution.");
+        performSeek(m_playbackController->getCurrentFrameIndex());
+    }
+}
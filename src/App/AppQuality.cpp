@@ -0,0 +1,60 @@
+// FILE: src/App/AppQuality.cpp
+#include "App/App.h"
+#include "Playback/DisplaySchedule.h"
+#include "Playback/PlaybackController.h"
+#include "Playback/ProxyGenerator.h"
+#include "Utils/DebugLog.h"
+#include <motioncam/Decoder.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+/**
+ * Called once per loop iteration. While playing, feeds the pipeline counters to
+ * m_adaptiveQuality and publishes its level to the IO and decode threads. Reaching the
+ * reduced-resolution level without a proxy starts writing one; until it is ready the IO thread
+ * keeps reading the clip, and the next step down skips late frames instead.
+ */
+void App::updateAdaptiveQuality() {
+    if (!m_playbackController || m_currentFileIndex < 0 || static_cast<size_t>(m_currentFileIndex) >= m_fileList.size()) {
+        return;
+    }
+    if (m_playbackController->isPaused()) {
+        m_adaptiveQuality.restartWindow();
+        return;
+    }
+    const std::string& clipPath = m_fileList[m_currentFileIndex];
+    // The IO thread reads only the frames DisplaySchedule puts on screen; load is measured against those.
+    const int64_t frameIntervalNs = m_playbackController->getFrameDurationNs();
+    const int64_t displayIntervalNs = DisplaySchedule::displayIntervalNs(frameIntervalNs, PlaybackController::getDisplayFps());
+    const double frameStride = DisplaySchedule::frameStride(frameIntervalNs, displayIntervalNs);
+
+    const PipelineMetrics::StageSummary decode = m_pipelineMetrics.summarize(PipelineMetrics::Stage::Decode);
+    AdaptiveQuality::Sample sample;
+    sample.framesDisplayed = m_pipelineMetrics.counter(PipelineMetrics::Counter::FramesDisplayed);
+    sample.playhead = m_playbackController->getCurrentFrameIndex();
+    sample.decodeCount = decode.count;
+    sample.decodeMsSum = decode.meanMs * static_cast<double>(decode.count);
+    sample.decodeQueueDepth = m_pipelineMetrics.currentDepth(PipelineMetrics::Queue::Decode);
+    sample.decodeQueueCapacity = m_decodeQueue.get_max_size_debug();
+    sample.frameIntervalMs = static_cast<double>(frameIntervalNs) * frameStride / 1e6;
+    sample.frameStride = frameStride;
+    sample.canReduceResolution = !motioncam::isRemoteLocation(clipPath) && !m_playbackController->isZoomNativePixels();
+
+    const AdaptiveQuality::Level previous = m_adaptiveQuality.level();
+    if (m_adaptiveQuality.update(std::chrono::steady_clock::now(), sample)) {
+        const AdaptiveQuality::Level level = m_adaptiveQuality.level();
+        LogToFile(std::string("[App::updateAdaptiveQuality] '") + fs::path(clipPath).filename().string() + "': " +
+            AdaptiveQuality::levelName(previous) + " -> " + AdaptiveQuality::levelName(level) + " (" + m_adaptiveQuality.reason() + ").");
+        m_qualityLevel.store(level, std::memory_order_relaxed);
+        if (level >= AdaptiveQuality::Level::ReducedResolution && !m_hasProxy && m_proxyGenerator) {
+            m_proxyGenerator->generate(clipPath);
+        }
+    }
+    // A frame needs its decode time plus about one interval for upload and present, in clip frames.
+    m_skipLateLeadFrames.store(static_cast<size_t>(std::ceil(static_cast<double>(m_adaptiveQuality.decodeLatencyFrames() + 1) * frameStride)),
+        std::memory_order_relaxed);
+}
@@ -1,5 +1,6 @@
 #include "Audio/AudioController.h"
 #include "Utils/DebugLog.h"
+#include "Utils/FrameTrace.h"
 #include <algorithm> // For std::min, std::max
 #include <vector>
 #include <utility>
@@ -53,6 +54,7 @@ void AudioController::shutdown() {
     if (m_device) {
         SDL_PauseAudioDevice(m_device, 1);
         SDL_ClearQueuedAudio(m_device);
+        m_queuedSinceClear = false;
         SDL_CloseAudioDevice(m_device);
         m_device = 0;
         LogToFile("[AudioController::shutdown] Audio device closed.");
@@ -68,13 +70,15 @@ void AudioController::reset(motioncam::AudioChunkLoader* loader, int64_t firstVi
     m_loader = loader;
     m_firstVideoFrameTs = firstVideoFrameTimestampNs; // This is the T0_media_video anchor for the current segment
     m_hasCache = false;
+    m_loaderExhausted = false;
     m_lastQueuedTimestamp = 0; // Reset relative queued timestamp
 
     log_oss << ", Internal m_firstVideoFrameTs (AudioAnchor) set to: " << m_firstVideoFrameTs;
-    LogToFile(log_oss.str());
+    LOG_DEBUG(log_oss.str());
 
     if (m_device) {
         SDL_ClearQueuedAudio(m_device);
+        m_queuedSinceClear = false;
         if (!m_isForceMuted && !m_isPaused) {
             SDL_PauseAudioDevice(m_device, 0);
         }
@@ -100,6 +104,7 @@ void AudioController::resume_internal() {
         m_isPaused = false;
         if (!m_isForceMuted) { // Only unpause if not force-muted
             SDL_ClearQueuedAudio(m_device); // Clear stale audio from pause
+            m_queuedSinceClear = false;
             SDL_PauseAudioDevice(m_device, 0);
             LogToFile("[AudioController::resume_internal] Audio actually resumed (SDL_PauseAudioDevice(0) after clear).");
         }
@@ -111,7 +116,7 @@ void AudioController::resume_internal() {
 
 void AudioController::setPaused(bool desiredPauseState) {
     if (desiredPauseState == m_isPaused) return; // No change
-    LogToFile(std::string("[AudioController::setPaused] Received desire to change pause state to: ") + (desiredPauseState ? "PAUSE" : "RESUME") + ". Current m_isPaused: " + (m_isPaused ? "true" : "false"));
+    LOG_DEBUG(std::string("[AudioController::setPaused] Received desire to change pause state to: ") + (desiredPauseState ? "PAUSE" : "RESUME") + ". Current m_isPaused: " + (m_isPaused ? "true" : "false"));
     if (desiredPauseState) {
         pause_internal();
     }
@@ -131,6 +136,7 @@ void AudioController::setForceMute(bool forceMute) {
         if (m_isForceMuted) {
             SDL_PauseAudioDevice(m_device, 1); // Muting implies pausing the device
             SDL_ClearQueuedAudio(m_device);
+            m_queuedSinceClear = false;
         }
         else { // Unmuting
             if (m_isPaused) { // If it was logically paused, keep it physically paused
@@ -138,6 +144,7 @@ void AudioController::setForceMute(bool forceMute) {
             }
             else { // If it was playing, resume physical playback
                 SDL_ClearQueuedAudio(m_device);
+                m_queuedSinceClear = false;
                 SDL_PauseAudioDevice(m_device, 0);
             }
         }
@@ -153,6 +160,17 @@ void AudioController::updatePlayback(int64_t elapsedNsSinceSegmentStart) {
         return;
     }
 
+    // The device ran dry although the stream continues: count each run of empty polls once.
+    if (m_queuedSinceClear && !m_loaderExhausted && SDL_GetQueuedAudioSize(m_device) == 0) {
+        if (!m_inUnderrun) {
+            ++m_underrunCount;
+            m_inUnderrun = true;
+        }
+    }
+    else {
+        m_inUnderrun = false;
+    }
+
     const int64_t targetQueueUntilMediaTimeNs = elapsedNsSinceSegmentStart + m_latencyNs;
 
     // More detailed logging for audio queueing decisions
@@ -173,6 +191,7 @@ void AudioController::updatePlayback(int64_t elapsedNsSinceSegmentStart) {
     int64_t effectiveTargetQueueUntilNs = std::min({ targetQueueUntilMediaTimeNs, catch_up_target_ns, initial_burst_target_ns });
     effectiveTargetQueueUntilNs = std::max(effectiveTargetQueueUntilNs, targetQueueUntilMediaTimeNs); // Ensure we at least target the base latency
 
+    FrameTrace::Scope queueScope("audio queue");
     int chunksQueuedThisCall = 0;
     const int MAX_CHUNKS_PER_UPDATE_CALL = 10; // Limit how many chunks we try to process in one go
 
@@ -180,6 +199,7 @@ void AudioController::updatePlayback(int64_t elapsedNsSinceSegmentStart) {
         if (!m_hasCache) {
             motioncam::AudioChunk tempChunk;
             if (!m_loader->next(tempChunk)) {
+                m_loaderExhausted = true;
                 // LogToFile("[Audio::updatePlayback] No more audio chunks from loader.");
                 break;
             }
@@ -227,6 +247,7 @@ void AudioController::queueSamples(const std::vector<int16_t>& pcm) {
         LogToFile(std::string("[AudioController::queueSamples] SDL_QueueAudio failed: ") + SDL_GetError());
     }
     else {
+        m_queuedSinceClear = true;
         // Only update m_lastQueuedTimestamp if the chunk had a valid, non-error timestamp
         if (m_cache.first != -1LL - m_firstVideoFrameTs) {
             m_lastQueuedTimestamp = m_cache.first;
@@ -0,0 +1,111 @@
+#include "Decoder/BandDecoder.h"
+
+#include <motioncam/RawData.hpp>
+
+#include <algorithm>
+
+namespace {
+constexpr unsigned kMaxHelpers = 3;
+constexpr int kRowsPerGroup = 4; // Height of a block row; bands start on one
+}
+
+BandDecoder::BandDecoder(unsigned numHelpers) {
+    if (numHelpers == 0) {
+        numHelpers = std::min(kMaxHelpers, std::thread::hardware_concurrency() / 2);
+    }
+    m_results.assign(numHelpers + 1, 0);
+    for (unsigned band = 1; band <= numHelpers; ++band) {
+        m_helpers.emplace_back(&BandDecoder::helperLoop, this, band);
+    }
+}
+
+BandDecoder::~BandDecoder() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workCv.notify_all();
+    for (std::thread& helper : m_helpers) {
+        if (helper.joinable()) helper.join();
+    }
+}
+
+size_t BandDecoder::decodeBand(const Job& job, unsigned band) {
+    const int rowGroups = (job.height + kRowsPerGroup - 1) / kRowsPerGroup;
+    const int firstGroup = static_cast<int>(static_cast<int64_t>(rowGroups) * band / job.bands);
+    const int endGroup = static_cast<int>(static_cast<int64_t>(rowGroups) * (band + 1) / job.bands);
+    return motioncam::raw::DecodeRows(job.output, job.width, job.height, job.input, job.len, *job.layout,
+        firstGroup * kRowsPerGroup, (endGroup - firstGroup) * kRowsPerGroup, job.writeCombined);
+}
+
+size_t BandDecoder::decode(uint16_t* output, int width, int height, const uint8_t* input, size_t len, bool writeCombined) {
+    if (width <= 0 || height <= 0) {
+        return 0;
+    }
+    const int rowGroups = (height + kRowsPerGroup - 1) / kRowsPerGroup;
+    const unsigned bands = std::min(bandCount(), static_cast<unsigned>(rowGroups));
+    if (bands <= 1) {
+        return writeCombined ? motioncam::raw::DecodeToWriteCombined(output, width, height, input, len)
+                             : motioncam::raw::Decode(output, width, height, input, len);
+    }
+    if (!motioncam::raw::ParseFrameLayout(width, height, input, len, m_layout)) {
+        return 0;
+    }
+
+    Job job;
+    job.output = output;
+    job.width = width;
+    job.height = height;
+    job.input = input;
+    job.len = len;
+    job.bands = bands;
+    job.writeCombined = writeCombined;
+    job.layout = &m_layout;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = job;
+        m_pending = bands - 1;
+        std::fill(m_results.begin(), m_results.end(), 0);
+        ++m_generation;
+    }
+    m_workCv.notify_all();
+
+    const size_t first = decodeBand(job, 0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this] { return m_pending == 0; });
+    if (first == 0) {
+        return 0;
+    }
+    size_t total = first;
+    for (unsigned band = 1; band < bands; ++band) {
+        if (m_results[band] == 0) {
+            return 0;
+        }
+        total += m_results[band];
+    }
+    return total;
+}
+
+void BandDecoder::helperLoop(unsigned band) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_workCv.wait(lock, [&] { return m_stop || m_generation != seen; });
+        if (m_stop) {
+            return;
+        }
+        seen = m_generation;
+        const Job job = m_job;
+        if (band >= job.bands) {
+            continue; // Fewer block rows than threads; this band is empty
+        }
+        lock.unlock();
+        const size_t written = decodeBand(job, band);
+        lock.lock();
+        m_results[band] = written;
+        if (--m_pending == 0) {
+            m_doneCv.notify_one();
+        }
+    }
+}
@@ -1,7 +1,9 @@
 #include "Decoder/DecoderWrapper.h"
 #include "Utils/DebugLog.h" // For LogToFile
 
+#include <algorithm>
 #include <stdexcept>
+#include <cstdlib>
 #include <filesystem> // For fs::exists, fs::is_regular_file, fs::path
 
 namespace fs = std::filesystem;
@@ -9,12 +11,13 @@ namespace fs = std::filesystem;
 DecoderWrapper::DecoderWrapper(const std::string& filePath)
     : m_filePath(filePath) {
     LogToFile(std::string("[DecoderWrapper] Constructor for: ") + filePath);
-    if (!fs::exists(m_filePath)) {
+    const bool remote = motioncam::isRemoteLocation(m_filePath);
+    if (!remote && !fs::exists(m_filePath)) {
         std::string errMsg = "DecoderWrapper: Input file does not exist: " + m_filePath;
         LogToFile(errMsg);
         throw std::runtime_error(errMsg);
     }
-    if (!fs::is_regular_file(m_filePath)) {
+    if (!remote && !fs::is_regular_file(m_filePath)) {
         std::string errMsg = "DecoderWrapper: Input path is not a regular file: " + m_filePath;
         LogToFile(errMsg);
         throw std::runtime_error(errMsg);
@@ -27,8 +30,9 @@ DecoderWrapper::DecoderWrapper(const std::string& filePath)
     }
 
     try {
-        m_decoder = std::make_unique<motioncam::Decoder>(m_filePath);
-        LogToFile(std::string("[DecoderWrapper] motioncam::Decoder initialized for: ") + m_filePath);
+        m_decoder = std::make_shared<motioncam::Decoder>(m_filePath);
+        LogToFile(std::string("[DecoderWrapper] motioncam::Decoder initialized for: ") + m_filePath +
+            " (" + m_decoder->getByteSource().name() + ")");
     }
     catch (const std::exception& e) {
         std::string errMsg = "DecoderWrapper: Failed to initialize motioncam::Decoder for '" + m_filePath + "': " + e.what();
@@ -51,23 +55,53 @@ DecoderWrapper::DecoderWrapper(const std::string& filePath)
     }
 }
 
-motioncam::AudioChunkLoader* DecoderWrapper::makeFreshAudioLoader() {
-    LogToFile(std::string("[DecoderWrapper] makeFreshAudioLoader called for: ") + m_filePath);
-    // This operation is potentially costly as it re-initializes the decoder.
-    // It's necessary if the underlying library doesn't support seeking/resetting audio stream independently.
-    m_decoder.reset();
-    try {
-        m_decoder = std::make_unique<motioncam::Decoder>(m_filePath);
-        LogToFile(std::string("[DecoderWrapper] motioncam::Decoder re-initialized for fresh audio loader."));
+void DecoderWrapper::configureByteSourceFromEnvironment() {
+    motioncam::ByteSourceOptions options = motioncam::defaultByteSourceOptions();
+
+    if (const char* io = std::getenv("MOTIONCAM_IO")) {
+        if (!motioncam::parseByteSourceKind(io, options.kind)) {
+            LogToFile(std::string("[DecoderWrapper] Ignoring unknown MOTIONCAM_IO value: ") + io);
+        }
     }
-    catch (const std::exception& e) {
-        std::string errMsg = "DecoderWrapper: Failed to re-open motioncam::Decoder for audio rewind: " + m_filePath + "': " + e.what();
-        LogToFile(errMsg);
-        throw std::runtime_error(errMsg);
+    if (const char* cacheMb = std::getenv("MOTIONCAM_IO_CACHE_MB")) {
+        const long mb = std::strtol(cacheMb, nullptr, 10);
+        if (mb > 0) {
+            options.cacheBytes = static_cast<size_t>(mb) << 20;
+        }
+    }
+    if (const char* depth = std::getenv("MOTIONCAM_IO_QUEUE_DEPTH")) {
+        const long d = std::strtol(depth, nullptr, 10);
+        if (d > 0) {
+            options.queueDepth = static_cast<unsigned>(std::min(d, 256L));
+        }
+    }
+
+    if (options.kind == motioncam::ByteSourceKind::Async && !motioncam::asyncByteSourceAvailable()) {
+        LogToFile("[DecoderWrapper] Async reads are not available in this build; using pread.");
     }
 
-    // The motioncam::Decoder::loadAudio() returns a reference to an internal loader.
-    // If the DecoderWrapper's m_decoder is reset again, this loader becomes invalid.
-    // The caller (AudioController) must be aware of this lifetime.
-    return &m_decoder->loadAudio();
-}
\ No newline at end of file
+    static const char* const kKindNames[] = { "auto", "mmap", "pread", "async", "http" };
+    LogToFile(std::string("[DecoderWrapper] Byte source: ") + kKindNames[static_cast<int>(options.kind)] +
+        ", cache " + std::to_string(options.cacheBytes >> 20) + " MiB, queue depth " + std::to_string(options.queueDepth));
+
+    motioncam::setDefaultByteSourceOptions(options);
+}
+
+motioncam::AudioChunkLoader* DecoderWrapper::makeFreshAudioLoader() {
+    LOG_DEBUG(std::string("[DecoderWrapper] makeFreshAudioLoader called for: ") + m_filePath);
+    if (!m_decoder) {
+        throw std::runtime_error("DecoderWrapper: No decoder open for audio rewind: " + m_filePath);
+    }
+    m_audioLoader = m_decoder->makeAudioLoader();
+    return m_audioLoader.get();
+}
+
+nlohmann::json DecoderWrapper::readFrameMetadata(motioncam::Timestamp timestamp) const {
+    std::vector<uint8_t> compressedPayload;
+    std::vector<uint8_t> metadataPayload;
+    int width = 0, height = 0, compressionType = -1;
+    if (!m_decoder || !m_decoder->getRawFramePayloads(timestamp, compressedPayload, metadataPayload, width, height, compressionType)) {
+        throw std::runtime_error("DecoderWrapper: Failed to read frame " + std::to_string(timestamp) + " from " + m_filePath);
+    }
+    return nlohmann::json::parse(metadataPayload.begin(), metadataPayload.end());
+}
@@ -0,0 +1,381 @@
+// FILE: src/Export/CompressedAnalysis.cpp
+#include "Export/CompressedAnalysis.h"
+#include "Export/HeadlessExport.h"
+#include "Utils/DebugLog.h"
+
+#include <motioncam/Decoder.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr int kCellRowGroups = 16;        // 16 row groups of 4 rows: 64-pixel-tall cells
+    constexpr size_t kBatchFrames = 16;       // Frames per Decoder::getBlockMetadata() call
+    constexpr float kFocusTopFraction = 0.1f;
+    constexpr float kSceneDeltaFloor = 0.12f;
+    constexpr float kSceneMedianFactor = 6.0f;
+    constexpr float kSoftFocusFraction = 0.6f;
+
+    struct FrameMaps {
+        int cols = 0;
+        int rows = 0;
+        std::vector<float> level;  // Mean block reference per cell
+        std::vector<float> detail; // Mean block bits per cell
+        uint64_t tableHash = 0;
+        bool valid = false;
+    };
+
+    bool buildMaps(const motioncam::FrameBlockMetadata& frame, FrameMaps& maps, float& outMeanBits, float& outFocus) {
+        maps.valid = false;
+        if (frame.bits.empty() || frame.blocksPerRow == 0 || frame.rowGroups == 0) {
+            return false;
+        }
+        maps.cols = static_cast<int>(frame.blocksPerRow);
+        maps.rows = static_cast<int>((frame.rowGroups + kCellRowGroups - 1) / kCellRowGroups);
+        const size_t cells = static_cast<size_t>(maps.cols) * maps.rows;
+        maps.level.assign(cells, 0.0f);
+        maps.detail.assign(cells, 0.0f);
+        std::vector<uint32_t> blocksPerCell(cells, 0);
+
+        uint64_t hash = 1469598103934665603ull;
+        uint64_t bitsTotal = 0;
+        size_t block = 0;
+        for (uint32_t rg = 0; rg < frame.rowGroups; ++rg) {
+            const size_t cellRow = static_cast<size_t>(rg / kCellRowGroups) * maps.cols;
+            for (uint32_t cx = 0; cx < frame.blocksPerRow; ++cx) {
+                uint32_t bitsSum = 0;
+                uint32_t refsSum = 0;
+                for (int b = 0; b < 4; ++b, ++block) {
+                    bitsSum += frame.bits[block];
+                    refsSum += frame.refs[block];
+                    hash = (hash ^ (static_cast<uint64_t>(frame.bits[block]) << 16 | frame.refs[block])) * 1099511628211ull;
+                }
+                bitsTotal += bitsSum;
+                maps.detail[cellRow + cx] += static_cast<float>(bitsSum);
+                maps.level[cellRow + cx] += static_cast<float>(refsSum);
+                blocksPerCell[cellRow + cx] += 4;
+            }
+        }
+        for (size_t c = 0; c < cells; ++c) {
+            const float n = static_cast<float>(std::max(1u, blocksPerCell[c]));
+            maps.detail[c] /= n;
+            maps.level[c] /= n;
+        }
+        maps.tableHash = hash;
+        maps.valid = true;
+
+        outMeanBits = static_cast<float>(static_cast<double>(bitsTotal) / static_cast<double>(frame.bits.size()));
+        std::vector<float> sorted = maps.detail;
+        const size_t top = std::max<size_t>(1, static_cast<size_t>(sorted.size() * kFocusTopFraction));
+        std::nth_element(sorted.begin(), sorted.end() - top, sorted.end());
+        double topSum = 0.0;
+        for (auto it = sorted.end() - top; it != sorted.end(); ++it) topSum += *it;
+        outFocus = static_cast<float>(topSum / static_cast<double>(top));
+        return true;
+    }
+
+    // Relative change of the level and detail maps, 0 for identical maps.
+    float mapDelta(const FrameMaps& a, const FrameMaps& b) {
+        double levelDiff = 0.0, levelSum = 0.0, detailDiff = 0.0, detailSum = 0.0;
+        for (size_t c = 0; c < a.level.size(); ++c) {
+            levelDiff += std::abs(a.level[c] - b.level[c]);
+            levelSum += 0.5 * (a.level[c] + b.level[c]);
+            detailDiff += std::abs(a.detail[c] - b.detail[c]);
+            detailSum += 0.5 * (a.detail[c] + b.detail[c]);
+        }
+        return static_cast<float>(0.5 * (levelDiff / std::max(1.0, levelSum) + detailDiff / std::max(1e-3, detailSum)));
+    }
+
+    float median(std::vector<float> values) {
+        if (values.empty()) return 0.0f;
+        auto middle = values.begin() + values.size() / 2;
+        std::nth_element(values.begin(), middle, values.end());
+        return *middle;
+    }
+
+    // Frames [begin, end) of the clip. The frame before begin is read too, so the first
+    // frame's delta is measured against its real predecessor.
+    void analyzeRange(const motioncam::Decoder& decoder, size_t begin, size_t end,
+        std::vector<CompressedAnalysis::FrameSummary>& summaries, int mapCols, int mapRows, std::vector<double>& detailSum) {
+        const std::vector<motioncam::Timestamp>& frames = decoder.getFrames();
+        FrameMaps previous;
+        FrameMaps current;
+        size_t previousBytes = 0;
+        std::vector<motioncam::Timestamp> batch;
+        std::vector<motioncam::FrameBlockMetadata> metadata;
+        for (size_t first = (begin > 0 ? begin - 1 : begin); first < end; first += kBatchFrames) {
+            const size_t last = std::min(end, first + kBatchFrames);
+            batch.assign(frames.begin() + first, frames.begin() + last);
+            decoder.getBlockMetadata(batch, metadata);
+            for (size_t k = 0; k < metadata.size(); ++k) {
+                const size_t index = first + k;
+                const motioncam::FrameBlockMetadata& frame = metadata[k];
+                float meanBits = 0.0f, focus = 0.0f;
+                const bool hasMaps = frame.valid && buildMaps(frame, current, meanBits, focus);
+                if (!hasMaps) current.valid = false;
+
+                if (index >= begin) {
+                    CompressedAnalysis::FrameSummary& s = summaries[index];
+                    s.timestamp = frames[index];
+                    s.compressedBytes = frame.compressedSize;
+                    s.hasTables = hasMaps;
+                    s.meanBits = meanBits;
+                    s.focus = focus;
+                    if (hasMaps && previous.valid && previous.cols == current.cols && previous.rows == current.rows) {
+                        s.sceneDelta = mapDelta(previous, current);
+                        s.duplicate = previous.tableHash == current.tableHash && previousBytes == frame.compressedSize;
+                    }
+                    if (hasMaps && current.cols == mapCols && current.rows == mapRows) {
+                        for (size_t c = 0; c < current.detail.size(); ++c) detailSum[c] += current.detail[c];
+                    }
+                }
+                std::swap(previous, current);
+                previousBytes = frame.compressedSize;
+            }
+        }
+    }
+
+    bool isMcrawPath(const fs::path& path) {
+        std::string ext = path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return ext == ".mcraw";
+    }
+
+    bool writeFrameCsv(const CompressedAnalysis::ClipReport& report, const fs::path& path) {
+        std::ofstream out(path, std::ios::trunc);
+        out << "frame,timestamp_ns,bytes,mbps,mean_bits,focus,scene_delta,flags\n";
+        for (size_t i = 0; i < report.frames.size(); ++i) {
+            const CompressedAnalysis::FrameSummary& s = report.frames[i];
+            std::string flags;
+            if (s.sceneChange) flags += "scene ";
+            if (s.duplicate) flags += "duplicate ";
+            if (s.soft) flags += "soft ";
+            if (!flags.empty()) flags.pop_back();
+            out << i << ',' << s.timestamp << ',' << s.compressedBytes << ',' << std::fixed << std::setprecision(2) << s.mbps << ','
+                << std::setprecision(3) << s.meanBits << ',' << s.focus << ',' << std::setprecision(4) << s.sceneDelta << ',' << flags << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    // Binary PGM, brightest cell white.
+    bool writeDetailMap(const CompressedAnalysis::ClipReport& report, const fs::path& path) {
+        if (report.mapCols <= 0 || report.mapRows <= 0) return false;
+        const float peak = std::max(1e-3f, *std::max_element(report.detailMap.begin(), report.detailMap.end()));
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "P5\n" << report.mapCols << ' ' << report.mapRows << "\n255\n";
+        for (float v : report.detailMap) {
+            out.put(static_cast<char>(static_cast<uint8_t>(std::lround(std::clamp(v / peak, 0.0f, 1.0f) * 255.0f))));
+        }
+        return static_cast<bool>(out);
+    }
+
+    std::string frameList(const CompressedAnalysis::ClipReport& report, bool CompressedAnalysis::FrameSummary::* flag, size_t limit) {
+        std::ostringstream oss;
+        size_t listed = 0, total = 0;
+        for (size_t i = 0; i < report.frames.size(); ++i) {
+            if (!(report.frames[i].*flag)) continue;
+            if (listed < limit) {
+                oss << (listed > 0 ? "," : "") << i;
+                ++listed;
+            }
+            ++total;
+        }
+        if (total > listed) oss << ",... (" << total << ")";
+        return total == 0 ? std::string("-") : oss.str();
+    }
+}
+
+namespace CompressedAnalysis {
+
+ClipReport analyzeClip(const std::string& path, unsigned numThreads) {
+    ClipReport report;
+    report.path = path;
+    const auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<motioncam::Decoder> decoder;
+    try {
+        decoder = std::make_unique<motioncam::Decoder>(path);
+    }
+    catch (const std::exception& e) {
+        report.error = e.what();
+        return report;
+    }
+    const std::vector<motioncam::Timestamp>& frames = decoder->getFrames();
+    if (frames.empty()) {
+        report.error = "No frames";
+        return report;
+    }
+
+    // The first frame fixes the map size; frames of another size are left out of the clip map.
+    std::vector<motioncam::FrameBlockMetadata> first;
+    decoder->getBlockMetadata({ frames.front() }, first);
+    if (!first.empty() && first.front().blocksPerRow > 0) {
+        report.mapCols = static_cast<int>(first.front().blocksPerRow);
+        report.mapRows = static_cast<int>((first.front().rowGroups + kCellRowGroups - 1) / kCellRowGroups);
+    }
+    const size_t cells = static_cast<size_t>(report.mapCols) * report.mapRows;
+
+    if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = static_cast<unsigned>(std::min<size_t>(numThreads, (frames.size() + kBatchFrames - 1) / kBatchFrames));
+    report.frames.resize(frames.size());
+    std::vector<std::vector<double>> detailSums(numThreads, std::vector<double>(cells, 0.0));
+    std::vector<std::thread> workers;
+    const size_t chunk = (frames.size() + numThreads - 1) / numThreads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        const size_t begin = std::min(frames.size(), t * chunk);
+        const size_t end = std::min(frames.size(), begin + chunk);
+        workers.emplace_back([&, t, begin, end] {
+            try {
+                analyzeRange(*decoder, begin, end, report.frames, report.mapCols, report.mapRows, detailSums[t]);
+            }
+            catch (const std::exception& e) {
+                LogToFile(std::string("[CompressedAnalysis] Frames ") + std::to_string(begin) + "-" + std::to_string(end) + " of " + path + ": " + e.what());
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    // Bitrate from each frame's interval; the last frame uses the median interval.
+    std::vector<float> intervals;
+    for (size_t i = 1; i < frames.size(); ++i) intervals.push_back(static_cast<float>(frames[i] - frames[i - 1]) * 1e-9f);
+    const double medianInterval = intervals.empty() ? 0.0 : median(intervals);
+    if (frames.size() > 1 && frames.back() > frames.front()) {
+        report.fps = static_cast<double>(frames.size() - 1) / (static_cast<double>(frames.back() - frames.front()) * 1e-9);
+    }
+    double totalBytes = 0.0;
+    for (size_t i = 0; i < report.frames.size(); ++i) {
+        FrameSummary& s = report.frames[i];
+        const double interval = (i + 1 < frames.size() && frames[i + 1] > frames[i]) ? static_cast<double>(frames[i + 1] - frames[i]) * 1e-9 : medianInterval;
+        s.mbps = interval > 0.0 ? static_cast<double>(s.compressedBytes) * 8.0 / interval * 1e-6 : 0.0;
+        report.peakMbps = std::max(report.peakMbps, s.mbps);
+        totalBytes += static_cast<double>(s.compressedBytes);
+    }
+    const double durationSec = medianInterval * static_cast<double>(frames.size());
+    report.meanMbps = durationSec > 0.0 ? totalBytes * 8.0 / durationSec * 1e-6 : 0.0;
+
+    // Candidates are judged against the clip's own typical frame-to-frame change and focus.
+    std::vector<float> deltas, focuses;
+    for (size_t i = 0; i < report.frames.size(); ++i) {
+        if (!report.frames[i].hasTables) continue;
+        if (i > 0) deltas.push_back(report.frames[i].sceneDelta);
+        focuses.push_back(report.frames[i].focus);
+    }
+    const float sceneThreshold = std::max(kSceneDeltaFloor, kSceneMedianFactor * median(deltas));
+    const float softThreshold = kSoftFocusFraction * median(focuses);
+    for (size_t i = 1; i < report.frames.size(); ++i) {
+        FrameSummary& s = report.frames[i];
+        s.sceneChange = s.hasTables && s.sceneDelta > sceneThreshold;
+    }
+    for (FrameSummary& s : report.frames) {
+        s.soft = s.hasTables && s.focus < softThreshold;
+    }
+
+    size_t mapFrames = 0;
+    for (const FrameSummary& s : report.frames) mapFrames += s.hasTables ? 1 : 0;
+    report.detailMap.assign(cells, 0.0f);
+    for (const std::vector<double>& sums : detailSums) {
+        for (size_t c = 0; c < cells; ++c) report.detailMap[c] += static_cast<float>(sums[c] / std::max<size_t>(1, mapFrames));
+    }
+
+    report.valid = true;
+    report.elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+} // namespace CompressedAnalysis
+
+namespace HeadlessExport {
+
+int runAnalyze(const std::vector<std::string>& args) {
+    std::vector<std::string> positional;
+    unsigned threads = 0;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads = static_cast<unsigned>(std::max(0, std::atoi(args[++i].c_str())));
+        }
+        else {
+            positional.push_back(args[i]);
+        }
+    }
+    if (positional.empty() || positional.size() > 2) return 1;
+
+    const fs::path input(positional[0]);
+    std::error_code ec;
+    std::vector<fs::path> clips;
+    if (fs::is_directory(input, ec)) {
+        for (const fs::directory_entry& entry : fs::directory_iterator(input, ec)) {
+            if (entry.is_regular_file(ec) && isMcrawPath(entry.path())) clips.push_back(entry.path());
+        }
+        std::sort(clips.begin(), clips.end());
+    }
+    else if (fs::exists(input, ec)) {
+        clips.push_back(input);
+    }
+    if (clips.empty()) {
+        std::cerr << "No .mcraw files at " << input.string() << std::endl;
+        return 2;
+    }
+
+    const fs::path outputDir = positional.size() > 1 ? fs::path(positional[1])
+        : (fs::is_directory(input, ec) ? input : input.parent_path()) / "mcraw_analysis";
+    fs::create_directories(outputDir, ec);
+    if (ec) {
+        std::cerr << "Cannot create " << outputDir.string() << ": " << ec.message() << std::endl;
+        return 2;
+    }
+
+    nlohmann::json summary = nlohmann::json::array();
+    bool allOk = true;
+    for (const fs::path& clip : clips) {
+        const CompressedAnalysis::ClipReport report = CompressedAnalysis::analyzeClip(clip.string(), threads);
+        if (!report.valid) {
+            std::cerr << clip.filename().string() << ": " << report.error << std::endl;
+            summary.push_back({ { "file", clip.filename().string() }, { "error", report.error } });
+            allOk = false;
+            continue;
+        }
+        const std::string stem = clip.stem().string();
+        writeFrameCsv(report, outputDir / (stem + "_frames.csv"));
+        writeDetailMap(report, outputDir / (stem + "_detail.pgm"));
+
+        size_t scenes = 0, duplicates = 0, soft = 0, untabled = 0;
+        for (const CompressedAnalysis::FrameSummary& s : report.frames) {
+            scenes += s.sceneChange; duplicates += s.duplicate; soft += s.soft; untabled += !s.hasTables;
+        }
+        const double framesPerSec = report.elapsedSec > 0.0 ? static_cast<double>(report.frames.size()) / report.elapsedSec : 0.0;
+        std::cout << clip.filename().string() << ": " << report.frames.size() << " frames, "
+            << std::fixed << std::setprecision(1) << report.meanMbps << " Mb/s mean, " << report.peakMbps << " peak; "
+            << "scene changes " << frameList(report, &CompressedAnalysis::FrameSummary::sceneChange, 10)
+            << "; duplicates " << frameList(report, &CompressedAnalysis::FrameSummary::duplicate, 10)
+            << "; soft " << frameList(report, &CompressedAnalysis::FrameSummary::soft, 10)
+            << " [" << std::setprecision(0) << framesPerSec << " frames/s]" << std::endl;
+        if (untabled > 0) {
+            std::cout << "  " << untabled << " frames without type 7 block tables: bitrate only." << std::endl;
+        }
+        summary.push_back({ { "file", clip.filename().string() }, { "frames", report.frames.size() }, { "fps", report.fps },
+            { "meanMbps", report.meanMbps }, { "peakMbps", report.peakMbps }, { "sceneChanges", scenes },
+            { "duplicates", duplicates }, { "softFrames", soft }, { "analysisSec", report.elapsedSec } });
+    }
+
+    std::ofstream(outputDir / "analysis_summary.json", std::ios::trunc) << summary.dump(2) << std::endl;
+    std::cout << "Reports written to " << outputDir.string() << std::endl;
+    return allOk ? 0 : 2;
+}
+
+} // namespace HeadlessExport
@@ -0,0 +1,338 @@
+// FILE: src/Export/ContainerVerify.cpp
+#include "Export/HeadlessExport.h"
+#include "Utils/XxHash64.h"
+
+#include <motioncam/Decoder.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr int kSidecarVersion = 1;
+    constexpr size_t kBatchFrames = 8; // Frames per Decoder::getRawFramePayloads() call
+
+    enum class FrameStatus { Unchecked, Ok, BadRecord, BadMetadata, DecodeFailed, HashMismatch };
+
+    const char* statusText(FrameStatus status) {
+        switch (status) {
+        case FrameStatus::Unchecked: return "not checked";
+        case FrameStatus::Ok: return "ok";
+        case FrameStatus::BadRecord: return "unreadable record or bad item header";
+        case FrameStatus::BadMetadata: return "bad frame metadata";
+        case FrameStatus::DecodeFailed: return "payload does not decode";
+        case FrameStatus::HashMismatch: return "payload differs from the sidecar hash";
+        }
+        return "?";
+    }
+
+    struct FrameResult {
+        FrameStatus status = FrameStatus::Unchecked;
+        uint64_t hash = 0;
+        size_t bytes = 0;
+    };
+
+    struct ChunkResult {
+        motioncam::Timestamp timestamp = 0;
+        uint64_t hash = 0;
+        size_t bytes = 0;
+    };
+
+    // Per-frame and per-audio-chunk XXH64 of the compressed payloads, written next to the clip
+    // as <clip>.xxh64.json after a full verification passed.
+    struct Sidecar {
+        uint64_t fileSize = 0;
+        std::vector<motioncam::Timestamp> timestamps;
+        std::vector<uint64_t> frameHashes;
+        std::vector<ChunkResult> audio;
+    };
+
+    fs::path sidecarPath(const std::string& inputPath) {
+        return fs::path(inputPath + ".xxh64.json");
+    }
+
+    bool loadSidecar(const fs::path& path, Sidecar& out, std::string& error) {
+        std::ifstream in(path);
+        if (!in) { error = "cannot open"; return false; }
+        try {
+            const nlohmann::json j = nlohmann::json::parse(in);
+            if (j.value("version", 0) != kSidecarVersion || j.value("algorithm", std::string()) != "xxh64") {
+                error = "unsupported version";
+                return false;
+            }
+            out.fileSize = j.at("fileSize").get<uint64_t>();
+            for (const nlohmann::json& f : j.at("frames")) {
+                uint64_t hash = 0;
+                if (!XxHash64::fromHex(f.at("xxh64").get<std::string>(), hash)) { error = "bad hash"; return false; }
+                out.timestamps.push_back(f.at("t").get<motioncam::Timestamp>());
+                out.frameHashes.push_back(hash);
+            }
+            for (const nlohmann::json& a : j.at("audio")) {
+                ChunkResult chunk;
+                if (!XxHash64::fromHex(a.at("xxh64").get<std::string>(), chunk.hash)) { error = "bad hash"; return false; }
+                chunk.timestamp = a.at("t").get<motioncam::Timestamp>();
+                out.audio.push_back(chunk);
+            }
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+            return false;
+        }
+        return true;
+    }
+
+    bool saveSidecar(const fs::path& path, const std::string& inputPath, const Sidecar& sidecar) {
+        nlohmann::json frames = nlohmann::json::array();
+        for (size_t i = 0; i < sidecar.timestamps.size(); ++i) {
+            frames.push_back({ { "t", sidecar.timestamps[i] }, { "xxh64", XxHash64::toHex(sidecar.frameHashes[i]) } });
+        }
+        nlohmann::json audio = nlohmann::json::array();
+        for (const ChunkResult& chunk : sidecar.audio) {
+            audio.push_back({ { "t", chunk.timestamp }, { "xxh64", XxHash64::toHex(chunk.hash) } });
+        }
+        const nlohmann::json j = {
+            { "version", kSidecarVersion }, { "algorithm", "xxh64" },
+            { "file", fs::path(inputPath).filename().string() }, { "fileSize", sidecar.fileSize },
+            { "frames", std::move(frames) }, { "audio", std::move(audio) } };
+
+        const fs::path tmp = path.string() + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            out << j.dump(1) << std::endl;
+            if (!out) return false;
+        }
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+        return !ec;
+    }
+
+    // Reads (and in a full pass decodes) every frame, with threads claiming batches from a
+    // shared counter. expected holds the sidecar hashes in hash-only mode, else null.
+    void checkFrames(const motioncam::Decoder& decoder, bool decode, const std::vector<uint64_t>* expected,
+        unsigned numThreads, std::vector<FrameResult>& results) {
+        const std::vector<motioncam::Timestamp>& frames = decoder.getFrames();
+        results.assign(frames.size(), FrameResult{});
+        std::atomic<size_t> nextFrame{ 0 };
+
+        auto worker = [&]() {
+            std::vector<motioncam::Timestamp> batch;
+            std::vector<motioncam::FramePayload> payloads;
+            std::vector<uint16_t> bayer;
+            for (;;) {
+                const size_t first = nextFrame.fetch_add(kBatchFrames);
+                if (first >= frames.size()) return;
+                const size_t last = std::min(frames.size(), first + kBatchFrames);
+                batch.assign(frames.begin() + first, frames.begin() + last);
+                try {
+                    decoder.getRawFramePayloads(batch, payloads);
+                }
+                catch (const std::exception&) {
+                    for (size_t i = first; i < last; ++i) results[i].status = FrameStatus::BadRecord;
+                    continue;
+                }
+                for (size_t k = 0; k < payloads.size(); ++k) {
+                    const motioncam::FramePayload& payload = payloads[k];
+                    FrameResult& result = results[first + k];
+                    if (payload.compressedPayload.empty() || payload.metadataPayload.empty()) {
+                        result.status = FrameStatus::BadRecord;
+                        continue;
+                    }
+                    result.bytes = payload.compressedPayload.size() + payload.metadataPayload.size();
+                    result.hash = XxHash64::hash(payload.compressedPayload.data(), payload.compressedPayload.size());
+                    if (!payload.valid) {
+                        result.status = FrameStatus::BadMetadata;
+                    }
+                    else if (expected && (*expected)[first + k] != result.hash) {
+                        result.status = FrameStatus::HashMismatch;
+                    }
+                    else if (decode) {
+                        bool decoded = false;
+                        try {
+                            decoded = HeadlessExport::decodeFramePayload(payload.compressedPayload, payload.width, payload.height,
+                                payload.compressionType, bayer);
+                        }
+                        catch (const std::exception&) {
+                        }
+                        result.status = decoded ? FrameStatus::Ok : FrameStatus::DecodeFailed;
+                    }
+                    else {
+                        result.status = FrameStatus::Ok;
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < numThreads; ++t) threads.emplace_back(worker);
+        worker();
+        for (std::thread& thread : threads) thread.join();
+    }
+
+    // Walks the audio index in order, checking each chunk's item headers. Returns false with
+    // error set at the first unreadable chunk; the loader throws on one cut short by the end
+    // of the file, so only whole chunks are hashed.
+    bool checkAudio(const motioncam::Decoder& decoder, std::vector<ChunkResult>& chunks, std::string& error) {
+        chunks.clear();
+        try {
+            std::unique_ptr<motioncam::AudioChunkLoader> loader = decoder.makeAudioLoader();
+            motioncam::AudioChunk chunk;
+            while (loader->next(chunk)) {
+                ChunkResult result;
+                result.timestamp = chunk.first;
+                result.bytes = chunk.second.size() * sizeof(int16_t);
+                result.hash = XxHash64::hash(chunk.second.data(), result.bytes);
+                chunks.push_back(result);
+            }
+        }
+        catch (const std::exception& e) {
+            error = "audio chunk " + std::to_string(chunks.size()) + ": " + e.what();
+            return false;
+        }
+        return true;
+    }
+}
+
+namespace HeadlessExport {
+
+int runVerify(const std::vector<std::string>& args) {
+    std::string inputPath;
+    bool forceFull = false;
+    unsigned threads = 0;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads = static_cast<unsigned>(std::max(0, std::atoi(args[++i].c_str())));
+        }
+        else if (args[i] == "--full") {
+            forceFull = true;
+        }
+        else if (inputPath.empty()) {
+            inputPath = args[i];
+        }
+        else {
+            return 1;
+        }
+    }
+    if (inputPath.empty()) return 1;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::unique_ptr<motioncam::Decoder> decoder;
+    try {
+        decoder = std::make_unique<motioncam::Decoder>(inputPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "FAILED: " << inputPath << ": container index unreadable: " << e.what() << std::endl;
+        return 2;
+    }
+    const std::vector<motioncam::Timestamp>& frames = decoder->getFrames();
+    const uint64_t fileSize = decoder->getByteSource().size();
+
+    // With a matching sidecar, hashing alone re-verifies the clip at disk speed.
+    const fs::path sidecarFile = sidecarPath(inputPath);
+    Sidecar sidecar;
+    bool hashOnly = false;
+    std::error_code ec;
+    if (!forceFull && fs::exists(sidecarFile, ec)) {
+        std::string error;
+        if (!loadSidecar(sidecarFile, sidecar, error)) {
+            std::cerr << "Ignoring " << sidecarFile.filename().string() << " (" << error << "); running a full verification." << std::endl;
+        }
+        else if (sidecar.fileSize != fileSize || sidecar.timestamps != frames) {
+            std::cerr << "FAILED: " << inputPath << ": size or frame index differs from " << sidecarFile.filename().string()
+                << " (" << sidecar.timestamps.size() << " frames, " << sidecar.fileSize << " bytes recorded; "
+                << frames.size() << " frames, " << fileSize << " bytes found)" << std::endl;
+            return 2;
+        }
+        else {
+            hashOnly = true;
+        }
+    }
+    std::cerr << (hashOnly ? "Hash check against " + sidecarFile.filename().string() : std::string("Full verification"))
+        << ": " << frames.size() << " frames on " << threads << " threads" << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Audio is read in index order on its own thread while the frame workers run.
+    std::vector<ChunkResult> audio;
+    std::string audioError;
+    bool audioOk = true;
+    std::thread audioThread([&] { audioOk = checkAudio(*decoder, audio, audioError); });
+
+    std::vector<FrameResult> results;
+    checkFrames(*decoder, !hashOnly, hashOnly ? &sidecar.frameHashes : nullptr, threads, results);
+    audioThread.join();
+
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (audioOk && hashOnly) {
+        if (audio.size() != sidecar.audio.size()) {
+            audioOk = false;
+            audioError = std::to_string(audio.size()) + " audio chunks, sidecar records " + std::to_string(sidecar.audio.size());
+        }
+        for (size_t i = 0; audioOk && i < audio.size(); ++i) {
+            if (audio[i].hash != sidecar.audio[i].hash || audio[i].timestamp != sidecar.audio[i].timestamp) {
+                audioOk = false;
+                audioError = "audio chunk " + std::to_string(i) + " differs from the sidecar hash";
+            }
+        }
+    }
+
+    size_t badFrames = 0;
+    size_t firstBad = results.size();
+    double bytes = 0.0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        bytes += static_cast<double>(results[i].bytes);
+        if (results[i].status != FrameStatus::Ok) {
+            ++badFrames;
+            firstBad = std::min(firstBad, i);
+        }
+    }
+    for (const ChunkResult& chunk : audio) bytes += static_cast<double>(chunk.bytes);
+
+    std::cerr << std::fixed << std::setprecision(2) << "Checked " << frames.size() << " frames and " << audio.size()
+        << " audio chunks in " << secs << " s (" << std::setprecision(1) << (secs > 0.0 ? frames.size() / secs : 0.0)
+        << " frames/s, " << (secs > 0.0 ? bytes / secs / (1024.0 * 1024.0) : 0.0) << " MB/s)" << std::endl;
+
+    if (badFrames > 0) {
+        std::cerr << "FAILED: " << badFrames << " bad frame(s); first is frame " << firstBad << " (timestamp "
+            << frames[firstBad] << "): " << statusText(results[firstBad].status) << std::endl;
+    }
+    if (!audioOk) {
+        std::cerr << "FAILED: " << audioError << std::endl;
+    }
+    if (badFrames > 0 || !audioOk) return 2;
+
+    if (!hashOnly) {
+        // Only a clip that decoded completely gets a sidecar; it is the reference for later checks.
+        sidecar = Sidecar{};
+        sidecar.fileSize = fileSize;
+        sidecar.timestamps = frames;
+        for (const FrameResult& result : results) sidecar.frameHashes.push_back(result.hash);
+        sidecar.audio = audio;
+        if (!saveSidecar(sidecarFile, inputPath, sidecar)) {
+            std::cerr << "OK, but failed to write " << sidecarFile.string() << std::endl;
+            return 0;
+        }
+        std::cerr << "OK; hashes written to " << sidecarFile.string() << std::endl;
+    }
+    else {
+        std::cerr << "OK; matches " << sidecarFile.filename().string() << std::endl;
+    }
+    return 0;
+}
+
+} // namespace HeadlessExport
@@ -0,0 +1,427 @@
+// FILE: src/Export/CpuImagePipeline.cpp
+#include "Export/CpuImagePipeline.h"
+#include "Utils/DebugLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <simde/x86/sse2.h>
+
+namespace CpuImagePipeline {
+
+namespace {
+    constexpr int kBandRows = 32;
+    constexpr int kSrgbLutSegments = 16384;
+    constexpr int kApron = 2;                   // Same as APRON in demosaic.comp: MHC reads +-2 pixels
+    constexpr int kWindowRows = 2 * kApron + 1;
+
+    enum Channel { CH_R = 0, CH_G = 1, CH_B = 2 };
+
+    // Colour at (y & 1, x & 1) for each cfaType, matching kShift/kSelect in demosaic.comp.
+    constexpr int kCfaPattern[4][4] = {
+        { CH_B, CH_G, CH_G, CH_R }, // BGGR
+        { CH_R, CH_G, CH_G, CH_B }, // RGGB
+        { CH_G, CH_B, CH_R, CH_G }, // GBRG
+        { CH_G, CH_R, CH_B, CH_G }, // GRBG
+    };
+
+    float srgbOetf(float v) {
+        v = std::clamp(v, 0.0f, 1.0f);
+        return (v <= 0.0031308f) ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+    }
+
+    const std::vector<float>& srgbLut() {
+        static const std::vector<float> lut = [] {
+            std::vector<float> t(kSrgbLutSegments + 2);
+            for (int i = 0; i <= kSrgbLutSegments; ++i) {
+                t[i] = srgbOetf(static_cast<float>(i) / kSrgbLutSegments);
+            }
+            t[kSrgbLutSegments + 1] = t[kSrgbLutSegments];
+            return t;
+        }();
+        return lut;
+    }
+
+    inline float srgbFromLut(const float* lut, float v) {
+        const float pos = v * kSrgbLutSegments;
+        const int i = static_cast<int>(pos);
+        const float f = pos - static_cast<float>(i);
+        return lut[i] + (lut[i + 1] - lut[i]) * f;
+    }
+
+    // Same as mirrorCoord in demosaic.comp: reflect without repeating the edge sample, so the
+    // neighbour across the border has the same CFA colour as the one inside it.
+    inline int mirrorCoord(int v, int size) {
+        v = std::abs(v);
+        return (v >= size) ? std::max(2 * size - 2 - v, 0) : v;
+    }
+
+    // Linearises one source row into dst[kApron..kApron+W-1] and mirrors the border samples into
+    // the apron on both sides, matching the shader's tile fetch.
+    void linearizeRow(const uint16_t* src, int width, const Params& p, float* dst) {
+        const float scale = p.invBlackWhiteRange;
+        for (int x = 0; x < width; ++x) {
+            const float t = (static_cast<float>(src[x]) - p.blackLevel) * scale;
+            dst[x + kApron] = std::clamp(t * p.exposure, 0.0f, 1.0f);
+        }
+        for (int a = 1; a <= kApron; ++a) {
+            dst[kApron - a] = dst[mirrorCoord(-a, width) + kApron];
+            dst[kApron + width - 1 + a] = dst[mirrorCoord(width - 1 + a, width) + kApron];
+        }
+    }
+
+    // rows[k] holds source row y + k - kApron, padded as linearizeRow leaves it.
+    void demosaicRowBilinear(const float* const rows[kWindowRows],
+        int width, int y, int cfaType, float* r, float* g, float* b)
+    {
+        const float* prev = rows[kApron - 1];
+        const float* cur = rows[kApron];
+        const float* next = rows[kApron + 1];
+        float* planes[3] = { r, g, b };
+        const int py = y & 1;
+
+        for (int px = 0; px < 2; ++px) {
+            const int native = kCfaPattern[cfaType][py * 2 + px];
+
+            if (native == CH_G) {
+                // Horizontal neighbours carry the colour of the other site in this row.
+                const int hColour = kCfaPattern[cfaType][py * 2 + (1 - px)];
+                float* hDst = planes[hColour];
+                float* vDst = planes[hColour == CH_R ? CH_B : CH_R];
+                for (int x = px; x < width; x += 2) {
+                    const int i = x + kApron;
+                    g[x] = cur[i];
+                    hDst[x] = 0.5f * (cur[i + 1] + cur[i - 1]);
+                    vDst[x] = 0.5f * (next[i] + prev[i]);
+                }
+            }
+            else {
+                float* nDst = planes[native];
+                float* dDst = planes[native == CH_R ? CH_B : CH_R];
+                for (int x = px; x < width; x += 2) {
+                    const int i = x + kApron;
+                    nDst[x] = cur[i];
+                    g[x] = 0.25f * (cur[i + 1] + cur[i - 1] + next[i] + prev[i]);
+                    dDst[x] = 0.25f * (next[i + 1] + next[i - 1] + prev[i + 1] + prev[i - 1]);
+                }
+            }
+        }
+    }
+
+    // Malvar-He-Cutler: the bilinear estimates corrected by the Laplacian of the centre channel,
+    // with the same coefficients and estimate selection as ALGORITHM 1 in demosaic.comp.
+    void demosaicRowMhc(const float* const rows[kWindowRows],
+        int width, int y, int cfaType, float* r, float* g, float* b)
+    {
+        const float* up2 = rows[0];
+        const float* up1 = rows[1];
+        const float* cur = rows[2];
+        const float* dn1 = rows[3];
+        const float* dn2 = rows[4];
+        float* planes[3] = { r, g, b };
+
+        // Estimate index per output channel for each site of an RGGB-aligned quad (kSelect in the shader):
+        // 0 centre, 1 G at R/B, 2 horizontal neighbours' colour, 3 vertical, 4 diagonal.
+        constexpr int kShift[4][2] = { { 1, 1 }, { 0, 0 }, { 0, 1 }, { 1, 0 } };
+        constexpr int kSelect[4][3] = { { 0, 1, 4 }, { 2, 0, 3 }, { 3, 0, 2 }, { 4, 1, 0 } };
+        const int qy = (y + kShift[cfaType][1]) & 1;
+
+        for (int px = 0; px < 2; ++px) {
+            const int qx = (px + kShift[cfaType][0]) & 1;
+            const int* sel = kSelect[qy * 2 + qx];
+            for (int x = px; x < width; x += 2) {
+                const int i = x + kApron;
+                const float c = cur[i];
+                const float a1h = cur[i - 1] + cur[i + 1];
+                const float a1v = up1[i] + dn1[i];
+                const float a2h = cur[i - 2] + cur[i + 2];
+                const float a2v = up2[i] + dn2[i];
+                const float dg = up1[i - 1] + up1[i + 1] + dn1[i - 1] + dn1[i + 1];
+
+                const float est[5] = {
+                    c,
+                    (4.0f * c + 2.0f * (a1h + a1v) - (a2h + a2v)) * 0.125f,
+                    (5.0f * c + 4.0f * a1h - a2h + 0.5f * a2v - dg) * 0.125f,
+                    (5.0f * c + 4.0f * a1v - a2v + 0.5f * a2h - dg) * 0.125f,
+                    (6.0f * c + 2.0f * dg - 1.5f * (a2h + a2v)) * 0.125f };
+
+                for (int ch = 0; ch < 3; ++ch) {
+                    planes[ch][x] = std::clamp(est[sel[ch]], 0.0f, 1.0f);
+                }
+            }
+        }
+    }
+
+    // WB gains, CCM and saturation, four pixels at a time. Results stay linear.
+    void colourRow(float* r, float* g, float* b, int width, const Params& p) {
+        const simde__m128 zero = simde_mm_setzero_ps();
+        const simde__m128 one = simde_mm_set1_ps(1.0f);
+        const simde__m128 gR = simde_mm_set1_ps(p.gainR);
+        const simde__m128 gG = simde_mm_set1_ps(p.gainG);
+        const simde__m128 gB = simde_mm_set1_ps(p.gainB);
+        simde__m128 m[9];
+        for (int i = 0; i < 9; ++i) m[i] = simde_mm_set1_ps(p.ccm[i]);
+        const simde__m128 lumR = simde_mm_set1_ps(0.2126f);
+        const simde__m128 lumG = simde_mm_set1_ps(0.7152f);
+        const simde__m128 lumB = simde_mm_set1_ps(0.0722f);
+        const simde__m128 sat = simde_mm_set1_ps(p.saturation);
+        const simde__m128 invSat = simde_mm_set1_ps(1.0f - p.saturation);
+
+        auto clamp01 = [&](simde__m128 v) { return simde_mm_min_ps(simde_mm_max_ps(v, zero), one); };
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            const simde__m128 rw = clamp01(simde_mm_mul_ps(simde_mm_loadu_ps(r + x), gR));
+            const simde__m128 gw = clamp01(simde_mm_mul_ps(simde_mm_loadu_ps(g + x), gG));
+            const simde__m128 bw = clamp01(simde_mm_mul_ps(simde_mm_loadu_ps(b + x), gB));
+
+            const simde__m128 rc = clamp01(simde_mm_add_ps(simde_mm_add_ps(simde_mm_mul_ps(m[0], rw), simde_mm_mul_ps(m[1], gw)), simde_mm_mul_ps(m[2], bw)));
+            const simde__m128 gc = clamp01(simde_mm_add_ps(simde_mm_add_ps(simde_mm_mul_ps(m[3], rw), simde_mm_mul_ps(m[4], gw)), simde_mm_mul_ps(m[5], bw)));
+            const simde__m128 bc = clamp01(simde_mm_add_ps(simde_mm_add_ps(simde_mm_mul_ps(m[6], rw), simde_mm_mul_ps(m[7], gw)), simde_mm_mul_ps(m[8], bw)));
+
+            const simde__m128 lum = simde_mm_add_ps(simde_mm_add_ps(simde_mm_mul_ps(rc, lumR), simde_mm_mul_ps(gc, lumG)), simde_mm_mul_ps(bc, lumB));
+            const simde__m128 lumMix = simde_mm_mul_ps(lum, invSat);
+
+            simde_mm_storeu_ps(r + x, clamp01(simde_mm_add_ps(lumMix, simde_mm_mul_ps(rc, sat))));
+            simde_mm_storeu_ps(g + x, clamp01(simde_mm_add_ps(lumMix, simde_mm_mul_ps(gc, sat))));
+            simde_mm_storeu_ps(b + x, clamp01(simde_mm_add_ps(lumMix, simde_mm_mul_ps(bc, sat))));
+        }
+
+        for (; x < width; ++x) {
+            const float rw = std::clamp(r[x] * p.gainR, 0.0f, 1.0f);
+            const float gw = std::clamp(g[x] * p.gainG, 0.0f, 1.0f);
+            const float bw = std::clamp(b[x] * p.gainB, 0.0f, 1.0f);
+            const float rc = std::clamp(p.ccm[0] * rw + p.ccm[1] * gw + p.ccm[2] * bw, 0.0f, 1.0f);
+            const float gc = std::clamp(p.ccm[3] * rw + p.ccm[4] * gw + p.ccm[5] * bw, 0.0f, 1.0f);
+            const float bc = std::clamp(p.ccm[6] * rw + p.ccm[7] * gw + p.ccm[8] * bw, 0.0f, 1.0f);
+            const float lumMix = (rc * 0.2126f + gc * 0.7152f + bc * 0.0722f) * (1.0f - p.saturation);
+            r[x] = std::clamp(lumMix + rc * p.saturation, 0.0f, 1.0f);
+            g[x] = std::clamp(lumMix + gc * p.saturation, 0.0f, 1.0f);
+            b[x] = std::clamp(lumMix + bc * p.saturation, 0.0f, 1.0f);
+        }
+    }
+
+    void processBand(const uint16_t* bayer, int width, int height, int y0, int y1,
+        const Params& p, Output output, uint16_t* outRgb, std::vector<float>& scratch)
+    {
+        const size_t paddedW = static_cast<size_t>(width) + 2 * kApron;
+        scratch.resize(paddedW * kWindowRows + static_cast<size_t>(width) * 3);
+        float* linRows[kWindowRows];
+        int linRowY[kWindowRows];
+        for (int i = 0; i < kWindowRows; ++i) {
+            linRows[i] = scratch.data() + paddedW * i;
+            linRowY[i] = -1;
+        }
+        float* r = scratch.data() + paddedW * kWindowRows;
+        float* g = r + width;
+        float* b = g + width;
+
+        auto fetchLin = [&](int sy) -> const float* {
+            sy = mirrorCoord(sy, height);
+            for (int i = 0; i < kWindowRows; ++i) {
+                if (linRowY[i] == sy) return linRows[i];
+            }
+            // Evict the slot holding the lowest row; rows are consumed top to bottom.
+            int slot = 0;
+            for (int i = 1; i < kWindowRows; ++i) {
+                if (linRowY[i] < linRowY[slot]) slot = i;
+            }
+            linearizeRow(bayer + static_cast<size_t>(sy) * width, width, p, linRows[slot]);
+            linRowY[slot] = sy;
+            return linRows[slot];
+        };
+
+        const float* lut = srgbLut().data();
+
+        for (int y = y0; y < y1; ++y) {
+            const float* rows[kWindowRows];
+            for (int k = 0; k < kWindowRows; ++k) rows[k] = fetchLin(y + k - kApron);
+
+            if (p.algorithm == 1) demosaicRowMhc(rows, width, y, p.cfaType, r, g, b);
+            else demosaicRowBilinear(rows, width, y, p.cfaType, r, g, b);
+            colourRow(r, g, b, width, p);
+
+            uint16_t* dst = outRgb + static_cast<size_t>(y) * width * 3;
+            if (output == Output::SRGB_U16) {
+                for (int x = 0; x < width; ++x) {
+                    dst[x * 3 + 0] = static_cast<uint16_t>(srgbFromLut(lut, r[x]) * 65535.0f + 0.5f);
+                    dst[x * 3 + 1] = static_cast<uint16_t>(srgbFromLut(lut, g[x]) * 65535.0f + 0.5f);
+                    dst[x * 3 + 2] = static_cast<uint16_t>(srgbFromLut(lut, b[x]) * 65535.0f + 0.5f);
+                }
+            }
+            else {
+                for (int x = 0; x < width; ++x) {
+                    dst[x * 3 + 0] = floatToHalf(r[x]);
+                    dst[x * 3 + 1] = floatToHalf(g[x]);
+                    dst[x * 3 + 2] = floatToHalf(b[x]);
+                }
+            }
+        }
+    }
+}
+
+int cfaTypeFromString(const std::string& arrangement) {
+    std::string upper = arrangement;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+        [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (upper == "BGGR") return 0;
+    if (upper == "RGGB") return 1;
+    if (upper == "GBRG") return 2;
+    if (upper == "GRBG") return 3;
+    LogToFile(std::string("[CpuImagePipeline::cfaTypeFromString] Unknown CFA pattern: ") + arrangement + ". Defaulting to BGGR (0).");
+    return 0;
+}
+
+int algorithmFromString(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "bilinear") return 0;
+    if (lower == "mhc" || lower == "malvar-he-cutler") return 1;
+    return -1;
+}
+
+Params paramsFromMetadata(const nlohmann::json& frameMetadata,
+    const nlohmann::json& containerMetadata,
+    std::optional<int> cfaOverride)
+{
+    Params p;
+
+    std::vector<double> blackLevelVec = containerMetadata.value("blackLevel", std::vector<double>{});
+    double staticBlack = 0.0;
+    if (!blackLevelVec.empty()) {
+        for (double v : blackLevelVec) staticBlack += v;
+        staticBlack /= static_cast<double>(blackLevelVec.size());
+    }
+    const double staticWhite = containerMetadata.value("whiteLevel", 65535.0);
+
+    p.cfaType = cfaOverride.value_or(cfaTypeFromString(
+        containerMetadata.value("sensorArrangment", containerMetadata.value("sensorArrangement", "BGGR"))));
+
+    float blackLvl = static_cast<float>(staticBlack);
+    if (frameMetadata.contains("dynamicBlackLevel")) {
+        const auto& jb = frameMetadata.at("dynamicBlackLevel");
+        if (jb.is_array() && !jb.empty()) {
+            double sum = 0.0;
+            size_t count = 0;
+            for (const auto& v : jb) {
+                if (v.is_number()) { sum += v.get<double>(); count++; }
+            }
+            if (count > 0) blackLvl = static_cast<float>(sum / count);
+        }
+        else if (jb.is_number()) {
+            blackLvl = jb.get<float>();
+        }
+    }
+    p.blackLevel = blackLvl;
+
+    float whiteLvl = static_cast<float>(staticWhite);
+    if (frameMetadata.contains("dynamicWhiteLevel") && frameMetadata.at("dynamicWhiteLevel").is_number()) {
+        whiteLvl = frameMetadata.at("dynamicWhiteLevel").get<float>();
+    }
+    p.whiteLevel = whiteLvl;
+    const float range = p.whiteLevel - p.blackLevel;
+    p.invBlackWhiteRange = (range <= 1e-5f) ? 1.0f : (1.0f / range);
+
+    std::vector<double> asn = { 1.0, 1.0, 1.0 };
+    auto asnJson = frameMetadata.value("asShotNeutral", nlohmann::json::array({ 1.0, 1.0, 1.0 }));
+    if (asnJson.is_array() && asnJson.size() >= 3) {
+        std::vector<double> tmp;
+        for (const auto& e : asnJson) {
+            if (!e.is_number()) { tmp.clear(); break; }
+            tmp.push_back(e.get<double>());
+        }
+        if (tmp.size() >= 3) asn = tmp;
+    }
+    p.gainG = 1.0f;
+    p.gainR = (asn[0] > 1e-6 && asn[1] > 1e-6) ? static_cast<float>(asn[1] / asn[0]) : 1.0f;
+    p.gainB = (asn[2] > 1e-6 && asn[1] > 1e-6) ? static_cast<float>(asn[1] / asn[2]) : 1.0f;
+
+    const nlohmann::json* ccmJson = nullptr;
+    if (frameMetadata.contains("ColorMatrix2") && frameMetadata.at("ColorMatrix2").is_array() && frameMetadata.at("ColorMatrix2").size() == 9) {
+        ccmJson = &frameMetadata.at("ColorMatrix2");
+    }
+    else if (frameMetadata.contains("ColorMatrix") && frameMetadata.at("ColorMatrix").is_array() && frameMetadata.at("ColorMatrix").size() == 9) {
+        ccmJson = &frameMetadata.at("ColorMatrix");
+    }
+    if (ccmJson) {
+        float m[9];
+        bool valid = true;
+        for (int i = 0; i < 9 && valid; ++i) {
+            valid = ccmJson->at(i).is_number();
+            if (valid) m[i] = ccmJson->at(i).get<float>();
+        }
+        if (valid) std::memcpy(p.ccm, m, sizeof(m));
+    }
+
+    p.exposure = 1.0f;
+    p.saturation = 1.50f;
+    return p;
+}
+
+void process(const uint16_t* bayer, int width, int height, const Params& params,
+    Output output, uint16_t* outRgb, unsigned numThreads)
+{
+    if (!bayer || !outRgb || width <= 0 || height <= 0) return;
+
+    Params p = params;
+    p.cfaType = std::clamp(p.cfaType, 0, 3);
+    p.algorithm = std::clamp(p.algorithm, 0, 1);
+
+    if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+    const int numBands = (height + kBandRows - 1) / kBandRows;
+    numThreads = std::min<unsigned>(numThreads, static_cast<unsigned>(numBands));
+
+    srgbLut(); // Build the table before workers race for it.
+
+    std::atomic<int> nextBand{ 0 };
+    auto worker = [&]() {
+        std::vector<float> scratch;
+        for (int band = nextBand.fetch_add(1); band < numBands; band = nextBand.fetch_add(1)) {
+            const int y0 = band * kBandRows;
+            const int y1 = std::min(height, y0 + kBandRows);
+            processBand(bayer, width, height, y0, y1, p, output, outRgb, scratch);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads > 0 ? numThreads - 1 : 0);
+    for (unsigned i = 1; i < numThreads; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+}
+
+uint16_t floatToHalf(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (((bits >> 23) & 0xFFu) == 0xFFu) { // Inf / NaN
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+    if (exponent >= 0x1F) {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000u;
+        const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t rem = mantissa & ((1u << shift) - 1u);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (rem > halfway || (rem == halfway && (half & 1u))) ++half;
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    const uint32_t rem = mantissa & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (half & 1u))) ++half; // May carry into the exponent, which is correct
+    return static_cast<uint16_t>(sign | half);
+}
+
+} // namespace CpuImagePipeline
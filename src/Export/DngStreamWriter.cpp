@@ -0,0 +1,348 @@
+// FILE: src/Export/DngStreamWriter.cpp
+#include "Export/DngStreamWriter.h"
+#include "Utils/DebugLog.h"
+#include <motioncam/RawData.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr int MC_COMPRESSION_TYPE_NEW = 7;
+    constexpr int MC_COMPRESSION_TYPE_LEGACY = 6;
+
+    // TIFF field types
+    constexpr uint16_t TIFF_BYTE = 1;
+    constexpr uint16_t TIFF_ASCII = 2;
+    constexpr uint16_t TIFF_SHORT = 3;
+    constexpr uint16_t TIFF_LONG = 4;
+    constexpr uint16_t TIFF_RATIONAL = 5;
+    constexpr uint16_t TIFF_SRATIONAL = 10;
+
+    // Pixel strip is aligned so streaming decoders write to aligned rows.
+    constexpr uint32_t kPixelAlignment = 64;
+
+    void putU16(std::vector<uint8_t>& out, uint16_t v) {
+        out.push_back(static_cast<uint8_t>(v & 0xFF));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+    }
+
+    void putU32(std::vector<uint8_t>& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
+    }
+
+    std::vector<float> readMatrix(const nlohmann::json& containerMetadata, const char* key, const char* altKey) {
+        std::vector<float> m = { 1,0,0, 0,1,0, 0,0,1 };
+        nlohmann::json j = containerMetadata.value(key, containerMetadata.value(altKey, nlohmann::json::array({ 1,0,0,0,1,0,0,0,1 })));
+        if (j.is_array() && j.size() == 9) {
+            for (size_t i = 0; i < 9; ++i) m[i] = j[i].get<float>();
+        }
+        return m;
+    }
+}
+
+DngStreamWriter::DngStreamWriter(uint32_t width, uint32_t height,
+    const nlohmann::json& frameMetadata,
+    const nlohmann::json& containerMetadata)
+    : m_width(width), m_height(height)
+{
+    if (width == 0 || height == 0) {
+        throw std::runtime_error("Invalid frame dimensions (width or height is zero).");
+    }
+    if (static_cast<uint64_t>(width) * height * sizeof(uint16_t) > 0xFFFFFFFFull - 65536) {
+        throw std::runtime_error("Frame too large for a classic TIFF strip.");
+    }
+    buildLayout(frameMetadata, containerMetadata);
+    serializeHeader();
+}
+
+DngStreamWriter::~DngStreamWriter() {
+    abortOutput();
+}
+
+void DngStreamWriter::buildLayout(const nlohmann::json& frameMetadata, const nlohmann::json& containerMetadata) {
+    auto addShorts = [this](uint16_t tag, std::initializer_list<uint16_t> values) {
+        Entry e{ tag, TIFF_SHORT, static_cast<uint32_t>(values.size()), {} };
+        for (uint16_t v : values) putU16(e.data, v);
+        m_entries.push_back(std::move(e));
+    };
+    auto addLongs = [this](uint16_t tag, std::initializer_list<uint32_t> values) {
+        Entry e{ tag, TIFF_LONG, static_cast<uint32_t>(values.size()), {} };
+        for (uint32_t v : values) putU32(e.data, v);
+        m_entries.push_back(std::move(e));
+    };
+    auto addBytes = [this](uint16_t tag, std::initializer_list<uint8_t> values) {
+        Entry e{ tag, TIFF_BYTE, static_cast<uint32_t>(values.size()), std::vector<uint8_t>(values) };
+        m_entries.push_back(std::move(e));
+    };
+    auto addRationals = [this](uint16_t tag, const std::vector<float>& values, bool isSigned) {
+        Entry e{ tag, isSigned ? TIFF_SRATIONAL : TIFF_RATIONAL, static_cast<uint32_t>(values.size()), {} };
+        for (float v : values) {
+            const int32_t den = 10000;
+            int32_t num = static_cast<int32_t>(std::lround(static_cast<double>(v) * den));
+            if (!isSigned && num < 0) num = 0;
+            putU32(e.data, static_cast<uint32_t>(num));
+            putU32(e.data, static_cast<uint32_t>(den));
+        }
+        m_entries.push_back(std::move(e));
+    };
+
+    std::vector<double> asShotNeutralDouble = frameMetadata.value("asShotNeutral", std::vector<double>{1.0, 1.0, 1.0});
+    std::vector<float> asShotNeutral;
+    for (double v : asShotNeutralDouble) asShotNeutral.push_back(static_cast<float>(v));
+    if (asShotNeutral.size() != 3) asShotNeutral = { 1.0f, 1.0f, 1.0f };
+
+    std::vector<double> blackLevelDouble = containerMetadata.value("blackLevel", std::vector<double>{0.0, 0.0, 0.0, 0.0});
+    if (blackLevelDouble.empty()) {
+        blackLevelDouble = { 0.0, 0.0, 0.0, 0.0 };
+    }
+    else if (blackLevelDouble.size() != 4) {
+        // A single value is replicated; other unexpected counts are padded with the first level.
+        blackLevelDouble.resize(4, blackLevelDouble[0]);
+    }
+    uint16_t blackLevel[4];
+    for (size_t i = 0; i < 4; ++i) {
+        blackLevel[i] = static_cast<uint16_t>(std::clamp(std::round(blackLevelDouble[i]), 0.0, 65535.0));
+    }
+    const double whiteLevel = containerMetadata.value("whiteLevel", 65535.0);
+
+    std::string sensorArrangement = containerMetadata.value("sensorArrangement",
+        containerMetadata.value("sensorArrangment", "BGGR"));
+    std::string cfaUpper = sensorArrangement;
+    std::transform(cfaUpper.begin(), cfaUpper.end(), cfaUpper.begin(), ::toupper);
+    uint8_t cfa[4];
+    if (cfaUpper == "RGGB")      { cfa[0] = 0; cfa[1] = 1; cfa[2] = 1; cfa[3] = 2; }
+    else if (cfaUpper == "BGGR") { cfa[0] = 2; cfa[1] = 1; cfa[2] = 1; cfa[3] = 0; }
+    else if (cfaUpper == "GRBG") { cfa[0] = 1; cfa[1] = 0; cfa[2] = 2; cfa[3] = 1; }
+    else if (cfaUpper == "GBRG") { cfa[0] = 1; cfa[1] = 2; cfa[2] = 0; cfa[3] = 1; }
+    else {
+        throw std::runtime_error("Invalid or unsupported sensorArrangement for DNG CFA pattern: " + sensorArrangement);
+    }
+
+    const uint32_t stripBytes = static_cast<uint32_t>(pixelBytes());
+
+    addLongs(254, { 0 });                          // NewSubfileType
+    addLongs(256, { m_width });                    // ImageWidth
+    addLongs(257, { m_height });                   // ImageLength
+    addShorts(258, { 16 });                        // BitsPerSample
+    addShorts(259, { 1 });                         // Compression: none
+    addShorts(262, { 32803 });                     // PhotometricInterpretation: CFA
+    addLongs(273, { 0 });                          // StripOffsets (patched in serializeHeader)
+    addShorts(277, { 1 });                         // SamplesPerPixel
+    addLongs(278, { m_height });                   // RowsPerStrip
+    addLongs(279, { stripBytes });                 // StripByteCounts
+    addShorts(284, { 1 });                         // PlanarConfiguration: contiguous
+    addShorts(33421, { 2, 2 });                    // CFARepeatPatternDim
+    addBytes(33422, { cfa[0], cfa[1], cfa[2], cfa[3] }); // CFAPattern
+    addBytes(50706, { 1, 4, 0, 0 });               // DNGVersion
+    addBytes(50707, { 1, 1, 0, 0 });               // DNGBackwardVersion
+    {
+        const std::string model = "MotionCam App Player Export";
+        Entry e{ 50708, TIFF_ASCII, static_cast<uint32_t>(model.size() + 1), std::vector<uint8_t>(model.begin(), model.end()) };
+        e.data.push_back(0);
+        m_entries.push_back(std::move(e));
+    }
+    addShorts(50711, { 1 });                       // CFALayout
+    addShorts(50713, { 2, 2 });                    // BlackLevelRepeatDim
+    addShorts(50714, { blackLevel[0], blackLevel[1], blackLevel[2], blackLevel[3] }); // BlackLevel
+    addLongs(50717, { static_cast<uint32_t>(std::clamp(std::round(whiteLevel), 0.0, 65535.0)) }); // WhiteLevel
+    addRationals(50721, readMatrix(containerMetadata, "ColorMatrix", "colorMatrix1"), true);  // ColorMatrix1
+    addRationals(50722, readMatrix(containerMetadata, "ColorMatrix2", "colorMatrix2"), true); // ColorMatrix2
+    addRationals(50728, asShotNeutral, false);     // AsShotNeutral
+    addShorts(50778, { 21 });                      // CalibrationIlluminant1 (D65)
+    addShorts(50779, { 17 });                      // CalibrationIlluminant2 (Standard light A)
+    addLongs(50829, { 0, 0, m_height, m_width });  // ActiveArea
+    addRationals(50964, readMatrix(containerMetadata, "ForwardMatrix1", "forwardMatrix1"), true); // ForwardMatrix1
+    addRationals(50965, readMatrix(containerMetadata, "ForwardMatrix2", "forwardMatrix2"), true); // ForwardMatrix2
+
+    std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) { return a.tag < b.tag; });
+}
+
+void DngStreamWriter::serializeHeader() {
+    const uint32_t ifdOffset = 8;
+    const uint32_t ifdSize = 2 + static_cast<uint32_t>(m_entries.size()) * 12 + 4;
+
+    // Out-of-line values follow the IFD, word aligned.
+    uint32_t dataCursor = ifdOffset + ifdSize;
+    std::vector<uint32_t> valueOffsets(m_entries.size(), 0);
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].data.size() > 4) {
+            dataCursor = (dataCursor + 1) & ~1u;
+            valueOffsets[i] = dataCursor;
+            dataCursor += static_cast<uint32_t>(m_entries[i].data.size());
+        }
+    }
+    m_pixelOffset = (dataCursor + kPixelAlignment - 1) & ~(kPixelAlignment - 1);
+
+    for (auto& e : m_entries) {
+        if (e.tag == 273) {
+            e.data.clear();
+            putU32(e.data, m_pixelOffset);
+        }
+    }
+
+    m_header.clear();
+    m_header.reserve(m_pixelOffset);
+    m_header.push_back('I');
+    m_header.push_back('I');
+    putU16(m_header, 42);
+    putU32(m_header, ifdOffset);
+
+    putU16(m_header, static_cast<uint16_t>(m_entries.size()));
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        const Entry& e = m_entries[i];
+        putU16(m_header, e.tag);
+        putU16(m_header, e.type);
+        putU32(m_header, e.count);
+        if (e.data.size() > 4) {
+            putU32(m_header, valueOffsets[i]);
+        }
+        else {
+            uint8_t inlineValue[4] = { 0, 0, 0, 0 };
+            std::memcpy(inlineValue, e.data.data(), e.data.size());
+            m_header.insert(m_header.end(), inlineValue, inlineValue + 4);
+        }
+    }
+    putU32(m_header, 0); // No further IFDs
+
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].data.size() > 4) {
+            m_header.resize(valueOffsets[i], 0);
+            m_header.insert(m_header.end(), m_entries[i].data.begin(), m_entries[i].data.end());
+        }
+    }
+    m_header.resize(m_pixelOffset, 0);
+}
+
+bool DngStreamWriter::beginOutput(const std::string& outputPath, std::string& errorMsg) {
+    abortOutput();
+    m_outputPath = outputPath;
+
+    {
+        std::ofstream create(outputPath, std::ios::binary | std::ios::trunc);
+        if (!create) {
+            errorMsg = "Failed to create output file: " + outputPath;
+            return false;
+        }
+        create.write(reinterpret_cast<const char*>(m_header.data()), static_cast<std::streamsize>(m_header.size()));
+        if (!create) {
+            errorMsg = "Failed to write DNG header: " + outputPath;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::resize_file(outputPath, fileSize(), ec);
+    if (!ec) {
+        m_map.map(outputPath, ec);
+    }
+    if (!ec && m_map.size() == fileSize()) {
+        m_mapped = true;
+        return true;
+    }
+
+    // Mapping unavailable (e.g. some network shares): decode into a single frame-sized buffer instead.
+    LOG_DEBUG("[DngStreamWriter::beginOutput] Memory mapping unavailable for " + outputPath + " (" + ec.message() + "), using write buffer.");
+    m_map.unmap();
+    m_mapped = false;
+    m_fallbackBuffer.resize(static_cast<size_t>(m_width) * m_height);
+    return true;
+}
+
+uint16_t* DngStreamWriter::pixelTarget() {
+    if (m_mapped) {
+        return reinterpret_cast<uint16_t*>(m_map.data() + m_pixelOffset);
+    }
+    return m_fallbackBuffer.data();
+}
+
+bool DngStreamWriter::finishOutput(std::string& errorMsg) {
+    if (m_mapped) {
+        std::error_code ec;
+        m_map.sync(ec);
+        m_map.unmap();
+        m_mapped = false;
+        if (ec) {
+            errorMsg = "Failed to flush mapped DNG output: " + ec.message();
+            std::error_code rmEc;
+            fs::remove(m_outputPath, rmEc);
+            return false;
+        }
+    }
+    else {
+        std::fstream out(m_outputPath, std::ios::binary | std::ios::in | std::ios::out);
+        if (!out) {
+            errorMsg = "Failed to reopen output file: " + m_outputPath;
+            return false;
+        }
+        out.seekp(m_pixelOffset);
+        out.write(reinterpret_cast<const char*>(m_fallbackBuffer.data()), static_cast<std::streamsize>(pixelBytes()));
+        if (!out) {
+            errorMsg = "Failed to write DNG pixel data: " + m_outputPath;
+            return false;
+        }
+        std::vector<uint16_t>().swap(m_fallbackBuffer);
+    }
+    m_outputPath.clear();
+    return true;
+}
+
+void DngStreamWriter::abortOutput() {
+    if (m_outputPath.empty()) return;
+    m_map.unmap();
+    m_mapped = false;
+    std::vector<uint16_t>().swap(m_fallbackBuffer);
+    std::error_code ec;
+    fs::remove(m_outputPath, ec);
+    m_outputPath.clear();
+}
+
+bool DngStreamWriter::writeFromCompressed(const std::string& outputPath,
+    const uint8_t* payload, size_t payloadSize, int compressionType,
+    std::string& errorMsg)
+{
+    if (!payload || payloadSize == 0) {
+        errorMsg = "Empty compressed payload.";
+        return false;
+    }
+    if (!beginOutput(outputPath, errorMsg)) {
+        abortOutput();
+        return false;
+    }
+
+    uint16_t* dst = pixelTarget();
+    const int w = static_cast<int>(m_width);
+    const int h = static_cast<int>(m_height);
+    bool ok = false;
+
+    if (compressionType == MC_COMPRESSION_TYPE_NEW) {
+        ok = motioncam::raw::Decode(dst, w, h, payload, payloadSize) > 0;
+    }
+    else if (compressionType == MC_COMPRESSION_TYPE_LEGACY) {
+        ok = motioncam::raw::DecodeLegacy(dst, w, h, payload, payloadSize) > 0;
+    }
+    else if (compressionType == 0) {
+        if (payloadSize == pixelBytes()) {
+            std::memcpy(dst, payload, payloadSize);
+            ok = true;
+        }
+    }
+    else {
+        errorMsg = "Unsupported compression type: " + std::to_string(compressionType);
+        abortOutput();
+        return false;
+    }
+
+    if (!ok) {
+        errorMsg = "Failed to decode frame payload (compression type " + std::to_string(compressionType) + ").";
+        abortOutput();
+        return false;
+    }
+    return finishOutput(errorMsg);
+}
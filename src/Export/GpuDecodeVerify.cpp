@@ -0,0 +1,411 @@
+// FILE: src/Export/GpuDecodeVerify.cpp
+#include "Export/HeadlessExport.h"
+#include "Graphics/GpuRawDecoder.h"
+#include "Utils/DebugLog.h"
+#include "Utils/vma_usage.h"
+
+#include <motioncam/Decoder.hpp>
+#include <motioncam/RawData.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern std::string g_AppBasePath;
+
+namespace {
+    constexpr int MC_COMPRESSION_TYPE_NEW = 7;
+
+    // Minimal compute-only device: no window, no swapchain. Any implementation works,
+    // including lavapipe (VK_ICD_FILENAMES=.../lvp_icd.*.json).
+    struct ComputeContext {
+        VkInstance instance = VK_NULL_HANDLE;
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkDevice device = VK_NULL_HANDLE;
+        VkQueue queue = VK_NULL_HANDLE;
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VmaAllocator allocator = VK_NULL_HANDLE;
+
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VmaAllocation stagingAllocation = VK_NULL_HANDLE;
+        void* stagingMapped = nullptr;
+        VkDeviceSize stagingSize = 0;
+
+        VkBuffer readbackBuffer = VK_NULL_HANDLE;
+        VmaAllocation readbackAllocation = VK_NULL_HANDLE;
+        void* readbackMapped = nullptr;
+
+        VkImage image = VK_NULL_HANDLE;
+        VmaAllocation imageAllocation = VK_NULL_HANDLE;
+        VkImageView imageView = VK_NULL_HANDLE;
+        int imageWidth = 0;
+        int imageHeight = 0;
+
+        ~ComputeContext() { destroy(); }
+
+        void destroyFrameResources() {
+            if (imageView != VK_NULL_HANDLE) vkDestroyImageView(device, imageView, nullptr);
+            if (image != VK_NULL_HANDLE) vmaDestroyImage(allocator, image, imageAllocation);
+            if (readbackBuffer != VK_NULL_HANDLE) vmaDestroyBuffer(allocator, readbackBuffer, readbackAllocation);
+            if (stagingBuffer != VK_NULL_HANDLE) vmaDestroyBuffer(allocator, stagingBuffer, stagingAllocation);
+            imageView = VK_NULL_HANDLE;
+            image = VK_NULL_HANDLE;
+            readbackBuffer = VK_NULL_HANDLE;
+            stagingBuffer = VK_NULL_HANDLE;
+            stagingMapped = readbackMapped = nullptr;
+            stagingSize = 0;
+            imageWidth = imageHeight = 0;
+        }
+
+        void destroy() {
+            if (device != VK_NULL_HANDLE) {
+                vkDeviceWaitIdle(device);
+                destroyFrameResources();
+                if (allocator != VK_NULL_HANDLE) vmaDestroyAllocator(allocator);
+                if (fence != VK_NULL_HANDLE) vkDestroyFence(device, fence, nullptr);
+                if (commandPool != VK_NULL_HANDLE) vkDestroyCommandPool(device, commandPool, nullptr);
+                vkDestroyDevice(device, nullptr);
+            }
+            if (instance != VK_NULL_HANDLE) vkDestroyInstance(instance, nullptr);
+            allocator = VK_NULL_HANDLE;
+            fence = VK_NULL_HANDLE;
+            commandPool = VK_NULL_HANDLE;
+            device = VK_NULL_HANDLE;
+            instance = VK_NULL_HANDLE;
+        }
+    };
+
+    bool check(VkResult result, const char* what) {
+        if (result == VK_SUCCESS) return true;
+        std::cerr << what << " failed. Error: " << result << std::endl;
+        return false;
+    }
+
+    bool createContext(ComputeContext& ctx) {
+        VkApplicationInfo appInfo{ VK_STRUCTURE_TYPE_APPLICATION_INFO };
+        appInfo.pApplicationName = "MotionCam Player GPU decode check";
+        appInfo.apiVersion = VK_API_VERSION_1_1;
+        VkInstanceCreateInfo instanceInfo{ VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+        instanceInfo.pApplicationInfo = &appInfo;
+        if (!check(vkCreateInstance(&instanceInfo, nullptr, &ctx.instance), "vkCreateInstance")) return false;
+
+        uint32_t deviceCount = 0;
+        vkEnumeratePhysicalDevices(ctx.instance, &deviceCount, nullptr);
+        std::vector<VkPhysicalDevice> devices(deviceCount);
+        vkEnumeratePhysicalDevices(ctx.instance, &deviceCount, devices.data());
+
+        uint32_t queueFamily = 0;
+        for (VkPhysicalDevice candidate : devices) {
+            if (!GpuRawDecoder::isSupported(candidate)) continue;
+            uint32_t familyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> families(familyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+            for (uint32_t i = 0; i < familyCount; ++i) {
+                if (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
+                    ctx.physicalDevice = candidate;
+                    queueFamily = i;
+                    break;
+                }
+            }
+            if (ctx.physicalDevice != VK_NULL_HANDLE) break;
+        }
+        if (ctx.physicalDevice == VK_NULL_HANDLE) {
+            std::cerr << "No Vulkan device supports R16_UINT storage images; GPU decoding is unavailable." << std::endl;
+            return false;
+        }
+        VkPhysicalDeviceProperties props{};
+        vkGetPhysicalDeviceProperties(ctx.physicalDevice, &props);
+        std::cerr << "Using " << props.deviceName << std::endl;
+
+        const float priority = 1.0f;
+        VkDeviceQueueCreateInfo queueInfo{ VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+        queueInfo.queueFamilyIndex = queueFamily;
+        queueInfo.queueCount = 1;
+        queueInfo.pQueuePriorities = &priority;
+        VkPhysicalDeviceFeatures features{};
+        features.shaderStorageImageExtendedFormats = VK_TRUE;
+        VkDeviceCreateInfo deviceInfo{ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+        deviceInfo.queueCreateInfoCount = 1;
+        deviceInfo.pQueueCreateInfos = &queueInfo;
+        deviceInfo.pEnabledFeatures = &features;
+        if (!check(vkCreateDevice(ctx.physicalDevice, &deviceInfo, nullptr, &ctx.device), "vkCreateDevice")) return false;
+        vkGetDeviceQueue(ctx.device, queueFamily, 0, &ctx.queue);
+
+        VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = queueFamily;
+        if (!check(vkCreateCommandPool(ctx.device, &poolInfo, nullptr, &ctx.commandPool), "vkCreateCommandPool")) return false;
+        VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+        allocInfo.commandPool = ctx.commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        if (!check(vkAllocateCommandBuffers(ctx.device, &allocInfo, &ctx.commandBuffer), "vkAllocateCommandBuffers")) return false;
+        VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+        if (!check(vkCreateFence(ctx.device, &fenceInfo, nullptr, &ctx.fence), "vkCreateFence")) return false;
+
+        VmaAllocatorCreateInfo allocatorInfo{};
+        allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_1;
+        allocatorInfo.physicalDevice = ctx.physicalDevice;
+        allocatorInfo.device = ctx.device;
+        allocatorInfo.instance = ctx.instance;
+        VmaVulkanFunctions vulkanFunctions{};
+        vulkanFunctions.vkGetInstanceProcAddr = vkGetInstanceProcAddr;
+        vulkanFunctions.vkGetDeviceProcAddr = vkGetDeviceProcAddr;
+        allocatorInfo.pVulkanFunctions = &vulkanFunctions;
+        return check(vmaCreateAllocator(&allocatorInfo, &ctx.allocator), "vmaCreateAllocator");
+    }
+
+    bool createHostBuffer(ComputeContext& ctx, VkDeviceSize size, VkBufferUsageFlags usage, bool readback, VkBuffer& buffer, VmaAllocation& allocation, void*& mapped) {
+        VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        bufferInfo.size = size;
+        bufferInfo.usage = usage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+        allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT |
+            (readback ? VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT : VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+        VmaAllocationInfo details{};
+        if (!check(vmaCreateBuffer(ctx.allocator, &bufferInfo, &allocInfo, &buffer, &allocation, &details), "vmaCreateBuffer")) return false;
+        mapped = details.pMappedData;
+        return mapped != nullptr;
+    }
+
+    /// (Re)creates the image, readback and staging buffers for a frame. The new image is left in SHADER_READ_ONLY.
+    bool ensureFrameResources(ComputeContext& ctx, GpuRawDecoder& decoder, int width, int height, VkDeviceSize stagedBytes) {
+        if (width != ctx.imageWidth || height != ctx.imageHeight) {
+            vkDeviceWaitIdle(ctx.device);
+            if (ctx.imageView != VK_NULL_HANDLE) vkDestroyImageView(ctx.device, ctx.imageView, nullptr);
+            if (ctx.image != VK_NULL_HANDLE) vmaDestroyImage(ctx.allocator, ctx.image, ctx.imageAllocation);
+            if (ctx.readbackBuffer != VK_NULL_HANDLE) vmaDestroyBuffer(ctx.allocator, ctx.readbackBuffer, ctx.readbackAllocation);
+            ctx.imageView = VK_NULL_HANDLE;
+            ctx.image = VK_NULL_HANDLE;
+            ctx.readbackBuffer = VK_NULL_HANDLE;
+
+            VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = VK_FORMAT_R16_UINT;
+            imageInfo.extent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1 };
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VmaAllocationCreateInfo allocInfo{};
+            allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            if (!check(vmaCreateImage(ctx.allocator, &imageInfo, &allocInfo, &ctx.image, &ctx.imageAllocation, nullptr), "vmaCreateImage")) return false;
+
+            VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+            viewInfo.image = ctx.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = VK_FORMAT_R16_UINT;
+            viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+            if (!check(vkCreateImageView(ctx.device, &viewInfo, nullptr, &ctx.imageView), "vkCreateImageView")) return false;
+
+            const VkDeviceSize readbackSize = static_cast<VkDeviceSize>(width) * height * sizeof(uint16_t);
+            if (!createHostBuffer(ctx, readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, ctx.readbackBuffer, ctx.readbackAllocation, ctx.readbackMapped)) return false;
+
+            // GpuRawDecoder expects the image in SHADER_READ_ONLY, as m_rawImage is between frames.
+            VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkResetCommandBuffer(ctx.commandBuffer, 0);
+            vkBeginCommandBuffer(ctx.commandBuffer, &beginInfo);
+            VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = ctx.image;
+            barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(ctx.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0, 0, nullptr, 0, nullptr, 1, &barrier);
+            vkEndCommandBuffer(ctx.commandBuffer);
+            VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &ctx.commandBuffer;
+            if (!check(vkQueueSubmit(ctx.queue, 1, &submitInfo, VK_NULL_HANDLE), "vkQueueSubmit")) return false;
+            vkQueueWaitIdle(ctx.queue);
+
+            ctx.imageWidth = width;
+            ctx.imageHeight = height;
+            decoder.setTarget(ctx.imageView);
+        }
+
+        if (stagedBytes > ctx.stagingSize) {
+            vkDeviceWaitIdle(ctx.device);
+            if (ctx.stagingBuffer != VK_NULL_HANDLE) vmaDestroyBuffer(ctx.allocator, ctx.stagingBuffer, ctx.stagingAllocation);
+            ctx.stagingBuffer = VK_NULL_HANDLE;
+            ctx.stagingSize = 0;
+            if (!createHostBuffer(ctx, stagedBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false, ctx.stagingBuffer, ctx.stagingAllocation, ctx.stagingMapped)) return false;
+            ctx.stagingSize = stagedBytes;
+            decoder.setSource(ctx.stagingBuffer, stagedBytes);
+        }
+        return true;
+    }
+
+    /// Decodes one staged frame on the GPU and reads it back into ctx.readbackMapped.
+    bool decodeOnGpu(ComputeContext& ctx, const GpuRawDecoder& decoder, const GpuRawDecoder::DecodeParams& params) {
+        vmaFlushAllocation(ctx.allocator, ctx.stagingAllocation, 0, VK_WHOLE_SIZE);
+
+        VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkResetCommandBuffer(ctx.commandBuffer, 0);
+        vkBeginCommandBuffer(ctx.commandBuffer, &beginInfo);
+
+        if (!decoder.recordDecode(ctx.commandBuffer, ctx.image, params)) {
+            vkEndCommandBuffer(ctx.commandBuffer);
+            return false;
+        }
+
+        VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = ctx.image;
+        barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(ctx.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        region.imageExtent = { static_cast<uint32_t>(params.width), static_cast<uint32_t>(params.height), 1 };
+        vkCmdCopyImageToBuffer(ctx.commandBuffer, ctx.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, ctx.readbackBuffer, 1, &region);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(ctx.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferMemoryBarrier hostBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+        hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.buffer = ctx.readbackBuffer;
+        hostBarrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(ctx.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+            0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+        vkEndCommandBuffer(ctx.commandBuffer);
+
+        VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &ctx.commandBuffer;
+        vkResetFences(ctx.device, 1, &ctx.fence);
+        if (!check(vkQueueSubmit(ctx.queue, 1, &submitInfo, ctx.fence), "vkQueueSubmit")) return false;
+        if (!check(vkWaitForFences(ctx.device, 1, &ctx.fence, VK_TRUE, UINT64_MAX), "vkWaitForFences")) return false;
+        vmaInvalidateAllocation(ctx.allocator, ctx.readbackAllocation, 0, VK_WHOLE_SIZE);
+        return true;
+    }
+}
+
+namespace HeadlessExport {
+
+int runVerifyGpuDecode(const std::vector<std::string>& args) {
+    std::string inputPath;
+    size_t maxFrames = 0;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--frames" && i + 1 < args.size()) {
+            maxFrames = static_cast<size_t>(std::max(0, std::atoi(args[++i].c_str())));
+        }
+        else if (inputPath.empty()) {
+            inputPath = args[i];
+        }
+        else {
+            return 1;
+        }
+    }
+    if (inputPath.empty()) return 1;
+
+    std::unique_ptr<motioncam::Decoder> decoder;
+    try {
+        decoder = std::make_unique<motioncam::Decoder>(inputPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Failed to open " << inputPath << ": " << e.what() << std::endl;
+        return 2;
+    }
+
+    ComputeContext ctx;
+    if (!createContext(ctx)) return 3; // Nothing to verify on, as opposed to a failed check
+    GpuRawDecoder gpuDecoder;
+    const std::string shaderPath = (std::filesystem::path(g_AppBasePath) / "shaders_spv" / "mcraw_decode.comp.spv").string();
+    if (!gpuDecoder.init(ctx.device, shaderPath)) {
+        std::cerr << "Failed to create the GPU decoder from " << shaderPath << std::endl;
+        return 2;
+    }
+
+    const auto& frames = decoder->getFrames();
+    const size_t frameCount = (maxFrames > 0) ? std::min(maxFrames, frames.size()) : frames.size();
+    std::vector<uint8_t> payload, metadataPayload;
+    std::vector<uint16_t> reference;
+    std::vector<uint32_t> blockTable;
+    size_t verified = 0, skipped = 0, mismatched = 0;
+
+    for (size_t i = 0; i < frameCount; ++i) {
+        int width = 0, height = 0, compressionType = -1;
+        uint32_t blocksPerRow = 0, rowGroups = 0;
+        if (!decoder->getRawFramePayloads(frames[i], payload, metadataPayload, width, height, compressionType) ||
+            compressionType != MC_COMPRESSION_TYPE_NEW || !decodeFramePayload(payload, width, height, compressionType, reference)) {
+            skipped++;
+            continue;
+        }
+        const size_t payloadBytes = motioncam::raw::BuildBlockTable(width, height, payload.data(), payload.size(), blockTable, blocksPerRow, rowGroups);
+        if (payloadBytes == 0) {
+            std::cerr << "Frame " << i << ": block table rejected, playback would decode it on the CPU." << std::endl;
+            skipped++;
+            continue;
+        }
+
+        // Same layout App::stageForGpuDecode writes into the staging ring.
+        const VkDeviceSize tableBytes = blockTable.size() * sizeof(uint32_t);
+        const VkDeviceSize stagedBytes = tableBytes + ((static_cast<VkDeviceSize>(payloadBytes) + 3) & ~VkDeviceSize(3));
+        if (!ensureFrameResources(ctx, gpuDecoder, width, height, stagedBytes)) return 2;
+        uint8_t* staged = static_cast<uint8_t*>(ctx.stagingMapped);
+        std::memcpy(staged, blockTable.data(), static_cast<size_t>(tableBytes));
+        std::memcpy(staged + tableBytes, payload.data(), payloadBytes);
+
+        GpuRawDecoder::DecodeParams params;
+        params.tableWordOffset = 0;
+        params.payloadWordOffset = static_cast<uint32_t>(tableBytes / sizeof(uint32_t));
+        params.blocksPerRow = blocksPerRow;
+        params.rowGroups = rowGroups;
+        params.width = width;
+        params.height = height;
+        if (!decodeOnGpu(ctx, gpuDecoder, params)) return 2;
+
+        const uint16_t* gpu = static_cast<const uint16_t*>(ctx.readbackMapped);
+        const size_t pixelCount = static_cast<size_t>(width) * height;
+        const auto firstDiff = std::mismatch(reference.begin(), reference.begin() + pixelCount, gpu);
+        if (firstDiff.first != reference.begin() + pixelCount) {
+            const size_t at = static_cast<size_t>(firstDiff.first - reference.begin());
+            std::cerr << "Frame " << i << ": MISMATCH at (" << (at % width) << ", " << (at / width) << "): CPU "
+                << *firstDiff.first << ", GPU " << *firstDiff.second << std::endl;
+            mismatched++;
+        }
+        else {
+            verified++;
+        }
+    }
+
+    std::cerr << verified << " frames bit-exact, " << mismatched << " mismatched, " << skipped << " skipped." << std::endl;
+    LogToFile("[HeadlessExport::runVerifyGpuDecode] " + inputPath + ": " + std::to_string(verified) + " bit-exact, " +
+        std::to_string(mismatched) + " mismatched, " + std::to_string(skipped) + " skipped.");
+    gpuDecoder.cleanup();
+    return (mismatched == 0 && verified > 0) ? 0 : 2;
+}
+
+} // namespace HeadlessExport
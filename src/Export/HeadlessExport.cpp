@@ -0,0 +1,327 @@
+// FILE: src/Export/HeadlessExport.cpp
+#include "Export/HeadlessExport.h"
+#include "Export/CpuImagePipeline.h"
+#include "Export/ImageWriters.h"
+#include "Utils/DebugLog.h"
+
+#include <motioncam/Decoder.hpp>
+#include <motioncam/RawData.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    enum class Format { TIFF, PNG, EXR, Y4M };
+
+    struct ExportOptions {
+        Format format = Format::TIFF;
+        std::string inputPath;
+        std::string outputPath;
+        unsigned threads = 0;
+        int algorithm = CpuImagePipeline::Params().algorithm; // --demosaic; the player's default
+    };
+
+    void printUsage() {
+        std::cerr << "Usage: --export <tiff|png|exr|y4m> <input.mcraw> [output] [--demosaic bilinear|mhc] [--threads N]" << std::endl;
+        std::cerr << "       --stream <rawvideo|y4m> <input.mcraw> [output|-] [--audio <wav path>] [--demosaic bilinear|mhc] [--threads N]" << std::endl;
+        std::cerr << "       --verify-gpu-decode <input.mcraw> [--frames N]" << std::endl;
+        std::cerr << "       --analyze <input.mcraw|folder> [output dir] [--threads N]" << std::endl;
+        std::cerr << "       --verify <input.mcraw> [--full] [--threads N]" << std::endl;
+        std::cerr << "       --remux <output.mcraw> <input.mcraw> [--frames A-B | --seconds S-E] [<input2.mcraw> [range]]..." << std::endl;
+        std::cerr << "       --proxy <input.mcraw>... [--bin 2|4] [--threads N]" << std::endl;
+    }
+
+    bool parseFormat(const std::string& s, Format& out) {
+        std::string l = s;
+        std::transform(l.begin(), l.end(), l.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (l == "tiff" || l == "tif") { out = Format::TIFF; return true; }
+        if (l == "png") { out = Format::PNG; return true; }
+        if (l == "exr") { out = Format::EXR; return true; }
+        if (l == "y4m") { out = Format::Y4M; return true; }
+        return false;
+    }
+
+    const char* extensionFor(Format f) {
+        switch (f) {
+        case Format::TIFF: return "tiff";
+        case Format::PNG:  return "png";
+        case Format::EXR:  return "exr";
+        case Format::Y4M:  return "y4m";
+        }
+        return "bin";
+    }
+
+    int runExport(const ExportOptions& opt) {
+        std::unique_ptr<motioncam::Decoder> decoder;
+        try {
+            decoder = std::make_unique<motioncam::Decoder>(opt.inputPath);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Failed to open " << opt.inputPath << ": " << e.what() << std::endl;
+            return 1;
+        }
+
+        const auto& frames = decoder->getFrames();
+        const auto& containerMetadata = decoder->getContainerMetadata();
+        const fs::path inPath(opt.inputPath);
+        const std::string stem = inPath.stem().string();
+
+        fs::path outPath = opt.outputPath;
+        if (outPath.empty()) {
+            if (opt.format == Format::Y4M) {
+                outPath = inPath.parent_path() / (stem + ".y4m");
+            }
+            else {
+                std::string fmt = extensionFor(opt.format);
+                std::transform(fmt.begin(), fmt.end(), fmt.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+                outPath = inPath.parent_path() / (stem + "_" + fmt + "_Exports");
+            }
+        }
+        if (opt.format != Format::Y4M) {
+            std::error_code ec;
+            fs::create_directories(outPath, ec);
+            if (ec) {
+                std::cerr << "Failed to create output directory " << outPath.string() << ": " << ec.message() << std::endl;
+                return 1;
+            }
+        }
+
+        const auto outputKind = (opt.format == Format::EXR) ? CpuImagePipeline::Output::LINEAR_HALF : CpuImagePipeline::Output::SRGB_U16;
+        ImageWriters::Y4mWriter y4m;
+        int fpsNum = 30, fpsDen = 1;
+        HeadlessExport::estimateFrameRate(frames, fpsNum, fpsDen);
+
+        std::vector<uint8_t> payload, metadataPayload;
+        std::vector<uint16_t> bayer, rgb;
+        size_t failCount = 0;
+        size_t framesRepeated = 0; // Y4M: copies of the previous frame in place of failed ones
+        size_t leadingRepeats = 0; // Y4M: failures before the first frame, written once it arrives
+        int streamWidth = 0, streamHeight = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        LogToFile(std::string("[HeadlessExport] Exporting ") + std::to_string(frames.size()) + " frames from " + opt.inputPath + " to " + outPath.string());
+
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const motioncam::Timestamp ts = frames[i];
+            int width = 0, height = 0, compressionType = -1;
+            std::string errorMsg;
+
+            // A Y4M file is a single stream: every frame of the clip yields exactly one frame of
+            // output, as in runStream, so a failed frame is replaced by the previous one (by the
+            // first good one when none is written yet) and the video keeps the clip's timing.
+            auto replaceFailedFrame = [&]() {
+                failCount++;
+                if (opt.format != Format::Y4M) return true;
+                if (!y4m.isOpen()) {
+                    leadingRepeats++;
+                    return true;
+                }
+                if (!y4m.writeFrame(rgb.data(), errorMsg)) {
+                    std::cerr << errorMsg << std::endl;
+                    return false;
+                }
+                framesRepeated++;
+                return true;
+            };
+
+            if (!decoder->getRawFramePayloads(ts, payload, metadataPayload, width, height, compressionType) ||
+                !HeadlessExport::decodeFramePayload(payload, width, height, compressionType, bayer)) {
+                std::cerr << "Frame " << i << ": failed to read or decode." << std::endl;
+                if (!replaceFailedFrame()) return 1;
+                continue;
+            }
+
+            nlohmann::json frameMetadata;
+            try {
+                frameMetadata = nlohmann::json::parse(metadataPayload.begin(), metadataPayload.end());
+            }
+            catch (const nlohmann::json::parse_error& e) {
+                std::cerr << "Frame " << i << ": metadata parse error: " << e.what() << std::endl;
+                if (!replaceFailedFrame()) return 1;
+                continue;
+            }
+
+            if (opt.format == Format::Y4M && streamWidth != 0 && (width != streamWidth || height != streamHeight)) {
+                std::cerr << "Frame " << i << ": " << width << "x" << height << " in a " << streamWidth << "x" << streamHeight << " stream." << std::endl;
+                if (!replaceFailedFrame()) return 1;
+                continue;
+            }
+
+            auto params = CpuImagePipeline::paramsFromMetadata(frameMetadata, containerMetadata);
+            params.algorithm = opt.algorithm;
+            rgb.resize(static_cast<size_t>(width) * height * 3);
+            CpuImagePipeline::process(bayer.data(), width, height, params, outputKind, rgb.data(), opt.threads);
+
+            bool ok = false;
+            if (opt.format == Format::Y4M) {
+                if (!y4m.isOpen()) {
+                    if (!y4m.open(outPath.string(), width, height, fpsNum, fpsDen, errorMsg)) {
+                        std::cerr << errorMsg << std::endl;
+                        return 1;
+                    }
+                    streamWidth = width;
+                    streamHeight = height;
+                }
+                ok = y4m.writeFrame(rgb.data(), errorMsg);
+                for (; ok && leadingRepeats > 0; --leadingRepeats) {
+                    ok = y4m.writeFrame(rgb.data(), errorMsg);
+                    if (ok) framesRepeated++;
+                }
+            }
+            else {
+                char fileName[256];
+                snprintf(fileName, sizeof(fileName), "%s_frame_%06zu_ts_%lld.%s",
+                    stem.c_str(), i, static_cast<long long>(ts), extensionFor(opt.format));
+                const std::string framePath = (outPath / fileName).string();
+                if (opt.format == Format::TIFF) ok = ImageWriters::writeTiff16(framePath, width, height, rgb.data(), errorMsg);
+                else if (opt.format == Format::PNG) ok = ImageWriters::writePng16(framePath, width, height, rgb.data(), errorMsg);
+                else ok = ImageWriters::writeExrHalf(framePath, width, height, rgb.data(), errorMsg);
+            }
+
+            if (!ok) {
+                std::cerr << "Frame " << i << ": " << errorMsg << std::endl;
+                failCount++;
+            }
+            if ((i + 1) % 50 == 0 || i + 1 == frames.size()) {
+                std::cerr << "Processed " << (i + 1) << "/" << frames.size() << " frames" << std::endl;
+            }
+        }
+        y4m.close();
+
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Done: " << (frames.size() - failCount) << " ok, " << failCount << " failed, "
+            << secs << " s (" << (secs > 0 ? frames.size() / secs : 0.0) << " fps)";
+        if (opt.format == Format::Y4M) std::cerr << ", " << framesRepeated << " repeated in their place";
+        std::cerr << std::endl;
+        LogToFile(std::string("[HeadlessExport] Finished. Failed frames: ") + std::to_string(failCount));
+        return failCount == 0 ? 0 : 2;
+    }
+}
+
+namespace HeadlessExport {
+
+namespace {
+    constexpr int MC_COMPRESSION_TYPE_NEW = 7;
+    constexpr int MC_COMPRESSION_TYPE_LEGACY = 6;
+}
+
+bool isHeadlessInvocation(int argc, char* argv[]) {
+    if (argc < 2 || argv[1] == nullptr) return false;
+    return std::strcmp(argv[1], "--export") == 0 || std::strcmp(argv[1], "--stream") == 0 ||
+        std::strcmp(argv[1], "--verify-gpu-decode") == 0 || std::strcmp(argv[1], "--analyze") == 0 ||
+        std::strcmp(argv[1], "--verify") == 0 || std::strcmp(argv[1], "--remux") == 0 ||
+        std::strcmp(argv[1], "--proxy") == 0;
+}
+
+bool writesToStdout(int argc, char* argv[]) {
+    if (argc < 2 || argv[1] == nullptr || std::strcmp(argv[1], "--stream") != 0) return false;
+    // Third positional argument is the output; absent or "-" means stdout.
+    int positional = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--audio") == 0 || std::strcmp(argv[i], "--threads") == 0 ||
+            std::strcmp(argv[i], "--demosaic") == 0) { ++i; continue; }
+        if (++positional == 3) return std::strcmp(argv[i], "-") == 0;
+    }
+    return true;
+}
+
+bool decodeFramePayload(const std::vector<uint8_t>& payload, int width, int height, int compressionType, std::vector<uint16_t>& bayer) {
+    bayer.resize(static_cast<size_t>(width) * height);
+    if (compressionType == MC_COMPRESSION_TYPE_NEW) {
+        return motioncam::raw::Decode(bayer.data(), width, height, payload.data(), payload.size()) > 0;
+    }
+    if (compressionType == MC_COMPRESSION_TYPE_LEGACY) {
+        return motioncam::raw::DecodeLegacy(bayer.data(), width, height, payload.data(), payload.size()) > 0;
+    }
+    if (compressionType == 0 && payload.size() == bayer.size() * sizeof(uint16_t)) {
+        std::memcpy(bayer.data(), payload.data(), payload.size());
+        return true;
+    }
+    return false;
+}
+
+void estimateFrameRate(const std::vector<motioncam::Timestamp>& frames, int& fpsNum, int& fpsDen) {
+    fpsNum = 30;
+    fpsDen = 1;
+    if (frames.size() < 2) return;
+    std::vector<motioncam::Timestamp> deltas;
+    deltas.reserve(frames.size() - 1);
+    for (size_t i = 1; i < frames.size(); ++i) {
+        if (frames[i] > frames[i - 1]) deltas.push_back(frames[i] - frames[i - 1]);
+    }
+    if (deltas.empty()) return;
+    std::nth_element(deltas.begin(), deltas.begin() + deltas.size() / 2, deltas.end());
+    const double fps = 1e9 / static_cast<double>(deltas[deltas.size() / 2]);
+    fpsDen = 1000;
+    fpsNum = static_cast<int>(std::lround(fps * fpsDen));
+}
+
+int run(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (!args.empty() && args[0] == "--stream") {
+        const int rc = runStream(args);
+        if (rc == 1) printUsage();
+        return rc;
+    }
+    if (!args.empty() && args[0] == "--verify-gpu-decode") {
+        const int rc = runVerifyGpuDecode(args);
+        if (rc == 1) printUsage();
+        return rc;
+    }
+    if (!args.empty() && args[0] == "--analyze") {
+        const int rc = runAnalyze(args);
+        if (rc == 1) printUsage();
+        return rc;
+    }
+    if (!args.empty() && args[0] == "--verify") {
+        const int rc = runVerify(args);
+        if (rc == 1) printUsage();
+        return rc;
+    }
+    if (!args.empty() && args[0] == "--remux") {
+        const int rc = runRemux(args);
+        if (rc == 1) printUsage();
+        return rc;
+    }
+    if (!args.empty() && args[0] == "--proxy") {
+        const int rc = runProxy(args);
+        if (rc == 1) printUsage();
+        return rc;
+    }
+
+    ExportOptions opt;
+    std::vector<std::string> positional;
+
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--threads" && i + 1 < args.size()) {
+            opt.threads = static_cast<unsigned>(std::max(0, std::atoi(args[++i].c_str())));
+        }
+        else if (args[i] == "--demosaic" && i + 1 < args.size()) {
+            opt.algorithm = CpuImagePipeline::algorithmFromString(args[++i]);
+        }
+        else {
+            positional.push_back(args[i]);
+        }
+    }
+
+    if (positional.size() < 2 || !parseFormat(positional[0], opt.format) || opt.algorithm < 0) {
+        printUsage();
+        return 1;
+    }
+    opt.inputPath = positional[1];
+    if (positional.size() >= 3) opt.outputPath = positional[2];
+
+    return runExport(opt);
+}
+
+} // namespace HeadlessExport
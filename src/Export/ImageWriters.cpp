@@ -0,0 +1,363 @@
+// FILE: src/Export/ImageWriters.cpp
+#include "Export/ImageWriters.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace ImageWriters {
+
+namespace {
+    void putLE16(std::vector<uint8_t>& out, uint16_t v) {
+        out.push_back(static_cast<uint8_t>(v & 0xFF));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+    }
+
+    void putLE32(std::vector<uint8_t>& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
+    }
+
+    void putLE64(std::vector<uint8_t>& out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
+    }
+
+    void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+        for (int i = 3; i >= 0; --i) out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
+    }
+
+    const std::array<uint32_t, 256>& crcTable() {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t n = 0; n < 256; ++n) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                t[n] = c;
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+        const auto& t = crcTable();
+        crc = ~crc;
+        for (size_t i = 0; i < len; ++i) crc = t[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    bool writePngChunk(std::ofstream& out, const char type[4], const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> len;
+        putBE32(len, static_cast<uint32_t>(data.size()));
+        out.write(reinterpret_cast<const char*>(len.data()), 4);
+        out.write(type, 4);
+        if (!data.empty()) out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        uint32_t crc = crc32Update(0, reinterpret_cast<const uint8_t*>(type), 4);
+        crc = crc32Update(crc, data.data(), data.size());
+        std::vector<uint8_t> crcBytes;
+        putBE32(crcBytes, crc);
+        out.write(reinterpret_cast<const char*>(crcBytes.data()), 4);
+        return static_cast<bool>(out);
+    }
+
+    void putExrAttribute(std::vector<uint8_t>& out, const char* name, const char* type, const std::vector<uint8_t>& value) {
+        out.insert(out.end(), name, name + std::strlen(name) + 1);
+        out.insert(out.end(), type, type + std::strlen(type) + 1);
+        putLE32(out, static_cast<uint32_t>(value.size()));
+        out.insert(out.end(), value.begin(), value.end());
+    }
+}
+
+bool writeTiff16(const std::string& path, int width, int height, const uint16_t* rgb, std::string& errorMsg) {
+    if (width <= 0 || height <= 0 || !rgb) {
+        errorMsg = "Invalid TIFF dimensions or null data.";
+        return false;
+    }
+    const uint64_t stripBytes = static_cast<uint64_t>(width) * height * 3 * sizeof(uint16_t);
+    if (stripBytes > 0xFFFFFF00ull) {
+        errorMsg = "Image too large for a classic TIFF.";
+        return false;
+    }
+
+    const uint16_t numEntries = 10;
+    const uint32_t ifdOffset = 8;
+    const uint32_t bpsOffset = ifdOffset + 2 + numEntries * 12 + 4;
+    const uint32_t pixelOffset = (bpsOffset + 6 + 15) & ~15u;
+
+    std::vector<uint8_t> header;
+    header.reserve(pixelOffset);
+    header.push_back('I'); header.push_back('I');
+    putLE16(header, 42);
+    putLE32(header, ifdOffset);
+    putLE16(header, numEntries);
+
+    auto entry = [&](uint16_t tag, uint16_t type, uint32_t count, uint32_t value) {
+        putLE16(header, tag);
+        putLE16(header, type);
+        putLE32(header, count);
+        if (type == 3 && count == 1) { putLE16(header, static_cast<uint16_t>(value)); putLE16(header, 0); }
+        else putLE32(header, value);
+    };
+    entry(256, 4, 1, static_cast<uint32_t>(width));   // ImageWidth
+    entry(257, 4, 1, static_cast<uint32_t>(height));  // ImageLength
+    entry(258, 3, 3, bpsOffset);                      // BitsPerSample (16,16,16)
+    entry(259, 3, 1, 1);                              // Compression: none
+    entry(262, 3, 1, 2);                              // Photometric: RGB
+    entry(273, 4, 1, pixelOffset);                    // StripOffsets
+    entry(277, 3, 1, 3);                              // SamplesPerPixel
+    entry(278, 4, 1, static_cast<uint32_t>(height));  // RowsPerStrip
+    entry(279, 4, 1, static_cast<uint32_t>(stripBytes)); // StripByteCounts
+    entry(284, 3, 1, 1);                              // PlanarConfiguration: contiguous
+    putLE32(header, 0);
+    putLE16(header, 16); putLE16(header, 16); putLE16(header, 16);
+    header.resize(pixelOffset, 0);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        errorMsg = "Failed to open TIFF output: " + path;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    out.write(reinterpret_cast<const char*>(rgb), static_cast<std::streamsize>(stripBytes));
+    if (!out) {
+        errorMsg = "Failed writing TIFF: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool writePng16(const std::string& path, int width, int height, const uint16_t* rgb, std::string& errorMsg) {
+    if (width <= 0 || height <= 0 || !rgb) {
+        errorMsg = "Invalid PNG dimensions or null data.";
+        return false;
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        errorMsg = "Failed to open PNG output: " + path;
+        return false;
+    }
+    static const uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.write(reinterpret_cast<const char*>(kSignature), 8);
+
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, static_cast<uint32_t>(width));
+    putBE32(ihdr, static_cast<uint32_t>(height));
+    ihdr.push_back(16); // bit depth
+    ihdr.push_back(2);  // colour type: RGB
+    ihdr.push_back(0); ihdr.push_back(0); ihdr.push_back(0);
+    writePngChunk(out, "IHDR", ihdr);
+
+    // zlib stream of stored blocks, one IDAT chunk per block, so memory stays at one block.
+    constexpr size_t kStoredBlockMax = 65535;
+    std::vector<uint8_t> block;
+    block.reserve(kStoredBlockMax);
+    uint32_t adlerA = 1, adlerB = 0;
+    bool firstChunk = true;
+
+    auto flushBlock = [&](bool final) {
+        std::vector<uint8_t> chunk;
+        chunk.reserve(block.size() + 16);
+        if (firstChunk) {
+            chunk.push_back(0x78);
+            chunk.push_back(0x01);
+            firstChunk = false;
+        }
+        chunk.push_back(final ? 1 : 0);
+        const uint16_t len = static_cast<uint16_t>(block.size());
+        putLE16(chunk, len);
+        putLE16(chunk, static_cast<uint16_t>(~len));
+        chunk.insert(chunk.end(), block.begin(), block.end());
+        if (final) putBE32(chunk, (adlerB << 16) | adlerA);
+        block.clear();
+        return writePngChunk(out, "IDAT", chunk);
+    };
+
+    auto feed = [&](const uint8_t* data, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            adlerA = (adlerA + data[i]) % 65521u;
+            adlerB = (adlerB + adlerA) % 65521u;
+        }
+        while (n > 0) {
+            const size_t take = std::min(n, kStoredBlockMax - block.size());
+            block.insert(block.end(), data, data + take);
+            data += take;
+            n -= take;
+            if (block.size() == kStoredBlockMax && !flushBlock(false)) return false;
+        }
+        return true;
+    };
+
+    std::vector<uint8_t> row(1 + static_cast<size_t>(width) * 6);
+    for (int y = 0; y < height; ++y) {
+        row[0] = 0; // filter: none
+        const uint16_t* src = rgb + static_cast<size_t>(y) * width * 3;
+        for (size_t i = 0; i < static_cast<size_t>(width) * 3; ++i) {
+            row[1 + i * 2] = static_cast<uint8_t>(src[i] >> 8);
+            row[2 + i * 2] = static_cast<uint8_t>(src[i] & 0xFF);
+        }
+        if (!feed(row.data(), row.size())) {
+            errorMsg = "Failed writing PNG data: " + path;
+            return false;
+        }
+    }
+    if (!flushBlock(true) || !writePngChunk(out, "IEND", {})) {
+        errorMsg = "Failed finishing PNG: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool writeExrHalf(const std::string& path, int width, int height, const uint16_t* rgbHalf, std::string& errorMsg) {
+    if (width <= 0 || height <= 0 || !rgbHalf) {
+        errorMsg = "Invalid EXR dimensions or null data.";
+        return false;
+    }
+
+    std::vector<uint8_t> header;
+    putLE32(header, 20000630); // magic
+    putLE32(header, 2);        // version 2, scanline, single part
+
+    std::vector<uint8_t> chlist;
+    for (const char* name : { "B", "G", "R" }) { // Channels must be sorted by name
+        chlist.insert(chlist.end(), name, name + std::strlen(name) + 1);
+        putLE32(chlist, 1);                  // HALF
+        chlist.push_back(0);                 // pLinear
+        chlist.push_back(0); chlist.push_back(0); chlist.push_back(0);
+        putLE32(chlist, 1);                  // xSampling
+        putLE32(chlist, 1);                  // ySampling
+    }
+    chlist.push_back(0);
+    putExrAttribute(header, "channels", "chlist", chlist);
+    putExrAttribute(header, "compression", "compression", { 0 });
+
+    std::vector<uint8_t> box;
+    putLE32(box, 0); putLE32(box, 0);
+    putLE32(box, static_cast<uint32_t>(width - 1)); putLE32(box, static_cast<uint32_t>(height - 1));
+    putExrAttribute(header, "dataWindow", "box2i", box);
+    putExrAttribute(header, "displayWindow", "box2i", box);
+    putExrAttribute(header, "lineOrder", "lineOrder", { 0 });
+
+    const float one = 1.0f, zero = 0.0f;
+    std::vector<uint8_t> f1(4), v2(8);
+    std::memcpy(f1.data(), &one, 4);
+    std::memcpy(v2.data(), &zero, 4);
+    std::memcpy(v2.data() + 4, &zero, 4);
+    putExrAttribute(header, "pixelAspectRatio", "float", f1);
+    putExrAttribute(header, "screenWindowCenter", "v2f", v2);
+    putExrAttribute(header, "screenWindowWidth", "float", f1);
+    header.push_back(0); // end of header
+
+    const uint64_t lineDataSize = static_cast<uint64_t>(width) * 3 * sizeof(uint16_t);
+    const uint64_t blockSize = 8 + lineDataSize;
+    const uint64_t firstBlock = header.size() + static_cast<uint64_t>(height) * 8;
+    for (int y = 0; y < height; ++y) putLE64(header, firstBlock + static_cast<uint64_t>(y) * blockSize);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        errorMsg = "Failed to open EXR output: " + path;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+    std::vector<uint8_t> line;
+    line.reserve(static_cast<size_t>(blockSize));
+    for (int y = 0; y < height; ++y) {
+        line.clear();
+        putLE32(line, static_cast<uint32_t>(y));
+        putLE32(line, static_cast<uint32_t>(lineDataSize));
+        const uint16_t* src = rgbHalf + static_cast<size_t>(y) * width * 3;
+        for (int c : { 2, 1, 0 }) { // B, G, R planes
+            for (int x = 0; x < width; ++x) putLE16(line, src[x * 3 + c]);
+        }
+        out.write(reinterpret_cast<const char*>(line.data()), static_cast<std::streamsize>(line.size()));
+    }
+    if (!out) {
+        errorMsg = "Failed writing EXR: " + path;
+        return false;
+    }
+    return true;
+}
+
+Y4mWriter::~Y4mWriter() {
+    close();
+}
+
+bool Y4mWriter::open(const std::string& path, int width, int height, int fpsNum, int fpsDen, std::string& errorMsg) {
+    close();
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        errorMsg = "Failed to open Y4M output: " + path;
+        return false;
+    }
+    m_ownsStream = true;
+    m_stream = f;
+    m_width = width;
+    m_height = height;
+    return writeHeader(fpsNum, fpsDen, errorMsg);
+}
+
+bool Y4mWriter::attach(std::FILE* stream, int width, int height, int fpsNum, int fpsDen, std::string& errorMsg) {
+    close();
+    if (!stream) {
+        errorMsg = "Null Y4M stream.";
+        return false;
+    }
+    m_ownsStream = false;
+    m_stream = stream;
+    m_width = width;
+    m_height = height;
+    return writeHeader(fpsNum, fpsDen, errorMsg);
+}
+
+bool Y4mWriter::writeHeader(int fpsNum, int fpsDen, std::string& errorMsg) {
+    if (std::fprintf(m_stream, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C444 XCOLORRANGE=LIMITED\n",
+        m_width, m_height, fpsNum, fpsDen) < 0) {
+        errorMsg = "Failed writing Y4M header.";
+        return false;
+    }
+    return true;
+}
+
+void Y4mWriter::rgb16ToYuv444(const uint16_t* rgb, int width, int height, std::vector<uint8_t>& outPlanes) {
+    const size_t n = static_cast<size_t>(width) * height;
+    outPlanes.resize(n * 3);
+    uint8_t* yp = outPlanes.data();
+    uint8_t* up = yp + n;
+    uint8_t* vp = up + n;
+    const float inv = 1.0f / 65535.0f;
+    for (size_t i = 0; i < n; ++i) {
+        const float r = rgb[i * 3 + 0] * inv;
+        const float g = rgb[i * 3 + 1] * inv;
+        const float b = rgb[i * 3 + 2] * inv;
+        const float y = 0.2126f * r + 0.7152f * g + 0.0722f * b; // BT.709
+        const float cb = (b - y) / 1.8556f;
+        const float cr = (r - y) / 1.5748f;
+        yp[i] = static_cast<uint8_t>(std::clamp(16.0f + 219.0f * y + 0.5f, 0.0f, 255.0f));
+        up[i] = static_cast<uint8_t>(std::clamp(128.0f + 224.0f * cb + 0.5f, 0.0f, 255.0f));
+        vp[i] = static_cast<uint8_t>(std::clamp(128.0f + 224.0f * cr + 0.5f, 0.0f, 255.0f));
+    }
+}
+
+bool Y4mWriter::writeFrame(const uint16_t* rgb, std::string& errorMsg) {
+    if (!m_stream) {
+        errorMsg = "Y4M writer is not open.";
+        return false;
+    }
+    rgb16ToYuv444(rgb, m_width, m_height, m_planes);
+    if (std::fwrite("FRAME\n", 1, 6, m_stream) != 6 ||
+        std::fwrite(m_planes.data(), 1, m_planes.size(), m_stream) != m_planes.size()) {
+        errorMsg = "Failed writing Y4M frame.";
+        return false;
+    }
+    return true;
+}
+
+void Y4mWriter::close() {
+    if (!m_stream) return;
+    std::fflush(m_stream);
+    if (m_ownsStream) std::fclose(m_stream);
+    m_stream = nullptr;
+    m_ownsStream = false;
+}
+
+} // namespace ImageWriters
@@ -0,0 +1,68 @@
+// FILE: src/Export/ProxyExport.cpp
+#include "Export/HeadlessExport.h"
+
+#include <motioncam/Proxy.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace HeadlessExport {
+
+int runProxy(const std::vector<std::string>& args) {
+    motioncam::ProxyOptions options;
+    std::vector<std::string> inputs;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--bin" && i + 1 < args.size()) {
+            options.binning = std::atoi(args[++i].c_str());
+            if (options.binning != 2 && options.binning != 4) return 1;
+        }
+        else if (args[i] == "--threads" && i + 1 < args.size()) {
+            options.threads = static_cast<unsigned>(std::max(0, std::atoi(args[++i].c_str())));
+        }
+        else {
+            inputs.push_back(args[i]);
+        }
+    }
+    if (inputs.empty()) return 1;
+
+    int rc = 0;
+    for (const std::string& input : inputs) {
+        const std::string outputPath = motioncam::ProxyPath(input);
+        size_t lastPercent = 0;
+        options.progress = [&](size_t framesDone, size_t frameCount) {
+            const size_t percent = frameCount > 0 ? framesDone * 100 / frameCount : 100;
+            if (percent >= lastPercent + 10) {
+                lastPercent = percent - percent % 10;
+                std::cerr << "  " << lastPercent << "%" << std::endl;
+            }
+            return true;
+        };
+
+        const auto start = std::chrono::steady_clock::now();
+        motioncam::ProxyStats stats;
+        try {
+            stats = motioncam::WriteProxy(input, outputPath, options);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Proxy of " << input << " failed: " << e.what() << std::endl;
+            rc = 2;
+            continue;
+        }
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const double mb = static_cast<double>(stats.bytesWritten) / (1024.0 * 1024.0);
+        std::cerr << "Wrote " << outputPath << ": " << stats.frames << " frames at " << stats.width << "x" << stats.height
+            << ", " << stats.audioChunks << " audio chunks, " << std::fixed << std::setprecision(1) << mb << " MB in "
+            << std::setprecision(2) << secs << " s (" << std::setprecision(1)
+            << (secs > 0.0 ? static_cast<double>(stats.frames) / secs : 0.0) << " fps)" << std::endl;
+    }
+    return rc;
+}
+
+} // namespace HeadlessExport
@@ -0,0 +1,108 @@
+// FILE: src/Export/RemuxExport.cpp
+#include "Export/HeadlessExport.h"
+
+#include <motioncam/Decoder.hpp>
+#include <motioncam/Remux.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    // "A-B", "A-" or "A"; either bound may be omitted on its side of the dash.
+    bool parseRange(const std::string& text, double& outBegin, double& outEnd, bool& outHasEnd) {
+        const size_t dash = text.find('-');
+        const std::string begin = text.substr(0, dash);
+        const std::string end = dash == std::string::npos ? begin : text.substr(dash + 1);
+        char* stop = nullptr;
+        outBegin = begin.empty() ? 0.0 : std::strtod(begin.c_str(), &stop);
+        if (!begin.empty() && *stop != '\0') return false;
+        outHasEnd = !end.empty();
+        outEnd = outHasEnd ? std::strtod(end.c_str(), &stop) : 0.0;
+        if (outHasEnd && *stop != '\0') return false;
+        return outBegin >= 0.0 && (!outHasEnd || outEnd >= outBegin);
+    }
+
+    // Resolves a --frames (inclusive indices) or --seconds (from the clip's first frame) range.
+    bool applyRange(motioncam::RemuxInput& input, const std::string& kind, const std::string& text) {
+        double begin = 0.0, end = 0.0;
+        bool hasEnd = false;
+        if (!parseRange(text, begin, end, hasEnd)) return false;
+
+        if (kind == "--frames") {
+            input.firstFrame = static_cast<size_t>(begin);
+            if (hasEnd) input.frameCount = static_cast<size_t>(end) - input.firstFrame + 1;
+            return true;
+        }
+
+        const motioncam::Decoder decoder(input.path);
+        const std::vector<motioncam::Timestamp>& frames = decoder.getFrames();
+        if (frames.empty()) return true;
+        const auto at = [&](double seconds) {
+            return frames.front() + static_cast<motioncam::Timestamp>(seconds * 1e9);
+        };
+        input.firstFrame = static_cast<size_t>(std::lower_bound(frames.begin(), frames.end(), at(begin)) - frames.begin());
+        if (hasEnd) {
+            const size_t last = static_cast<size_t>(std::lower_bound(frames.begin(), frames.end(), at(end)) - frames.begin());
+            input.frameCount = last > input.firstFrame ? last - input.firstFrame : 0;
+        }
+        return true;
+    }
+}
+
+namespace HeadlessExport {
+
+int runRemux(const std::vector<std::string>& args) {
+    if (args.size() < 3) return 1;
+    const std::string outputPath = args[1];
+
+    std::vector<motioncam::RemuxInput> inputs;
+    try {
+        for (size_t i = 2; i < args.size(); ++i) {
+            if (args[i] == "--frames" || args[i] == "--seconds") {
+                if (inputs.empty() || i + 1 >= args.size()) return 1;
+                if (!applyRange(inputs.back(), args[i], args[i + 1])) {
+                    std::cerr << "Invalid range for " << args[i] << ": " << args[i + 1] << std::endl;
+                    return 1;
+                }
+                ++i;
+            }
+            else {
+                motioncam::RemuxInput input;
+                input.path = args[i];
+                inputs.push_back(input);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Failed to open input: " << e.what() << std::endl;
+        return 2;
+    }
+    if (inputs.empty()) return 1;
+
+    const auto start = std::chrono::steady_clock::now();
+    motioncam::RemuxStats stats;
+    try {
+        stats = motioncam::Remux(inputs, outputPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Remux failed: " << e.what() << std::endl;
+        return 2;
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double mb = static_cast<double>(stats.bytesWritten) / (1024.0 * 1024.0);
+    std::cerr << "Wrote " << outputPath << ": " << stats.frames << " frames, " << stats.audioChunks << " audio chunks, "
+        << std::fixed << std::setprecision(1) << mb << " MB in " << std::setprecision(2) << secs << " s ("
+        << std::setprecision(1) << (secs > 0.0 ? mb / secs : 0.0) << " MB/s, "
+        << (stats.bytesWritten > 0 ? 100.0 * static_cast<double>(stats.bytesCopiedInKernel) / static_cast<double>(stats.bytesWritten) : 0.0)
+        << "% copied in the kernel)" << std::endl;
+    return 0;
+}
+
+} // namespace HeadlessExport
@@ -0,0 +1,378 @@
+// FILE: src/Export/StreamExport.cpp
+#include "Export/HeadlessExport.h"
+#include "Export/CpuImagePipeline.h"
+#include "Export/ImageWriters.h"
+#include "Utils/DebugLog.h"
+#include "Utils/ThreadSafeQueue.h"
+
+#include <motioncam/Decoder.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+    enum class StreamFormat { RAWVIDEO, Y4M };
+
+    // Double buffering: the decode thread fills one slot while another is written to the pipe.
+    // The third holds the last frame written, which stands in for frames that cannot be decoded.
+    constexpr size_t kNumStreamSlots = 3;
+    constexpr size_t kEndOfStream = std::numeric_limits<size_t>::max();
+    constexpr size_t kRepeatFrame = kEndOfStream - 1; // Frame failed: write the previous one again
+
+    struct StreamSlot {
+        std::vector<uint16_t> rgb;
+        int width = 0;
+        int height = 0;
+        size_t frameIndex = 0;
+    };
+
+    struct StreamOptions {
+        StreamFormat format = StreamFormat::Y4M;
+        std::string inputPath;
+        std::string outputPath = "-";
+        std::string audioPath;
+        unsigned threads = 0;
+        int algorithm = CpuImagePipeline::Params().algorithm; // --demosaic; the player's default
+    };
+
+    bool isNamedPipePath(const std::string& path) {
+        return path.rfind("\\\\.\\pipe\\", 0) == 0;
+    }
+
+    // Opens stdout ("-"), a Windows named pipe (created here and waited on), or any other path
+    // (POSIX FIFOs block in fopen until the reader attaches).
+    std::FILE* openOutputStream(const std::string& path, bool& ownsStream) {
+        ownsStream = false;
+        if (path.empty() || path == "-") {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            return stdout;
+        }
+#ifdef _WIN32
+        if (isNamedPipePath(path)) {
+            HANDLE pipe = CreateNamedPipeA(path.c_str(), PIPE_ACCESS_OUTBOUND, PIPE_TYPE_BYTE | PIPE_WAIT,
+                1, 1 << 20, 0, 0, nullptr);
+            if (pipe == INVALID_HANDLE_VALUE) return nullptr;
+            if (!ConnectNamedPipe(pipe, nullptr) && GetLastError() != ERROR_PIPE_CONNECTED) {
+                CloseHandle(pipe);
+                return nullptr;
+            }
+            const int fd = _open_osfhandle(reinterpret_cast<intptr_t>(pipe), _O_WRONLY | _O_BINARY);
+            if (fd < 0) {
+                CloseHandle(pipe);
+                return nullptr;
+            }
+            ownsStream = true;
+            return _fdopen(fd, "wb");
+        }
+#endif
+        ownsStream = true;
+        return std::fopen(path.c_str(), "wb");
+    }
+
+    void putLE16(std::vector<uint8_t>& out, uint16_t v) {
+        out.push_back(static_cast<uint8_t>(v & 0xFF));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+    }
+
+    void putLE32(std::vector<uint8_t>& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
+    }
+
+    // Writes the clip's audio as 16-bit PCM WAV. Sizes are patched at the end for regular files;
+    // on pipes they stay at the "unknown length" value that ffmpeg and friends accept.
+    bool writeWavStream(const motioncam::Decoder& decoder, motioncam::Timestamp firstVideoTs, const std::string& path, std::string& errorMsg) {
+        const int sampleRate = decoder.audioSampleRateHz();
+        const int channels = decoder.numAudioChannels();
+        if (sampleRate <= 0 || channels <= 0) {
+            errorMsg = "Clip has no audio track.";
+            return false;
+        }
+
+        std::vector<motioncam::AudioChunk> chunks;
+        decoder.loadAudio(chunks);
+
+        bool ownsStream = false;
+        std::FILE* out = openOutputStream(path, ownsStream);
+        if (!out) {
+            errorMsg = "Failed to open audio output: " + path;
+            return false;
+        }
+
+        std::vector<uint8_t> header;
+        header.insert(header.end(), { 'R', 'I', 'F', 'F' });
+        putLE32(header, 0xFFFFFFFFu);
+        header.insert(header.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+        putLE32(header, 16);
+        putLE16(header, 1); // PCM
+        putLE16(header, static_cast<uint16_t>(channels));
+        putLE32(header, static_cast<uint32_t>(sampleRate));
+        putLE32(header, static_cast<uint32_t>(sampleRate * channels * 2));
+        putLE16(header, static_cast<uint16_t>(channels * 2));
+        putLE16(header, 16);
+        header.insert(header.end(), { 'd', 'a', 't', 'a' });
+        putLE32(header, 0xFFFFFFFFu);
+        std::fwrite(header.data(), 1, header.size(), out);
+
+        uint64_t dataBytes = 0;
+        for (const auto& chunk : chunks) {
+            // Same rule as AudioController: drop audio that precedes the first video frame.
+            if (chunk.first != -1 && chunk.first < firstVideoTs) continue;
+            const size_t bytes = chunk.second.size() * sizeof(int16_t);
+            if (std::fwrite(chunk.second.data(), 1, bytes, out) != bytes) {
+                errorMsg = "Audio stream write failed (reader closed?).";
+                break;
+            }
+            dataBytes += bytes;
+        }
+
+        if (ownsStream && !isNamedPipePath(path) && dataBytes < 0xFFFFFFF0ull && std::fseek(out, 0, SEEK_SET) == 0) {
+            std::vector<uint8_t> sizes;
+            putLE32(sizes, static_cast<uint32_t>(36 + dataBytes));
+            std::fseek(out, 4, SEEK_SET);
+            std::fwrite(sizes.data(), 1, 4, out);
+            sizes.clear();
+            putLE32(sizes, static_cast<uint32_t>(dataBytes));
+            std::fseek(out, 40, SEEK_SET);
+            std::fwrite(sizes.data(), 1, 4, out);
+        }
+        if (ownsStream) std::fclose(out);
+        else std::fflush(out);
+        return errorMsg.empty();
+    }
+}
+
+namespace HeadlessExport {
+
+int runStream(const std::vector<std::string>& args) {
+#ifndef _WIN32
+    // A reader that goes away must surface as a failed write, not kill the process.
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    StreamOptions opt;
+    std::vector<std::string> positional;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--threads" && i + 1 < args.size()) {
+            opt.threads = static_cast<unsigned>(std::max(0, std::atoi(args[++i].c_str())));
+        }
+        else if (args[i] == "--audio" && i + 1 < args.size()) {
+            opt.audioPath = args[++i];
+        }
+        else if (args[i] == "--demosaic" && i + 1 < args.size()) {
+            opt.algorithm = CpuImagePipeline::algorithmFromString(args[++i]);
+            if (opt.algorithm < 0) return 1;
+        }
+        else {
+            positional.push_back(args[i]);
+        }
+    }
+    if (positional.size() < 2) return 1;
+    if (positional[0] == "rawvideo") opt.format = StreamFormat::RAWVIDEO;
+    else if (positional[0] == "y4m") opt.format = StreamFormat::Y4M;
+    else return 1;
+    opt.inputPath = positional[1];
+    if (positional.size() >= 3) opt.outputPath = positional[2];
+
+    std::unique_ptr<motioncam::Decoder> decoder;
+    try {
+        decoder = std::make_unique<motioncam::Decoder>(opt.inputPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Failed to open " << opt.inputPath << ": " << e.what() << std::endl;
+        return 2;
+    }
+
+    const std::vector<motioncam::Timestamp> frames = decoder->getFrames();
+    const nlohmann::json containerMetadata = decoder->getContainerMetadata();
+    if (frames.empty()) {
+        std::cerr << "No frames in " << opt.inputPath << std::endl;
+        return 2;
+    }
+    int fpsNum = 30, fpsDen = 1;
+    estimateFrameRate(frames, fpsNum, fpsDen);
+
+    // Audio runs on its own thread so a reader that opens the video and audio pipes in either
+    // order never deadlocks against us. It shares the decoder; reads are thread-safe.
+    std::thread audioThread;
+    if (!opt.audioPath.empty()) {
+        audioThread = std::thread([&opt, &audioDecoder = *decoder, firstTs = frames.front()]() {
+            try {
+                std::string err;
+                if (!writeWavStream(audioDecoder, firstTs, opt.audioPath, err)) {
+                    std::cerr << "Audio: " << err << std::endl;
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Audio: " << e.what() << std::endl;
+            }
+        });
+    }
+
+    StreamSlot slots[kNumStreamSlots];
+    ThreadSafeQueue<size_t> freeSlots;
+    ThreadSafeQueue<size_t> readySlots;
+    for (size_t i = 0; i < kNumStreamSlots; ++i) freeSlots.push(i);
+    std::atomic<bool> abort{ false };
+    std::atomic<size_t> failedFrames{ 0 };
+
+    std::thread producer([&]() {
+        std::vector<uint8_t> payload, metadataPayload;
+        std::vector<uint16_t> bayer;
+        for (size_t i = 0; i < frames.size() && !abort.load(); ++i) {
+            int width = 0, height = 0, compressionType = -1;
+            if (!decoder->getRawFramePayloads(frames[i], payload, metadataPayload, width, height, compressionType) ||
+                !decodeFramePayload(payload, width, height, compressionType, bayer)) {
+                LogToFile("[HeadlessExport::runStream] Failed to decode frame " + std::to_string(i) + ", repeating the previous frame.");
+                failedFrames++;
+                readySlots.push(kRepeatFrame);
+                continue;
+            }
+            nlohmann::json frameMetadata;
+            try {
+                frameMetadata = nlohmann::json::parse(metadataPayload.begin(), metadataPayload.end());
+            }
+            catch (const nlohmann::json::parse_error&) {
+                frameMetadata = nlohmann::json::object();
+            }
+
+            size_t slotIdx;
+            if (!freeSlots.wait_pop(slotIdx)) break;
+            StreamSlot& slot = slots[slotIdx];
+            slot.rgb.resize(static_cast<size_t>(width) * height * 3);
+            slot.width = width;
+            slot.height = height;
+            slot.frameIndex = i;
+            CpuImagePipeline::Params params = CpuImagePipeline::paramsFromMetadata(frameMetadata, containerMetadata);
+            params.algorithm = opt.algorithm;
+            CpuImagePipeline::process(bayer.data(), width, height, params,
+                CpuImagePipeline::Output::SRGB_U16, slot.rgb.data(), opt.threads);
+            readySlots.push(slotIdx);
+        }
+        readySlots.push(kEndOfStream);
+    });
+
+    bool ownsStream = false;
+    std::FILE* out = openOutputStream(opt.outputPath, ownsStream);
+    if (!out) {
+        std::cerr << "Failed to open video output: " << opt.outputPath << std::endl;
+        abort.store(true);
+        freeSlots.stop_operations();
+    }
+
+    ImageWriters::Y4mWriter y4m;
+    size_t framesWritten = 0;  // Decoded frames of the clip
+    size_t framesRepeated = 0; // Copies of the previous frame in place of failed ones
+    size_t leadingRepeats = 0; // Failures before the first frame, written once it arrives
+    size_t lastWritten = kEndOfStream; // Slot kept back for repeats
+    int streamWidth = 0, streamHeight = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    // Every frame of the clip yields exactly one frame of output, so the video keeps its
+    // timing against the audio side stream however many frames fail.
+    auto writeRgb = [&](const std::vector<uint16_t>& rgb, std::string& err) {
+        if (opt.format == StreamFormat::Y4M) return y4m.writeFrame(rgb.data(), err);
+        // rgb48le is the native little-endian layout of the slot.
+        const size_t bytes = rgb.size() * sizeof(uint16_t);
+        if (std::fwrite(rgb.data(), 1, bytes, out) == bytes) return true;
+        err = "Video stream write failed (reader closed?).";
+        return false;
+    };
+
+    while (out) {
+        size_t slotIdx;
+        if (!readySlots.wait_pop(slotIdx) || slotIdx == kEndOfStream) break;
+        std::string err;
+        bool ok = true;
+
+        if (slotIdx == kRepeatFrame) {
+            if (lastWritten == kEndOfStream) {
+                leadingRepeats++;
+                continue;
+            }
+            ok = writeRgb(slots[lastWritten].rgb, err);
+            if (ok) framesRepeated++;
+        }
+        else {
+            const StreamSlot& slot = slots[slotIdx];
+            if (streamWidth == 0) {
+                streamWidth = slot.width;
+                streamHeight = slot.height;
+                if (opt.format == StreamFormat::Y4M) {
+                    ok = y4m.attach(out, streamWidth, streamHeight, fpsNum, fpsDen, err);
+                }
+                else {
+                    std::cerr << "rawvideo: -f rawvideo -pix_fmt rgb48le -s " << streamWidth << "x" << streamHeight
+                        << " -r " << fpsNum << "/" << fpsDen << std::endl;
+                }
+            }
+
+            if (ok && (slot.width != streamWidth || slot.height != streamHeight)) {
+                LogToFile("[HeadlessExport::runStream] Frame " + std::to_string(slot.frameIndex) + " changes dimensions mid-stream, repeating the previous frame.");
+                failedFrames++;
+                ok = writeRgb(slots[lastWritten].rgb, err);
+                if (ok) framesRepeated++;
+                freeSlots.push(slotIdx);
+            }
+            else if (ok) {
+                for (size_t copies = 1 + leadingRepeats; ok && copies > 0; --copies) {
+                    ok = writeRgb(slot.rgb, err);
+                }
+                if (ok) {
+                    framesWritten++;
+                    framesRepeated += leadingRepeats;
+                    leadingRepeats = 0;
+                }
+                if (lastWritten != kEndOfStream) freeSlots.push(lastWritten);
+                lastWritten = slotIdx;
+            }
+            else {
+                freeSlots.push(slotIdx);
+            }
+        }
+
+        if (!ok) {
+            std::cerr << err << std::endl;
+            abort.store(true);
+            freeSlots.stop_operations();
+            break;
+        }
+    }
+
+    producer.join();
+    y4m.close();
+    if (out) {
+        if (ownsStream) std::fclose(out);
+        else std::fflush(out);
+    }
+    if (audioThread.joinable()) audioThread.join();
+
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Streamed " << framesWritten << "/" << frames.size() << " frames in " << secs << " s ("
+        << (secs > 0 ? framesWritten / secs : 0.0) << " fps), " << failedFrames.load() << " failed, "
+        << framesRepeated << " repeated in their place" << std::endl;
+    LogToFile("[HeadlessExport::runStream] Streamed " + std::to_string(framesWritten) + " frames, " +
+        std::to_string(framesRepeated) + " repeated.");
+    return (abort.load() || failedFrames.load() > 0) ? 2 : 0;
+}
+
+} // namespace HeadlessExport
@@ -4,6 +4,7 @@
 #include "Utils/DebugLog.h"
 
 #include <array> // For std::array
+#include <vector>
 
 namespace Descriptor {
 
@@ -12,18 +13,41 @@ namespace Descriptor {
         VkDescriptorSetLayoutBinding samplerLayoutBinding{};
         samplerLayoutBinding.binding = 0;
         samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        samplerLayoutBinding.descriptorCount = 1;
-        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        samplerLayoutBinding.descriptorCount = Renderer_VK::kNumRawImages;
+        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
         samplerLayoutBinding.pImmutableSamplers = nullptr;
 
         VkDescriptorSetLayoutBinding uboLayoutBinding{};
         uboLayoutBinding.binding = 1;
         uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         uboLayoutBinding.descriptorCount = 1;
-        uboLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        uboLayoutBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
         uboLayoutBinding.pImmutableSamplers = nullptr;
 
-        std::array<VkDescriptorSetLayoutBinding, 2> bindings = { samplerLayoutBinding, uboLayoutBinding };
+        // One layout shared by the demosaic compute pass (0, 1, 2) and the display pass (1, 3).
+        VkDescriptorSetLayoutBinding storageImageLayoutBinding{};
+        storageImageLayoutBinding.binding = 2;
+        storageImageLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        storageImageLayoutBinding.descriptorCount = 1;
+        storageImageLayoutBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        storageImageLayoutBinding.pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutBinding processedSamplerLayoutBinding{};
+        processedSamplerLayoutBinding.binding = 3;
+        processedSamplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        processedSamplerLayoutBinding.descriptorCount = 1;
+        processedSamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        processedSamplerLayoutBinding.pImmutableSamplers = nullptr;
+
+        // Staging ring read in place by the demosaic pass on the StorageBuffer upload path.
+        VkDescriptorSetLayoutBinding rawBufferLayoutBinding{};
+        rawBufferLayoutBinding.binding = 4;
+        rawBufferLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        rawBufferLayoutBinding.descriptorCount = 1;
+        rawBufferLayoutBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        rawBufferLayoutBinding.pImmutableSamplers = nullptr;
+
+        std::array<VkDescriptorSetLayoutBinding, 5> bindings = { samplerLayoutBinding, uboLayoutBinding, storageImageLayoutBinding, processedSamplerLayoutBinding, rawBufferLayoutBinding };
         VkDescriptorSetLayoutCreateInfo layoutInfo{};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -152,11 +176,15 @@ namespace Descriptor {
         if (renderer->m_swapChainImageCount == 0) {
             LogToFile("[Descriptor::createDescriptorPool] WARNING: m_swapChainImageCount is 0. Pool will be minimal.");
         }
-        std::array<VkDescriptorPoolSize, 2> poolSizes{};
+        std::array<VkDescriptorPoolSize, 4> poolSizes{};
         poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes[0].descriptorCount = (renderer->m_swapChainImageCount > 0) ? renderer->m_swapChainImageCount : 1;
+        poolSizes[0].descriptorCount = (Renderer_VK::kNumRawImages + 1) * ((renderer->m_swapChainImageCount > 0) ? renderer->m_swapChainImageCount : 1);
         poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         poolSizes[1].descriptorCount = (renderer->m_swapChainImageCount > 0) ? renderer->m_swapChainImageCount : 1;
+        poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes[2].descriptorCount = (renderer->m_swapChainImageCount > 0) ? renderer->m_swapChainImageCount : 1;
+        poolSizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[3].descriptorCount = (renderer->m_swapChainImageCount > 0) ? renderer->m_swapChainImageCount : 1;
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -196,16 +224,42 @@ namespace Descriptor {
         }
 
         updateDescriptorSetsWithNewRawImage(renderer);
+        updateRawSourceBuffer(renderer);
         return true;
     }
 
+    void updateRawSourceBuffer(Renderer_VK* renderer) {
+        VkBuffer buffer = (renderer->m_rawSourceBuffer != VK_NULL_HANDLE) ? renderer->m_rawSourceBuffer : renderer->m_placeholderRawBuffer;
+        if (renderer->m_descriptorSets.empty() || buffer == VK_NULL_HANDLE) {
+            return;
+        }
+
+        VkDescriptorBufferInfo rawBufferInfo{};
+        rawBufferInfo.buffer = buffer;
+        rawBufferInfo.offset = 0;
+        rawBufferInfo.range = VK_WHOLE_SIZE;
+
+        std::vector<VkWriteDescriptorSet> writes(renderer->m_descriptorSets.size());
+        for (size_t i = 0; i < renderer->m_descriptorSets.size(); ++i) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = renderer->m_descriptorSets[i];
+            writes[i].dstBinding = 4;
+            writes[i].dstArrayElement = 0;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].descriptorCount = 1;
+            writes[i].pBufferInfo = &rawBufferInfo;
+        }
+        vkUpdateDescriptorSets(renderer->m_device_p, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
     void updateDescriptorSetsWithNewRawImage(Renderer_VK* renderer) {
         if (renderer->m_descriptorSets.empty()) {
             LogToFile("[Descriptor::updateDescriptorSetsWithNewRawImage] No descriptor sets to update.");
             return;
         }
-        if (renderer->m_rawImageView == VK_NULL_HANDLE || renderer->m_rawImageSampler == VK_NULL_HANDLE) {
-            LogToFile("[Descriptor::updateDescriptorSetsWithNewRawImage] ERROR: Cannot update. Raw image view or sampler is invalid.");
+        if (renderer->m_rawImageView == VK_NULL_HANDLE || renderer->m_rawImageSampler == VK_NULL_HANDLE ||
+            renderer->m_processedImageView == VK_NULL_HANDLE || renderer->m_processedImageSampler == VK_NULL_HANDLE) {
+            LogToFile("[Descriptor::updateDescriptorSetsWithNewRawImage] ERROR: Cannot update. Raw/processed image view or sampler is invalid.");
             return;
         }
         LogToFile(std::string("[Descriptor::updateDescriptorSetsWithNewRawImage] Updating ") + std::to_string(renderer->m_descriptorSets.size()) + " descriptor sets.");
@@ -223,24 +277,38 @@ namespace Descriptor {
                 continue;
             }
 
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = renderer->m_rawImageView;
-            imageInfo.sampler = renderer->m_rawImageSampler;
+            // m_rawImage first, then the transfer slots; m_rawImage fills any slot that does not exist.
+            std::array<VkDescriptorImageInfo, Renderer_VK::kNumRawImages> rawImageInfos{};
+            for (uint32_t e = 0; e < Renderer_VK::kNumRawImages; ++e) {
+                const bool hasSlot = e > 0 && e - 1 < renderer->m_transferSlotViews.size() && renderer->m_transferSlotViews[e - 1] != VK_NULL_HANDLE;
+                rawImageInfos[e].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                rawImageInfos[e].imageView = hasSlot ? renderer->m_transferSlotViews[e - 1] : renderer->m_rawImageView;
+                rawImageInfos[e].sampler = renderer->m_rawImageSampler;
+            }
 
             VkDescriptorBufferInfo bufferInfo{};
             bufferInfo.buffer = renderer->m_uniformBuffers[i];
             bufferInfo.offset = 0;
             bufferInfo.range = sizeof(TempShaderParamsUBO); // Using local temp struct for sizeof
 
-            std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+            VkDescriptorImageInfo storageImageInfo{};
+            storageImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            storageImageInfo.imageView = renderer->m_processedImageView;
+            storageImageInfo.sampler = VK_NULL_HANDLE;
+
+            VkDescriptorImageInfo processedImageInfo{};
+            processedImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            processedImageInfo.imageView = renderer->m_processedImageView;
+            processedImageInfo.sampler = renderer->m_processedImageSampler;
+
+            std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
             descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptorWrites[0].dstSet = renderer->m_descriptorSets[i];
             descriptorWrites[0].dstBinding = 0;
             descriptorWrites[0].dstArrayElement = 0;
             descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[0].descriptorCount = 1;
-            descriptorWrites[0].pImageInfo = &imageInfo;
+            descriptorWrites[0].descriptorCount = Renderer_VK::kNumRawImages;
+            descriptorWrites[0].pImageInfo = rawImageInfos.data();
 
             descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptorWrites[1].dstSet = renderer->m_descriptorSets[i];
@@ -250,6 +318,22 @@ namespace Descriptor {
             descriptorWrites[1].descriptorCount = 1;
             descriptorWrites[1].pBufferInfo = &bufferInfo;
 
+            descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[2].dstSet = renderer->m_descriptorSets[i];
+            descriptorWrites[2].dstBinding = 2;
+            descriptorWrites[2].dstArrayElement = 0;
+            descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            descriptorWrites[2].descriptorCount = 1;
+            descriptorWrites[2].pImageInfo = &storageImageInfo;
+
+            descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[3].dstSet = renderer->m_descriptorSets[i];
+            descriptorWrites[3].dstBinding = 3;
+            descriptorWrites[3].dstArrayElement = 0;
+            descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrites[3].descriptorCount = 1;
+            descriptorWrites[3].pImageInfo = &processedImageInfo;
+
             vkUpdateDescriptorSets(renderer->m_device_p, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
         }
     }
@@ -0,0 +1,215 @@
+// FILE: src/Graphics/GpuRawDecoder.cpp
+#include "Graphics/GpuRawDecoder.h"
+#include "Graphics/VulkanHelpers.h"
+#include "Utils/DebugLog.h"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+GpuRawDecoder::~GpuRawDecoder() {
+    cleanup();
+}
+
+bool GpuRawDecoder::isSupported(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceFeatures features{};
+    vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+    if (!features.shaderStorageImageExtendedFormats) {
+        return false;
+    }
+    VkFormatProperties formatProperties{};
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R16_UINT, &formatProperties);
+    return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0;
+}
+
+bool GpuRawDecoder::init(VkDevice device, const std::string& shaderPath, VkPipelineCache pipelineCache) {
+    cleanup();
+    m_device = device;
+
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    VkResult result = vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_setLayout);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuRawDecoder::init] Failed to create descriptor set layout. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 };
+    poolSizes[1] = { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 };
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+    result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_descriptorPool);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuRawDecoder::init] Failed to create descriptor pool. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = m_descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_setLayout;
+    result = vkAllocateDescriptorSets(device, &allocInfo, &m_descriptorSet);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuRawDecoder::init] Failed to allocate descriptor set. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(DecodeParams);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    result = vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuRawDecoder::init] Failed to create pipeline layout. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    try {
+        shaderModule = VulkanHelpers::createShaderModule(device, VulkanHelpers::readFile(shaderPath));
+    }
+    catch (const std::exception& e) {
+        LogToFile(std::string("[GpuRawDecoder::init] Failed to load ") + shaderPath + ": " + e.what());
+        cleanup();
+        return false;
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = m_pipelineLayout;
+    result = vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &m_pipeline);
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuRawDecoder::init] Failed to create decode pipeline. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    LogToFile("[GpuRawDecoder::init] GPU decoding of type 7 payloads available.");
+    return true;
+}
+
+void GpuRawDecoder::cleanup() {
+    if (m_device != VK_NULL_HANDLE) {
+        if (m_pipeline != VK_NULL_HANDLE) vkDestroyPipeline(m_device, m_pipeline, nullptr);
+        if (m_pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        if (m_descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+        if (m_setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+    }
+    m_pipeline = VK_NULL_HANDLE;
+    m_pipelineLayout = VK_NULL_HANDLE;
+    m_descriptorPool = VK_NULL_HANDLE;
+    m_descriptorSet = VK_NULL_HANDLE;
+    m_setLayout = VK_NULL_HANDLE;
+    m_sourceRange = 0;
+    m_hasSource = false;
+    m_hasTarget = false;
+    m_device = VK_NULL_HANDLE;
+}
+
+void GpuRawDecoder::setSource(VkBuffer buffer, VkDeviceSize range) {
+    if (m_descriptorSet == VK_NULL_HANDLE || buffer == VK_NULL_HANDLE || range == 0) {
+        m_sourceRange = 0;
+        m_hasSource = false;
+        return;
+    }
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = range;
+
+    VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    write.dstSet = m_descriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+    m_sourceRange = range;
+    m_hasSource = true;
+}
+
+void GpuRawDecoder::setTarget(VkImageView targetView) {
+    if (m_descriptorSet == VK_NULL_HANDLE || targetView == VK_NULL_HANDLE) {
+        m_hasTarget = false;
+        return;
+    }
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = targetView;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    write.dstSet = m_descriptorSet;
+    write.dstBinding = 1;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+    m_hasTarget = true;
+}
+
+bool GpuRawDecoder::recordDecode(VkCommandBuffer commandBuffer, VkImage target, const DecodeParams& params) const {
+    if (m_pipeline == VK_NULL_HANDLE || !m_hasSource || !m_hasTarget) {
+        LogToFile("[GpuRawDecoder::recordDecode] ERROR: Pipeline, source or target not set. Skipping decode.");
+        return false;
+    }
+
+    VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = target;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    // The previous frame's demosaic may still be sampling the image.
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DecodeParams), &params);
+    // One workgroup per 64 columns x 4 rows, see local_size in mcraw_decode.comp.
+    vkCmdDispatch(commandBuffer, params.blocksPerRow, params.rowGroups, 1);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+    return true;
+}
@@ -0,0 +1,389 @@
+// FILE: src/Graphics/GpuScopes.cpp
+#include "Graphics/GpuScopes.h"
+#include "Graphics/VulkanHelpers.h"
+#include "Utils/DebugLog.h"
+
+#include <imgui_impl_vulkan.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    constexpr uint32_t kGroupSize = 16; // GROUP in scopes.comp
+    constexpr uint32_t kAtlasWidth = GpuScopes::kPanelSize * GpuScopes::kNumPanels;
+    constexpr uint32_t kAtlasHeight = GpuScopes::kPanelSize;
+
+    uint32_t groupsFor(uint32_t n) {
+        return (n + kGroupSize - 1) / kGroupSize;
+    }
+}
+
+GpuScopes::~GpuScopes() {
+    cleanup();
+}
+
+bool GpuScopes::init(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator, uint32_t queueFamily,
+    uint32_t framesInFlight, const std::string& shaderPath, VkPipelineCache pipelineCache) {
+    cleanup();
+    m_device = device;
+    m_allocator = allocator;
+    m_framesInFlight = framesInFlight;
+
+    VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size = static_cast<VkDeviceSize>(kBinCount) * sizeof(uint32_t);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VmaAllocationCreateInfo bufferAllocInfo{};
+    bufferAllocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    VkResult result = vmaCreateBuffer(m_allocator, &bufferInfo, &bufferAllocInfo, &m_bins, &m_binsAllocation, nullptr);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuScopes::init] Failed to create bin buffer. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = { kAtlasWidth, kAtlasHeight, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VmaAllocationCreateInfo imageAllocInfo{};
+    imageAllocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    result = vmaCreateImage(m_allocator, &imageInfo, &imageAllocInfo, &m_atlas, &m_atlasAllocation, nullptr);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuScopes::init] Failed to create scope atlas. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+    viewInfo.image = m_atlas;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    VK_CHECK_RENDERER(vkCreateImageView(m_device, &viewInfo, nullptr, &m_atlasView));
+
+    VkSamplerCreateInfo samplerInfo{ VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+    VK_CHECK_RENDERER(vkCreateSampler(m_device, &samplerInfo, nullptr, &m_atlasSampler));
+
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    bindings[0] = { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+    bindings[1] = { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+    bindings[2] = { 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+    VkDescriptorSetLayoutCreateInfo layoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    result = vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_setLayout);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuScopes::init] Failed to create descriptor set layout. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    poolSizes[0] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, framesInFlight };
+    poolSizes[1] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, framesInFlight };
+    poolSizes[2] = { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, framesInFlight };
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = framesInFlight;
+    result = vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuScopes::init] Failed to create descriptor pool. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    std::vector<VkDescriptorSetLayout> setLayouts(framesInFlight, m_setLayout);
+    m_sets.assign(framesInFlight, VK_NULL_HANDLE);
+    m_boundSources.assign(framesInFlight, VK_NULL_HANDLE);
+    VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = m_descriptorPool;
+    allocInfo.descriptorSetCount = framesInFlight;
+    allocInfo.pSetLayouts = setLayouts.data();
+    result = vkAllocateDescriptorSets(m_device, &allocInfo, m_sets.data());
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuScopes::init] Failed to allocate descriptor sets. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    // The bins and the atlas never change; only the processed image is rebound later.
+    VkDescriptorBufferInfo binsInfo{ m_bins, 0, VK_WHOLE_SIZE };
+    VkDescriptorImageInfo atlasInfo{ VK_NULL_HANDLE, m_atlasView, VK_IMAGE_LAYOUT_GENERAL };
+    std::vector<VkWriteDescriptorSet> writes;
+    for (VkDescriptorSet set : m_sets) {
+        VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        write.dstSet = set;
+        write.descriptorCount = 1;
+        write.dstBinding = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &binsInfo;
+        writes.push_back(write);
+        write.dstBinding = 2;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write.pBufferInfo = nullptr;
+        write.pImageInfo = &atlasInfo;
+        writes.push_back(write);
+    }
+    vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    VkPushConstantRange pushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants) };
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    result = vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuScopes::init] Failed to create pipeline layout. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    try {
+        shaderModule = VulkanHelpers::createShaderModule(m_device, VulkanHelpers::readFile(shaderPath));
+    }
+    catch (const std::exception& e) {
+        LogToFile(std::string("[GpuScopes::init] Failed to load ") + shaderPath + ": " + e.what());
+        cleanup();
+        return false;
+    }
+
+    // PASS is the only specialisation constant: 0 accumulates, 1 resolves.
+    const std::array<int32_t, 2> passes = { 0, 1 };
+    const VkSpecializationMapEntry passEntry{ 0, 0, sizeof(int32_t) };
+    std::array<VkSpecializationInfo, 2> specInfos{};
+    std::array<VkComputePipelineCreateInfo, 2> pipelineInfos{};
+    for (size_t i = 0; i < passes.size(); ++i) {
+        specInfos[i] = { 1, &passEntry, sizeof(int32_t), &passes[i] };
+        pipelineInfos[i].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfos[i].stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfos[i].stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfos[i].stage.module = shaderModule;
+        pipelineInfos[i].stage.pName = "main";
+        pipelineInfos[i].stage.pSpecializationInfo = &specInfos[i];
+        pipelineInfos[i].layout = m_pipelineLayout;
+    }
+    std::array<VkPipeline, 2> pipelines{};
+    result = vkCreateComputePipelines(m_device, pipelineCache, static_cast<uint32_t>(pipelineInfos.size()), pipelineInfos.data(), nullptr, pipelines.data());
+    vkDestroyShaderModule(m_device, shaderModule, nullptr);
+    if (result != VK_SUCCESS) {
+        LogToFile("[GpuScopes::init] Failed to create scope pipelines. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+    m_accumulatePipeline = pipelines[0];
+    m_resolvePipeline = pipelines[1];
+
+    // Timing is optional; the scopes work without it.
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &props);
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    if (queueFamily < familyCount && families[queueFamily].timestampValidBits > 0 && props.limits.timestampPeriod > 0.0f) {
+        VkQueryPoolCreateInfo queryInfo{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = 2 * framesInFlight;
+        if (vkCreateQueryPool(m_device, &queryInfo, nullptr, &m_queryPool) == VK_SUCCESS) {
+            m_timestampPeriodNs = props.limits.timestampPeriod;
+        }
+        else {
+            m_queryPool = VK_NULL_HANDLE;
+        }
+    }
+    m_queryPending.assign(framesInFlight, false);
+
+    m_textureSet = ImGui_ImplVulkan_AddTexture(m_atlasSampler, m_atlasView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    LogToFile(std::string("[GpuScopes::init] Scopes available") + (m_queryPool != VK_NULL_HANDLE ? ", GPU-timed." : ", untimed."));
+    return true;
+}
+
+void GpuScopes::cleanup() {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+    if (m_textureSet != VK_NULL_HANDLE) {
+        ImGui_ImplVulkan_RemoveTexture(m_textureSet);
+        m_textureSet = VK_NULL_HANDLE;
+    }
+    if (m_queryPool != VK_NULL_HANDLE) vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+    if (m_accumulatePipeline != VK_NULL_HANDLE) vkDestroyPipeline(m_device, m_accumulatePipeline, nullptr);
+    if (m_resolvePipeline != VK_NULL_HANDLE) vkDestroyPipeline(m_device, m_resolvePipeline, nullptr);
+    if (m_pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+    if (m_descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+    if (m_setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+    if (m_atlasSampler != VK_NULL_HANDLE) vkDestroySampler(m_device, m_atlasSampler, nullptr);
+    if (m_atlasView != VK_NULL_HANDLE) vkDestroyImageView(m_device, m_atlasView, nullptr);
+    if (m_atlas != VK_NULL_HANDLE) vmaDestroyImage(m_allocator, m_atlas, m_atlasAllocation);
+    if (m_bins != VK_NULL_HANDLE) vmaDestroyBuffer(m_allocator, m_bins, m_binsAllocation);
+    m_queryPool = VK_NULL_HANDLE;
+    m_accumulatePipeline = VK_NULL_HANDLE;
+    m_resolvePipeline = VK_NULL_HANDLE;
+    m_pipelineLayout = VK_NULL_HANDLE;
+    m_descriptorPool = VK_NULL_HANDLE;
+    m_setLayout = VK_NULL_HANDLE;
+    m_atlasSampler = VK_NULL_HANDLE;
+    m_atlasView = VK_NULL_HANDLE;
+    m_atlas = VK_NULL_HANDLE;
+    m_atlasAllocation = VK_NULL_HANDLE;
+    m_bins = VK_NULL_HANDLE;
+    m_binsAllocation = VK_NULL_HANDLE;
+    m_sets.clear();
+    m_boundSources.clear();
+    m_queryPending.clear();
+    m_atlasInitialized = false;
+    m_lastGeneration = 0;
+    m_lastGpuMs = -1.0;
+    m_device = VK_NULL_HANDLE;
+}
+
+GpuScopes::Uv GpuScopes::panelUv(Panel panel) {
+    const float u0 = static_cast<float>(static_cast<int>(panel)) / kNumPanels;
+    return { u0, 0.0f, u0 + 1.0f / kNumPanels, 1.0f };
+}
+
+// The slot's previous submission has completed, so its timestamps are available without waiting.
+void GpuScopes::collectTimestamps(uint32_t frameSlot) {
+    if (m_queryPool == VK_NULL_HANDLE || !m_queryPending[frameSlot]) {
+        return;
+    }
+    m_queryPending[frameSlot] = false;
+    std::array<uint64_t, 2> ticks{};
+    if (vkGetQueryPoolResults(m_device, m_queryPool, 2 * frameSlot, 2, sizeof(ticks), ticks.data(), sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT) == VK_SUCCESS && ticks[1] >= ticks[0]) {
+        m_lastGpuMs = static_cast<double>(ticks[1] - ticks[0]) * m_timestampPeriodNs * 1e-6;
+    }
+}
+
+void GpuScopes::recordUpdate(VkCommandBuffer commandBuffer, uint32_t frameSlot,
+    VkImageView processedView, VkSampler processedSampler, uint64_t sourceGeneration,
+    int frameWidth, int frameHeight) {
+    if (m_device == VK_NULL_HANDLE || frameSlot >= m_framesInFlight) {
+        return;
+    }
+    collectTimestamps(frameSlot);
+    if (sourceGeneration == m_lastGeneration || processedView == VK_NULL_HANDLE || frameWidth <= 0 || frameHeight <= 0) {
+        return;
+    }
+    m_lastGeneration = sourceGeneration;
+
+    // The processed image is only recreated after a device wait, and this slot's previous
+    // submission has finished, so rebinding its set here is safe.
+    VkDescriptorSet set = m_sets[frameSlot];
+    if (m_boundSources[frameSlot] != processedView) {
+        VkDescriptorImageInfo sourceInfo{ processedSampler, processedView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        write.dstSet = set;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &sourceInfo;
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+        m_boundSources[frameSlot] = processedView;
+    }
+
+    const uint64_t pixels = static_cast<uint64_t>(frameWidth) * static_cast<uint64_t>(frameHeight);
+    const int32_t stride = std::max<int32_t>(1, static_cast<int32_t>(std::ceil(std::sqrt(static_cast<double>(pixels) / kMaxSamples))));
+    const uint32_t samplesX = (static_cast<uint32_t>(frameWidth) + stride - 1) / stride;
+    const uint32_t samplesY = (static_cast<uint32_t>(frameHeight) + stride - 1) / stride;
+    m_lastSampleCount = samplesX * samplesY;
+    const float samples = static_cast<float>(m_lastSampleCount);
+
+    PushConstants params{};
+    params.width = frameWidth;
+    params.height = frameHeight;
+    params.stride = stride;
+    // A column or chroma bin that gets its share of samples lands mid-scale.
+    params.waveGain = 262144.0f / samples;
+    params.paradeGain = 131072.0f / samples;
+    params.vectorGain = 65536.0f / samples;
+
+    if (m_queryPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, m_queryPool, 2 * frameSlot, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, 2 * frameSlot);
+    }
+
+    // The previous update's resolve may still be reading the bins.
+    VkBufferMemoryBarrier binsBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+    binsBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    binsBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    binsBarrier.buffer = m_bins;
+    binsBarrier.offset = 0;
+    binsBarrier.size = VK_WHOLE_SIZE;
+    binsBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    binsBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 1, &binsBarrier, 0, nullptr);
+    vkCmdFillBuffer(commandBuffer, m_bins, 0, VK_WHOLE_SIZE, 0);
+
+    binsBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    binsBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    // The demosaic's final barrier only covers fragment reads; chain through it for compute.
+    VkMemoryBarrier sourceBarrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    sourceBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    sourceBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &sourceBarrier, 1, &binsBarrier, 0, nullptr);
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &set, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_accumulatePipeline);
+    vkCmdDispatch(commandBuffer, groupsFor(samplesX), groupsFor(samplesY), 1);
+
+    // Earlier frames in flight may still be drawing the previous atlas.
+    VkImageMemoryBarrier atlasBarrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    atlasBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    atlasBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    atlasBarrier.image = m_atlas;
+    atlasBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    atlasBarrier.oldLayout = m_atlasInitialized ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    atlasBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    atlasBarrier.srcAccessMask = m_atlasInitialized ? VK_ACCESS_SHADER_READ_BIT : 0;
+    atlasBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    binsBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    binsBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 1, &binsBarrier, 1, &atlasBarrier);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_resolvePipeline);
+    vkCmdDispatch(commandBuffer, groupsFor(kAtlasWidth), groupsFor(kAtlasHeight), 1);
+
+    atlasBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    atlasBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    atlasBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    atlasBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &atlasBarrier);
+    m_atlasInitialized = true;
+
+    if (m_queryPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, 2 * frameSlot + 1);
+        m_queryPending[frameSlot] = true;
+    }
+}
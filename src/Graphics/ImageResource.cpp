@@ -106,6 +106,9 @@ namespace ImageResource {
         imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
         imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (renderer->m_gpuRawDecoder) {
+            imageInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT; // Written by mcraw_decode.comp
+        }
         imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 
@@ -125,6 +128,9 @@ namespace ImageResource {
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
         VK_CHECK_RENDERER(vkCreateImageView(renderer->m_device_p, &viewInfo, nullptr, &renderer->m_rawImageView));
+        if (renderer->m_gpuRawDecoder) {
+            renderer->m_gpuRawDecoder->setTarget(renderer->m_rawImageView);
+        }
 
         VkSamplerCreateInfo samplerInfo{};
         samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -153,11 +159,52 @@ namespace ImageResource {
             VK_IMAGE_LAYOUT_UNDEFINED,
             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         );
-        LogToFile("ImageResource::createRawImageResources Raw image resources created and transitioned.");
+
+        // Demosaiced output, same extent as the raw image.
+        imageInfo.format = VK_FORMAT_R16G16B16A16_SFLOAT;
+        imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        VK_CHECK_RENDERER(vmaCreateImage(renderer->m_allocator_p, &imageInfo, &allocInfo, &renderer->m_processedImage, &renderer->m_processedImageAllocation, nullptr));
+
+        viewInfo.image = renderer->m_processedImage;
+        viewInfo.format = VK_FORMAT_R16G16B16A16_SFLOAT;
+        VK_CHECK_RENDERER(vkCreateImageView(renderer->m_device_p, &viewInfo, nullptr, &renderer->m_processedImageView));
+
+        // Linear filtering for the fit-to-window downscale. Zooming in past 1:1 shows photosites
+        // as square pixels rather than blurring them; 1:1 lands on texel centres either way.
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+        VK_CHECK_RENDERER(vkCreateSampler(renderer->m_device_p, &samplerInfo, nullptr, &renderer->m_processedImageSampler));
+
+        transitionImageLayout(
+            renderer->m_device_p,
+            renderer->m_hostSiteCommandPool_p,
+            renderer->m_graphicsQueue_p,
+            renderer->m_processedImage,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        );
+        renderer->m_processedImageValid = false;
+
+        LogToFile("ImageResource::createRawImageResources Raw and processed image resources created and transitioned.");
         return true;
     }
 
     void cleanupRawImageResources(Renderer_VK* renderer) {
+        if (renderer->m_processedImageSampler != VK_NULL_HANDLE) {
+            vkDestroySampler(renderer->m_device_p, renderer->m_processedImageSampler, nullptr);
+            renderer->m_processedImageSampler = VK_NULL_HANDLE;
+        }
+        if (renderer->m_processedImageView != VK_NULL_HANDLE) {
+            vkDestroyImageView(renderer->m_device_p, renderer->m_processedImageView, nullptr);
+            renderer->m_processedImageView = VK_NULL_HANDLE;
+        }
+        if (renderer->m_processedImage != VK_NULL_HANDLE && renderer->m_allocator_p != VK_NULL_HANDLE) {
+            vmaDestroyImage(renderer->m_allocator_p, renderer->m_processedImage, renderer->m_processedImageAllocation);
+            renderer->m_processedImage = VK_NULL_HANDLE;
+            renderer->m_processedImageAllocation = VK_NULL_HANDLE;
+        }
+        renderer->m_processedImageValid = false;
         if (renderer->m_rawImageSampler != VK_NULL_HANDLE) {
             vkDestroySampler(renderer->m_device_p, renderer->m_rawImageSampler, nullptr);
             renderer->m_rawImageSampler = VK_NULL_HANDLE;
@@ -5,6 +5,7 @@
 #include "Utils/DebugLog.h"
 
 #include <array> // For std::array
+#include <cstddef> // For offsetof
 #include <filesystem> // For path joining
 
 namespace fs = std::filesystem;
@@ -128,7 +129,7 @@ namespace Pipeline {
         pipelineInfo.renderPass = renderPass;
         pipelineInfo.subpass = 0;
 
-        VK_CHECK_RENDERER(vkCreateGraphicsPipelines(renderer->m_device_p, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &renderer->m_graphicsPipeline));
+        VK_CHECK_RENDERER(vkCreateGraphicsPipelines(renderer->m_device_p, renderer->m_pipelineCache_p, 1, &pipelineInfo, nullptr, &renderer->m_graphicsPipeline));
         LogToFile("[Pipeline::createGraphicsPipeline] Graphics pipeline created.");
 
         vkDestroyShaderModule(renderer->m_device_p, fragShaderModule, nullptr);
@@ -138,6 +139,111 @@ namespace Pipeline {
         return true;
     }
 
+    bool createComputePipeline(Renderer_VK* renderer) {
+        LogToFile("[Pipeline::createComputePipeline] Creating demosaic compute pipelines...");
+        cleanupComputePipeline(renderer);
+
+        fs::path basePathFs(g_AppBasePath);
+        std::string compShaderPath = (basePathFs / "shaders_spv" / "demosaic.comp.spv").string();
+        LogToFile(std::string("[Pipeline::createComputePipeline] Attempting to load compute shader from: ") + compShaderPath);
+
+        auto compShaderCode = VulkanHelpers::readFile(compShaderPath);
+        VkShaderModule compShaderModule = VulkanHelpers::createShaderModule(renderer->m_device_p, compShaderCode);
+
+        // rawWordOffset and rawImageIndex (see RawSourceParams in demosaic.comp).
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = 2 * sizeof(uint32_t);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &renderer->m_descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        VK_CHECK_RENDERER(vkCreatePipelineLayout(renderer->m_device_p, &pipelineLayoutInfo, nullptr, &renderer->m_computePipelineLayout));
+
+        // Transfer slots, and with them a rawImageIndex other than 0, exist only when App enabled
+        // shaderSampledImageArrayDynamicIndexing, which it does whenever the device supports it.
+        VkPhysicalDeviceFeatures features{};
+        vkGetPhysicalDeviceFeatures(renderer->m_physicalDevice_p, &features);
+        const VkBool32 dynamicRawImageIndex = features.shaderSampledImageArrayDynamicIndexing;
+
+        // constant_id 0 = CFA layout, 1 = algorithm, 2 = raw source, 3 = dynamic raw image index
+        // (see demosaic.comp).
+        struct DemosaicSpecialization {
+            int32_t cfaType;
+            int32_t algorithm;
+            int32_t rawSource;
+            VkBool32 dynamicRawImageIndex;
+        };
+        std::array<VkSpecializationMapEntry, 4> specEntries{};
+        specEntries[0].constantID = 0;
+        specEntries[0].offset = offsetof(DemosaicSpecialization, cfaType);
+        specEntries[0].size = sizeof(int32_t);
+        specEntries[1].constantID = 1;
+        specEntries[1].offset = offsetof(DemosaicSpecialization, algorithm);
+        specEntries[1].size = sizeof(int32_t);
+        specEntries[2].constantID = 2;
+        specEntries[2].offset = offsetof(DemosaicSpecialization, rawSource);
+        specEntries[2].size = sizeof(int32_t);
+        specEntries[3].constantID = 3;
+        specEntries[3].offset = offsetof(DemosaicSpecialization, dynamicRawImageIndex);
+        specEntries[3].size = sizeof(VkBool32);
+
+        constexpr int kNumPipelines = Renderer_VK::kNumRawUploadPaths * Renderer_VK::kNumDemosaicAlgorithms * Renderer_VK::kNumCfaTypes;
+        std::array<DemosaicSpecialization, kNumPipelines> specData{};
+        std::array<VkSpecializationInfo, kNumPipelines> specInfos{};
+        std::array<VkComputePipelineCreateInfo, kNumPipelines> pipelineInfos{};
+
+        // Flattened in the same order as m_demosaicPipelines[rawSource][algorithm][cfa].
+        for (int rawSource = 0; rawSource < Renderer_VK::kNumRawUploadPaths; ++rawSource) {
+            for (int algorithm = 0; algorithm < Renderer_VK::kNumDemosaicAlgorithms; ++algorithm) {
+                for (int cfa = 0; cfa < Renderer_VK::kNumCfaTypes; ++cfa) {
+                    const int i = (rawSource * Renderer_VK::kNumDemosaicAlgorithms + algorithm) * Renderer_VK::kNumCfaTypes + cfa;
+                    specData[i] = { cfa, algorithm, rawSource, dynamicRawImageIndex };
+
+                    specInfos[i].mapEntryCount = static_cast<uint32_t>(specEntries.size());
+                    specInfos[i].pMapEntries = specEntries.data();
+                    specInfos[i].dataSize = sizeof(DemosaicSpecialization);
+                    specInfos[i].pData = &specData[i];
+
+                    pipelineInfos[i].sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+                    pipelineInfos[i].stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+                    pipelineInfos[i].stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+                    pipelineInfos[i].stage.module = compShaderModule;
+                    pipelineInfos[i].stage.pName = "main";
+                    pipelineInfos[i].stage.pSpecializationInfo = &specInfos[i];
+                    pipelineInfos[i].layout = renderer->m_computePipelineLayout;
+                }
+            }
+        }
+
+        VK_CHECK_RENDERER(vkCreateComputePipelines(renderer->m_device_p, renderer->m_pipelineCache_p, kNumPipelines, pipelineInfos.data(), nullptr, &renderer->m_demosaicPipelines[0][0][0]));
+        LogToFile(std::string("[Pipeline::createComputePipeline] ") + std::to_string(kNumPipelines) + " compute pipelines created.");
+
+        vkDestroyShaderModule(renderer->m_device_p, compShaderModule, nullptr);
+        return true;
+    }
+
+    void cleanupComputePipeline(Renderer_VK* renderer) {
+        for (auto& perRawSource : renderer->m_demosaicPipelines) {
+            for (auto& perAlgorithm : perRawSource) {
+                for (auto& pipeline : perAlgorithm) {
+                    if (pipeline != VK_NULL_HANDLE) {
+                        vkDestroyPipeline(renderer->m_device_p, pipeline, nullptr);
+                        pipeline = VK_NULL_HANDLE;
+                    }
+                }
+            }
+        }
+        if (renderer->m_computePipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(renderer->m_device_p, renderer->m_computePipelineLayout, nullptr);
+            renderer->m_computePipelineLayout = VK_NULL_HANDLE;
+        }
+    }
+
     void cleanupSwapChainResources(Renderer_VK* renderer) {
         LogToFile("[Pipeline::cleanupSwapChainResources] Cleaning swapchain-dependent resources...");
         if (renderer->m_graphicsPipeline != VK_NULL_HANDLE) {
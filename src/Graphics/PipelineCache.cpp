@@ -0,0 +1,103 @@
+// FILE: src/Graphics/PipelineCache.cpp
+#include "Graphics/PipelineCache.h"
+#include "Utils/DebugLog.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Drivers validate the blob themselves, but some crash on data from another GPU or
+    // driver version, so only hand over data whose header names this one.
+    bool headerMatches(const std::vector<char>& data, const VkPhysicalDeviceProperties& props) {
+        VkPipelineCacheHeaderVersionOne header{};
+        if (data.size() < sizeof(header)) return false;
+        std::memcpy(&header, data.data(), sizeof(header));
+        return header.headerSize >= sizeof(header)
+            && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            && header.vendorID == props.vendorID
+            && header.deviceID == props.deviceID
+            && std::memcmp(header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+}
+
+PipelineCache::~PipelineCache() {
+    cleanup();
+}
+
+bool PipelineCache::init(VkPhysicalDevice physicalDevice, VkDevice device, std::string path) {
+    cleanup();
+    m_device = device;
+    m_path = std::move(path);
+
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &props);
+
+    std::vector<char> data;
+    {
+        std::ifstream in(m_path, std::ios::binary);
+        if (in) {
+            data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+    }
+    if (!data.empty() && !headerMatches(data, props)) {
+        LogToFile("[PipelineCache::init] Ignoring " + m_path + ": written for another device or driver.");
+        data.clear();
+    }
+
+    VkPipelineCacheCreateInfo createInfo{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+    VkResult result = vkCreatePipelineCache(m_device, &createInfo, nullptr, &m_cache);
+    if (result != VK_SUCCESS && !data.empty()) {
+        LogToFile("[PipelineCache::init] Driver rejected " + m_path + ". Starting empty.");
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(m_device, &createInfo, nullptr, &m_cache);
+    }
+    if (result != VK_SUCCESS) {
+        LogToFile("[PipelineCache::init] vkCreatePipelineCache failed. Error: " + std::to_string(result));
+        m_cache = VK_NULL_HANDLE;
+        return false;
+    }
+    LogToFile("[PipelineCache::init] " + (data.empty() ? std::string("Empty cache") : "Loaded " + std::to_string(data.size()) + " bytes from " + m_path) + ".");
+    return true;
+}
+
+void PipelineCache::cleanup() {
+    if (m_cache == VK_NULL_HANDLE) return;
+    save();
+    vkDestroyPipelineCache(m_device, m_cache, nullptr);
+    m_cache = VK_NULL_HANDLE;
+}
+
+void PipelineCache::save() const {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) != VK_SUCCESS || size == 0) return;
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(m_device, m_cache, &size, data.data()) != VK_SUCCESS) return;
+    data.resize(size);
+
+    const std::string tempPath = m_path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            LogToFile("[PipelineCache::save] Cannot write " + tempPath);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, m_path, ec);
+    if (ec) {
+        LogToFile("[PipelineCache::save] Cannot replace " + m_path + ": " + ec.message());
+        return;
+    }
+    LOG_DEBUG("[PipelineCache::save] Wrote " + std::to_string(data.size()) + " bytes to " + m_path);
+}
@@ -15,15 +15,23 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <filesystem>
 #include <glm/gtc/matrix_transform.hpp>
 
+extern std::string g_AppBasePath;
 
-Renderer_VK::Renderer_VK(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator, VkQueue graphicsQueue, VkCommandPool commandPool)
+namespace {
+    // Must match TILE in demosaic.comp.
+    constexpr uint32_t kDemosaicTileSize = 16;
+}
+
+Renderer_VK::Renderer_VK(VkPhysicalDevice physicalDevice, VkDevice device, VmaAllocator allocator, VkQueue graphicsQueue, VkCommandPool commandPool, VkPipelineCache pipelineCache)
     : m_physicalDevice_p(physicalDevice),
     m_device_p(device),
     m_allocator_p(allocator),
     m_graphicsQueue_p(graphicsQueue),
     m_hostSiteCommandPool_p(commandPool),
+    m_pipelineCache_p(pipelineCache),
     m_rawImage(VK_NULL_HANDLE),
     m_rawImageAllocation(VK_NULL_HANDLE),
     m_rawImageView(VK_NULL_HANDLE),
@@ -51,9 +59,23 @@ bool Renderer_VK::init(VkRenderPass renderPass, uint32_t swapChainImageCount) {
     if (!Descriptor::createDescriptorSetLayout(this)) { LogToFile("[Renderer_VK::init] ERROR: Failed to create descriptor set layout."); return false; }
     LogToFile("[Renderer_VK::init] Descriptor set layout created.");
 
+    // Decides whether m_rawImage is created with storage usage, so it has to come first.
+    if (GpuRawDecoder::isSupported(m_physicalDevice_p)) {
+        m_gpuRawDecoder = std::make_unique<GpuRawDecoder>();
+        const std::string decodeShaderPath = (std::filesystem::path(g_AppBasePath) / "shaders_spv" / "mcraw_decode.comp.spv").string();
+        if (!m_gpuRawDecoder->init(m_device_p, decodeShaderPath, m_pipelineCache_p)) {
+            LogToFile("[Renderer_VK::init] GPU decoder unavailable. Frames are decoded on the CPU.");
+            m_gpuRawDecoder.reset();
+        }
+    }
+
     if (!ImageResource::createRawImageResources(this, 1, 1)) { LogToFile("[Renderer_VK::init] ERROR: Failed to create initial raw image resources."); return false; }
     LogToFile("[Renderer_VK::init] Initial raw image resources created.");
 
+    if (!Pipeline::createComputePipeline(this)) { LogToFile("[Renderer_VK::init] ERROR: Failed to create demosaic compute pipeline."); return false; }
+
+    if (!createPlaceholderRawBuffer()) { LogToFile("[Renderer_VK::init] ERROR: Failed to create placeholder raw source buffer."); return false; }
+
     onSwapChainRecreated(renderPass, swapChainImageCount);
 
     LogToFile("[Renderer_VK::init] Initialization successful.");
@@ -63,7 +85,14 @@ bool Renderer_VK::init(VkRenderPass renderPass, uint32_t swapChainImageCount) {
 void Renderer_VK::cleanup() {
     LogToFile("[Renderer_VK::cleanup] Starting cleanup...");
     Pipeline::cleanupSwapChainResources(this);
+    Pipeline::cleanupComputePipeline(this);
+    if (m_gpuRawDecoder) {
+        m_gpuRawDecoder->cleanup();
+        m_gpuRawDecoder.reset();
+    }
     ImageResource::cleanupRawImageResources(this);
+    destroyPlaceholderRawBuffer();
+    m_rawSourceBuffer = VK_NULL_HANDLE;
 
     if (m_descriptorSetLayout != VK_NULL_HANDLE) {
         LogToFile("[Renderer_VK::cleanup] Destroying descriptor set layout.");
@@ -100,7 +129,9 @@ void Renderer_VK::updateUniformBuffer(uint32_t uboBindingIndex, const ShaderPara
 void Renderer_VK::prepareAndUploadFrameData(
     VkCommandBuffer commandBuffer,
     uint32_t uboBindingIndex,
-    VkBuffer prefilledStagingBuffer,
+    VkBuffer prefilledStagingBuffer, VkDeviceSize stagingOffset,
+    std::optional<uint32_t> transferSlot,
+    const std::optional<GpuRawDecoder::DecodeParams>& gpuDecode,
     int frameWidth, int frameHeight,
     const nlohmann::json& frameMetadata,
     double staticBlack, double staticWhite, int cfaTypeOverride,
@@ -119,14 +150,33 @@ void Renderer_VK::prepareAndUploadFrameData(
             + std::to_string(m_currentRawW) + "x" + std::to_string(m_currentRawH) + " to " + std::to_string(frameWidth) + "x" + std::to_string(frameHeight)
             + ". Recreating GPU image resources if necessary.");
 
-        ensureRawImageCapacity(static_cast<uint32_t>(frameWidth), static_cast<uint32_t>(frameHeight));
+        ensureRawImageSize(static_cast<uint32_t>(frameWidth), static_cast<uint32_t>(frameHeight));
         Descriptor::updateDescriptorSetsWithNewRawImage(this);
         forceUpload = true;
     }
 
     if (forceUpload) {
-        if (prefilledStagingBuffer == VK_NULL_HANDLE) {
+        if (transferSlot.has_value() && m_rawUploadPath == RawUploadPath::CopyToImage && *transferSlot < m_transferSlotViews.size()) {
+            // Already copied on the transfer queue; the caller recorded the ownership acquire.
+            m_rawImageIndex = 1 + *transferSlot;
+            m_rawSourceKind = RawUploadPath::CopyToImage;
+            m_rawSourceValid = true;
+        }
+        else if (gpuDecode.has_value() && m_gpuRawDecoder && prefilledStagingBuffer != VK_NULL_HANDLE) {
+            // The span holds the compressed frame; expand it into m_rawImage ahead of the demosaic.
+            m_rawSourceValid = m_gpuRawDecoder->recordDecode(commandBuffer, m_rawImage, *gpuDecode);
+            m_rawImageIndex = 0;
+            m_rawSourceKind = RawUploadPath::CopyToImage;
+        }
+        else if (prefilledStagingBuffer == VK_NULL_HANDLE) {
             LogToFile("[Renderer_VK::prepareAndUploadFrameData] ERROR: forceUpload is true, but prefilledStagingBuffer is VK_NULL_HANDLE. Cannot upload.");
+            m_rawSourceValid = false;
+        }
+        else if (m_rawUploadPath == RawUploadPath::StorageBuffer) {
+            // The demosaic pass reads the span in place; the host writes are made visible by the queue submit.
+            m_rawSourceOffset = stagingOffset;
+            m_rawSourceKind = RawUploadPath::StorageBuffer;
+            m_rawSourceValid = true;
         }
         else {
             VkImageMemoryBarrier barrier{};
@@ -146,12 +196,12 @@ void Renderer_VK::prepareAndUploadFrameData(
             barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
             vkCmdPipelineBarrier(commandBuffer,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                 VK_PIPELINE_STAGE_TRANSFER_BIT,
                 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
             VkBufferImageCopy region{};
-            region.bufferOffset = 0;
+            region.bufferOffset = stagingOffset;
             region.bufferRowLength = 0;
             region.bufferImageHeight = 0;
             region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -169,8 +219,11 @@ void Renderer_VK::prepareAndUploadFrameData(
 
             vkCmdPipelineBarrier(commandBuffer,
                 VK_PIPELINE_STAGE_TRANSFER_BIT,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+            m_rawImageIndex = 0;
+            m_rawSourceKind = RawUploadPath::CopyToImage;
+            m_rawSourceValid = true;
         }
     }
 
@@ -248,6 +301,71 @@ void Renderer_VK::prepareAndUploadFrameData(
     ubo.saturationAdjustment = 1.50f;
 
     updateUniformBuffer(uboBindingIndex, ubo);
+
+    // Only a new upload or changed parameters invalidate the processed image; otherwise the
+    // display pass keeps sampling the previous result. Without readable raw data there is
+    // nothing to recompute from, so the previous result is kept as well.
+    if (m_rawSourceValid && (forceUpload || !m_processedImageValid || !sameDemosaicParams(ubo, m_lastDemosaicParams))) {
+        m_lastDemosaicParams = ubo;
+        recordDemosaicDispatch(commandBuffer, uboBindingIndex, frameWidth, frameHeight);
+        m_processedImageValid = true;
+    }
+}
+
+bool Renderer_VK::sameDemosaicParams(const ShaderParamsUBO& a, const ShaderParamsUBO& b) {
+    return a.W == b.W && a.H == b.H && a.cfaType == b.cfaType && a.exposure == b.exposure &&
+        a.blackLevel == b.blackLevel && a.whiteLevel == b.whiteLevel && a.invBlackWhiteRange == b.invBlackWhiteRange &&
+        a.gainR == b.gainR && a.gainG == b.gainG && a.gainB == b.gainB &&
+        a.CCM == b.CCM && a.saturationAdjustment == b.saturationAdjustment;
+}
+
+void Renderer_VK::recordDemosaicDispatch(VkCommandBuffer commandBuffer, uint32_t uboBindingIndex, int frameWidth, int frameHeight) {
+    const int cfaType = std::clamp(m_lastDemosaicParams.cfaType, 0, kNumCfaTypes - 1);
+    VkPipeline pipeline = m_demosaicPipelines[static_cast<int>(m_rawSourceKind)][static_cast<int>(m_demosaicAlgorithm)][cfaType];
+    if (uboBindingIndex >= m_descriptorSets.size() || m_descriptorSets[uboBindingIndex] == VK_NULL_HANDLE || pipeline == VK_NULL_HANDLE) {
+        LogToFile("[Renderer_VK::recordDemosaicDispatch] ERROR: Missing descriptor set or compute pipeline. Skipping dispatch.");
+        return;
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_processedImage;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    // Earlier frames in flight may still be sampling the previous result.
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipelineLayout, 0, 1, &m_descriptorSets[uboBindingIndex], 0, nullptr);
+    const uint32_t rawSourceParams[2] = { static_cast<uint32_t>(m_rawSourceOffset / sizeof(uint32_t)), m_rawImageIndex };
+    vkCmdPushConstants(commandBuffer, m_computePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(rawSourceParams), rawSourceParams);
+    vkCmdDispatch(commandBuffer,
+        (static_cast<uint32_t>(frameWidth) + kDemosaicTileSize - 1) / kDemosaicTileSize,
+        (static_cast<uint32_t>(frameHeight) + kDemosaicTileSize - 1) / kDemosaicTileSize,
+        1);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+    ++m_processedImageGeneration;
 }
 
 void Renderer_VK::recordDrawCommands(
@@ -330,12 +448,111 @@ void Renderer_VK::resetDimensions() {
     m_currentRawH = 0;
 }
 
-void Renderer_VK::ensureRawImageCapacity(uint32_t w, uint32_t h)
+void Renderer_VK::setDemosaicAlgorithm(DemosaicAlgorithm algorithm) {
+    if (algorithm == m_demosaicAlgorithm) return;
+    m_demosaicAlgorithm = algorithm;
+    m_processedImageValid = false;
+    LogToFile(std::string("[Renderer_VK::setDemosaicAlgorithm] Demosaic algorithm set to ") + (algorithm == DemosaicAlgorithm::MalvarHeCutler ? "Malvar-He-Cutler" : "bilinear"));
+}
+
+Renderer_VK::DemosaicAlgorithm Renderer_VK::getDemosaicAlgorithm() const { return m_demosaicAlgorithm; }
+uint64_t Renderer_VK::getProcessedImageGeneration() const { return m_processedImageGeneration; }
+
+void Renderer_VK::setRawSourceBuffer(VkBuffer stagingBuffer, VkDeviceSize stagingSize, bool stagingIsDeviceLocal) {
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(m_physicalDevice_p, &props);
+
+    // Reading host memory in place only pays off where the device sees it at (near) local
+    // speed: integrated/CPU implementations, or a host-visible heap that is device-local
+    // (resizable BAR). Discrete GPUs reading over PCIe keep the copy into m_rawImage.
+    const bool unifiedMemory = props.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU || props.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU;
+    const bool fitsBinding = stagingSize > 0 && stagingSize <= props.limits.maxStorageBufferRange;
+    const RawUploadPath path = (stagingBuffer != VK_NULL_HANDLE && fitsBinding && (unifiedMemory || stagingIsDeviceLocal))
+        ? RawUploadPath::StorageBuffer : RawUploadPath::CopyToImage;
+
+    // A new staging buffer invalidates any span the in-place path was reading from.
+    if (path == RawUploadPath::StorageBuffer || path != m_rawUploadPath) {
+        m_rawSourceValid = false;
+    }
+    m_rawUploadPath = path;
+    m_rawSourceKind = path;
+    m_rawSourceBuffer = (path == RawUploadPath::StorageBuffer) ? stagingBuffer : VK_NULL_HANDLE;
+    m_rawSourceOffset = 0;
+    Descriptor::updateRawSourceBuffer(this);
+
+    // GPU decoding reads the compressed frames from the same buffer on either path.
+    if (m_gpuRawDecoder) {
+        m_gpuRawDecoder->setSource(stagingBuffer, std::min<VkDeviceSize>(stagingSize, props.limits.maxStorageBufferRange));
+    }
+
+    LogToFile(std::string("[Renderer_VK::setRawSourceBuffer] Upload path: ") + (path == RawUploadPath::StorageBuffer ? "storage buffer (no copy)" : "buffer-to-image copy") +
+        ". Device type " + std::to_string(props.deviceType) + ", staging " + (stagingIsDeviceLocal ? "device-local" : "host-only") +
+        ", " + std::to_string(stagingSize) + " bytes (max storage range " + std::to_string(props.limits.maxStorageBufferRange) + ").");
+}
+
+Renderer_VK::RawUploadPath Renderer_VK::getRawUploadPath() const { return m_rawUploadPath; }
+
+bool Renderer_VK::supportsGpuRawDecode() const { return m_gpuRawDecoder != nullptr; }
+
+VkDeviceSize Renderer_VK::getGpuRawDecodeSourceRange() const {
+    return m_gpuRawDecoder ? m_gpuRawDecoder->sourceRange() : 0;
+}
+
+void Renderer_VK::invalidateRawSource() {
+    // m_rawImage keeps its contents, so only the in-place path and transfer slots lose their source.
+    if (m_rawSourceKind == RawUploadPath::StorageBuffer || m_rawImageIndex != 0) {
+        m_rawSourceValid = false;
+        m_rawImageIndex = 0;
+    }
+}
+
+void Renderer_VK::setTransferSlotViews(const std::vector<VkImageView>& slotViews) {
+    m_transferSlotViews = slotViews;
+    if (m_transferSlotViews.size() > kNumRawImages - 1) {
+        m_transferSlotViews.resize(kNumRawImages - 1);
+    }
+    if (m_rawImageIndex != 0) {
+        m_rawSourceValid = false;
+        m_rawImageIndex = 0;
+    }
+    Descriptor::updateDescriptorSetsWithNewRawImage(this);
+}
+
+bool Renderer_VK::createPlaceholderRawBuffer() {
+    VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size = 256;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    VkResult result = vmaCreateBuffer(m_allocator_p, &bufferInfo, &allocInfo, &m_placeholderRawBuffer, &m_placeholderRawBufferAllocation, nullptr);
+    if (result != VK_SUCCESS) {
+        LogToFile(std::string("[Renderer_VK::createPlaceholderRawBuffer] vmaCreateBuffer failed. Error: ") + std::to_string(result));
+        m_placeholderRawBuffer = VK_NULL_HANDLE;
+        m_placeholderRawBufferAllocation = VK_NULL_HANDLE;
+        return false;
+    }
+    return true;
+}
+
+void Renderer_VK::destroyPlaceholderRawBuffer() {
+    if (m_placeholderRawBuffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(m_allocator_p, m_placeholderRawBuffer, m_placeholderRawBufferAllocation);
+        m_placeholderRawBuffer = VK_NULL_HANDLE;
+        m_placeholderRawBufferAllocation = VK_NULL_HANDLE;
+    }
+}
+
+// Exact rather than at least: the processed image and the viewport follow the raw image's
+// size, so a smaller frame (a proxy) must not be drawn into the corner of a larger one.
+void Renderer_VK::ensureRawImageSize(uint32_t w, uint32_t h)
 {
-    if (w <= static_cast<uint32_t>(m_currentRawW) && h <= static_cast<uint32_t>(m_currentRawH)) {
+    if (w == static_cast<uint32_t>(m_currentRawW) && h == static_cast<uint32_t>(m_currentRawH)) {
         return;
     }
-    LogToFile(std::string("[Renderer_VK::ensureRawImageCapacity] Capacity insufficient (current: ") +
+    LogToFile(std::string("[Renderer_VK::ensureRawImageSize] Size differs (current: ") +
         std::to_string(m_currentRawW) + "x" + std::to_string(m_currentRawH) +
         ", required: " + std::to_string(w) + "x" + std::to_string(h) + "). Resizing GPU image.");
 
@@ -343,7 +560,7 @@ void Renderer_VK::ensureRawImageCapacity(uint32_t w, uint32_t h)
         vkDeviceWaitIdle(m_device_p);
     }
     if (!ImageResource::createRawImageResources(this, static_cast<int>(w), static_cast<int>(h))) {
-        LogToFile("[Renderer_VK::ensureRawImageCapacity] ERROR: Failed to recreate raw image resources for new capacity.");
-        throw std::runtime_error("Failed to ensure raw image capacity by recreating resources.");
+        LogToFile("[Renderer_VK::ensureRawImageSize] ERROR: Failed to recreate raw image resources for the new size.");
+        throw std::runtime_error("Failed to resize raw image by recreating resources.");
     }
 }
\ No newline at end of file
@@ -0,0 +1,182 @@
+// FILE: src/Graphics/StagingRing.cpp
+#include "Graphics/StagingRing.h"
+#include "Utils/DebugLog.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+    VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+StagingRing::~StagingRing() {
+    destroy();
+}
+
+void StagingRing::create(VmaAllocator allocator, VkDeviceSize capacityBytes) {
+    destroy();
+    if (allocator == VK_NULL_HANDLE || capacityBytes == 0) {
+        throw std::runtime_error("StagingRing::create called with null allocator or zero capacity");
+    }
+
+    VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size = capacityBytes;
+    // TRANSFER_SRC for the copy into the raw image, STORAGE_BUFFER for demosaicing in place.
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationDetails{};
+    VkResult result = vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &m_buffer, &m_allocation, &allocationDetails);
+    if (result != VK_SUCCESS) {
+        m_buffer = VK_NULL_HANDLE;
+        m_allocation = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to create staging ring buffer of " + std::to_string(capacityBytes) + " bytes. Error: " + std::to_string(result));
+    }
+    if (!allocationDetails.pMappedData) {
+        vmaDestroyBuffer(allocator, m_buffer, m_allocation);
+        m_buffer = VK_NULL_HANDLE;
+        m_allocation = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to map staging ring buffer (pMappedData is null)");
+    }
+
+    VkMemoryPropertyFlags memoryFlags = 0;
+    vmaGetAllocationMemoryProperties(allocator, m_allocation, &memoryFlags);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_allocator = allocator;
+    m_mapped = static_cast<uint8_t*>(allocationDetails.pMappedData);
+    m_deviceLocal = (memoryFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+    m_capacity = capacityBytes;
+    m_entries.clear();
+    ++m_generation;
+    LogToFile(std::string("[StagingRing::create] Created staging ring of ") + std::to_string(capacityBytes / (1024 * 1024)) + " MiB" + (m_deviceLocal ? " (device-local)." : "."));
+}
+
+void StagingRing::destroy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_buffer != VK_NULL_HANDLE && m_allocator != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(m_allocator, m_buffer, m_allocation);
+    }
+    m_buffer = VK_NULL_HANDLE;
+    m_allocation = VK_NULL_HANDLE;
+    m_mapped = nullptr;
+    m_capacity = 0;
+    m_deviceLocal = false;
+    m_entries.clear();
+    ++m_generation;
+    m_cond.notify_all();
+}
+
+bool StagingRing::tryCarveLocked(VkDeviceSize sizeBytes, VkDeviceSize& outOffset) const {
+    if (m_entries.empty()) {
+        outOffset = 0;
+        return sizeBytes <= m_capacity;
+    }
+
+    const Entry& oldest = m_entries.front();
+    const Entry& newest = m_entries.back();
+    const VkDeviceSize head = alignUp(newest.offset + newest.size, kAlignment);
+
+    if (newest.offset >= oldest.offset) {
+        // Live region is [oldest, head): try the space after it, then wrap to the start.
+        if (head + sizeBytes <= m_capacity) {
+            outOffset = head;
+            return true;
+        }
+        if (sizeBytes <= oldest.offset) {
+            outOffset = 0;
+            return true;
+        }
+        return false;
+    }
+
+    // Wrapped: free space is the gap between head and the oldest live span.
+    if (head + sizeBytes <= oldest.offset) {
+        outOffset = head;
+        return true;
+    }
+    return false;
+}
+
+std::optional<StagingSpan> StagingRing::acquire(VkDeviceSize sizeBytes) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_stopped || m_buffer == VK_NULL_HANDLE || sizeBytes == 0 || sizeBytes > m_capacity) {
+        return std::nullopt;
+    }
+
+    VkDeviceSize offset = 0;
+    m_cond.wait(lock, [&] {
+        return m_stopped || m_buffer == VK_NULL_HANDLE || tryCarveLocked(sizeBytes, offset);
+        });
+    if (m_stopped || m_buffer == VK_NULL_HANDLE) {
+        return std::nullopt;
+    }
+
+    m_entries.push_back({ offset, sizeBytes, false });
+
+    StagingSpan span;
+    span.offset = offset;
+    span.size = sizeBytes;
+    span.mappedPtr = m_mapped + offset;
+    span.generation = m_generation;
+    return span;
+}
+
+void StagingRing::release(const StagingSpan& span) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (span.generation != m_generation) {
+            return;
+        }
+        for (Entry& e : m_entries) {
+            if (e.offset == span.offset && !e.released) {
+                e.released = true;
+                break;
+            }
+        }
+        while (!m_entries.empty() && m_entries.front().released) {
+            m_entries.pop_front();
+        }
+    }
+    m_cond.notify_all();
+}
+
+void StagingRing::flush(const StagingSpan& span) {
+    // No-op on HOST_COHERENT memory; required before the GPU reads otherwise.
+    if (m_allocator != VK_NULL_HANDLE && m_allocation != VK_NULL_HANDLE) {
+        vmaFlushAllocation(m_allocator, m_allocation, span.offset, span.size);
+    }
+}
+
+void StagingRing::reset() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        ++m_generation;
+    }
+    m_cond.notify_all();
+}
+
+void StagingRing::stop_operations() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+    m_cond.notify_all();
+}
+
+void StagingRing::resume_operations() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopped = false;
+}
+
+size_t StagingRing::liveSpanCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
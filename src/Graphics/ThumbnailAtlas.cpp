@@ -0,0 +1,226 @@
+// FILE: src/Graphics/ThumbnailAtlas.cpp
+#include "Graphics/ThumbnailAtlas.h"
+#include "Graphics/VulkanHelpers.h"
+#include "Playback/ClipIndexer.h"
+#include "Utils/DebugLog.h"
+
+#include <imgui_impl_vulkan.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+namespace {
+    constexpr VkDeviceSize kCellBytes = static_cast<VkDeviceSize>(ThumbnailAtlas::kCellSize) * ThumbnailAtlas::kCellSize * 4;
+
+    VkImageMemoryBarrier atlasBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+        VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        return barrier;
+    }
+}
+
+ThumbnailAtlas::~ThumbnailAtlas() {
+    cleanup();
+}
+
+bool ThumbnailAtlas::init(VkDevice device, VmaAllocator allocator, uint32_t framesInFlight) {
+    cleanup();
+    m_device = device;
+    m_allocator = allocator;
+    m_framesInFlight = framesInFlight;
+
+    VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = { kAtlasSize, kAtlasSize, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo imageAllocInfo{};
+    imageAllocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    VkResult result = vmaCreateImage(m_allocator, &imageInfo, &imageAllocInfo, &m_image, &m_imageAllocation, nullptr);
+    if (result != VK_SUCCESS) {
+        LogToFile("[ThumbnailAtlas::init] Failed to create atlas image. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+    viewInfo.image = m_image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    VK_CHECK_RENDERER(vkCreateImageView(m_device, &viewInfo, nullptr, &m_view));
+
+    VkSamplerCreateInfo samplerInfo{ VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+    VK_CHECK_RENDERER(vkCreateSampler(m_device, &samplerInfo, nullptr, &m_sampler));
+
+    VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size = kCellBytes * kUploadsPerFrame * m_framesInFlight;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo bufferAllocInfo{};
+    bufferAllocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+    bufferAllocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationInfo bufferDetails{};
+    result = vmaCreateBuffer(m_allocator, &bufferInfo, &bufferAllocInfo, &m_staging, &m_stagingAllocation, &bufferDetails);
+    if (result != VK_SUCCESS || !bufferDetails.pMappedData) {
+        LogToFile("[ThumbnailAtlas::init] Failed to create staging buffer. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+    m_stagingMapped = static_cast<uint8_t*>(bufferDetails.pMappedData);
+
+    m_descriptorSet = ImGui_ImplVulkan_AddTexture(m_sampler, m_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    m_cells.assign(kCellsPerRow * kCellsPerRow, Cell{});
+    m_lru.clear();
+    for (uint32_t i = 0; i < m_cells.size(); ++i) {
+        m_lru.push_back(i);
+    }
+    LogToFile("[ThumbnailAtlas::init] " + std::to_string(kAtlasSize) + "x" + std::to_string(kAtlasSize) + " atlas with " + std::to_string(m_cells.size()) + " cells.");
+    return true;
+}
+
+void ThumbnailAtlas::cleanup() {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+    if (m_descriptorSet != VK_NULL_HANDLE) {
+        ImGui_ImplVulkan_RemoveTexture(m_descriptorSet);
+        m_descriptorSet = VK_NULL_HANDLE;
+    }
+    if (m_sampler != VK_NULL_HANDLE) vkDestroySampler(m_device, m_sampler, nullptr);
+    if (m_view != VK_NULL_HANDLE) vkDestroyImageView(m_device, m_view, nullptr);
+    if (m_image != VK_NULL_HANDLE) vmaDestroyImage(m_allocator, m_image, m_imageAllocation);
+    if (m_staging != VK_NULL_HANDLE) vmaDestroyBuffer(m_allocator, m_staging, m_stagingAllocation);
+    m_sampler = VK_NULL_HANDLE;
+    m_view = VK_NULL_HANDLE;
+    m_image = VK_NULL_HANDLE;
+    m_imageAllocation = VK_NULL_HANDLE;
+    m_staging = VK_NULL_HANDLE;
+    m_stagingAllocation = VK_NULL_HANDLE;
+    m_stagingMapped = nullptr;
+    m_imageInitialized = false;
+    m_cells.clear();
+    m_lru.clear();
+    m_byPath.clear();
+    m_pendingUploads.clear();
+    m_device = VK_NULL_HANDLE;
+}
+
+std::optional<ThumbnailAtlas::Uv> ThumbnailAtlas::lookup(const std::string& path, const std::shared_ptr<const ClipInfo>& info) {
+    if (m_descriptorSet == VK_NULL_HANDLE) {
+        return std::nullopt;
+    }
+    auto it = m_byPath.find(path);
+    if (it != m_byPath.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        Cell& cell = m_cells[*it->second];
+        cell.lastUsedSerial = m_frameSerial;
+        return cell.resident ? std::optional<Uv>(cell.uv) : std::nullopt;
+    }
+    if (!info || !info->hasThumbnail() || m_pendingUploads.size() >= kUploadsPerFrame) {
+        return std::nullopt;
+    }
+    const std::optional<uint32_t> index = acquireCell();
+    if (!index) {
+        return std::nullopt; // Every cell is on screen or still in flight
+    }
+    Cell& cell = m_cells[*index];
+    cell.path = path;
+    cell.lastUsedSerial = m_frameSerial;
+    cell.resident = false;
+    m_byPath[path] = m_lru.begin();
+    m_pendingUploads.emplace_back(*index, info);
+    return std::nullopt;
+}
+
+// Takes the least recently used cell that no in-flight frame can still be sampling.
+std::optional<uint32_t> ThumbnailAtlas::acquireCell() {
+    for (auto it = m_lru.rbegin(); it != m_lru.rend(); ++it) {
+        Cell& cell = m_cells[*it];
+        if (!cell.path.empty() && cell.lastUsedSerial + m_framesInFlight > m_frameSerial) {
+            continue;
+        }
+        if (!cell.path.empty()) {
+            m_byPath.erase(cell.path);
+            cell.path.clear();
+            cell.resident = false;
+        }
+        const uint32_t index = *it;
+        m_lru.splice(m_lru.begin(), m_lru, std::next(it).base());
+        return index;
+    }
+    return std::nullopt;
+}
+
+void ThumbnailAtlas::recordUploads(VkCommandBuffer commandBuffer, uint32_t frameSlot, uint64_t frameSerial) {
+    m_frameSerial = frameSerial;
+    if (m_pendingUploads.empty() || m_image == VK_NULL_HANDLE) {
+        return;
+    }
+
+    const VkDeviceSize regionOffset = kCellBytes * kUploadsPerFrame * frameSlot;
+    std::vector<VkBufferImageCopy> copies;
+    copies.reserve(m_pendingUploads.size());
+    for (size_t i = 0; i < m_pendingUploads.size(); ++i) {
+        const uint32_t index = m_pendingUploads[i].first;
+        const ClipInfo& info = *m_pendingUploads[i].second;
+        const uint32_t width = std::min<uint32_t>(static_cast<uint32_t>(info.thumbnailWidth), kCellSize);
+        const uint32_t height = std::min<uint32_t>(static_cast<uint32_t>(info.thumbnailHeight), kCellSize);
+        const VkDeviceSize offset = regionOffset + kCellBytes * i;
+        for (uint32_t row = 0; row < height; ++row) {
+            std::memcpy(m_stagingMapped + offset + static_cast<VkDeviceSize>(row) * width * 4,
+                info.thumbnail.data() + static_cast<size_t>(row) * info.thumbnailWidth * 4, static_cast<size_t>(width) * 4);
+        }
+
+        const uint32_t cellX = (index % kCellsPerRow) * kCellSize;
+        const uint32_t cellY = (index / kCellsPerRow) * kCellSize;
+        VkBufferImageCopy copy{};
+        copy.bufferOffset = offset;
+        copy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        copy.imageOffset = { static_cast<int32_t>(cellX), static_cast<int32_t>(cellY), 0 };
+        copy.imageExtent = { width, height, 1 };
+        copies.push_back(copy);
+
+        Cell& cell = m_cells[index];
+        cell.uv = { static_cast<float>(cellX) / kAtlasSize, static_cast<float>(cellY) / kAtlasSize,
+            static_cast<float>(cellX + width) / kAtlasSize, static_cast<float>(cellY + height) / kAtlasSize };
+        cell.resident = true;
+    }
+    vmaFlushAllocation(m_allocator, m_stagingAllocation, regionOffset, kCellBytes * copies.size());
+
+    // UNDEFINED the first time: nothing in the atlas has been drawn yet.
+    VkImageMemoryBarrier toTransfer = m_imageInitialized
+        ? atlasBarrier(m_image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT)
+        : atlasBarrier(m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+    vkCmdCopyBufferToImage(commandBuffer, m_staging, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()), copies.data());
+    VkImageMemoryBarrier toShader = atlasBarrier(m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+    m_imageInitialized = true;
+    m_pendingUploads.clear();
+}
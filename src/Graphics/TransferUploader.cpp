@@ -0,0 +1,351 @@
+// FILE: src/Graphics/TransferUploader.cpp
+#include "Graphics/TransferUploader.h"
+#include "Graphics/ImageResource.h"
+#include "Utils/DebugLog.h"
+
+#include <algorithm>
+#include <string>
+
+TransferUploader::~TransferUploader() {
+    cleanup();
+}
+
+bool TransferUploader::init(VkDevice device, VmaAllocator allocator,
+    VkQueue transferQueue, uint32_t transferFamily,
+    VkQueue graphicsQueue, uint32_t graphicsFamily, VkCommandPool graphicsCommandPool) {
+    cleanup();
+
+    m_device = device;
+    m_allocator = allocator;
+    m_transferQueue = transferQueue;
+    m_transferFamily = transferFamily;
+    m_graphicsQueue = graphicsQueue;
+    m_graphicsFamily = graphicsFamily;
+    m_graphicsCommandPool = graphicsCommandPool;
+
+    m_getSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR"));
+    m_waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+    if (!m_getSemaphoreCounterValue || !m_waitSemaphores) {
+        LogToFile("[TransferUploader::init] Timeline semaphore entry points not found.");
+        cleanup();
+        return false;
+    }
+
+    VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = transferFamily;
+    VkResult result = vkCreateCommandPool(device, &poolInfo, nullptr, &m_commandPool);
+    if (result != VK_SUCCESS) {
+        LogToFile("[TransferUploader::init] Failed to create transfer command pool. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+
+    std::array<VkCommandBuffer, kNumSlots> commandBuffers{};
+    VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocInfo.commandPool = m_commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = kNumSlots;
+    result = vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data());
+    if (result != VK_SUCCESS) {
+        LogToFile("[TransferUploader::init] Failed to allocate transfer command buffers. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+    for (uint32_t i = 0; i < kNumSlots; ++i) {
+        m_slots[i].commandBuffer = commandBuffers[i];
+        m_slots[i].lastValue = 0;
+    }
+
+    VkSemaphoreTypeCreateInfoKHR typeInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR };
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    typeInfo.initialValue = 0;
+    VkSemaphoreCreateInfo semaphoreInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+    semaphoreInfo.pNext = &typeInfo;
+    result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_timeline);
+    if (result != VK_SUCCESS) {
+        LogToFile("[TransferUploader::init] Failed to create timeline semaphore. Error: " + std::to_string(result));
+        cleanup();
+        return false;
+    }
+    m_nextValue = 0;
+
+    LogToFile("[TransferUploader::init] Transfer uploads enabled on queue family " + std::to_string(transferFamily) +
+        " (graphics family " + std::to_string(graphicsFamily) + "), " + std::to_string(kNumSlots) + " slots.");
+    return true;
+}
+
+void TransferUploader::cleanup() {
+    destroySlotImages();
+    if (m_device != VK_NULL_HANDLE) {
+        if (m_timeline != VK_NULL_HANDLE) {
+            vkDestroySemaphore(m_device, m_timeline, nullptr);
+        }
+        if (m_commandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        }
+    }
+    m_timeline = VK_NULL_HANDLE;
+    m_commandPool = VK_NULL_HANDLE;
+    for (Slot& slot : m_slots) {
+        slot.commandBuffer = VK_NULL_HANDLE;
+        slot.lastValue = 0;
+    }
+    m_getSemaphoreCounterValue = nullptr;
+    m_waitSemaphores = nullptr;
+    m_device = VK_NULL_HANDLE;
+}
+
+void TransferUploader::destroySlotImages() {
+    for (Slot& slot : m_slots) {
+        if (slot.view != VK_NULL_HANDLE && m_device != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_device, slot.view, nullptr);
+        }
+        if (slot.image != VK_NULL_HANDLE && m_allocator != VK_NULL_HANDLE) {
+            vmaDestroyImage(m_allocator, slot.image, slot.allocation);
+        }
+        slot.view = VK_NULL_HANDLE;
+        slot.image = VK_NULL_HANDLE;
+        slot.allocation = VK_NULL_HANDLE;
+    }
+    m_slotWidth = 0;
+    m_slotHeight = 0;
+}
+
+bool TransferUploader::ensureSlotImages(uint32_t width, uint32_t height) {
+    if (m_device == VK_NULL_HANDLE || width == 0 || height == 0) {
+        return false;
+    }
+    if (width == m_slotWidth && height == m_slotHeight) {
+        return true;
+    }
+    destroySlotImages();
+
+    VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = { width, height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = VK_FORMAT_R16_UINT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    for (uint32_t i = 0; i < kNumSlots; ++i) {
+        Slot& slot = m_slots[i];
+        VkResult result = vmaCreateImage(m_allocator, &imageInfo, &allocInfo, &slot.image, &slot.allocation, nullptr);
+        if (result != VK_SUCCESS) {
+            LogToFile("[TransferUploader::ensureSlotImages] Failed to create slot image " + std::to_string(i) + ". Error: " + std::to_string(result));
+            slot.image = VK_NULL_HANDLE;
+            slot.allocation = VK_NULL_HANDLE;
+            destroySlotImages();
+            return false;
+        }
+
+        VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+        viewInfo.image = slot.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R16_UINT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.layerCount = 1;
+        result = vkCreateImageView(m_device, &viewInfo, nullptr, &slot.view);
+        if (result != VK_SUCCESS) {
+            LogToFile("[TransferUploader::ensureSlotImages] Failed to create slot image view " + std::to_string(i) + ". Error: " + std::to_string(result));
+            slot.view = VK_NULL_HANDLE;
+            destroySlotImages();
+            return false;
+        }
+
+        // Owned by the graphics family until the first upload, so unused slots are still
+        // valid to bind. Uploads start from UNDEFINED and need no acquire on the transfer side.
+        ImageResource::transitionImageLayout(m_device, m_graphicsCommandPool, m_graphicsQueue, slot.image,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    m_slotWidth = width;
+    m_slotHeight = height;
+    LogToFile("[TransferUploader::ensureSlotImages] Created " + std::to_string(kNumSlots) + " slot images of " + std::to_string(width) + "x" + std::to_string(height) + ".");
+    return true;
+}
+
+std::vector<VkImageView> TransferUploader::slotViews() const {
+    std::vector<VkImageView> views;
+    views.reserve(kNumSlots);
+    for (const Slot& slot : m_slots) {
+        views.push_back(slot.view);
+    }
+    return views;
+}
+
+VkImageMemoryBarrier TransferUploader::ownershipBarrier(uint32_t slot) const {
+    VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = m_transferFamily;
+    barrier.dstQueueFamilyIndex = m_graphicsFamily;
+    barrier.image = m_slots[slot].image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    return barrier;
+}
+
+std::optional<TransferUploader::Ticket> TransferUploader::submitUpload(VkBuffer stagingBuffer, VkDeviceSize stagingOffset, uint32_t width, uint32_t height) {
+    if (m_device == VK_NULL_HANDLE || stagingBuffer == VK_NULL_HANDLE || !fits(width, height)) {
+        return std::nullopt;
+    }
+
+    Ticket ticket;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto findFree = [&]() -> std::optional<uint32_t> {
+            for (uint32_t i = 0; i < kNumSlots; ++i) {
+                if (!m_slotBusy[i]) return i;
+            }
+            return std::nullopt;
+            };
+        m_cond.wait(lock, [&] { return m_stopped || findFree().has_value(); });
+        if (m_stopped) {
+            return std::nullopt;
+        }
+        ticket.slot = findFree().value();
+        ticket.generation = m_generation;
+        m_slotBusy[ticket.slot] = true;
+    }
+
+    Slot& slot = m_slots[ticket.slot];
+
+    // A reset() can hand a slot back while its previous copy is still executing.
+    if (slot.lastValue > 0) {
+        VkSemaphoreWaitInfoKHR waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR };
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_timeline;
+        waitInfo.pValues = &slot.lastValue;
+        m_waitSemaphores(m_device, &waitInfo, UINT64_MAX);
+    }
+
+    vkResetCommandBuffer(slot.commandBuffer, 0);
+    VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(slot.commandBuffer, &beginInfo);
+
+    VkImageMemoryBarrier barrier = ownershipBarrier(ticket.slot);
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(slot.commandBuffer,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = stagingOffset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = { width, height, 1 };
+    vkCmdCopyBufferToImage(slot.commandBuffer, stagingBuffer, slot.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    // Release half of the queue family ownership transfer; recordAcquire() is the other half.
+    barrier = ownershipBarrier(ticket.slot);
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    vkCmdPipelineBarrier(slot.commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+    vkEndCommandBuffer(slot.commandBuffer);
+
+    const uint64_t signalValue = m_nextValue + 1;
+    VkTimelineSemaphoreSubmitInfoKHR timelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR };
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+    VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &slot.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_timeline;
+
+    VkResult result = vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) {
+        LogToFile("[TransferUploader::submitUpload] vkQueueSubmit failed. Error: " + std::to_string(result));
+        release(ticket);
+        return std::nullopt;
+    }
+    m_nextValue = signalValue;
+    slot.lastValue = signalValue;
+    ticket.value = signalValue;
+    return ticket;
+}
+
+bool TransferUploader::isComplete(uint64_t value) const {
+    if (m_timeline == VK_NULL_HANDLE) {
+        return false;
+    }
+    uint64_t current = 0;
+    if (m_getSemaphoreCounterValue(m_device, m_timeline, &current) != VK_SUCCESS) {
+        return false;
+    }
+    return current >= value;
+}
+
+void TransferUploader::recordAcquire(VkCommandBuffer commandBuffer, uint32_t slot) const {
+    VkImageMemoryBarrier barrier = ownershipBarrier(slot);
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    // Chained to the timeline wait, which the graphics submit places at the compute stage.
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void TransferUploader::release(const Ticket& ticket) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (ticket.generation != m_generation || ticket.slot >= kNumSlots) {
+            return;
+        }
+        m_slotBusy[ticket.slot] = false;
+    }
+    m_cond.notify_all();
+}
+
+void TransferUploader::reset() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slotBusy.fill(false);
+        ++m_generation;
+    }
+    m_cond.notify_all();
+}
+
+void TransferUploader::stop_operations() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+    m_cond.notify_all();
+}
+
+void TransferUploader::resume_operations() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopped = false;
+}
+
+size_t TransferUploader::busySlotCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(std::count(m_slotBusy.begin(), m_slotBusy.end(), true));
+}
@@ -16,6 +16,12 @@
 #include "Playback/PlaybackController.h"
 #include "Audio/AudioController.h"
 #include "Decoder/DecoderWrapper.h"
+#include "Graphics/Renderer_VK.h"
+#include "Graphics/GpuScopes.h"
+#include "Graphics/ThumbnailAtlas.h"
+#include "Playback/ClipAnalyzer.h"
+#include "Playback/ClipIndexer.h"
+#include "Playback/ProxyGenerator.h"
 
 
 #include <imgui.h>
@@ -33,8 +39,10 @@
 #include <map>
 #include <chrono>
 #include <algorithm>
+#include <array>
 #include <cstdio>
 #include <numeric>
+#include <utility>
 #include <cmath>
 
 #ifdef _WIN32
@@ -49,6 +57,217 @@ namespace GuiOverlay {
 
     bool show_playlist_aux = false;
 
+    namespace {
+        int metricsHistogramStage = static_cast<int>(PipelineMetrics::Stage::Decode);
+
+        void renderPipelineMetrics(const PipelineMetrics& metrics) {
+            using Stage = PipelineMetrics::Stage;
+            using Counter = PipelineMetrics::Counter;
+            using Queue = PipelineMetrics::Queue;
+
+            ImGui::Text("Frames: %llu shown, %llu repeated",
+                static_cast<unsigned long long>(metrics.counter(Counter::FramesDisplayed)),
+                static_cast<unsigned long long>(metrics.counter(Counter::FramesRepeated)));
+            ImGui::Text("  Dropped: %llu late, %llu stale, %llu skipped",
+                static_cast<unsigned long long>(metrics.counter(Counter::FramesDroppedLate)),
+                static_cast<unsigned long long>(metrics.counter(Counter::FramesDroppedStale)),
+                static_cast<unsigned long long>(metrics.counter(Counter::FramesSkippedLate)));
+            ImGui::Text("  Audio Underruns: %llu", static_cast<unsigned long long>(metrics.counter(Counter::AudioUnderruns)));
+
+            if (ImGui::BeginTable("##stage_latency", 5, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("Stage (ms)");
+                ImGui::TableSetupColumn("p50");
+                ImGui::TableSetupColumn("p95");
+                ImGui::TableSetupColumn("p99");
+                ImGui::TableSetupColumn("max");
+                ImGui::TableHeadersRow();
+                for (int i = 0; i < static_cast<int>(Stage::Count); ++i) {
+                    const PipelineMetrics::StageSummary s = metrics.summarize(static_cast<Stage>(i));
+                    if (s.count == 0) continue;
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(PipelineMetrics::stageName(static_cast<Stage>(i)));
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", s.p50Ms);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", s.p95Ms);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", s.p99Ms);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", s.maxMs);
+                }
+                ImGui::EndTable();
+            }
+
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::Combo("##histogram_stage", &metricsHistogramStage,
+                [](void*, int idx) { return PipelineMetrics::stageName(static_cast<Stage>(idx)); },
+                nullptr, static_cast<int>(Stage::Count));
+            std::array<float, PipelineMetrics::kHistogramBuckets> buckets;
+            metrics.copyHistogram(static_cast<Stage>(metricsHistogramStage), buckets);
+            // Trim empty buckets on both sides so the populated range fills the plot.
+            size_t first = 0;
+            while (first < buckets.size() && buckets[first] == 0.0f) ++first;
+            size_t last = buckets.size();
+            while (last > first && buckets[last - 1] == 0.0f) --last;
+            char rangeLabel[64] = "no samples";
+            if (last > first) {
+                std::snprintf(rangeLabel, sizeof(rangeLabel), "%.2f - %.2f ms",
+                    first > 0 ? PipelineMetrics::bucketUpperBoundMs(first - 1) : 0.0,
+                    PipelineMetrics::bucketUpperBoundMs(last - 1));
+            }
+            ImGui::PlotHistogram("##stage_histogram", buckets.data() + first, static_cast<int>(last - first), 0,
+                rangeLabel, 0.0f, FLT_MAX, ImVec2(280.0f, 48.0f));
+
+            std::array<float, PipelineMetrics::kDepthHistory> depths;
+            for (int i = 0; i < static_cast<int>(Queue::Count); ++i) {
+                const Queue queue = static_cast<Queue>(i);
+                metrics.copyDepthHistory(queue, depths);
+                char overlay[64];
+                std::snprintf(overlay, sizeof(overlay), "%s %zu (max %zu)",
+                    PipelineMetrics::queueName(queue), metrics.currentDepth(queue), metrics.maxDepth(queue));
+                ImGui::PushID(i);
+                ImGui::PlotLines("##queue_depth", depths.data(), static_cast<int>(depths.size()), 0, overlay,
+                    0.0f, static_cast<float>(std::max<size_t>(metrics.maxDepth(queue), 1)), ImVec2(280.0f, 32.0f));
+                ImGui::PopID();
+            }
+        }
+
+        // Heat-strip under the scrubber, one column per pixel, coloured by the worst problem among
+        // the frames it covers: black frames purple, clipping red, crushed shadows blue, soft frames
+        // amber. Problem-free frames show their exposure as a grey ramp; unanalysed ones stay dark.
+        void renderClipStatsStrip(const ClipStats& stats, const ImVec2& sliderMin, const ImVec2& sliderMax) {
+            if (stats.samples.empty() || stats.frameCount == 0 || sliderMax.x <= sliderMin.x) {
+                return;
+            }
+            constexpr float kClippedWarnPct = 1.0f;
+            constexpr float kCrushedWarnPct = 25.0f;
+            const ImVec2 stripMin(sliderMin.x, sliderMax.y + 1.0f);
+            const ImVec2 stripMax(sliderMax.x, sliderMax.y + 4.0f);
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+            drawList->AddRectFilled(stripMin, stripMax, IM_COL32(32, 33, 36, 255));
+
+            const int columns = static_cast<int>(stripMax.x - stripMin.x);
+            for (int col = 0; col < columns; ++col) {
+                const size_t firstFrame = static_cast<size_t>(col) * stats.frameCount / columns;
+                const size_t endFrame = std::max(firstFrame + 1, static_cast<size_t>(col + 1) * stats.frameCount / columns);
+                const size_t firstSample = firstFrame / stats.stride;
+                const size_t endSample = std::min(stats.samples.size(), std::max(firstSample + 1, (endFrame + stats.stride - 1) / stats.stride));
+                bool black = false, soft = false, any = false;
+                float clipped = 0.0f, crushed = 0.0f, exposure = 0.0f;
+                for (size_t i = firstSample; i < endSample; ++i) {
+                    const FrameStats& s = stats.samples[i];
+                    if (!s.valid) continue;
+                    any = true;
+                    black = black || s.isBlack();
+                    soft = soft || stats.isSoft(s);
+                    clipped = std::max(clipped, s.clippedPct);
+                    crushed = std::max(crushed, s.crushedPct);
+                    exposure = std::max(exposure, s.maxMean());
+                }
+                if (!any) continue;
+                ImU32 color;
+                if (black) color = IM_COL32(150, 60, 200, 255);
+                else if (clipped >= kClippedWarnPct) color = IM_COL32(static_cast<int>(std::min(255.0f, 140.0f + clipped * 10.0f)), 40, 40, 255);
+                else if (crushed >= kCrushedWarnPct) color = IM_COL32(40, 80, static_cast<int>(std::min(255.0f, 120.0f + crushed * 1.5f)), 255);
+                else if (soft) color = IM_COL32(220, 160, 40, 255);
+                else {
+                    const int grey = 50 + static_cast<int>(std::sqrt(exposure) * 110.0f);
+                    color = IM_COL32(grey, grey, grey, 255);
+                }
+                drawList->AddRectFilled(ImVec2(stripMin.x + col, stripMin.y), ImVec2(stripMin.x + col + 1, stripMax.y), color);
+            }
+
+            if (ImGui::IsMouseHoveringRect(ImVec2(stripMin.x, stripMin.y - 2.0f), ImVec2(stripMax.x, stripMax.y + 2.0f))) {
+                const float t = std::clamp((ImGui::GetIO().MousePos.x - stripMin.x) / (stripMax.x - stripMin.x), 0.0f, 1.0f);
+                const size_t frame = std::min(stats.frameCount - 1, static_cast<size_t>(t * stats.frameCount));
+                if (const FrameStats* s = stats.sampleForFrame(frame)) {
+                    ImGui::SetTooltip("Frame %zu\nMean: %.3f %.3f %.3f %.3f\nClipped: %.2f%%  Crushed: %.2f%%\nSharpness: %.4f%s",
+                        frame + 1, s->channelMean[0], s->channelMean[1], s->channelMean[2], s->channelMean[3],
+                        s->clippedPct, s->crushedPct, s->sharpness,
+                        s->isBlack() ? "\nBlack frame" : (stats.isSoft(*s) ? "\nSoft" : ""));
+                }
+                else if (!stats.complete) {
+                    ImGui::SetTooltip("Analysing clip: %zu / %zu", stats.analyzedCount, stats.samples.size());
+                }
+            }
+        }
+
+        std::string clipMetaLine(const ClipInfo& info) {
+            if (!info.valid) {
+                return info.error.empty() ? "Unreadable" : "Unreadable: " + info.error;
+            }
+            const int seconds = static_cast<int>(std::lround(info.durationSec));
+            char line[128];
+            int written = std::snprintf(line, sizeof(line), "%dx%d  %.2f fps  %d:%02d  %zu fr",
+                info.width, info.height, info.fps, seconds / 60, seconds % 60, info.frameCount);
+            if (info.hasAudio() && written > 0 && written < static_cast<int>(sizeof(line))) {
+                std::snprintf(line + written, sizeof(line) - written, "  %.0fk %dch", info.audioSampleRate / 1000.0, info.audioChannels);
+            }
+            return line;
+        }
+
+        // One row per clip: poster frame, name and the indexer's summary. Only the rows in view
+        // are laid out, so a card with thousands of clips costs the same as one with ten.
+        void renderPlaylistEntries(App* appInstance, const ImGuiStyle& style) {
+            ClipIndexer* indexer = appInstance->m_clipIndexer.get();
+            const size_t total = appInstance->m_fileList.size();
+            if (indexer && indexer->pendingCount() > 0) {
+                ImGui::TextDisabled("Indexing %zu/%zu", std::min(indexer->indexedCount(), total), total);
+            }
+
+            const float thumbHeight = 45.0f;
+            const float thumbWidth = 80.0f;
+            const float rowHeight = std::max(thumbHeight, ImGui::GetTextLineHeightWithSpacing() * 2.0f);
+            const ImTextureID atlasTexture = (ImTextureID)appInstance->m_thumbnailAtlas.descriptorSet();
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(total), rowHeight + style.ItemSpacing.y);
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                    const std::string& filePath = appInstance->m_fileList[i];
+                    const std::shared_ptr<const ClipInfo> info = indexer ? indexer->find(filePath) : nullptr;
+                    if (indexer && (!info || (info->valid && !info->hasThumbnail()))) {
+                        indexer->prioritize(filePath);
+                    }
+
+                    ImGui::PushID(i);
+                    const bool is_selected = (appInstance->m_currentFileIndex == i);
+                    const ImVec2 rowMin = ImGui::GetCursorScreenPos();
+                    if (is_selected) ImGui::PushStyleColor(ImGuiCol_Header, style.Colors[ImGuiCol_HeaderActive]);
+                    if (ImGui::Selectable("##playlist_row", is_selected, ImGuiSelectableFlags_SpanAllColumns, ImVec2(0.0f, rowHeight))) {
+                        if (!is_selected) {
+                            bool originalFirstFileLoadedState = appInstance->m_firstFileLoaded;
+                            appInstance->m_firstFileLoaded = true;
+                            appInstance->loadFileAtIndex(i);
+                            appInstance->m_firstFileLoaded = originalFirstFileLoadedState;
+                        }
+                    }
+                    if (is_selected) ImGui::PopStyleColor();
+
+                    const ImVec2 boxMin(rowMin.x + 2.0f, rowMin.y + (rowHeight - thumbHeight) * 0.5f);
+                    const ImVec2 boxMax(boxMin.x + thumbWidth, boxMin.y + thumbHeight);
+                    const std::optional<ThumbnailAtlas::Uv> uv = appInstance->m_thumbnailAtlas.lookup(filePath, info);
+                    if (uv && info) {
+                        // Fit the poster frame into the box, keeping its aspect ratio.
+                        const float scale = std::min(thumbWidth / info->thumbnailWidth, thumbHeight / info->thumbnailHeight);
+                        const ImVec2 size(info->thumbnailWidth * scale, info->thumbnailHeight * scale);
+                        const ImVec2 imageMin(boxMin.x + (thumbWidth - size.x) * 0.5f, boxMin.y + (thumbHeight - size.y) * 0.5f);
+                        drawList->AddImage(atlasTexture, imageMin, imageMin + size, ImVec2(uv->u0, uv->v0), ImVec2(uv->u1, uv->v1));
+                    }
+                    else {
+                        drawList->AddRectFilled(boxMin, boxMax, ImGui::GetColorU32(ImGuiCol_FrameBg));
+                    }
+
+                    char entry_buf[512];
+                    snprintf(entry_buf, sizeof(entry_buf), "%2d. %s", i + 1, fs::path(filePath).stem().string().c_str());
+                    const ImVec2 textPos(boxMax.x + 8.0f, rowMin.y + (rowHeight - ImGui::GetTextLineHeightWithSpacing() * 2.0f) * 0.5f);
+                    drawList->AddText(textPos, ImGui::GetColorU32(ImGuiCol_Text), entry_buf);
+                    const std::string meta = info ? clipMetaLine(*info) : std::string("...");
+                    drawList->AddText(ImVec2(textPos.x, textPos.y + ImGui::GetTextLineHeightWithSpacing()),
+                        ImGui::GetColorU32(info && !info->valid ? ImGuiCol_PlotLinesHovered : ImGuiCol_TextDisabled), meta.c_str());
+                    ImGui::PopID();
+                }
+            }
+        }
+    }
+
     void beginFrame() {
         ImGui_ImplVulkan_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -162,12 +381,44 @@ namespace GuiOverlay {
 
         data.cfaOverride = appInstance->m_cfaOverride;
         data.cfaFromMetadataStr = appInstance->m_cfaStringFromMetadata;
+        if (appInstance->m_rendererVk) {
+            data.demosaicAlgorithmStr = appInstance->m_rendererVk->getDemosaicAlgorithm() == Renderer_VK::DemosaicAlgorithm::MalvarHeCutler ? "Malvar-He-Cutler" : "Bilinear";
+            if (appInstance->m_rendererVk->getRawUploadPath() == Renderer_VK::RawUploadPath::StorageBuffer) data.uploadPathStr = "In place";
+            else data.uploadPathStr = appInstance->m_transferUploader ? "Transfer queue" : "Copy";
+        }
         data.isFullscreen = appInstance->m_isFullscreen;
         data.showMetrics = appInstance->m_showMetrics;
         data.showHelpPage = appInstance->m_showHelpPage;
 
         data.decodedWidth = appInstance->m_decodedWidth;
         data.decodedHeight = appInstance->m_decodedHeight;
+        data.proxyStatusStr = "None";
+        if (appInstance->m_hasLastSuccessfullyUploadedPacket.load(std::memory_order_acquire) && appInstance->m_lastSuccessfullyUploadedPacket.proxy) {
+            data.proxyStatusStr = "Playing";
+        }
+        else if (appInstance->m_hasProxy) {
+            data.proxyStatusStr = "Ready";
+        }
+        else if (appInstance->m_proxyGenerator && appInstance->m_currentFileIndex >= 0 &&
+            static_cast<size_t>(appInstance->m_currentFileIndex) < appInstance->m_fileList.size()) {
+            const ProxyStatus proxy = appInstance->m_proxyGenerator->status();
+            if (proxy.clipPath == appInstance->m_fileList[appInstance->m_currentFileIndex]) {
+                if (proxy.state == ProxyStatus::State::Generating) {
+                    data.proxyStatusStr = "Writing " + std::to_string(proxy.frameCount > 0 ? proxy.framesDone * 100 / proxy.frameCount : 0) + "%";
+                }
+                else if (proxy.state == ProxyStatus::State::Failed) {
+                    data.proxyStatusStr = "Failed";
+                }
+            }
+        }
+
+        {
+            const AdaptiveQuality& quality = appInstance->m_adaptiveQuality;
+            char qualityBuf[128];
+            std::snprintf(qualityBuf, sizeof(qualityBuf), "%s (shown %.0f%%, decode %.2fx)", AdaptiveQuality::levelName(quality.level()),
+                quality.shownRatio() * 100.0, quality.decodeLoad());
+            data.qualityStr = qualityBuf;
+        }
 
         data.totalLoopTimeMs = appInstance->m_totalLoopTimeMs;
         data.gpuWaitTimeMs = appInstance->m_gpuWaitTimeMs;
@@ -237,23 +488,7 @@ namespace GuiOverlay {
                     ImGui::TextDisabled(" (empty)");
                 }
                 else {
-                    for (int i = 0; i < static_cast<int>(appInstance->m_fileList.size()); ++i) {
-                        const std::string& filePath = appInstance->m_fileList[i];
-                        std::string filename_to_display = fs::path(filePath).stem().string();
-                        bool is_selected = (appInstance->m_currentFileIndex == i);
-                        char entry_buf[512];
-                        snprintf(entry_buf, sizeof(entry_buf), "%2d. %s ", i + 1, filename_to_display.c_str());
-                        if (is_selected) ImGui::PushStyleColor(ImGuiCol_Header, style.Colors[ImGuiCol_HeaderActive]);
-                        if (ImGui::Selectable(entry_buf, is_selected, ImGuiSelectableFlags_SpanAllColumns)) {
-                            if (!is_selected) {
-                                bool originalFirstFileLoadedState = appInstance->m_firstFileLoaded;
-                                appInstance->m_firstFileLoaded = true;
-                                appInstance->loadFileAtIndex(i);
-                                appInstance->m_firstFileLoaded = originalFirstFileLoadedState;
-                            }
-                        }
-                        if (is_selected) ImGui::PopStyleColor();
-                    }
+                    renderPlaylistEntries(appInstance, style);
                 }
             }
             ImGui::End();
@@ -285,7 +520,10 @@ namespace GuiOverlay {
                 ImGui::Text("Display & UI:");
                 ImGui::BulletText("[F] or [F11]   : Toggle Fullscreen");
                 ImGui::BulletText("[Z]            : Toggle Zoom (Native Pixels / Fit to Window)");
+                ImGui::BulletText("[D]            : Toggle Demosaic (Malvar-He-Cutler / Bilinear)");
                 ImGui::BulletText("[M]            : Toggle Metrics Overlay");
+                ImGui::BulletText("[S]            : Toggle Scopes");
+                ImGui::BulletText("[T]            : Save Frame Trace (Chrome/Perfetto JSON)");
                 ImGui::BulletText("[H] or [F1]    : Toggle This Help Page");
                 ImGui::BulletText("[Tab]          : Toggle Main UI Controls");
                 ImGui::BulletText("[Esc]          : Exit Fullscreen / Close Popups / Quit");
@@ -407,44 +645,54 @@ namespace GuiOverlay {
                 int total_frames_slider = std::max(0, static_cast<int>(ui.totalFramesInFile) - 1);
 
                 bool value_changed_by_user_drag = ImGui::SliderInt("##Scrubber", &current_frame_idx_slider, 0, total_frames_slider, "", ImGuiSliderFlags_AlwaysClamp);
+                const ImVec2 scrubberMin = ImGui::GetItemRectMin();
+                const ImVec2 scrubberMax = ImGui::GetItemRectMax();
 
                 static bool was_paused_state_before_scrub = false;
                 static bool scrub_in_progress = false;
 
                 if (ImGui::IsItemActivated()) {
-                    LogToFile("[GuiRender::Slider] Scrub ACTIVATED.");
+                    LOG_DEBUG("[GuiRender::Slider] Scrub ACTIVATED.");
                     scrub_in_progress = true;
                     was_paused_state_before_scrub = appInstance->m_playbackController_ptr->isPaused();
                     if (!was_paused_state_before_scrub) {
-                        LogToFile("[GuiRender::Slider] Was playing, pausing for scrub via handleKey(SPACE).");
+                        LOG_DEBUG("[GuiRender::Slider] Was playing, pausing for scrub via handleKey(SPACE).");
                         appInstance->handleKey(GLFW_KEY_SPACE, 0); // This will toggle pause and call recordPauseTime
                     }
                 }
 
                 if (ImGui::IsItemActive() && value_changed_by_user_drag) {
-                    LogToFile(std::string("[GuiRender::Slider] Scrub DRAG, slider val: ") + std::to_string(current_frame_idx_slider) + ". Calling performSeek.");
+                    LOG_DEBUG(std::string("[GuiRender::Slider] Scrub DRAG, slider val: ") + std::to_string(current_frame_idx_slider) + ". Calling performSeek.");
                     appInstance->performSeek(static_cast<size_t>(current_frame_idx_slider));
                 }
 
                 if (scrub_in_progress && ImGui::IsItemDeactivated()) {
-                    LogToFile(std::string("[GuiRender::Slider] Scrub DEACTIVATED. Final slider val: ") + std::to_string(current_frame_idx_slider) +
+                    LOG_DEBUG(std::string("[GuiRender::Slider] Scrub DEACTIVATED. Final slider val: ") + std::to_string(current_frame_idx_slider) +
                         ", Current PB idx (after last drag seek, if any): " + std::to_string(appInstance->m_playbackController_ptr->getCurrentFrameIndex()));
                     scrub_in_progress = false;
 
                     if (static_cast<size_t>(current_frame_idx_slider) != appInstance->m_playbackController_ptr->getCurrentFrameIndex()) {
-                        LogToFile(std::string("[GuiRender::Slider] Scrub DEACTIVATED, value different from PB. Final seek to: ") + std::to_string(current_frame_idx_slider));
+                        LOG_DEBUG(std::string("[GuiRender::Slider] Scrub DEACTIVATED, value different from PB. Final seek to: ") + std::to_string(current_frame_idx_slider));
                         appInstance->performSeek(static_cast<size_t>(current_frame_idx_slider));
                     }
 
                     if (!was_paused_state_before_scrub) {
-                        LogToFile("[GuiRender::Slider] Scrub ended, was playing before. Resuming playback via handleKey(SPACE).");
+                        LOG_DEBUG("[GuiRender::Slider] Scrub ended, was playing before. Resuming playback via handleKey(SPACE).");
                         appInstance->handleKey(GLFW_KEY_SPACE, 0); // This will unpause and call anchorPlaybackTimeForResume
                     }
                     else {
-                        LogToFile("[GuiRender::Slider] Scrub ended, was paused. Stays paused. Anchor already set by (final) performSeek for paused state.");
+                        LOG_DEBUG("[GuiRender::Slider] Scrub ended, was paused. Stays paused. Anchor already set by (final) performSeek for paused state.");
                     }
                     was_paused_state_before_scrub = false;
                 }
+
+                if (appInstance->m_clipAnalyzer && appInstance->m_currentFileIndex >= 0 &&
+                    static_cast<size_t>(appInstance->m_currentFileIndex) < appInstance->m_fileList.size()) {
+                    const std::shared_ptr<const ClipStats> clipStats = appInstance->m_clipAnalyzer->current();
+                    if (clipStats && clipStats->path == appInstance->m_fileList[appInstance->m_currentFileIndex]) {
+                        renderClipStatsStrip(*clipStats, scrubberMin, scrubberMax);
+                    }
+                }
             }
             else {
                 int dummy = 0;
@@ -570,6 +818,8 @@ namespace GuiOverlay {
                 ImGui::Text("Frame: %zu / %zu", ui.currentFrameIndex + (ui.totalFramesInFile > 0 ? 1 : 0), ui.totalFramesInFile);
                 ImGui::Text("Time: %s / %s", ui.videoTimestampStr.c_str(), GuiUtils::formatHMS(static_cast<int64_t>(ui.totalDurationSec * 1e9)).c_str());
                 ImGui::Text("Decoded Res: %d x %d", ui.decodedWidth, ui.decodedHeight);
+                ImGui::Text("Proxy: %s", ui.proxyStatusStr.c_str());
+                ImGui::Text("Quality: %s", ui.qualityStr.c_str());
                 ImGui::Separator();
                 ImGui::Text("Captured FPS: %.2f", ui.capturedFps);
                 ImGui::Text("Display FPS: %.1f", ui.actualDisplayFps);
@@ -584,12 +834,57 @@ namespace GuiOverlay {
                 ImGui::Text("  App Logic (Events/PB/Audio): %.1f", ui.appLogicTimeMs);
                 ImGui::Text("  Sleep: %.1f", ui.sleepTimeMs);
 
+                ImGui::Separator();
+                renderPipelineMetrics(appInstance->m_pipelineMetrics);
+
                 ImGui::Separator();
                 ImGui::Text("CFA: %s (Meta: %s)", ui.cfaOverride.has_value() ? std::to_string(ui.cfaOverride.value()).c_str() : "Auto", ui.cfaFromMetadataStr.c_str());
+                ImGui::Text("Demosaic: %s, Upload: %s", ui.demosaicAlgorithmStr.c_str(), ui.uploadPathStr.c_str());
                 ImGui::Text("Mode: %s, Zoom: %s", ui.isFullscreen ? "Fullscreen" : "Windowed", ui.isZoomedToNative ? "Native Pixels" : "Fit to Window");
             }
             ImGui::End();
         }
+
+        if (appInstance->m_showScopes) {
+            ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - style.WindowPadding.x, viewport->WorkPos.y + style.WindowPadding.y), ImGuiCond_Appearing, ImVec2(1.0f, 0.0f));
+            ImGui::SetNextWindowBgAlpha(0.75f);
+            ImGuiWindowFlags scopes_window_flags = ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_AlwaysAutoResize;
+
+            if (ImGui::Begin("SCOPES", &appInstance->m_showScopes, scopes_window_flags)) {
+                const GpuScopes& scopes = appInstance->m_scopes;
+                if (scopes.texture() == VK_NULL_HANDLE) {
+                    ImGui::TextUnformatted("Scopes unavailable (see log).");
+                }
+                else if (!scopes.hasContent()) {
+                    ImGui::TextUnformatted("Waiting for a frame...");
+                }
+                else {
+                    static constexpr std::pair<GpuScopes::Panel, const char*> kPanels[] = {
+                        { GpuScopes::Panel::Histogram, "Histogram" },
+                        { GpuScopes::Panel::Waveform, "Waveform" },
+                        { GpuScopes::Panel::Parade, "RGB Parade" },
+                        { GpuScopes::Panel::Vectorscope, "Vectorscope" },
+                    };
+                    const ImTextureID scopesTexture = (ImTextureID)scopes.texture();
+                    const float panelSize = static_cast<float>(GpuScopes::kPanelSize);
+                    for (int i = 0; i < GpuScopes::kNumPanels; ++i) {
+                        if (i % 2 != 0) ImGui::SameLine();
+                        ImGui::BeginGroup();
+                        ImGui::TextUnformatted(kPanels[i].second);
+                        const GpuScopes::Uv uv = GpuScopes::panelUv(kPanels[i].first);
+                        ImGui::Image(scopesTexture, ImVec2(panelSize, panelSize), ImVec2(uv.u0, uv.v0), ImVec2(uv.u1, uv.v1));
+                        ImGui::EndGroup();
+                    }
+                    if (scopes.lastGpuMs() >= 0.0) {
+                        ImGui::Text("GPU: %.3f ms, %u samples", scopes.lastGpuMs(), scopes.lastSampleCount());
+                    }
+                    else {
+                        ImGui::Text("%u samples", scopes.lastSampleCount());
+                    }
+                }
+            }
+            ImGui::End();
+        }
     }
 
     void endFrame(VkCommandBuffer commandBuffer) {
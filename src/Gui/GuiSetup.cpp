@@ -48,7 +48,7 @@ namespace GuiOverlay {
         }
         init_info.QueueFamily = indices.graphicsFamily.value();
         init_info.Queue = appInstance->m_graphicsQueue;
-        init_info.PipelineCache = VK_NULL_HANDLE; // Optional
+        init_info.PipelineCache = appInstance->m_pipelineCache.handle();
         init_info.DescriptorPool = appInstance->m_imguiDescriptorPool; // App creates and owns this
         init_info.Subpass = 0; // Assuming ImGui renders in the first subpass
 
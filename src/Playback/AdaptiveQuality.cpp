@@ -0,0 +1,150 @@
+#include "Playback/AdaptiveQuality.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+constexpr auto kWindow = std::chrono::seconds(1);
+constexpr double kSlowShownRatio = 0.9;   // A window showing fewer of the frames the playhead passed is slow
+constexpr double kSlowDecodeLoad = 0.95;  // ...as is one whose mean decode time uses up the frame interval
+constexpr int kSlowWindowsBeforeStep = 2; // Consecutive slow windows; one is a seek or a hiccup
+constexpr double kGoodShownRatio = 0.98;
+constexpr double kGoodDecodeLoad = 0.7;
+constexpr double kGoodDecodeBacklog = 0.5;
+constexpr int kBaseGoodWindows = 4;       // Windows with headroom before a step up
+constexpr int kMaxGoodWindows = 32;
+constexpr int kStepUpProbationWindows = 3; // A step down this soon after a step up undoes it
+
+AdaptiveQuality::Level lower(AdaptiveQuality::Level level, bool canReduceResolution) {
+    using Level = AdaptiveQuality::Level;
+    switch (level) {
+    case Level::Full: return Level::ParallelDecode;
+    case Level::ParallelDecode: return canReduceResolution ? Level::ReducedResolution : Level::SkipLate;
+    default: return Level::SkipLate;
+    }
+}
+
+AdaptiveQuality::Level higher(AdaptiveQuality::Level level, bool canReduceResolution) {
+    using Level = AdaptiveQuality::Level;
+    switch (level) {
+    case Level::SkipLate: return canReduceResolution ? Level::ReducedResolution : Level::ParallelDecode;
+    case Level::ReducedResolution: return Level::ParallelDecode;
+    default: return Level::Full;
+    }
+}
+
+std::string percent(double ratio) {
+    return std::to_string(static_cast<int>(std::lround(ratio * 100.0))) + "%";
+}
+}
+
+const char* AdaptiveQuality::levelName(Level level) {
+    switch (level) {
+    case Level::Full: return "Full";
+    case Level::ParallelDecode: return "Parallel decode";
+    case Level::ReducedResolution: return "Reduced resolution";
+    case Level::SkipLate: return "Skipping late frames";
+    default: return "?";
+    }
+}
+
+AdaptiveQuality::AdaptiveQuality() {
+    reset();
+}
+
+void AdaptiveQuality::reset() {
+    m_level = Level::Full;
+    m_reason.clear();
+    m_windowStart = {};
+    m_slowWindows = 0;
+    m_goodWindows = 0;
+    m_goodWindowsRequired = kBaseGoodWindows;
+    m_windowsSinceStepUp = -1;
+    m_shownRatio = 1.0;
+    m_decodeLoad = 0.0;
+    m_decodeBacklog = 0.0;
+}
+
+size_t AdaptiveQuality::decodeLatencyFrames() const {
+    return static_cast<size_t>(std::max(1.0, std::ceil(m_decodeLoad)));
+}
+
+void AdaptiveQuality::step(Level to, const std::string& reason) {
+    m_level = to;
+    m_reason = reason;
+    m_slowWindows = 0;
+    m_goodWindows = 0;
+}
+
+bool AdaptiveQuality::update(std::chrono::steady_clock::time_point now, const Sample& sample) {
+    if (m_windowStart == std::chrono::steady_clock::time_point{} || sample.playhead < m_windowFirst.playhead ||
+        sample.framesDisplayed < m_windowFirst.framesDisplayed || sample.decodeCount < m_windowFirst.decodeCount) {
+        // First window after a load, pause, seek or loop
+        m_windowStart = now;
+        m_windowFirst = sample;
+        m_depthSum = 0.0;
+        m_depthSamples = 0;
+        return false;
+    }
+    if (sample.decodeQueueCapacity > 0) {
+        m_depthSum += static_cast<double>(sample.decodeQueueDepth) / static_cast<double>(sample.decodeQueueCapacity);
+        ++m_depthSamples;
+    }
+    if (now - m_windowStart < kWindow) {
+        return false;
+    }
+
+    const uint64_t shown = sample.framesDisplayed - m_windowFirst.framesDisplayed;
+    const size_t passed = sample.playhead - m_windowFirst.playhead;
+    const uint64_t decoded = sample.decodeCount - m_windowFirst.decodeCount;
+    const double decodeMs = sample.decodeMsSum - m_windowFirst.decodeMsSum;
+    // Of the frames the playhead passed, only one per stride is meant to be shown.
+    const double due = static_cast<double>(passed) / std::max(1.0, sample.frameStride);
+    m_shownRatio = passed > 0 ? std::min(1.0, static_cast<double>(shown) / due) : 1.0;
+    m_decodeLoad = decoded > 0 && sample.frameIntervalMs > 0.0 ? decodeMs / static_cast<double>(decoded) / sample.frameIntervalMs : 0.0;
+    m_decodeBacklog = m_depthSamples > 0 ? m_depthSum / static_cast<double>(m_depthSamples) : 0.0;
+    m_windowStart = now;
+    m_windowFirst = sample;
+    m_depthSum = 0.0;
+    m_depthSamples = 0;
+    if (passed == 0) {
+        return false;
+    }
+    if (m_windowsSinceStepUp >= 0) {
+        ++m_windowsSinceStepUp;
+    }
+
+    const bool missed = m_shownRatio < kSlowShownRatio;
+    const bool overloaded = m_decodeLoad > kSlowDecodeLoad;
+    if (missed || overloaded) {
+        m_goodWindows = 0;
+        if (++m_slowWindows < kSlowWindowsBeforeStep || m_level == Level::SkipLate) {
+            return false;
+        }
+        if (m_windowsSinceStepUp >= 0 && m_windowsSinceStepUp <= kStepUpProbationWindows) {
+            m_goodWindowsRequired = std::min(m_goodWindowsRequired * 2, kMaxGoodWindows);
+        }
+        m_windowsSinceStepUp = -1;
+        char load[32];
+        std::snprintf(load, sizeof(load), "%.2f", m_decodeLoad);
+        step(lower(m_level, sample.canReduceResolution), missed
+            ? std::to_string(shown) + " of " + std::to_string(static_cast<uint64_t>(std::lround(due))) + " frames shown"
+            : std::string("decode takes ") + load + "x the frame interval");
+        return true;
+    }
+
+    m_slowWindows = 0;
+    const bool headroom = m_shownRatio >= kGoodShownRatio && m_decodeLoad < kGoodDecodeLoad && m_decodeBacklog < kGoodDecodeBacklog;
+    if (!headroom || m_level == Level::Full) {
+        m_goodWindows = 0;
+        return false;
+    }
+    if (++m_goodWindows < m_goodWindowsRequired) {
+        return false;
+    }
+    m_windowsSinceStepUp = 0;
+    step(higher(m_level, sample.canReduceResolution), "headroom for " + std::to_string(m_goodWindows) +
+        " s, decode at " + percent(m_decodeLoad) + " of the frame interval");
+    return true;
+}
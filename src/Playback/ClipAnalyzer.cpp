@@ -0,0 +1,384 @@
+#include "Playback/ClipAnalyzer.h"
+#include "Export/CpuImagePipeline.h"
+#include "Utils/DebugLog.h"
+
+#include <motioncam/Decoder.hpp>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr int kCacheVersion = 1;
+constexpr size_t kPublishInterval = 32; // Samples between snapshots for the GUI
+constexpr size_t kFloatsPerSample = 7;
+
+// Analysis must never take decode time from playback.
+void lowerThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+    setpriority(PRIO_PROCESS, 0, 10); // Linux applies this to the calling thread only
+#endif
+}
+
+// One pass over the mosaic. Only whole 2x2 quads are measured, so every sum is per CFA site.
+FrameStats measureFrame(const uint16_t* src, int width, int height, float blackLevel, float whiteLevel) {
+    FrameStats stats;
+    const int evenW = width & ~1;
+    const int evenH = height & ~1;
+    if (evenW < 4 || evenH < 2 || whiteLevel <= blackLevel) {
+        return stats;
+    }
+    const uint32_t clipAt = static_cast<uint32_t>(std::lround(whiteLevel));
+    const uint32_t crushAt = static_cast<uint32_t>(std::lround(blackLevel));
+
+    uint64_t sums[4] = {};
+    uint64_t clipped = 0;
+    uint64_t crushed = 0;
+    uint64_t gradient = 0;
+    for (int y = 0; y < evenH; ++y) {
+        const uint16_t* row = src + static_cast<size_t>(y) * width;
+        uint64_t sumEven = 0;
+        uint64_t sumOdd = 0;
+        for (int x = 0; x < evenW; x += 2) {
+            const uint32_t v0 = row[x];
+            const uint32_t v1 = row[x + 1];
+            sumEven += v0;
+            sumOdd += v1;
+            clipped += (v0 >= clipAt) + (v1 >= clipAt);
+            crushed += (v0 <= crushAt) + (v1 <= crushAt);
+            if (x + 3 < evenW) {
+                gradient += static_cast<uint32_t>(std::abs(static_cast<int32_t>(row[x + 2]) - static_cast<int32_t>(v0)));
+                gradient += static_cast<uint32_t>(std::abs(static_cast<int32_t>(row[x + 3]) - static_cast<int32_t>(v1)));
+            }
+        }
+        sums[(y & 1) * 2] += sumEven;
+        sums[(y & 1) * 2 + 1] += sumOdd;
+    }
+
+    const double range = static_cast<double>(whiteLevel) - blackLevel;
+    const double sitesPerChannel = static_cast<double>(evenW / 2) * (evenH / 2);
+    const double totalSites = sitesPerChannel * 4.0;
+    for (int c = 0; c < 4; ++c) {
+        const double mean = (static_cast<double>(sums[c]) / sitesPerChannel - blackLevel) / range;
+        stats.channelMean[c] = static_cast<float>(std::clamp(mean, 0.0, 1.0));
+    }
+    stats.clippedPct = static_cast<float>(100.0 * static_cast<double>(clipped) / totalSites);
+    stats.crushedPct = static_cast<float>(100.0 * static_cast<double>(crushed) / totalSites);
+    stats.sharpness = static_cast<float>(static_cast<double>(gradient) / (static_cast<double>(evenW - 2) * evenH) / range);
+    stats.valid = true;
+    return stats;
+}
+
+nlohmann::json toJson(const ClipStats& stats) {
+    std::vector<uint8_t> values(stats.samples.size() * kFloatsPerSample * sizeof(float));
+    std::vector<uint8_t> valid(stats.samples.size());
+    for (size_t i = 0; i < stats.samples.size(); ++i) {
+        const FrameStats& s = stats.samples[i];
+        const float packed[kFloatsPerSample] = { s.channelMean[0], s.channelMean[1], s.channelMean[2], s.channelMean[3],
+            s.clippedPct, s.crushedPct, s.sharpness };
+        std::memcpy(values.data() + i * sizeof(packed), packed, sizeof(packed));
+        valid[i] = s.valid ? 1 : 0;
+    }
+    return {
+        { "size", stats.fileSize }, { "mtime", stats.modifiedTime },
+        { "frames", stats.frameCount }, { "stride", stats.stride },
+        { "values", nlohmann::json::binary(std::move(values)) }, { "valid", nlohmann::json::binary(std::move(valid)) } };
+}
+
+std::shared_ptr<ClipStats> fromJson(const nlohmann::json& j, const std::string& path) {
+    auto stats = std::make_shared<ClipStats>();
+    stats->path = path;
+    stats->fileSize = j.value("size", uint64_t{ 0 });
+    stats->modifiedTime = j.value("mtime", int64_t{ 0 });
+    stats->frameCount = j.value("frames", size_t{ 0 });
+    stats->stride = std::max<size_t>(1, j.value("stride", size_t{ 1 }));
+    const auto values = j.find("values");
+    const auto valid = j.find("valid");
+    if (values == j.end() || valid == j.end() || !values->is_binary() || !valid->is_binary()) {
+        return nullptr;
+    }
+    const size_t count = (stats->frameCount + stats->stride - 1) / stats->stride;
+    if (valid->get_binary().size() != count || values->get_binary().size() != count * kFloatsPerSample * sizeof(float)) {
+        return nullptr;
+    }
+    stats->samples.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        float packed[kFloatsPerSample];
+        std::memcpy(packed, values->get_binary().data() + i * sizeof(packed), sizeof(packed));
+        FrameStats& s = stats->samples[i];
+        std::copy(packed, packed + 4, s.channelMean);
+        s.clippedPct = packed[4];
+        s.crushedPct = packed[5];
+        s.sharpness = packed[6];
+        s.valid = valid->get_binary()[i] != 0;
+    }
+    stats->analyzedCount = count;
+    stats->complete = true;
+    return stats;
+}
+
+float medianSharpness(const std::vector<FrameStats>& samples) {
+    std::vector<float> values;
+    values.reserve(samples.size());
+    for (const FrameStats& s : samples) {
+        if (s.valid) values.push_back(s.sharpness);
+    }
+    if (values.empty()) {
+        return 0.0f;
+    }
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+}
+
+float FrameStats::maxMean() const {
+    return *std::max_element(channelMean, channelMean + 4);
+}
+
+const FrameStats* ClipStats::sampleForFrame(size_t frameIndex) const {
+    const size_t index = frameIndex / stride;
+    if (index >= samples.size() || !samples[index].valid) {
+        return nullptr;
+    }
+    return &samples[index];
+}
+
+bool ClipStats::isSoft(const FrameStats& stats) const {
+    return stats.valid && !stats.isBlack() && medianSharpness > 0.0f && stats.sharpness < medianSharpness * 0.5f;
+}
+
+ClipAnalyzer::ClipAnalyzer(std::string cachePath, unsigned numThreads)
+    : m_cachePath(std::move(cachePath)),
+      m_numThreads(numThreads != 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency() / 4)) {
+    loadCache();
+    LogToFile("[ClipAnalyzer] " + std::to_string(m_numThreads) + " analysis threads, " + std::to_string(m_cache.size()) + " cached clips.");
+}
+
+ClipAnalyzer::~ClipAnalyzer() {
+    cancel();
+}
+
+void ClipAnalyzer::analyze(const std::string& path, std::shared_ptr<const motioncam::Decoder> decoder) {
+    if (path.empty() || !decoder || path == m_requestedPath) {
+        return;
+    }
+    cancel();
+    m_requestedPath = path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_building = ClipStats();
+        m_current.reset();
+        m_publishedCount = 0;
+    }
+    // Analysing a remote clip would download all of it.
+    if (motioncam::isRemoteLocation(path)) {
+        LOG_DEBUG("[ClipAnalyzer::analyze] Skipping remote clip " + path);
+        return;
+    }
+    m_cancel.store(false, std::memory_order_relaxed);
+    m_worker = std::thread(&ClipAnalyzer::run, this, path, std::move(decoder));
+}
+
+void ClipAnalyzer::cancel() {
+    m_cancel.store(true, std::memory_order_relaxed);
+    if (m_worker.joinable()) m_worker.join();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_current || !m_current->complete) {
+        m_requestedPath.clear(); // Analysing the same clip again starts over
+    }
+}
+
+std::shared_ptr<const ClipStats> ClipAnalyzer::current() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_current;
+}
+
+void ClipAnalyzer::run(std::string path, std::shared_ptr<const motioncam::Decoder> decoder) {
+    lowerThreadPriority();
+    const auto start = std::chrono::steady_clock::now();
+    const std::string fileName = fs::path(path).filename().string();
+
+    ClipStats layout;
+    layout.path = path;
+    std::error_code ec;
+    layout.fileSize = static_cast<uint64_t>(fs::file_size(path, ec));
+    if (!ec) {
+        layout.modifiedTime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    }
+    if (ec) {
+        LogToFile("[ClipAnalyzer] Cannot stat '" + fileName + "': " + ec.message());
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_cache.find(path);
+        if (it != m_cache.end()) {
+            std::shared_ptr<ClipStats> cached = fromJson(it->second, path);
+            if (cached && cached->fileSize == layout.fileSize && cached->modifiedTime == layout.modifiedTime) {
+                cached->medianSharpness = medianSharpness(cached->samples);
+                m_building = *cached;
+                m_current = std::move(cached);
+                LOG_DEBUG("[ClipAnalyzer] '" + fileName + "' served from cache.");
+                return;
+            }
+        }
+    }
+
+    const std::vector<motioncam::Timestamp>& frames = decoder->getFrames();
+    if (frames.empty()) {
+        return;
+    }
+    layout.frameCount = frames.size();
+    layout.stride = (frames.size() + kMaxSamples - 1) / kMaxSamples;
+    layout.samples.resize((frames.size() + layout.stride - 1) / layout.stride);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_building = layout;
+        m_publishedCount = 0;
+        publishLocked();
+    }
+
+    std::atomic<size_t> nextSample{ 0 };
+    std::vector<std::thread> helpers;
+    for (unsigned i = 1; i < m_numThreads && i < layout.samples.size(); ++i) {
+        helpers.emplace_back([this, &decoder, &layout, &nextSample] {
+            lowerThreadPriority();
+            analyzeFrames(*decoder, layout, nextSample);
+        });
+    }
+    analyzeFrames(*decoder, layout, nextSample);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    if (m_cancel.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_building.complete = m_building.analyzedCount == m_building.samples.size();
+        publishLocked();
+        m_cache[path] = toJson(m_building);
+    }
+    const double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double clipSec = static_cast<double>(frames.back() - frames.front()) * 1e-9;
+    LogToFile("[ClipAnalyzer] '" + fileName + "': " + std::to_string(layout.samples.size()) + " of " + std::to_string(frames.size()) +
+        " frames in " + std::to_string(elapsedSec) + " s (" + std::to_string(elapsedSec > 0.0 ? clipSec / elapsedSec : 0.0) + "x realtime).");
+    saveCache();
+}
+
+void ClipAnalyzer::analyzeFrames(const motioncam::Decoder& decoder, const ClipStats& layout, std::atomic<size_t>& nextSample) {
+    const std::vector<motioncam::Timestamp>& frames = decoder.getFrames();
+    std::vector<uint8_t> frame;
+    nlohmann::json frameMetadata;
+    while (!m_cancel.load(std::memory_order_relaxed)) {
+        const size_t index = nextSample.fetch_add(1, std::memory_order_relaxed);
+        const size_t frameIndex = index * layout.stride;
+        if (index >= layout.samples.size() || frameIndex >= frames.size()) {
+            return;
+        }
+        FrameStats stats;
+        try {
+            decoder.loadFrame(frames[frameIndex], frame, frameMetadata);
+            const CpuImagePipeline::Params params = CpuImagePipeline::paramsFromMetadata(frameMetadata, decoder.getContainerMetadata());
+            stats = measureFrame(reinterpret_cast<const uint16_t*>(frame.data()),
+                frameMetadata.value("width", 0), frameMetadata.value("height", 0), params.blackLevel, params.whiteLevel);
+        }
+        catch (const std::exception& e) {
+            LOG_DEBUG("[ClipAnalyzer] Frame " + std::to_string(frameIndex) + " not analysed: " + e.what());
+        }
+        storeSample(index, stats);
+    }
+}
+
+void ClipAnalyzer::storeSample(size_t index, const FrameStats& stats) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_building.samples[index] = stats;
+    ++m_building.analyzedCount;
+    if (m_building.analyzedCount - m_publishedCount >= kPublishInterval) {
+        publishLocked();
+    }
+}
+
+void ClipAnalyzer::publishLocked() {
+    auto snapshot = std::make_shared<ClipStats>(m_building);
+    snapshot->medianSharpness = medianSharpness(snapshot->samples);
+    m_current = std::move(snapshot);
+    m_publishedCount = m_building.analyzedCount;
+}
+
+void ClipAnalyzer::loadCache() {
+    std::ifstream in(m_cachePath, std::ios::binary);
+    if (!in) {
+        return;
+    }
+    try {
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        nlohmann::json root = nlohmann::json::from_msgpack(bytes);
+        if (root.value("version", 0) != kCacheVersion) {
+            LogToFile("[ClipAnalyzer::loadCache] Ignoring " + m_cachePath + " from another version.");
+            return;
+        }
+        for (auto& [path, clip] : root.at("clips").items()) {
+            m_cache.emplace(path, std::move(clip));
+        }
+    }
+    catch (const std::exception& e) {
+        LogToFile("[ClipAnalyzer::loadCache] Ignoring unreadable " + m_cachePath + ": " + e.what());
+        m_cache.clear();
+    }
+}
+
+void ClipAnalyzer::saveCache() {
+    nlohmann::json clips = nlohmann::json::object();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [path, clip] : m_cache) {
+            clips[path] = clip;
+        }
+    }
+
+    const nlohmann::json root = { { "version", kCacheVersion }, { "clips", std::move(clips) } };
+    const std::vector<uint8_t> bytes = nlohmann::json::to_msgpack(root);
+    const std::string tempPath = m_cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            LogToFile("[ClipAnalyzer::saveCache] Cannot write " + tempPath);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, m_cachePath, ec);
+    if (ec) {
+        LogToFile("[ClipAnalyzer::saveCache] Cannot replace " + m_cachePath + ": " + ec.message());
+        return;
+    }
+    LOG_DEBUG("[ClipAnalyzer::saveCache] Wrote " + std::to_string(bytes.size()) + " bytes to " + m_cachePath);
+}
@@ -0,0 +1,388 @@
+#include "Playback/ClipIndexer.h"
+#include "Export/CpuImagePipeline.h"
+#include "Utils/DebugLog.h"
+
+#include <motioncam/Decoder.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr int kCacheVersion = 1;
+
+// Keeps one 2x2 CFA quad per output pixel so the reduced mosaic has the same layout as the
+// frame, develops it with the headless pipeline and averages each quad down to one RGBA pixel.
+void makeThumbnail(const std::vector<uint8_t>& frame, int width, int height,
+    const nlohmann::json& frameMetadata, const nlohmann::json& containerMetadata, ClipInfo& info)
+{
+    const int longSide = std::max(width, height);
+    const int thumbW = std::max(1, width * ClipIndexer::kThumbnailSize / longSide);
+    const int thumbH = std::max(1, height * ClipIndexer::kThumbnailSize / longSide);
+    const int mosaicW = thumbW * 2;
+    const int mosaicH = thumbH * 2;
+
+    const uint16_t* src = reinterpret_cast<const uint16_t*>(frame.data());
+    std::vector<uint16_t> mosaic(static_cast<size_t>(mosaicW) * mosaicH);
+    for (int ty = 0; ty < thumbH; ++ty) {
+        const int sy = std::min((ty * height / thumbH) & ~1, height - 2);
+        for (int tx = 0; tx < thumbW; ++tx) {
+            const int sx = std::min((tx * width / thumbW) & ~1, width - 2);
+            for (int qy = 0; qy < 2; ++qy) {
+                for (int qx = 0; qx < 2; ++qx) {
+                    mosaic[static_cast<size_t>(ty * 2 + qy) * mosaicW + tx * 2 + qx] = src[static_cast<size_t>(sy + qy) * width + sx + qx];
+                }
+            }
+        }
+    }
+
+    const CpuImagePipeline::Params params = CpuImagePipeline::paramsFromMetadata(frameMetadata, containerMetadata);
+    std::vector<uint16_t> rgb(static_cast<size_t>(mosaicW) * mosaicH * 3);
+    CpuImagePipeline::process(mosaic.data(), mosaicW, mosaicH, params, CpuImagePipeline::Output::SRGB_U16, rgb.data(), 1);
+
+    info.thumbnailWidth = thumbW;
+    info.thumbnailHeight = thumbH;
+    info.thumbnail.assign(static_cast<size_t>(thumbW) * thumbH * 4, 255);
+    for (int ty = 0; ty < thumbH; ++ty) {
+        for (int tx = 0; tx < thumbW; ++tx) {
+            for (int c = 0; c < 3; ++c) {
+                uint32_t sum = 0;
+                for (int qy = 0; qy < 2; ++qy) {
+                    for (int qx = 0; qx < 2; ++qx) {
+                        sum += rgb[(static_cast<size_t>(ty * 2 + qy) * mosaicW + tx * 2 + qx) * 3 + c];
+                    }
+                }
+                info.thumbnail[(static_cast<size_t>(ty) * thumbW + tx) * 4 + c] = static_cast<uint8_t>(sum >> 10);
+            }
+        }
+    }
+}
+
+nlohmann::json toJson(const ClipInfo& info) {
+    nlohmann::json j = {
+        { "size", info.fileSize }, { "mtime", info.modifiedTime }, { "valid", info.valid },
+        { "width", info.width }, { "height", info.height }, { "frames", info.frameCount },
+        { "durationSec", info.durationSec }, { "fps", info.fps },
+        { "audioRate", info.audioSampleRate }, { "audioChannels", info.audioChannels } };
+    if (!info.error.empty()) {
+        j["error"] = info.error;
+    }
+    if (info.hasThumbnail()) {
+        j["thumbW"] = info.thumbnailWidth;
+        j["thumbH"] = info.thumbnailHeight;
+        j["thumb"] = nlohmann::json::binary(info.thumbnail);
+    }
+    return j;
+}
+
+std::shared_ptr<const ClipInfo> fromJson(const nlohmann::json& j) {
+    auto info = std::make_shared<ClipInfo>();
+    info->fileSize = j.value("size", uint64_t{ 0 });
+    info->modifiedTime = j.value("mtime", int64_t{ 0 });
+    info->valid = j.value("valid", false);
+    info->error = j.value("error", std::string());
+    info->width = j.value("width", 0);
+    info->height = j.value("height", 0);
+    info->frameCount = j.value("frames", size_t{ 0 });
+    info->durationSec = j.value("durationSec", 0.0);
+    info->fps = j.value("fps", 0.0);
+    info->audioSampleRate = j.value("audioRate", 0);
+    info->audioChannels = j.value("audioChannels", 0);
+    const auto thumb = j.find("thumb");
+    if (thumb != j.end() && thumb->is_binary()) {
+        const int w = j.value("thumbW", 0);
+        const int h = j.value("thumbH", 0);
+        if (w > 0 && h > 0 && thumb->get_binary().size() == static_cast<size_t>(w) * h * 4) {
+            info->thumbnailWidth = w;
+            info->thumbnailHeight = h;
+            info->thumbnail.assign(thumb->get_binary().begin(), thumb->get_binary().end());
+        }
+    }
+    return info;
+}
+}
+
+ClipIndexer::ClipIndexer(std::string cachePath, unsigned numThreads)
+    : m_cachePath(std::move(cachePath)) {
+    loadCache();
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    }
+    for (unsigned i = 0; i < numThreads; ++i) {
+        m_workers.emplace_back(&ClipIndexer::workerLoop, this);
+    }
+    LogToFile("[ClipIndexer] " + std::to_string(numThreads) + " indexing threads, " + std::to_string(m_cached.size()) + " cached clips.");
+}
+
+ClipIndexer::~ClipIndexer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (std::thread& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+    saveCache();
+}
+
+void ClipIndexer::enqueue(const std::vector<std::string>& paths) {
+    size_t added = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::string& path : paths) {
+            auto [it, inserted] = m_entries.try_emplace(path);
+            if (!inserted) continue;
+            it->second.queued = true;
+            m_metadataQueue.push_back(path);
+            ++added;
+        }
+    }
+    if (added > 0) {
+        m_cond.notify_all();
+        LOG_DEBUG("[ClipIndexer::enqueue] Queued " + std::to_string(added) + " clips.");
+    }
+}
+
+void ClipIndexer::prioritize(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto entry = m_entries.find(path);
+    if (entry == m_entries.end() || !entry->second.queued) {
+        return;
+    }
+    std::deque<std::string>& queue = entry->second.info ? m_thumbnailQueue : m_metadataQueue;
+    auto it = std::find(queue.begin(), queue.end(), path);
+    if (it != queue.end() && it != queue.begin()) {
+        std::string moved = std::move(*it);
+        queue.erase(it);
+        queue.push_front(std::move(moved));
+    }
+}
+
+std::shared_ptr<const ClipInfo> ClipIndexer::find(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(path);
+    return it != m_entries.end() ? it->second.info : nullptr;
+}
+
+size_t ClipIndexer::pendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_metadataQueue.size();
+}
+
+size_t ClipIndexer::indexedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_indexedCount;
+}
+
+void ClipIndexer::workerLoop() {
+    while (true) {
+        std::string path;
+        bool thumbnailPass = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_stop || !m_metadataQueue.empty() || !m_thumbnailQueue.empty(); });
+            if (m_stop) return;
+            // Every queued clip gets its metadata before any thumbnail is decoded.
+            std::deque<std::string>& queue = !m_metadataQueue.empty() ? m_metadataQueue : m_thumbnailQueue;
+            thumbnailPass = (&queue == &m_thumbnailQueue);
+            path = std::move(queue.front());
+            queue.pop_front();
+            m_entries[path].queued = false;
+            ++m_busyWorkers;
+        }
+
+        try {
+            if (thumbnailPass) runThumbnailPass(path);
+            else runMetadataPass(path);
+        }
+        catch (const std::exception& e) {
+            LogToFile("[ClipIndexer] Unexpected error indexing '" + path + "': " + e.what());
+        }
+
+        bool idle;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_busyWorkers;
+            idle = m_busyWorkers == 0 && m_metadataQueue.empty() && m_thumbnailQueue.empty() && m_dirty;
+        }
+        if (idle) {
+            saveCache();
+        }
+    }
+}
+
+void ClipIndexer::publish(const std::string& path, std::shared_ptr<const ClipInfo> info, bool countIndexed) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = m_entries[path];
+        const bool needsThumbnail = info->valid && !info->hasThumbnail() && !entry.queued;
+        entry.info = std::move(info);
+        if (countIndexed) ++m_indexedCount;
+        m_dirty = true;
+        if (!needsThumbnail || m_stop) return;
+        entry.queued = true;
+        m_thumbnailQueue.push_back(path);
+    }
+    m_cond.notify_one();
+}
+
+void ClipIndexer::runMetadataPass(const std::string& path) {
+    auto info = std::make_shared<ClipInfo>();
+    // URLs have no cheap stat, so they are never served from the cache
+    const bool remote = motioncam::isRemoteLocation(path);
+    std::error_code ec;
+    if (!remote) {
+        info->fileSize = static_cast<uint64_t>(fs::file_size(path, ec));
+    }
+    if (!remote && !ec) {
+        info->modifiedTime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    }
+    if (ec) {
+        info->error = ec.message();
+        publish(path, std::move(info), true);
+        return;
+    }
+
+    std::shared_ptr<const ClipInfo> cached;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_cached.find(path);
+        if (it != m_cached.end()) {
+            if (it->second->fileSize == info->fileSize && it->second->modifiedTime == info->modifiedTime) {
+                cached = std::move(it->second);
+            }
+            m_cached.erase(it);
+        }
+    }
+    if (cached) {
+        publish(path, std::move(cached), true);
+        return;
+    }
+
+    try {
+        motioncam::Decoder decoder(path);
+        if (remote) {
+            info->fileSize = decoder.getByteSource().size();
+        }
+        const std::vector<motioncam::Timestamp>& frames = decoder.getFrames();
+        info->frameCount = frames.size();
+        if (frames.size() > 1) {
+            info->durationSec = static_cast<double>(frames.back() - frames.front()) * 1e-9;
+            if (info->durationSec > 1e-6) {
+                info->fps = static_cast<double>(frames.size() - 1) / info->durationSec;
+            }
+        }
+        if (!frames.empty()) {
+            std::vector<uint8_t> compressed;
+            std::vector<uint8_t> metadata;
+            int compressionType = -1;
+            decoder.getRawFramePayloads(frames.front(), compressed, metadata, info->width, info->height, compressionType);
+        }
+        info->audioSampleRate = decoder.audioSampleRateHz();
+        info->audioChannels = decoder.numAudioChannels();
+        info->valid = true;
+    }
+    catch (const std::exception& e) {
+        info->error = e.what();
+        LogToFile("[ClipIndexer] Cannot index '" + fs::path(path).filename().string() + "': " + e.what());
+    }
+    publish(path, std::move(info), true);
+}
+
+void ClipIndexer::runThumbnailPass(const std::string& path) {
+    std::shared_ptr<const ClipInfo> current = find(path);
+    if (!current || !current->valid || current->hasThumbnail()) {
+        return;
+    }
+
+    auto updated = std::make_shared<ClipInfo>(*current);
+    try {
+        motioncam::Decoder decoder(path);
+        const std::vector<motioncam::Timestamp>& frames = decoder.getFrames();
+        if (frames.empty()) {
+            return;
+        }
+        std::vector<uint8_t> frame;
+        nlohmann::json frameMetadata;
+        decoder.loadFrame(frames.front(), frame, frameMetadata);
+        const int width = frameMetadata.value("width", 0);
+        const int height = frameMetadata.value("height", 0);
+        if (width < 2 || height < 2) {
+            return;
+        }
+        makeThumbnail(frame, width, height, frameMetadata, decoder.getContainerMetadata(), *updated);
+    }
+    catch (const std::exception& e) {
+        LogToFile("[ClipIndexer] No thumbnail for '" + fs::path(path).filename().string() + "': " + e.what());
+        return;
+    }
+    publish(path, std::move(updated), false);
+}
+
+void ClipIndexer::loadCache() {
+    std::ifstream in(m_cachePath, std::ios::binary);
+    if (!in) {
+        return;
+    }
+    try {
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const nlohmann::json root = nlohmann::json::from_msgpack(bytes);
+        if (root.value("version", 0) != kCacheVersion) {
+            LogToFile("[ClipIndexer::loadCache] Ignoring " + m_cachePath + " from another version.");
+            return;
+        }
+        for (const auto& [path, clip] : root.at("clips").items()) {
+            m_cached.emplace(path, fromJson(clip));
+        }
+    }
+    catch (const std::exception& e) {
+        LogToFile("[ClipIndexer::loadCache] Ignoring unreadable " + m_cachePath + ": " + e.what());
+        m_cached.clear();
+    }
+}
+
+void ClipIndexer::saveCache() {
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
+    nlohmann::json clips = nlohmann::json::object();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty) {
+            return;
+        }
+        m_dirty = false;
+        // Clips cached from other folders stay in the file.
+        for (const auto& [path, info] : m_cached) {
+            clips[path] = toJson(*info);
+        }
+        for (const auto& [path, entry] : m_entries) {
+            if (entry.info && !motioncam::isRemoteLocation(path)) clips[path] = toJson(*entry.info);
+        }
+    }
+
+    const nlohmann::json root = { { "version", kCacheVersion }, { "clips", std::move(clips) } };
+    const std::vector<uint8_t> bytes = nlohmann::json::to_msgpack(root);
+    const std::string tempPath = m_cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            LogToFile("[ClipIndexer::saveCache] Cannot write " + tempPath);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, m_cachePath, ec);
+    if (ec) {
+        LogToFile("[ClipIndexer::saveCache] Cannot replace " + m_cachePath + ": " + ec.message());
+        return;
+    }
+    LOG_DEBUG("[ClipIndexer::saveCache] Wrote " + std::to_string(bytes.size()) + " bytes to " + m_cachePath);
+}
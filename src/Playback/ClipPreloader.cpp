@@ -0,0 +1,96 @@
+#include "Playback/ClipPreloader.h"
+#include "Utils/DebugLog.h"
+#include "Utils/FrameTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+ClipPreloader::ClipPreloader(size_t prerollFrames)
+    : m_prerollFrames(prerollFrames) {
+}
+
+ClipPreloader::~ClipPreloader() {
+    cancel();
+}
+
+void ClipPreloader::request(const std::string& path) {
+    if (path.empty() || path == m_requestedPath) {
+        return;
+    }
+    cancel();
+    m_requestedPath = path;
+    m_cancel.store(false, std::memory_order_relaxed);
+    LogToFile(std::string("[ClipPreloader::request] Preparing '") + fs::path(path).filename().string() + "'");
+    m_worker = std::thread(&ClipPreloader::prepare, this, path);
+}
+
+std::unique_ptr<PreparedClip> ClipPreloader::take(const std::string& path) {
+    if (path.empty() || path != m_requestedPath) {
+        cancel();
+        return nullptr;
+    }
+    const auto waitStart = std::chrono::steady_clock::now();
+    if (m_worker.joinable()) m_worker.join();
+    LogToFile(std::string("[ClipPreloader::take] '") + fs::path(path).filename().string() + "' " + (m_prepared ? "ready" : "failed") +
+        ", waited " + std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count()) + " ms");
+    m_requestedPath.clear();
+    return std::move(m_prepared);
+}
+
+void ClipPreloader::cancel() {
+    m_cancel.store(true, std::memory_order_relaxed);
+    if (m_worker.joinable()) m_worker.join();
+    m_prepared.reset();
+    m_requestedPath.clear();
+}
+
+void ClipPreloader::prepare(std::string path) {
+    FrameTrace::setThreadName("Preload");
+    FrameTrace::Scope scope("clip preload");
+    auto clip = std::make_unique<PreparedClip>();
+    clip->path = path;
+    try {
+        clip->decoder = std::make_unique<DecoderWrapper>(path);
+        clip->audioLoader = clip->decoder->makeFreshAudioLoader();
+
+        const motioncam::Decoder& decoder = *clip->decoder->getDecoder();
+        const std::vector<motioncam::Timestamp>& frames = decoder.getFrames();
+        const size_t prerollCount = std::min(m_prerollFrames, frames.size());
+        clip->prerollPackets.reserve(prerollCount);
+        for (size_t i = 0; i < prerollCount; ++i) {
+            if (m_cancel.load(std::memory_order_relaxed)) {
+                LogToFile(std::string("[ClipPreloader::prepare] Cancelled '") + fs::path(path).filename().string() + "'");
+                return;
+            }
+            CompressedFramePacket packet;
+            packet.timestamp = frames[i];
+            packet.frameIndex = i;
+            const auto readStart = FrameTrace::Clock::now();
+            if (!decoder.getRawFramePayloads(frames[i], packet.compressedPayload, packet.metadataPayload, packet.width, packet.height, packet.compressionType)) {
+                break;
+            }
+            FrameTrace::recordSpan("preroll read", readStart, FrameTrace::Clock::now(), static_cast<int64_t>(i));
+            clip->prerollPackets.push_back(std::move(packet));
+        }
+
+        if (!clip->prerollPackets.empty()) {
+            const std::vector<uint8_t>& firstMetadata = clip->prerollPackets.front().metadataPayload;
+            clip->firstFrameMetadata = nlohmann::json::parse(firstMetadata.begin(), firstMetadata.end());
+        }
+        else if (!frames.empty()) {
+            clip->firstFrameMetadata["timestamp"] = frames.front();
+        }
+    }
+    catch (const std::exception& e) {
+        LogToFile(std::string("[ClipPreloader::prepare] Failed to prepare '") + fs::path(path).filename().string() + "': " + e.what());
+        return;
+    }
+
+    LogToFile(std::string("[ClipPreloader::prepare] '") + fs::path(path).filename().string() + "' ready with " + std::to_string(clip->prerollPackets.size()) + " pre-rolled frames");
+    m_prepared = std::move(clip);
+}
@@ -0,0 +1,73 @@
+#include "Playback/DisplaySchedule.h"
+
+#include <algorithm>
+
+namespace DisplaySchedule {
+
+int64_t frameIntervalNs(const std::vector<int64_t>& timestamps) {
+    if (timestamps.size() < 2 || timestamps.back() <= timestamps.front()) {
+        return 0;
+    }
+    return (timestamps.back() - timestamps.front()) / static_cast<int64_t>(timestamps.size() - 1);
+}
+
+int64_t displayIntervalNs(int64_t frameIntervalNs, double displayFps) {
+    if (frameIntervalNs <= 0 || displayFps < 1.0) {
+        return 0;
+    }
+    const double intervalNs = 1e9 / displayFps;
+    return intervalNs >= kMinRateRatio * static_cast<double>(frameIntervalNs) ? static_cast<int64_t>(intervalNs) : 0;
+}
+
+double frameStride(int64_t frameIntervalNs, int64_t displayIntervalNs) {
+    if (frameIntervalNs <= 0 || displayIntervalNs <= 0) {
+        return 1.0;
+    }
+    return std::max(1.0, static_cast<double>(displayIntervalNs) / static_cast<double>(frameIntervalNs));
+}
+
+Cursor start(const std::vector<int64_t>& timestamps, size_t index) {
+    Cursor cursor;
+    cursor.index = std::min(index, timestamps.size());
+    if (cursor.index >= timestamps.size()) {
+        cursor.mediaTimeNs = timestamps.empty() ? 0 : timestamps.back();
+    }
+    else if (cursor.index + 1 < timestamps.size()) {
+        // Halfway through the frame's time on screen, so jitter in the timestamps does not
+        // move later refreshes onto a neighbouring frame.
+        cursor.mediaTimeNs = timestamps[cursor.index] + (timestamps[cursor.index + 1] - timestamps[cursor.index]) / 2;
+    }
+    else {
+        cursor.mediaTimeNs = timestamps[cursor.index];
+    }
+    return cursor;
+}
+
+Cursor next(const std::vector<int64_t>& timestamps, const Cursor& cursor, int64_t displayIntervalNs) {
+    Cursor result;
+    result.index = cursor.index + 1;
+    if (result.index >= timestamps.size()) {
+        result.index = timestamps.size();
+        result.mediaTimeNs = cursor.mediaTimeNs + std::max<int64_t>(displayIntervalNs, 0);
+        return result;
+    }
+    if (displayIntervalNs <= 0) {
+        result.mediaTimeNs = timestamps[result.index];
+        return result;
+    }
+
+    // The schedule advances by whole refreshes, not from the frame picked last time, so
+    // refreshes falling between frames do not accumulate into drift.
+    result.mediaTimeNs = cursor.mediaTimeNs + displayIntervalNs;
+    const auto after = std::upper_bound(timestamps.begin() + static_cast<std::ptrdiff_t>(result.index), timestamps.end(), result.mediaTimeNs);
+    if (after != timestamps.begin() + static_cast<std::ptrdiff_t>(result.index)) {
+        result.index = static_cast<size_t>(std::distance(timestamps.begin(), after)) - 1;
+    }
+    else {
+        // Not even the next frame is due yet: a gap in the schedule, read the next frame anyway.
+        result.mediaTimeNs = timestamps[result.index];
+    }
+    return result;
+}
+
+} // namespace DisplaySchedule
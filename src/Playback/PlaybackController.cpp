@@ -8,7 +8,7 @@
 #include <nlohmann/json.hpp>
 #include <sstream> // For std::ostringstream in logging
 
-double PlaybackController::s_displayFps = 0.0;
+std::atomic<double> PlaybackController::s_displayFps{ 0.0 };
 
 PlaybackController::PlaybackController() : m_isPaused(false) {
     m_fpsAvgStart = std::chrono::steady_clock::now();
@@ -88,7 +88,7 @@ bool PlaybackController::updatePlayhead(
     m_framesForAvg++;
     double elapsedSecondsForFps = std::chrono::duration<double>(frameEndTimeForFps - m_fpsAvgStart).count();
     if (elapsedSecondsForFps >= 1.0) {
-        s_displayFps = static_cast<double>(m_framesForAvg) / elapsedSecondsForFps;
+        s_displayFps.store(static_cast<double>(m_framesForAvg) / elapsedSecondsForFps, std::memory_order_relaxed);
         m_fpsAvgStart = frameEndTimeForFps;
         m_framesForAvg = 0;
     }
@@ -152,7 +152,7 @@ bool PlaybackController::updatePlayhead(
             << ", NewIdx: " << newFrameIdx
             << (mediaFrameTimestamps.empty() || newFrameIdx >= mediaFrameTimestamps.size() ? std::string(", NewIdx MediaTS: OOB or Empty") : std::string(", NewIdx MediaTS: ") + std::to_string(mediaFrameTimestamps[newFrameIdx]))
             << ", SegmentEnded: " << (segmentEnded ? "T" : "F");
-        LogToFile(log_oss_idx.str());
+        LOG_TRACE(log_oss_idx.str());
     }
     m_currentFrameIdx = newFrameIdx;
 
@@ -234,7 +234,7 @@ void PlaybackController::seekToFrame(
     if (!m_firstFrameMediaTimestampNs_currentSegment.has_value()) {
         // This case should ideally be handled by ensuring processNewSegment always sets it if frames exist.
         // If it happens, it's a sign of inconsistent state.
-        LogToFile(log_oss_seek.str() + " | CRITICAL WARNING: FirstFrameMediaTS for segment is NOT SET during seekToFrame. Attempting fallback.");
+        LOG_WARN(log_oss_seek.str() + " | CRITICAL WARNING: FirstFrameMediaTS for segment is NOT SET during seekToFrame. Attempting fallback.");
         if (!mediaFrameTimestamps.empty()) {
             // Attempt to recover, but this indicates a logic flow issue elsewhere
             m_firstFrameMediaTimestampNs_currentSegment = mediaFrameTimestamps.front();
@@ -264,7 +264,7 @@ void PlaybackController::seekToFrame(
         << ", DeltaVideoNsFromSegStart: " << deltaVideoNsFromSegmentStart
         << ", NowEpochNs for anchor: " << now_for_anchor.time_since_epoch().count()
         << ", New WallClockAnchorEpochNs: " << m_segmentWallClockStartTime.time_since_epoch().count();
-    LogToFile(log_oss_seek.str());
+    LOG_DEBUG(log_oss_seek.str());
 }
 
 
@@ -311,5 +311,5 @@ void PlaybackController::setWallClockAnchorForSegment(std::chrono::steady_clock:
 }
 
 double PlaybackController::getDisplayFps() {
-    return s_displayFps;
+    return s_displayFps.load(std::memory_order_relaxed);
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "Playback/ProxyGenerator.h"
+#include "Utils/DebugLog.h"
+
+#include <motioncam/Decoder.hpp>
+#include <motioncam/Proxy.hpp>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+// Frames wider than this are binned 4x4 rather than 2x2, so the proxy stays small enough
+// to play in realtime.
+constexpr int kWideFrameWidth = 5000;
+
+// Proxy generation must never take decode time from playback.
+void lowerThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+    setpriority(PRIO_PROCESS, 0, 10); // Linux applies this to the calling thread only
+#endif
+}
+
+int binningFor(const std::string& path) {
+    const motioncam::Decoder decoder(path);
+    if (decoder.getFrames().empty()) {
+        return 2;
+    }
+    std::vector<motioncam::FrameBlockMetadata> first;
+    decoder.getBlockMetadata({ decoder.getFrames().front() }, first);
+    return first[0].valid && first[0].width > kWideFrameWidth ? 4 : 2;
+}
+}
+
+ProxyGenerator::ProxyGenerator(unsigned numThreads)
+    : m_numThreads(numThreads != 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency() / 4)) {
+}
+
+ProxyGenerator::~ProxyGenerator() {
+    cancel();
+}
+
+void ProxyGenerator::generate(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (path.empty() || (path == m_status.clipPath && m_status.state != ProxyStatus::State::Idle)) {
+            return;
+        }
+    }
+    cancel();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_status = ProxyStatus();
+        m_status.clipPath = path;
+    }
+    // Writing the proxy of a remote clip would download all of it.
+    if (motioncam::isRemoteLocation(path)) {
+        LOG_DEBUG("[ProxyGenerator::generate] Skipping remote clip " + path);
+        return;
+    }
+    m_cancel.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_status.state = ProxyStatus::State::Generating;
+    }
+    m_worker = std::thread(&ProxyGenerator::run, this, path);
+}
+
+void ProxyGenerator::cancel() {
+    m_cancel.store(true, std::memory_order_relaxed);
+    if (m_worker.joinable()) m_worker.join();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_status.state == ProxyStatus::State::Generating) {
+        m_status.state = ProxyStatus::State::Idle; // Generating the same clip again starts over
+    }
+}
+
+ProxyStatus ProxyGenerator::status() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_status;
+}
+
+void ProxyGenerator::run(std::string path) {
+    lowerThreadPriority();
+    const auto start = std::chrono::steady_clock::now();
+    const std::string fileName = fs::path(path).filename().string();
+    const std::string proxyPath = motioncam::ProxyPath(path);
+
+    motioncam::ProxyOptions options;
+    options.threads = m_numThreads;
+    options.threadStarted = lowerThreadPriority;
+    options.progress = [this](size_t framesDone, size_t frameCount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_status.framesDone = framesDone;
+        m_status.frameCount = frameCount;
+        return !m_cancel.load(std::memory_order_relaxed);
+    };
+
+    motioncam::ProxyStats stats;
+    try {
+        options.binning = binningFor(path);
+        stats = motioncam::WriteProxy(path, proxyPath, options);
+    }
+    catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_cancel.load(std::memory_order_relaxed)) {
+            LOG_DEBUG("[ProxyGenerator] Stopped writing the proxy of '" + fileName + "'.");
+            return;
+        }
+        m_status.state = ProxyStatus::State::Failed;
+        LogToFile("[ProxyGenerator] Cannot write the proxy of '" + fileName + "': " + e.what());
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_status.proxyPath = proxyPath;
+        m_status.framesDone = stats.frames;
+        m_status.frameCount = stats.frames;
+        m_status.state = ProxyStatus::State::Ready;
+    }
+    const double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LogToFile("[ProxyGenerator] '" + fileName + "': " + std::to_string(stats.frames) + " frames at " +
+        std::to_string(stats.width) + "x" + std::to_string(stats.height) + " (binning " + std::to_string(options.binning) +
+        ") in " + std::to_string(elapsedSec) + " s.");
+}
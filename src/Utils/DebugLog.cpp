@@ -1,36 +1,379 @@
 #include "Utils/DebugLog.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
 #include <fstream>
-#include <iomanip>
-#include <sstream>
-#include <mutex> // For thread-safe logging
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
-static std::mutex g_log_mutex; // Mutex to protect file access
+namespace {
 
-void LogToFile(const std::string& message) {
-    std::lock_guard<std::mutex> lock(g_log_mutex); // Lock for thread safety
+// Per-thread ring size. At the writer's 20 ms drain interval a thread has to log more than
+// 50k messages per second before anything is dropped.
+constexpr uint64_t kRingCapacity = 1024;
+constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+// Non-error output reaches the disk at most this late.
+constexpr auto kFlushInterval = std::chrono::milliseconds(500);
 
-    static std::ofstream log_file("motioncam_player_log.txt", std::ios_base::app | std::ios_base::out);
+struct LogRecord {
+    int64_t wallTimeNs = 0;
+    LogLevel level = LogLevel::Info;
+    std::string text;
+};
 
-    if (log_file.is_open()) {
-        auto now = std::chrono::system_clock::now();
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-        std::time_t time_now = std::chrono::system_clock::to_time_t(now);
+// Single-producer (the owning thread) / single-consumer (the writer) ring.
+struct ThreadRing {
+    std::array<LogRecord, kRingCapacity> slots;
+    alignas(64) std::atomic<uint64_t> head{ 0 };
+    alignas(64) std::atomic<uint64_t> tail{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<bool> orphaned{ false };
+};
 
-        std::tm timeinfo{};
+// Marks the ring for removal once drained when its thread exits. The registry holds the other
+// reference, so messages logged just before exit are still written.
+struct ThreadRingHandle {
+    std::shared_ptr<ThreadRing> ring;
+    ~ThreadRingHandle() {
+        if (ring) ring->orphaned.store(true, std::memory_order_release);
+    }
+};
+
+thread_local ThreadRingHandle t_ringHandle;
+
+int64_t wallClockNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+LogLevel parseLogLevel(const char* value, LogLevel fallback) {
+    if (!value) return fallback;
+    const std::string s(value);
+    if (s == "trace") return LogLevel::Trace;
+    if (s == "debug") return LogLevel::Debug;
+    if (s == "info") return LogLevel::Info;
+    if (s == "warn") return LogLevel::Warn;
+    if (s == "error") return LogLevel::Error;
+    return fallback;
+}
+
+// localtime and strftime only run when the second changes.
+struct TimestampCache {
+    int64_t second = -1;
+    char text[32] = {};
+};
+
+const char* levelTag(LogLevel level) {
+    switch (level) {
+    case LogLevel::Trace: return "[TRACE] ";
+    case LogLevel::Debug: return "[DEBUG] ";
+    case LogLevel::Warn: return "[WARN] ";
+    case LogLevel::Error: return "[ERROR] ";
+    default: return "";
+    }
+}
+
+class AsyncLogger {
+public:
+    static AsyncLogger& instance() {
+        // Never destroyed: threads may still log while statics are torn down. The atexit
+        // handler drains and joins the writer instead.
+        static AsyncLogger* logger = [] {
+            auto* created = new AsyncLogger();
+            std::atexit([] { AsyncLogger::instance().shutdown(); });
+            return created;
+        }();
+        return *logger;
+    }
+
+    bool accepts(LogLevel level) const {
+        return static_cast<int>(level) >= m_minLevel.load(std::memory_order_relaxed);
+    }
+
+    void setMinLevel(LogLevel level) {
+        m_minLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    LogLevel minLevel() const {
+        return static_cast<LogLevel>(m_minLevel.load(std::memory_order_relaxed));
+    }
+
+    void enqueue(LogLevel level, std::string&& text) {
+        const int64_t nowNs = wallClockNowNs();
+        if (!m_running.load(std::memory_order_acquire)) {
+            writeSynchronously(nowNs, level, text);
+            return;
+        }
+
+        ThreadRing& ring = ringForThisThread();
+        const uint64_t head = ring.head.load(std::memory_order_relaxed);
+        const uint64_t used = head - ring.tail.load(std::memory_order_acquire);
+        if (used >= kRingCapacity) {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        LogRecord& slot = ring.slots[head % kRingCapacity];
+        slot.wallTimeNs = nowNs;
+        slot.level = level;
+        slot.text = std::move(text);
+        ring.head.store(head + 1, std::memory_order_release);
+
+        if (level == LogLevel::Error) {
+            m_flushRequested.fetch_add(1, std::memory_order_acq_rel);
+            wakeWriter();
+        }
+        else if (used + 1 >= kRingCapacity / 2) {
+            wakeWriter();
+        }
+    }
+
+    void flush() {
+        if (!m_running.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(m_fileMutex);
+            m_file.flush();
+            return;
+        }
+        const uint64_t ticket = m_flushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+        wakeWriter();
+        std::unique_lock<std::mutex> lock(m_flushMutex);
+        m_flushCv.wait(lock, [&] {
+            return m_flushCompleted >= ticket || !m_running.load(std::memory_order_acquire);
+        });
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> shutdownLock(m_shutdownMutex);
+        if (!m_running.exchange(false, std::memory_order_acq_rel)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_wakeRequested = true;
+        }
+        m_wakeCv.notify_one();
+        if (m_writer.joinable()) {
+            m_writer.join();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_flushMutex);
+            m_flushCompleted = m_flushRequested.load(std::memory_order_acquire);
+        }
+        m_flushCv.notify_all();
+    }
+
+private:
+    AsyncLogger()
+        : m_file("motioncam_player_log.txt", std::ios_base::app | std::ios_base::out) {
+        m_minLevel.store(static_cast<int>(parseLogLevel(std::getenv("MOTIONCAM_LOG_LEVEL"), LogLevel::Info)),
+            std::memory_order_relaxed);
+        m_running.store(true, std::memory_order_release);
+        m_writer = std::thread([this] { writerLoop(); });
+    }
+
+    ThreadRing& ringForThisThread() {
+        if (!t_ringHandle.ring) {
+            auto ring = std::make_shared<ThreadRing>();
+            {
+                std::lock_guard<std::mutex> lock(m_ringsMutex);
+                m_rings.push_back(ring);
+            }
+            t_ringHandle.ring = std::move(ring);
+        }
+        return *t_ringHandle.ring;
+    }
+
+    void wakeWriter() {
+        if (m_wakePending.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_wakeRequested = true;
+        }
+        m_wakeCv.notify_one();
+    }
+
+    void writerLoop() {
+        std::vector<LogRecord> batch;
+        std::string buffer;
+        TimestampCache timestamps;
+        auto lastFlush = std::chrono::steady_clock::now();
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wakeCv.wait_for(lock, kDrainInterval, [&] { return m_wakeRequested; });
+                m_wakeRequested = false;
+            }
+            m_wakePending.store(false, std::memory_order_release);
+
+            const bool stopping = !m_running.load(std::memory_order_acquire);
+            // Read before draining so every message enqueued ahead of the request is covered.
+            const uint64_t flushTarget = m_flushRequested.load(std::memory_order_acquire);
+
+            batch.clear();
+            uint64_t dropped = drainRings(batch);
+            // Rings are drained one after another; restore cross-thread order within the batch.
+            std::stable_sort(batch.begin(), batch.end(),
+                [](const LogRecord& a, const LogRecord& b) { return a.wallTimeNs < b.wallTimeNs; });
+
+            buffer.clear();
+            for (const LogRecord& record : batch) {
+                appendFormatted(buffer, timestamps, record.wallTimeNs, record.level, record.text);
+            }
+            if (dropped > 0) {
+                appendFormatted(buffer, timestamps, wallClockNowNs(), LogLevel::Warn,
+                    "[DebugLog] Dropped " + std::to_string(dropped) + " messages from full thread rings.");
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(m_fileMutex);
+                if (!buffer.empty() && m_file.is_open()) {
+                    m_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                }
+                const bool flushDue = flushTarget != m_flushCompletedByWriter || stopping ||
+                    (!buffer.empty() && now - lastFlush >= kFlushInterval);
+                if (flushDue) {
+                    m_file.flush();
+                    lastFlush = now;
+                }
+            }
+
+            if (flushTarget != m_flushCompletedByWriter) {
+                m_flushCompletedByWriter = flushTarget;
+                {
+                    std::lock_guard<std::mutex> lock(m_flushMutex);
+                    m_flushCompleted = flushTarget;
+                }
+                m_flushCv.notify_all();
+            }
+
+            if (stopping) {
+                break;
+            }
+        }
+    }
+
+    uint64_t drainRings(std::vector<LogRecord>& out) {
+        uint64_t dropped = 0;
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        for (auto it = m_rings.begin(); it != m_rings.end();) {
+            ThreadRing& ring = **it;
+            // Checked before draining: a set flag means the owner will not push again.
+            const bool orphaned = ring.orphaned.load(std::memory_order_acquire);
+            const uint64_t head = ring.head.load(std::memory_order_acquire);
+            uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+            for (; tail != head; ++tail) {
+                out.push_back(std::move(ring.slots[tail % kRingCapacity]));
+            }
+            ring.tail.store(tail, std::memory_order_release);
+            dropped += ring.dropped.exchange(0, std::memory_order_relaxed);
+
+            if (orphaned) {
+                it = m_rings.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        return dropped;
+    }
+
+    // "[YYYY-mm-dd HH:MM:SS.mmm] [LEVEL] message\n"; Info lines carry no level tag, as before.
+    static void appendFormatted(std::string& out, TimestampCache& cache, int64_t wallTimeNs, LogLevel level, const std::string& text) {
+        const int64_t seconds = wallTimeNs / 1000000000;
+        const int millis = static_cast<int>((wallTimeNs / 1000000) % 1000);
+        if (seconds != cache.second) {
+            std::time_t timeNow = static_cast<std::time_t>(seconds);
+            std::tm timeinfo{};
 #ifdef _WIN32
-        localtime_s(&timeinfo, &time_now);
+            localtime_s(&timeinfo, &timeNow);
 #else
-        localtime_r(&time_now, &timeinfo);
+            localtime_r(&timeNow, &timeinfo);
 #endif
+            std::strftime(cache.text, sizeof(cache.text), "%Y-%m-%d %H:%M:%S", &timeinfo);
+            cache.second = seconds;
+        }
+        char millisText[8];
+        std::snprintf(millisText, sizeof(millisText), ".%03d", millis);
 
-        std::ostringstream oss;
-        oss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
-        oss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+        out += '[';
+        out += cache.text;
+        out += millisText;
+        out += "] ";
+        out += levelTag(level);
+        out += text;
+        out += '\n';
+    }
+
+    void writeSynchronously(int64_t wallTimeNs, LogLevel level, const std::string& text) {
+        std::lock_guard<std::mutex> lock(m_fileMutex);
+        if (!m_file.is_open()) return;
+        std::string line;
+        TimestampCache cache;
+        appendFormatted(line, cache, wallTimeNs, level, text);
+        m_file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        m_file.flush();
+    }
+
+    std::atomic<int> m_minLevel{ static_cast<int>(LogLevel::Info) };
+    std::atomic<bool> m_running{ false };
+
+    std::mutex m_ringsMutex;
+    std::vector<std::shared_ptr<ThreadRing>> m_rings;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    bool m_wakeRequested = false;
+    std::atomic<bool> m_wakePending{ false };
+
+    std::atomic<uint64_t> m_flushRequested{ 0 };
+    uint64_t m_flushCompletedByWriter = 0; // Writer thread only
+    std::mutex m_flushMutex;
+    std::condition_variable m_flushCv;
+    uint64_t m_flushCompleted = 0;
 
-        log_file << "[" << oss.str() << "] " << message << std::endl;
-        // log_file.flush(); // Optional: flush immediately, impacts performance
+    // The writer owns the file while running; afterwards writes are synchronous under this lock.
+    std::mutex m_fileMutex;
+    std::ofstream m_file;
+
+    std::mutex m_shutdownMutex;
+    std::thread m_writer;
+};
+
+} // namespace
+
+void LogMessage(LogLevel level, std::string message) {
+    AsyncLogger& logger = AsyncLogger::instance();
+    if (!logger.accepts(level)) {
+        return;
     }
-}
\ No newline at end of file
+    logger.enqueue(level, std::move(message));
+}
+
+void SetLogLevel(LogLevel level) {
+    AsyncLogger::instance().setMinLevel(level);
+}
+
+LogLevel GetLogLevel() {
+    return AsyncLogger::instance().minLevel();
+}
+
+void FlushLog() {
+    AsyncLogger::instance().flush();
+}
+
+void ShutdownLog() {
+    AsyncLogger::instance().shutdown();
+}
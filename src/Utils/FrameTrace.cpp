@@ -0,0 +1,249 @@
+#include "Utils/FrameTrace.h"
+#include "Utils/DebugLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace FrameTrace {
+namespace {
+
+// Most recent events kept per thread; at ~10 events per displayed frame this is well over
+// half a minute of playback on the render thread.
+constexpr uint64_t kRingCapacity = 1u << 14;
+constexpr int64_t kInstant = -1;
+
+// Seqlock-protected so a dump can read while the owning thread overwrites older entries.
+struct TraceSlot {
+    std::atomic<uint32_t> seq{ 0 };
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<uint32_t> tid{ 0 };
+    std::atomic<int64_t> beginNs{ 0 };
+    std::atomic<int64_t> durationNs{ 0 };
+    std::atomic<int64_t> frameIndex{ kNoFrame };
+    std::atomic<uint64_t> loadId{ 0 };
+};
+
+// Rings outlive their threads: IO and decode threads are relaunched on every file load, and a
+// new thread takes over a retired ring instead of allocating another. Slots carry the tid of
+// the thread that wrote them, so older events keep their attribution.
+struct ThreadRing {
+    std::unique_ptr<TraceSlot[]> slots{ new TraceSlot[kRingCapacity] };
+    std::atomic<uint64_t> count{ 0 };
+    std::atomic<bool> inUse{ false };
+};
+
+struct TraceEvent {
+    const char* name;
+    uint32_t tid;
+    int64_t beginNs;
+    int64_t durationNs;
+    int64_t frameIndex;
+    uint64_t loadId;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    std::vector<std::pair<uint32_t, const char*>> threadNames;
+    std::atomic<uint32_t> nextTid{ 1 };
+    const Clock::time_point epoch = Clock::now();
+    const bool enabled = [] {
+        const char* env = std::getenv("MOTIONCAM_TRACE");
+        return !(env && std::string(env) == "0");
+    }();
+};
+
+Registry& registry() {
+    // Leaked so threads still recording during static destruction stay safe.
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+struct ThreadState {
+    std::shared_ptr<ThreadRing> ring;
+    uint32_t tid = 0;
+    ~ThreadState() {
+        if (ring) ring->inUse.store(false, std::memory_order_release);
+    }
+};
+
+thread_local ThreadState t_state;
+
+ThreadState& threadState() {
+    if (!t_state.ring) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto& ring : reg.rings) {
+            bool expected = false;
+            if (ring->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                t_state.ring = ring;
+                break;
+            }
+        }
+        if (!t_state.ring) {
+            auto ring = std::make_shared<ThreadRing>();
+            ring->inUse.store(true, std::memory_order_relaxed);
+            reg.rings.push_back(ring);
+            t_state.ring = std::move(ring);
+        }
+        t_state.tid = reg.nextTid.fetch_add(1, std::memory_order_relaxed);
+    }
+    return t_state;
+}
+
+void record(const char* name, int64_t beginNs, int64_t durationNs, int64_t frameIndex, uint64_t loadId) {
+    ThreadState& state = threadState();
+    ThreadRing& ring = *state.ring;
+    const uint64_t index = ring.count.load(std::memory_order_relaxed);
+    TraceSlot& slot = ring.slots[index & (kRingCapacity - 1)];
+
+    const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.tid.store(state.tid, std::memory_order_relaxed);
+    slot.beginNs.store(beginNs, std::memory_order_relaxed);
+    slot.durationNs.store(durationNs, std::memory_order_relaxed);
+    slot.frameIndex.store(frameIndex, std::memory_order_relaxed);
+    slot.loadId.store(loadId, std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+    ring.count.store(index + 1, std::memory_order_release);
+}
+
+int64_t sinceEpochNs(Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t - registry().epoch).count();
+}
+
+// Skips slots being rewritten while we read them.
+bool readSlot(const TraceSlot& slot, TraceEvent& out) {
+    const uint32_t before = slot.seq.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1u) != 0) {
+        return false;
+    }
+    out.name = slot.name.load(std::memory_order_relaxed);
+    out.tid = slot.tid.load(std::memory_order_relaxed);
+    out.beginNs = slot.beginNs.load(std::memory_order_relaxed);
+    out.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+    out.frameIndex = slot.frameIndex.load(std::memory_order_relaxed);
+    out.loadId = slot.loadId.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == before && out.name != nullptr;
+}
+
+} // namespace
+
+bool isEnabled() {
+    return registry().enabled;
+}
+
+void setThreadName(const char* name) {
+    if (!isEnabled()) return;
+    const uint32_t tid = threadState().tid;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.threadNames.emplace_back(tid, name);
+}
+
+void recordSpan(const char* name, Clock::time_point begin, Clock::time_point end, int64_t frameIndex, uint64_t loadId) {
+    if (!isEnabled()) return;
+    record(name, sinceEpochNs(begin), std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()), frameIndex, loadId);
+}
+
+void recordInstant(const char* name, int64_t frameIndex, uint64_t loadId) {
+    if (!isEnabled()) return;
+    record(name, sinceEpochNs(Clock::now()), kInstant, frameIndex, loadId);
+}
+
+bool writeChromeTrace(const std::string& path) {
+    Registry& reg = registry();
+    std::vector<TraceEvent> events;
+    std::vector<std::pair<uint32_t, const char*>> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        threadNames = reg.threadNames;
+        for (const auto& ring : reg.rings) {
+            const uint64_t count = ring->count.load(std::memory_order_acquire);
+            const uint64_t first = count > kRingCapacity ? count - kRingCapacity : 0;
+            for (uint64_t i = first; i < count; ++i) {
+                TraceEvent event;
+                if (readSlot(ring->slots[i & (kRingCapacity - 1)], event)) {
+                    events.push_back(event);
+                }
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.beginNs < b.beginNs; });
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LogToFile("[FrameTrace::writeChromeTrace] Cannot open " + path + " for writing.");
+        return false;
+    }
+
+    char line[512];
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& [tid, name] : threadNames) {
+        std::snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n", tid, name);
+        out << line;
+        first = false;
+    }
+    for (const TraceEvent& e : events) {
+        int written;
+        if (e.durationNs == kInstant) {
+            written = std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+                first ? "" : ",\n", e.name, e.beginNs / 1000.0, e.tid);
+        }
+        else {
+            written = std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u",
+                first ? "" : ",\n", e.name, e.beginNs / 1000.0, e.durationNs / 1000.0, e.tid);
+        }
+        if (written > 0 && static_cast<size_t>(written) < sizeof(line) && e.frameIndex != kNoFrame) {
+            std::snprintf(line + written, sizeof(line) - written, ",\"args\":{\"frame\":%lld,\"loadId\":%llu}",
+                static_cast<long long>(e.frameIndex), static_cast<unsigned long long>(e.loadId));
+        }
+        out << line << '}';
+        first = false;
+    }
+    out << "\n]}\n";
+    out.close();
+
+    if (!out) {
+        LogToFile("[FrameTrace::writeChromeTrace] Write to " + path + " failed.");
+        return false;
+    }
+    LogToFile("[FrameTrace::writeChromeTrace] Wrote " + std::to_string(events.size()) + " events to " + path);
+    return true;
+}
+
+std::string defaultTracePath() {
+    std::time_t now = std::time(nullptr);
+    std::tm timeinfo{};
+#ifdef _WIN32
+    localtime_s(&timeinfo, &now);
+#else
+    localtime_r(&now, &timeinfo);
+#endif
+    char name[64];
+    std::strftime(name, sizeof(name), "motioncam_trace_%Y%m%d_%H%M%S.json", &timeinfo);
+    return name;
+}
+
+std::optional<std::string> exitTracePath() {
+    const char* env = std::getenv("MOTIONCAM_TRACE_FILE");
+    if (!env || *env == '\0') {
+        return std::nullopt;
+    }
+    return std::string(env);
+}
+
+} // namespace FrameTrace
@@ -0,0 +1,179 @@
+#include "Utils/PipelineMetrics.h"
+#include "Utils/DebugLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+constexpr double kFirstBucketMs = 0.01;
+constexpr double kBucketsPerOctave = 8.0;
+
+size_t bucketFor(double ms) {
+    if (!(ms > kFirstBucketMs)) return 0;
+    const double index = std::ceil(std::log2(ms / kFirstBucketMs) * kBucketsPerOctave);
+    return static_cast<size_t>(std::min(index, static_cast<double>(PipelineMetrics::kHistogramBuckets - 1)));
+}
+}
+
+const char* PipelineMetrics::stageName(Stage stage) {
+    switch (stage) {
+    case Stage::IoRead: return "ioRead";
+    case Stage::StagingAcquire: return "stagingAcquire";
+    case Stage::Decode: return "decode";
+    case Stage::UploadSubmit: return "uploadSubmit";
+    case Stage::FenceWait: return "fenceWait";
+    case Stage::Upload: return "upload";
+    case Stage::Render: return "render";
+    case Stage::Present: return "present";
+    case Stage::AudioQueue: return "audioQueue";
+    default: return "unknown";
+    }
+}
+
+const char* PipelineMetrics::counterName(Counter counter) {
+    switch (counter) {
+    case Counter::FramesDisplayed: return "framesDisplayed";
+    case Counter::FramesDroppedStale: return "framesDroppedStale";
+    case Counter::FramesDroppedLate: return "framesDroppedLate";
+    case Counter::FramesSkippedLate: return "framesSkippedLate";
+    case Counter::FramesRepeated: return "framesRepeated";
+    case Counter::AudioUnderruns: return "audioUnderruns";
+    default: return "unknown";
+    }
+}
+
+const char* PipelineMetrics::queueName(Queue queue) {
+    switch (queue) {
+    case Queue::Decode: return "decodeQueue";
+    case Queue::GpuUpload: return "gpuUploadQueue";
+    case Queue::StagingSpans: return "stagingSpans";
+    case Queue::TransferSlots: return "transferSlots";
+    default: return "unknown";
+    }
+}
+
+double PipelineMetrics::bucketUpperBoundMs(size_t bucket) {
+    return kFirstBucketMs * std::exp2(static_cast<double>(bucket) / kBucketsPerOctave);
+}
+
+void PipelineMetrics::recordLatency(Stage stage, double ms) {
+    Histogram& h = m_histograms[static_cast<size_t>(stage)];
+    const uint64_t us = static_cast<uint64_t>(std::max(ms, 0.0) * 1000.0);
+    h.buckets[bucketFor(ms)].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.sumUs.fetch_add(us, std::memory_order_relaxed);
+    uint64_t previousMax = h.maxUs.load(std::memory_order_relaxed);
+    while (us > previousMax && !h.maxUs.compare_exchange_weak(previousMax, us, std::memory_order_relaxed)) {
+    }
+}
+
+void PipelineMetrics::sampleQueueDepth(Queue queue, size_t depth) {
+    DepthTrack& track = m_depths[static_cast<size_t>(queue)];
+    track.current = depth;
+    track.max = std::max(track.max, depth);
+    track.sum += static_cast<double>(depth);
+    ++track.samples;
+    track.history[track.next] = static_cast<float>(depth);
+    track.next = (track.next + 1) % kDepthHistory;
+}
+
+void PipelineMetrics::copyDepthHistory(Queue queue, std::array<float, kDepthHistory>& out) const {
+    const DepthTrack& track = m_depths[static_cast<size_t>(queue)];
+    for (size_t i = 0; i < kDepthHistory; ++i) {
+        out[i] = track.history[(track.next + i) % kDepthHistory];
+    }
+}
+
+double PipelineMetrics::percentileMs(const Histogram& histogram, double fraction) const {
+    const uint64_t count = histogram.count.load(std::memory_order_relaxed);
+    if (count == 0) return 0.0;
+    const uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kHistogramBuckets; ++i) {
+        seen += histogram.buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // Bucket upper bounds overestimate; never report more than the observed maximum.
+            return std::min(bucketUpperBoundMs(i), histogram.maxUs.load(std::memory_order_relaxed) / 1000.0);
+        }
+    }
+    return histogram.maxUs.load(std::memory_order_relaxed) / 1000.0;
+}
+
+PipelineMetrics::StageSummary PipelineMetrics::summarize(Stage stage) const {
+    const Histogram& h = m_histograms[static_cast<size_t>(stage)];
+    StageSummary summary;
+    summary.count = h.count.load(std::memory_order_relaxed);
+    if (summary.count == 0) return summary;
+    summary.meanMs = h.sumUs.load(std::memory_order_relaxed) / 1000.0 / static_cast<double>(summary.count);
+    summary.p50Ms = percentileMs(h, 0.50);
+    summary.p95Ms = percentileMs(h, 0.95);
+    summary.p99Ms = percentileMs(h, 0.99);
+    summary.maxMs = h.maxUs.load(std::memory_order_relaxed) / 1000.0;
+    return summary;
+}
+
+void PipelineMetrics::copyHistogram(Stage stage, std::array<float, kHistogramBuckets>& out) const {
+    const Histogram& h = m_histograms[static_cast<size_t>(stage)];
+    for (size_t i = 0; i < kHistogramBuckets; ++i) {
+        out[i] = static_cast<float>(h.buckets[i].load(std::memory_order_relaxed));
+    }
+}
+
+void PipelineMetrics::reset(const std::string& fileName) {
+    for (Histogram& h : m_histograms) {
+        for (auto& bucket : h.buckets) bucket.store(0, std::memory_order_relaxed);
+        h.count.store(0, std::memory_order_relaxed);
+        h.sumUs.store(0, std::memory_order_relaxed);
+        h.maxUs.store(0, std::memory_order_relaxed);
+    }
+    for (auto& c : m_counters) c.store(0, std::memory_order_relaxed);
+    for (DepthTrack& track : m_depths) track = DepthTrack{};
+    m_fileName = fileName;
+    m_startTime = std::chrono::steady_clock::now();
+}
+
+nlohmann::json PipelineMetrics::summaryJson() const {
+    nlohmann::json j;
+    j["file"] = m_fileName;
+    j["wallSeconds"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+
+    nlohmann::json counters = nlohmann::json::object();
+    for (size_t i = 0; i < static_cast<size_t>(Counter::Count); ++i) {
+        counters[counterName(static_cast<Counter>(i))] = m_counters[i].load(std::memory_order_relaxed);
+    }
+    j["counters"] = std::move(counters);
+
+    nlohmann::json stages = nlohmann::json::object();
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i) {
+        const StageSummary s = summarize(static_cast<Stage>(i));
+        if (s.count == 0) continue;
+        stages[stageName(static_cast<Stage>(i))] = {
+            { "count", s.count }, { "meanMs", s.meanMs }, { "p50Ms", s.p50Ms },
+            { "p95Ms", s.p95Ms }, { "p99Ms", s.p99Ms }, { "maxMs", s.maxMs } };
+    }
+    j["stages"] = std::move(stages);
+
+    nlohmann::json queues = nlohmann::json::object();
+    for (size_t i = 0; i < static_cast<size_t>(Queue::Count); ++i) {
+        const DepthTrack& track = m_depths[i];
+        if (track.samples == 0) continue;
+        queues[queueName(static_cast<Queue>(i))] = {
+            { "max", track.max }, { "mean", track.sum / static_cast<double>(track.samples) } };
+    }
+    j["queues"] = std::move(queues);
+    return j;
+}
+
+bool PipelineMetrics::appendSummary(const std::string& path) const {
+    if (counter(Counter::FramesDisplayed) == 0) {
+        return false;
+    }
+    std::ofstream out(path, std::ios::app);
+    if (!out) {
+        LogToFile("[PipelineMetrics::appendSummary] Cannot open " + path);
+        return false;
+    }
+    out << summaryJson().dump() << '\n';
+    return static_cast<bool>(out);
+}
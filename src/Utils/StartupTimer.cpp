@@ -0,0 +1,43 @@
+#include "Utils/StartupTimer.h"
+#include "Utils/DebugLog.h"
+#include "Utils/FrameTrace.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+double msBetween(StartupTimer::Clock::time_point a, StartupTimer::Clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+}
+
+void StartupTimer::mark(const char* phase) {
+    const Clock::time_point now = Clock::now();
+    m_phases.push_back({ phase, m_last, now, false });
+    FrameTrace::recordSpan(phase, m_last, now);
+    m_last = now;
+}
+
+void StartupTimer::addConcurrent(const char* phase, Clock::time_point begin, Clock::time_point end) {
+    m_phases.push_back({ phase, begin, end, true });
+    FrameTrace::recordSpan(phase, begin, end);
+}
+
+double StartupTimer::elapsedMs() const {
+    return msBetween(m_begin, Clock::now());
+}
+
+void StartupTimer::logSummary(const char* milestone) {
+    if (m_logged) return;
+    m_logged = true;
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "[Startup] %s after %.1f ms", milestone, elapsedMs());
+    LogToFile(line);
+    for (const Phase& phase : m_phases) {
+        std::snprintf(line, sizeof(line), "[Startup]   %-28s %8.1f ms  (at %8.1f ms%s)",
+            phase.name, msBetween(phase.begin, phase.end), msBetween(m_begin, phase.begin),
+            phase.concurrent ? ", concurrent" : "");
+        LogToFile(line);
+    }
+}
@@ -34,6 +34,8 @@
 #include <SDL.h>
 
 #include "App/App.h"
+#include "Decoder/DecoderWrapper.h"
+#include "Export/HeadlessExport.h"
 #include "Utils/DebugLog.h"
 #ifdef _WIN32
 #include "Utils/SingleInstanceGuard.h"
@@ -200,6 +202,20 @@ int main(int argc, char* argv[]) {
     // Determine and set the application base path.
     determineAppBasePath(argc > 0 ? argv[0] : "");
 
+    // Read backend for every decoder opened from here on, headless or not.
+    DecoderWrapper::configureByteSourceFromEnvironment();
+
+    // Headless modes never open a window and must not forward to a running instance.
+    if (HeadlessExport::isHeadlessInvocation(argc, argv)) {
+#ifdef _WIN32
+        // A stream to stdout is consumed by a pipe; re-opening CONOUT$ would break it.
+        if (!HeadlessExport::writesToStdout(argc, argv)) {
+            RedirectIOToConsole();
+        }
+#endif
+        LogToFile(std::string("[main] Headless mode: ") + argv[1]);
+        return HeadlessExport::run(argc, argv);
+    }
 
 #ifdef _WIN32
     static const wchar_t* kMutexName = L"MCRAW_PLAYER_SINGLE_INSTANCE_MUTEX_V2_UNIQUE";
@@ -272,7 +288,8 @@ int main(int argc, char* argv[]) {
         LogToFile(std::string("[main] Input file from dialog: ") + inPath);
     }
 
-    if (!fs::exists(inPath) || !fs::is_regular_file(inPath)) {
+    const bool remoteInput = motioncam::isRemoteLocation(inPath);
+    if (!remoteInput && (!fs::exists(inPath) || !fs::is_regular_file(inPath))) {
         std::string errorMsg = "[main] Input file not found or not a regular file: " + inPath;
         LogToFile(errorMsg);
 #ifdef _WIN32
@@ -281,7 +298,7 @@ int main(int argc, char* argv[]) {
         std::cerr << errorMsg << std::endl;
         return 1;
     }
-    if (fs::path(inPath).extension() != ".mcraw") {
+    if (!remoteInput && fs::path(inPath).extension() != ".mcraw") {
         std::string errorMsg = "[main] Input file must have a .mcraw extension: " + inPath;
         LogToFile(errorMsg);
 #ifdef _WIN32
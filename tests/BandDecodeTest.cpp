@@ -0,0 +1,101 @@
+// FILE: tests/BandDecodeTest.cpp
+//
+// Round-trips raw::Encode output through every banded decode path: both raw::DecodeRows
+// overloads (re-parsing the metadata per band, and from one raw::ParseFrameLayout) over bands
+// of several heights, and BandDecoder with one to three helper threads, with regular and
+// write-combined stores. Frame sizes are not multiples of the 64-sample block or of the 4-row
+// block row, so the padded right edge and a partial last row group are exercised.
+#include "Decoder/BandDecoder.h"
+
+#include <motioncam/RawData.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kSizes[][2] = { { 1, 1 }, { 8, 4 }, { 17, 9 }, { 64, 13 }, { 130, 61 }, { 200, 122 }, { 1001, 333 } };
+
+std::vector<uint16_t> makeFrame(int width, int height, uint32_t seed) {
+    std::vector<uint16_t> frame(static_cast<size_t>(width) * height);
+    uint32_t state = seed;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            state = state * 1664525u + 1013904223u;
+            // Smooth areas next to noisy ones, so neighbouring blocks get different widths.
+            const int v = ((x / 64 + y / 4) & 1) ? static_cast<int>(state >> 16) : 2048 + x + (static_cast<int>(state >> 28));
+            frame[static_cast<size_t>(y) * width + x] = static_cast<uint16_t>(v & 0xFFFF);
+        }
+    }
+    return frame;
+}
+
+int failures = 0;
+
+void report(bool ok, const std::string& what) {
+    if (!ok) {
+        std::printf("FAIL %s\n", what.c_str());
+        failures++;
+    }
+}
+
+} // namespace
+
+int main() {
+    const size_t sizeCount = sizeof(kSizes) / sizeof(kSizes[0]);
+    int checks = 0;
+
+    for (size_t s = 0; s < sizeCount; ++s) {
+        const int width = kSizes[s][0];
+        const int height = kSizes[s][1];
+        const std::string size = std::to_string(width) + "x" + std::to_string(height);
+        const std::vector<uint16_t> frame = makeFrame(width, height, 0xba4d0000u + static_cast<uint32_t>(s));
+        const size_t samples = frame.size();
+
+        std::vector<uint8_t> payload;
+        if (motioncam::raw::Encode(payload, frame.data(), width, height) == 0) {
+            report(false, size + ": Encode failed");
+            continue;
+        }
+
+        motioncam::raw::FrameLayout layout;
+        if (!motioncam::raw::ParseFrameLayout(width, height, payload.data(), payload.size(), layout)) {
+            report(false, size + ": ParseFrameLayout rejected the frame");
+            continue;
+        }
+
+        for (int bandRows : { 4, 8, 12, 32 }) {
+            std::vector<uint16_t> reparsed(samples, 0xFFFF);
+            std::vector<uint16_t> shared(samples, 0xFFFF);
+            size_t reparsedCount = 0;
+            size_t sharedCount = 0;
+            for (int row = 0; row < height; row += bandRows) {
+                reparsedCount += motioncam::raw::DecodeRows(reparsed.data(), width, height, payload.data(), payload.size(), row, bandRows);
+                sharedCount += motioncam::raw::DecodeRows(shared.data(), width, height, payload.data(), payload.size(), layout, row, bandRows);
+            }
+            const std::string bands = size + " in " + std::to_string(bandRows) + "-row bands";
+            report(reparsedCount == samples && reparsed == frame, "DecodeRows " + bands);
+            report(sharedCount == samples && shared == frame, "DecodeRows with FrameLayout " + bands);
+            checks += 2;
+        }
+
+        for (unsigned helpers = 1; helpers <= 3; ++helpers) {
+            BandDecoder decoder(helpers);
+            for (bool writeCombined : { false, true }) {
+                // Twice, so the second frame reuses the decoder's layout and helper threads.
+                for (int pass = 0; pass < 2; ++pass) {
+                    std::vector<uint16_t> out(samples, 0xFFFF);
+                    const size_t n = decoder.decode(out.data(), width, height, payload.data(), payload.size(), writeCombined);
+                    report(n == samples && out == frame, "BandDecoder " + size + " with " + std::to_string(helpers) + " helpers" +
+                        (writeCombined ? ", write-combined" : "") + ", pass " + std::to_string(pass));
+                    checks++;
+                }
+            }
+        }
+    }
+
+    std::printf("%s %d banded decodes of %zu frame sizes\n", failures == 0 ? "PASS" : "FAIL", checks, sizeCount);
+    return failures == 0 ? 0 : 1;
+}
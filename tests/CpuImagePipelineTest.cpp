@@ -0,0 +1,128 @@
+// FILE: tests/CpuImagePipelineTest.cpp
+//
+// Runs CpuImagePipeline::process on a small synthetic Bayer frame for every cfaType and demosaic
+// algorithm and compares the result against a direct scalar port of shaders/demosaic.comp +
+// shaders/image_process.frag.
+//
+// Tolerance: the pipeline evaluates the sRGB curve through a 16384-segment interpolated table in
+// single precision, the reference uses std::pow in double. The two agree to well under one 10-bit
+// code value; anything above kMaxSrgbError (16-bit units) is a real divergence in the math.
+#include "Export/CpuImagePipeline.h"
+#include "SyntheticFrame.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 37;  // Odd sizes exercise both mirrored borders on every CFA phase,
+constexpr int kHeight = 35; // and more than one 32-row band.
+constexpr int kMaxSrgbError = 16;
+
+// --- Reference: shaders/demosaic.comp and srgb_eotf from image_process.frag ---
+
+int mirrorCoord(int v, int size) {
+    v = std::abs(v);
+    return (v >= size) ? std::max(2 * size - 2 - v, 0) : v;
+}
+
+double clamp01(double v) { return std::min(std::max(v, 0.0), 1.0); }
+
+double srgbEotf(double v) {
+    v = clamp01(v);
+    return (v <= 0.0031308) ? v * 12.92 : 1.055 * std::pow(v, 1.0 / 2.4) - 0.055;
+}
+
+void referencePixel(const std::vector<uint16_t>& bayer, const CpuImagePipeline::Params& p,
+    int x, int y, double out[3])
+{
+    auto px = [&](int dx, int dy) {
+        const int sx = mirrorCoord(x + dx, kWidth);
+        const int sy = mirrorCoord(y + dy, kHeight);
+        const double t = (static_cast<double>(bayer[static_cast<size_t>(sy) * kWidth + sx]) - p.blackLevel) * p.invBlackWhiteRange;
+        return clamp01(t * p.exposure);
+    };
+
+    const double c = px(0, 0);
+    const double a1h = px(-1, 0) + px(1, 0);
+    const double a1v = px(0, -1) + px(0, 1);
+    const double dg = px(-1, -1) + px(1, -1) + px(-1, 1) + px(1, 1);
+    double est[5] = { c, 0.25 * (a1h + a1v), 0.5 * a1h, 0.5 * a1v, 0.25 * dg };
+    if (p.algorithm == 1) {
+        const double a2h = px(-2, 0) + px(2, 0);
+        const double a2v = px(0, -2) + px(0, 2);
+        est[1] = (4.0 * c + 2.0 * (a1h + a1v) - (a2h + a2v)) * 0.125;
+        est[2] = (5.0 * c + 4.0 * a1h - a2h + 0.5 * a2v - dg) * 0.125;
+        est[3] = (5.0 * c + 4.0 * a1v - a2v + 0.5 * a2h - dg) * 0.125;
+        est[4] = (6.0 * c + 2.0 * dg - 1.5 * (a2h + a2v)) * 0.125;
+    }
+
+    static const int kShift[4][2] = { { 1, 1 }, { 0, 0 }, { 0, 1 }, { 1, 0 } };
+    static const int kSelect[4][3] = { { 0, 1, 4 }, { 2, 0, 3 }, { 3, 0, 2 }, { 4, 1, 0 } };
+    const int qx = (x + kShift[p.cfaType][0]) & 1;
+    const int qy = (y + kShift[p.cfaType][1]) & 1;
+    const int* sel = kSelect[qy * 2 + qx];
+
+    const double wb[3] = {
+        clamp01(clamp01(est[sel[0]]) * p.gainR),
+        clamp01(clamp01(est[sel[1]]) * p.gainG),
+        clamp01(clamp01(est[sel[2]]) * p.gainB) };
+
+    double corrected[3];
+    for (int i = 0; i < 3; ++i) {
+        corrected[i] = clamp01(p.ccm[i * 3 + 0] * wb[0] + p.ccm[i * 3 + 1] * wb[1] + p.ccm[i * 3 + 2] * wb[2]);
+    }
+    const double luminance = corrected[0] * 0.2126 + corrected[1] * 0.7152 + corrected[2] * 0.0722;
+    for (int i = 0; i < 3; ++i) {
+        const double saturated = clamp01(luminance + (corrected[i] - luminance) * p.saturation);
+        out[i] = srgbEotf(saturated);
+    }
+}
+
+} // namespace
+
+int main() {
+    int failures = 0;
+    const char* kCfaNames[4] = { "BGGR", "RGGB", "GBRG", "GRBG" };
+    const char* kAlgorithmNames[2] = { "bilinear", "MHC" };
+
+    for (int test = 0; test < 8; ++test) {
+        const int cfaType = test % 4;
+        const int algorithm = test / 4;
+        const std::vector<uint16_t> bayer = SyntheticFrame::makeBayer(kWidth, kHeight, 0x5eed0000u + test);
+        const CpuImagePipeline::Params params = SyntheticFrame::makeParams(cfaType, algorithm);
+
+        std::vector<uint16_t> rgb(static_cast<size_t>(kWidth) * kHeight * 3);
+        CpuImagePipeline::process(bayer.data(), kWidth, kHeight, params,
+            CpuImagePipeline::Output::SRGB_U16, rgb.data(), 2);
+
+        int maxError = 0;
+        int worstX = 0, worstY = 0;
+        for (int y = 0; y < kHeight; ++y) {
+            for (int x = 0; x < kWidth; ++x) {
+                double ref[3];
+                referencePixel(bayer, params, x, y, ref);
+                for (int ch = 0; ch < 3; ++ch) {
+                    const int expected = static_cast<int>(std::lround(ref[ch] * 65535.0));
+                    const int actual = rgb[(static_cast<size_t>(y) * kWidth + x) * 3 + ch];
+                    const int error = std::abs(actual - expected);
+                    if (error > maxError) {
+                        maxError = error;
+                        worstX = x;
+                        worstY = y;
+                    }
+                }
+            }
+        }
+
+        const bool ok = maxError <= kMaxSrgbError;
+        std::printf("%s %s %s: max error %d/65535 at (%d, %d), tolerance %d\n",
+            ok ? "PASS" : "FAIL", kCfaNames[cfaType], kAlgorithmNames[algorithm], maxError, worstX, worstY, kMaxSrgbError);
+        if (!ok) failures++;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,508 @@
+// FILE: tests/DemosaicGpuTest.cpp
+//
+// Runs shaders/demosaic.comp on a Vulkan device (lavapipe in CI, see tests/CMakeLists.txt) for
+// both algorithms and all four CFA layouts and compares the rgba16f output with
+// CpuImagePipeline::process(..., LINEAR_HALF) on the same synthetic frame, so --export/--stream
+// and playback cannot drift apart.
+//
+// Tolerance: both sides compute in single precision and round to half, but host and device
+// compilers order and contract (FMA) the arithmetic differently. kMaxLinearError is four half
+// ULPs at 1.0; a wrong tap, coefficient or CFA phase is off by orders of magnitude more.
+//
+// Usage: DemosaicGpuTest <demosaic.comp.spv>. Exits 77 (skipped) when no Vulkan device is present.
+#include "Export/CpuImagePipeline.h"
+#include "Graphics/VulkanHelpers.h"
+#include "SyntheticFrame.h"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 53;  // Not a multiple of the 16x16 workgroup: partial tiles and
+constexpr int kHeight = 37; // mirrored aprons on every edge.
+constexpr float kMaxLinearError = 2.0e-3f;
+constexpr int kSkipped = 77;
+constexpr uint32_t kTile = 16;          // TILE in demosaic.comp
+constexpr uint32_t kRawImageSlots = 7;  // RAW_IMAGE_SLOTS in demosaic.comp
+
+// std140 layout of ShaderParams, as Renderer_VK::ShaderParamsUBO.
+struct ShaderParams {
+    int32_t W;
+    int32_t H;
+    int32_t cfaType;
+    float exposure;
+    float blackLevel;
+    float whiteLevel;
+    float invBlackWhiteRange;
+    float gainR;
+    float gainG;
+    float gainB;
+    alignas(16) float CCM[16]; // Column-major mat4, top-left 3x3 used
+    float saturationAdjustment;
+};
+static_assert(offsetof(ShaderParams, CCM) == 48, "ShaderParams must match the std140 block");
+static_assert(offsetof(ShaderParams, saturationAdjustment) == 112, "ShaderParams must match the std140 block");
+
+struct Buffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    void* mapped = nullptr;
+};
+
+struct Image {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+};
+
+struct Context {
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+
+    Buffer staging;  // Raw frame upload
+    Buffer uniforms;
+    Buffer readback;
+    Image raw;       // R16_UINT, sampled
+    Image output;    // rgba16f, storage
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+
+    ~Context() {
+        if (device != VK_NULL_HANDLE) {
+            vkDeviceWaitIdle(device);
+            for (Buffer* b : { &staging, &uniforms, &readback }) {
+                if (b->buffer != VK_NULL_HANDLE) vkDestroyBuffer(device, b->buffer, nullptr);
+                if (b->memory != VK_NULL_HANDLE) vkFreeMemory(device, b->memory, nullptr);
+            }
+            for (Image* i : { &raw, &output }) {
+                if (i->view != VK_NULL_HANDLE) vkDestroyImageView(device, i->view, nullptr);
+                if (i->image != VK_NULL_HANDLE) vkDestroyImage(device, i->image, nullptr);
+                if (i->memory != VK_NULL_HANDLE) vkFreeMemory(device, i->memory, nullptr);
+            }
+            if (sampler != VK_NULL_HANDLE) vkDestroySampler(device, sampler, nullptr);
+            if (shaderModule != VK_NULL_HANDLE) vkDestroyShaderModule(device, shaderModule, nullptr);
+            if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+            if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+            if (setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+            if (commandPool != VK_NULL_HANDLE) vkDestroyCommandPool(device, commandPool, nullptr);
+            vkDestroyDevice(device, nullptr);
+        }
+        if (instance != VK_NULL_HANDLE) vkDestroyInstance(instance, nullptr);
+    }
+};
+
+bool check(VkResult result, const char* what) {
+    if (result == VK_SUCCESS) return true;
+    std::fprintf(stderr, "%s failed. Error: %d\n", what, static_cast<int>(result));
+    return false;
+}
+
+uint32_t findMemoryType(const Context& ctx, uint32_t typeBits, VkMemoryPropertyFlags flags) {
+    VkPhysicalDeviceMemoryProperties props{};
+    vkGetPhysicalDeviceMemoryProperties(ctx.physicalDevice, &props);
+    for (uint32_t i = 0; i < props.memoryTypeCount; ++i) {
+        if ((typeBits & (1u << i)) && (props.memoryTypes[i].propertyFlags & flags) == flags) return i;
+    }
+    return UINT32_MAX;
+}
+
+bool createBuffer(Context& ctx, VkDeviceSize size, VkBufferUsageFlags usage, Buffer& out) {
+    VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (!check(vkCreateBuffer(ctx.device, &bufferInfo, nullptr, &out.buffer), "vkCreateBuffer")) return false;
+
+    VkMemoryRequirements req{};
+    vkGetBufferMemoryRequirements(ctx.device, out.buffer, &req);
+    VkMemoryAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocInfo.allocationSize = req.size;
+    allocInfo.memoryTypeIndex = findMemoryType(ctx, req.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (allocInfo.memoryTypeIndex == UINT32_MAX) return false;
+    if (!check(vkAllocateMemory(ctx.device, &allocInfo, nullptr, &out.memory), "vkAllocateMemory")) return false;
+    if (!check(vkBindBufferMemory(ctx.device, out.buffer, out.memory, 0), "vkBindBufferMemory")) return false;
+    return check(vkMapMemory(ctx.device, out.memory, 0, VK_WHOLE_SIZE, 0, &out.mapped), "vkMapMemory");
+}
+
+bool createImage(Context& ctx, VkFormat format, VkImageUsageFlags usage, Image& out) {
+    VkImageCreateInfo imageInfo{ VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = { static_cast<uint32_t>(kWidth), static_cast<uint32_t>(kHeight), 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (!check(vkCreateImage(ctx.device, &imageInfo, nullptr, &out.image), "vkCreateImage")) return false;
+
+    VkMemoryRequirements req{};
+    vkGetImageMemoryRequirements(ctx.device, out.image, &req);
+    VkMemoryAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocInfo.allocationSize = req.size;
+    allocInfo.memoryTypeIndex = findMemoryType(ctx, req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (allocInfo.memoryTypeIndex == UINT32_MAX) allocInfo.memoryTypeIndex = findMemoryType(ctx, req.memoryTypeBits, 0);
+    if (!check(vkAllocateMemory(ctx.device, &allocInfo, nullptr, &out.memory), "vkAllocateMemory")) return false;
+    if (!check(vkBindImageMemory(ctx.device, out.image, out.memory, 0), "vkBindImageMemory")) return false;
+
+    VkImageViewCreateInfo viewInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+    viewInfo.image = out.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    return check(vkCreateImageView(ctx.device, &viewInfo, nullptr, &out.view), "vkCreateImageView");
+}
+
+/// Returns false with ctx.device unset if there is no usable device (the test is then skipped).
+bool createDevice(Context& ctx) {
+    VkApplicationInfo appInfo{ VK_STRUCTURE_TYPE_APPLICATION_INFO };
+    appInfo.pApplicationName = "MotionCam Player demosaic test";
+    appInfo.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo instanceInfo{ VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+    instanceInfo.pApplicationInfo = &appInfo;
+    if (!check(vkCreateInstance(&instanceInfo, nullptr, &ctx.instance), "vkCreateInstance")) return false;
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(ctx.instance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(ctx.instance, &deviceCount, devices.data());
+
+    uint32_t queueFamily = 0;
+    for (VkPhysicalDevice candidate : devices) {
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+        for (uint32_t i = 0; i < familyCount; ++i) {
+            if (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
+                ctx.physicalDevice = candidate;
+                queueFamily = i;
+                break;
+            }
+        }
+        if (ctx.physicalDevice != VK_NULL_HANDLE) break;
+    }
+    if (ctx.physicalDevice == VK_NULL_HANDLE) {
+        std::fprintf(stderr, "No Vulkan device with a compute queue.\n");
+        return false;
+    }
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(ctx.physicalDevice, &props);
+    std::printf("Using %s\n", props.deviceName);
+
+    const float priority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo{ VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+    queueInfo.queueFamilyIndex = queueFamily;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &priority;
+    VkDeviceCreateInfo deviceInfo{ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+    if (!check(vkCreateDevice(ctx.physicalDevice, &deviceInfo, nullptr, &ctx.device), "vkCreateDevice")) return false;
+    vkGetDeviceQueue(ctx.device, queueFamily, 0, &ctx.queue);
+
+    VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+    if (!check(vkCreateCommandPool(ctx.device, &poolInfo, nullptr, &ctx.commandPool), "vkCreateCommandPool")) return false;
+    VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocInfo.commandPool = ctx.commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    return check(vkAllocateCommandBuffers(ctx.device, &allocInfo, &ctx.commandBuffer), "vkAllocateCommandBuffers");
+}
+
+/// Buffers, images, sampler and a descriptor set with the bindings demosaic.comp declares.
+bool createResources(Context& ctx, const char* shaderPath) {
+    const VkDeviceSize rawBytes = static_cast<VkDeviceSize>(kWidth) * kHeight * sizeof(uint16_t);
+    const VkDeviceSize outBytes = static_cast<VkDeviceSize>(kWidth) * kHeight * 4 * sizeof(uint16_t);
+    if (!createBuffer(ctx, rawBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, ctx.staging)) return false;
+    if (!createBuffer(ctx, sizeof(ShaderParams), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, ctx.uniforms)) return false;
+    if (!createBuffer(ctx, outBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT, ctx.readback)) return false;
+    if (!createImage(ctx, VK_FORMAT_R16_UINT, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, ctx.raw)) return false;
+    if (!createImage(ctx, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, ctx.output)) return false;
+
+    VkSamplerCreateInfo samplerInfo{ VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    if (!check(vkCreateSampler(ctx.device, &samplerInfo, nullptr, &ctx.sampler), "vkCreateSampler")) return false;
+
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+    bindings[0] = { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kRawImageSlots, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+    bindings[1] = { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+    bindings[2] = { 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+    bindings[3] = { 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr };
+    VkDescriptorSetLayoutCreateInfo layoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (!check(vkCreateDescriptorSetLayout(ctx.device, &layoutInfo, nullptr, &ctx.setLayout), "vkCreateDescriptorSetLayout")) return false;
+
+    std::array<VkDescriptorPoolSize, 4> poolSizes{};
+    poolSizes[0] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kRawImageSlots };
+    poolSizes[1] = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 };
+    poolSizes[2] = { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 };
+    poolSizes[3] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 };
+    VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+    if (!check(vkCreateDescriptorPool(ctx.device, &poolInfo, nullptr, &ctx.descriptorPool), "vkCreateDescriptorPool")) return false;
+    VkDescriptorSetAllocateInfo setInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    setInfo.descriptorPool = ctx.descriptorPool;
+    setInfo.descriptorSetCount = 1;
+    setInfo.pSetLayouts = &ctx.setLayout;
+    if (!check(vkAllocateDescriptorSets(ctx.device, &setInfo, &ctx.descriptorSet), "vkAllocateDescriptorSets")) return false;
+
+    // Every raw slot points at the one image; the push constant selects slot 0.
+    std::array<VkDescriptorImageInfo, kRawImageSlots> rawInfos{};
+    for (auto& info : rawInfos) info = { ctx.sampler, ctx.raw.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    const VkDescriptorBufferInfo uniformInfo{ ctx.uniforms.buffer, 0, sizeof(ShaderParams) };
+    const VkDescriptorImageInfo outputInfo{ VK_NULL_HANDLE, ctx.output.view, VK_IMAGE_LAYOUT_GENERAL };
+    const VkDescriptorBufferInfo wordsInfo{ ctx.staging.buffer, 0, VK_WHOLE_SIZE };
+    std::array<VkWriteDescriptorSet, 4> writes{};
+    for (auto& w : writes) {
+        w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        w.dstSet = ctx.descriptorSet;
+    }
+    writes[0].dstBinding = 0;
+    writes[0].descriptorCount = kRawImageSlots;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].pImageInfo = rawInfos.data();
+    writes[1].dstBinding = 1;
+    writes[1].descriptorCount = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[1].pBufferInfo = &uniformInfo;
+    writes[2].dstBinding = 2;
+    writes[2].descriptorCount = 1;
+    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[2].pImageInfo = &outputInfo;
+    writes[3].dstBinding = 4;
+    writes[3].descriptorCount = 1;
+    writes[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[3].pBufferInfo = &wordsInfo;
+    vkUpdateDescriptorSets(ctx.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    VkPushConstantRange pushRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, 2 * sizeof(uint32_t) };
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &ctx.setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+    if (!check(vkCreatePipelineLayout(ctx.device, &pipelineLayoutInfo, nullptr, &ctx.pipelineLayout), "vkCreatePipelineLayout")) return false;
+
+    try {
+        ctx.shaderModule = VulkanHelpers::createShaderModule(ctx.device, VulkanHelpers::readFile(shaderPath));
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Failed to load %s: %s\n", shaderPath, e.what());
+        return false;
+    }
+    return true;
+}
+
+/// One pipeline per (CFA, algorithm), with the raw image as source, as Pipeline.cpp builds them.
+VkPipeline createPipeline(const Context& ctx, int cfaType, int algorithm) {
+    const int32_t constants[3] = { cfaType, algorithm, 0 };
+    const VkSpecializationMapEntry entries[3] = {
+        { 0, 0, sizeof(int32_t) }, { 1, sizeof(int32_t), sizeof(int32_t) }, { 2, 2 * sizeof(int32_t), sizeof(int32_t) } };
+    VkSpecializationInfo specInfo{};
+    specInfo.mapEntryCount = 3;
+    specInfo.pMapEntries = entries;
+    specInfo.dataSize = sizeof(constants);
+    specInfo.pData = constants;
+
+    VkComputePipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = ctx.shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.stage.pSpecializationInfo = &specInfo;
+    pipelineInfo.layout = ctx.pipelineLayout;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    check(vkCreateComputePipelines(ctx.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline), "vkCreateComputePipelines");
+    return pipeline;
+}
+
+void imageBarrier(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage)
+{
+    VkImageMemoryBarrier barrier{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+/// Uploads the raw frame, runs the demosaic and copies the result into ctx.readback.
+bool runDemosaic(Context& ctx, VkPipeline pipeline) {
+    VkCommandBuffer cmd = ctx.commandBuffer;
+    VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkResetCommandBuffer(cmd, 0);
+    vkBeginCommandBuffer(cmd, &beginInfo);
+
+    const VkExtent3D extent{ static_cast<uint32_t>(kWidth), static_cast<uint32_t>(kHeight), 1 };
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = extent;
+
+    imageBarrier(cmd, ctx.raw.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    vkCmdCopyBufferToImage(cmd, ctx.staging.buffer, ctx.raw.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    imageBarrier(cmd, ctx.raw.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    imageBarrier(cmd, ctx.output.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        0, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    const uint32_t pushConstants[2] = { 0, 0 }; // rawWordOffset, rawImageIndex
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, ctx.pipelineLayout, 0, 1, &ctx.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(cmd, ctx.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), pushConstants);
+    vkCmdDispatch(cmd, (kWidth + kTile - 1) / kTile, (kHeight + kTile - 1) / kTile, 1);
+
+    imageBarrier(cmd, ctx.output.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    vkCmdCopyImageToBuffer(cmd, ctx.output.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, ctx.readback.buffer, 1, &region);
+
+    VkBufferMemoryBarrier hostBarrier{ VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = ctx.readback.buffer;
+    hostBarrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+    vkEndCommandBuffer(cmd);
+
+    VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmd;
+    if (!check(vkQueueSubmit(ctx.queue, 1, &submitInfo, VK_NULL_HANDLE), "vkQueueSubmit")) return false;
+    return check(vkQueueWaitIdle(ctx.queue), "vkQueueWaitIdle");
+}
+
+void fillShaderParams(const CpuImagePipeline::Params& p, ShaderParams& out) {
+    std::memset(&out, 0, sizeof(out));
+    out.W = kWidth;
+    out.H = kHeight;
+    out.cfaType = p.cfaType;
+    out.exposure = p.exposure;
+    out.blackLevel = p.blackLevel;
+    out.whiteLevel = p.whiteLevel;
+    out.invBlackWhiteRange = p.invBlackWhiteRange;
+    out.gainR = p.gainR;
+    out.gainG = p.gainG;
+    out.gainB = p.gainB;
+    // Row-major 3x3 into a column-major mat4, as Renderer_VK::prepareAndUploadFrameData does.
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) out.CCM[col * 4 + row] = p.ccm[row * 3 + col];
+    }
+    out.CCM[15] = 1.0f;
+    out.saturationAdjustment = p.saturation;
+}
+
+float halfToFloat(uint16_t h) {
+    const int exponent = (h >> 10) & 0x1F;
+    const int mantissa = h & 0x3FF;
+    float v;
+    if (exponent == 0) v = std::ldexp(static_cast<float>(mantissa), -24);
+    else if (exponent == 31) v = mantissa ? NAN : INFINITY;
+    else v = std::ldexp(static_cast<float>(mantissa | 0x400), exponent - 25);
+    return (h & 0x8000) ? -v : v;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: DemosaicGpuTest <demosaic.comp.spv>\n");
+        return 1;
+    }
+
+    Context ctx;
+    if (!createDevice(ctx)) {
+        std::printf("SKIP: no Vulkan device (install lavapipe to run this test).\n");
+        return kSkipped;
+    }
+    if (!createResources(ctx, argv[1])) return 1;
+
+    int failures = 0;
+    const char* kCfaNames[4] = { "BGGR", "RGGB", "GBRG", "GRBG" };
+    const char* kAlgorithmNames[2] = { "bilinear", "MHC" };
+    std::vector<uint16_t> cpu(static_cast<size_t>(kWidth) * kHeight * 3);
+
+    for (int test = 0; test < 8; ++test) {
+        const int cfaType = test % 4;
+        const int algorithm = test / 4;
+        const std::vector<uint16_t> bayer = SyntheticFrame::makeBayer(kWidth, kHeight, 0x5eed1000u + test);
+        const CpuImagePipeline::Params params = SyntheticFrame::makeParams(cfaType, algorithm);
+
+        std::memcpy(ctx.staging.mapped, bayer.data(), bayer.size() * sizeof(uint16_t));
+        fillShaderParams(params, *static_cast<ShaderParams*>(ctx.uniforms.mapped));
+
+        VkPipeline pipeline = createPipeline(ctx, cfaType, algorithm);
+        if (pipeline == VK_NULL_HANDLE) return 1;
+        const bool ran = runDemosaic(ctx, pipeline);
+        vkDestroyPipeline(ctx.device, pipeline, nullptr);
+        if (!ran) return 1;
+
+        CpuImagePipeline::process(bayer.data(), kWidth, kHeight, params,
+            CpuImagePipeline::Output::LINEAR_HALF, cpu.data(), 1);
+
+        const uint16_t* gpu = static_cast<const uint16_t*>(ctx.readback.mapped);
+        float maxError = 0.0f;
+        int worstX = 0, worstY = 0;
+        for (int y = 0; y < kHeight; ++y) {
+            for (int x = 0; x < kWidth; ++x) {
+                const size_t i = static_cast<size_t>(y) * kWidth + x;
+                for (int ch = 0; ch < 3; ++ch) {
+                    float error = std::fabs(halfToFloat(gpu[i * 4 + ch]) - halfToFloat(cpu[i * 3 + ch]));
+                    if (std::isnan(error)) error = INFINITY;
+                    if (error > maxError) {
+                        maxError = error;
+                        worstX = x;
+                        worstY = y;
+                    }
+                }
+            }
+        }
+
+        const bool ok = maxError <= kMaxLinearError;
+        std::printf("%s %s %s: max error %.6f at (%d, %d), tolerance %.6f\n",
+            ok ? "PASS" : "FAIL", kCfaNames[cfaType], kAlgorithmNames[algorithm], maxError, worstX, worstY, kMaxLinearError);
+        if (!ok) failures++;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
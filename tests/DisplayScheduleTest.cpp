@@ -0,0 +1,125 @@
+// FILE: tests/DisplayScheduleTest.cpp
+//
+// Walks DisplaySchedule cursors over synthetic timestamp lists: 120 and 240 fps clips on a
+// 60 Hz display read every 2nd and 4th frame, jittered timestamps keep the same stride and the
+// schedule's media time stays on whole refreshes, clips less than 1.25x faster than the display
+// read every frame, and a cursor stepped past the last frame ends at timestamps.size().
+#include "Playback/DisplaySchedule.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kDisplayFps = 60.0;
+
+// frames timestamps at fps, each moved by up to +-jitterNs.
+std::vector<int64_t> makeTimestamps(double fps, size_t frames, int64_t jitterNs) {
+    std::vector<int64_t> timestamps(frames);
+    uint32_t state = 0x5eed1234u;
+    for (size_t i = 0; i < frames; ++i) {
+        state = state * 1664525u + 1013904223u;
+        const int64_t jitter = jitterNs > 0 ? static_cast<int64_t>(state >> 8) % (2 * jitterNs + 1) - jitterNs : 0;
+        timestamps[i] = 1000000000 + static_cast<int64_t>(static_cast<double>(i) * 1e9 / fps) + jitter;
+    }
+    return timestamps;
+}
+
+int failures = 0;
+
+void report(bool ok, const std::string& what) {
+    std::printf("%s %s\n", ok ? "PASS" : "FAIL", what.c_str());
+    if (!ok) failures++;
+}
+
+// Steps a schedule from frame 0 to the end; true when every step advanced by stride frames
+// (the last may be shorter) and each refresh's media time is the first one plus a whole number of display intervals.
+bool walksWithStride(const std::vector<int64_t>& timestamps, double displayFps, size_t stride, size_t& steps) {
+    const int64_t displayInterval = DisplaySchedule::displayIntervalNs(DisplaySchedule::frameIntervalNs(timestamps), displayFps);
+    DisplaySchedule::Cursor cursor = DisplaySchedule::start(timestamps, 0);
+    const int64_t firstMediaTime = cursor.mediaTimeNs;
+    steps = 0;
+    for (;;) {
+        const DisplaySchedule::Cursor following = DisplaySchedule::next(timestamps, cursor, displayInterval);
+        if (following.index >= timestamps.size())
+            return following.index == timestamps.size();
+        steps++;
+        // The playhead reaches the last frame before a whole stride is left for the final step.
+        const bool lastFrame = following.index + 1 == timestamps.size();
+        if (following.index != cursor.index + stride && !(lastFrame && following.index < cursor.index + stride))
+            return false;
+        if (displayInterval > 0 && following.mediaTimeNs != firstMediaTime + static_cast<int64_t>(steps) * displayInterval)
+            return false;
+        cursor = following;
+    }
+}
+
+} // namespace
+
+int main() {
+    // 10 s of 120 and 240 fps footage at 60 Hz.
+    for (const int fps : { 120, 240 }) {
+        const size_t stride = static_cast<size_t>(fps) / 60;
+        const std::vector<int64_t> timestamps = makeTimestamps(fps, static_cast<size_t>(fps) * 10, 0);
+        const int64_t frameInterval = DisplaySchedule::frameIntervalNs(timestamps);
+        const int64_t displayInterval = DisplaySchedule::displayIntervalNs(frameInterval, kDisplayFps);
+        const double frameStride = DisplaySchedule::frameStride(frameInterval, displayInterval);
+        size_t steps = 0;
+        const bool ok = walksWithStride(timestamps, kDisplayFps, stride, steps);
+        report(ok && steps == timestamps.size() / stride && frameStride > stride - 0.01 && frameStride < stride + 0.01,
+            std::to_string(fps) + " fps at 60 Hz reads every " + std::to_string(stride) + " frames: " +
+            std::to_string(steps) + " steps, stride " + std::to_string(frameStride));
+    }
+
+    // Up to +-2 ms of jitter on a 120 fps clip (frames 8.3 ms apart) must not move any refresh
+    // onto a neighbouring frame or let the schedule fall behind the playhead.
+    {
+        const std::vector<int64_t> timestamps = makeTimestamps(120, 1200, 2000000);
+        size_t steps = 0;
+        const bool ok = walksWithStride(timestamps, kDisplayFps, 2, steps);
+        report(ok && steps == timestamps.size() / 2, "jittered 120 fps at 60 Hz: " + std::to_string(steps) + " steps, no drift");
+    }
+
+    // 60 and 72 fps (ratios 1 and 1.2) read every frame; 75 fps (1.25) is the first that skips.
+    for (const int fps : { 60, 72 }) {
+        const std::vector<int64_t> timestamps = makeTimestamps(fps, static_cast<size_t>(fps) * 2, 0);
+        const int64_t frameInterval = DisplaySchedule::frameIntervalNs(timestamps);
+        const int64_t displayInterval = DisplaySchedule::displayIntervalNs(frameInterval, kDisplayFps);
+        size_t steps = 0;
+        const bool ok = walksWithStride(timestamps, kDisplayFps, 1, steps);
+        report(ok && displayInterval == 0 && DisplaySchedule::frameStride(frameInterval, displayInterval) == 1.0 &&
+                steps == timestamps.size() - 1,
+            std::to_string(fps) + " fps at 60 Hz reads every frame");
+    }
+    {
+        const std::vector<int64_t> timestamps = makeTimestamps(75, 150, 0);
+        report(DisplaySchedule::displayIntervalNs(DisplaySchedule::frameIntervalNs(timestamps), kDisplayFps) > 0,
+            "75 fps at 60 Hz is scheduled");
+        report(DisplaySchedule::displayIntervalNs(DisplaySchedule::frameIntervalNs(timestamps), 0.0) == 0,
+            "unknown refresh rate reads every frame");
+    }
+
+    // Past the end: from the last frame, from the end itself, and starting beyond it.
+    {
+        const std::vector<int64_t> timestamps = makeTimestamps(120, 10, 0);
+        const int64_t displayInterval = DisplaySchedule::displayIntervalNs(DisplaySchedule::frameIntervalNs(timestamps), kDisplayFps);
+        const DisplaySchedule::Cursor last = DisplaySchedule::start(timestamps, timestamps.size() - 1);
+        const DisplaySchedule::Cursor end = DisplaySchedule::next(timestamps, last, displayInterval);
+        const DisplaySchedule::Cursor afterEnd = DisplaySchedule::next(timestamps, end, displayInterval);
+        const DisplaySchedule::Cursor unscheduled = DisplaySchedule::next(timestamps, last, 0);
+        const DisplaySchedule::Cursor beyond = DisplaySchedule::start(timestamps, timestamps.size() + 5);
+        report(end.index == timestamps.size() && afterEnd.index == timestamps.size() &&
+                unscheduled.index == timestamps.size() && beyond.index == timestamps.size(),
+            "next past the last frame returns size()");
+
+        const std::vector<int64_t> single(1, 0);
+        report(DisplaySchedule::frameIntervalNs(single) == 0 &&
+                DisplaySchedule::next(single, DisplaySchedule::start(single, 0), 0).index == 1 &&
+                DisplaySchedule::start(std::vector<int64_t>(), 0).index == 0,
+            "single-frame and empty clips");
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+// FILE: tests/HttpByteSourceTest.cpp
+//
+// Serves a deterministic 1 MiB file from an in-process HTTP/1.1 server with Range and keep-alive
+// support and reads it back through openByteSource(ByteSourceKind::Http). Checks cached and
+// direct reads against the file, that readBatch() coalesces nearby requests into one range
+// request per span, and that a pooled connection the server has closed is replaced transparently.
+//
+// POSIX sockets only; not built on Windows.
+#include <motioncam/ByteSource.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kFileSize = size_t{ 1 } << 20;
+constexpr size_t kBlockSize = 4096; // Smallest block the cache accepts
+
+std::vector<uint8_t> makeFile() {
+    std::vector<uint8_t> file(kFileSize);
+    uint32_t state = 0x0b5e55edu;
+    for (uint8_t& b : file) {
+        state = state * 1664525u + 1013904223u;
+        b = static_cast<uint8_t>(state >> 24);
+    }
+    return file;
+}
+
+// Answers "Range: bytes=a-b" GETs with 206 on keep-alive connections, one thread per connection.
+class RangeServer {
+public:
+    explicit RangeServer(const std::vector<uint8_t>& file) : mFile(file) {
+        mListen = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (mListen < 0 ||
+            bind(mListen, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(mListen, 64) != 0 ||
+            getsockname(mListen, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            std::fprintf(stderr, "Cannot start the test server\n");
+            std::exit(1);
+        }
+        mPort = ntohs(address.sin_port);
+        mAcceptThread = std::thread([this]() { acceptLoop(); });
+    }
+
+    ~RangeServer() {
+        mStopping = true;
+        shutdown(mListen, SHUT_RDWR);
+        mAcceptThread.join();
+        close(mListen);
+        dropConnections();
+        for (std::thread& t : mConnectionThreads)
+            t.join();
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(mPort) + "/clip.mcraw"; }
+
+    int requests() const { return mRequests; }
+    int connections() const { return mConnections; }
+
+    // Close every open connection from the server side, as an idle timeout would.
+    void dropConnections() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (int s : mOpen)
+            shutdown(s, SHUT_RDWR);
+    }
+
+    int openConnections() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return static_cast<int>(mOpen.size());
+    }
+
+private:
+    void acceptLoop() {
+        while (!mStopping) {
+            const int s = accept(mListen, nullptr, nullptr);
+            if (s < 0)
+                break;
+            std::lock_guard<std::mutex> lock(mMutex);
+            mConnections++;
+            mOpen.push_back(s);
+            mConnectionThreads.emplace_back([this, s]() { serve(s); });
+        }
+    }
+
+    void serve(int s) {
+        std::string pending;
+        char buffer[4096];
+        for (;;) {
+            size_t end = pending.find("\r\n\r\n");
+            while (end == std::string::npos) {
+                const ssize_t n = recv(s, buffer, sizeof(buffer), 0);
+                if (n <= 0)
+                    break;
+                pending.append(buffer, static_cast<size_t>(n));
+                end = pending.find("\r\n\r\n");
+            }
+            if (end == std::string::npos)
+                break;
+
+            std::string request = pending.substr(0, end + 2);
+            pending.erase(0, end + 4);
+            std::transform(request.begin(), request.end(), request.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+            mRequests++;
+
+            const size_t range = request.find("\r\nrange: bytes=");
+            unsigned long long first = 0, last = 0;
+            if (range == std::string::npos ||
+                std::sscanf(request.c_str() + range + 15, "%llu-%llu", &first, &last) != 2 ||
+                first > last || first >= mFile.size()) {
+                const std::string response = "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Length: 0\r\n\r\n";
+                send(s, response.data(), response.size(), MSG_NOSIGNAL);
+                continue;
+            }
+            last = std::min<unsigned long long>(last, mFile.size() - 1);
+            const size_t length = static_cast<size_t>(last - first + 1);
+            std::string response =
+                "HTTP/1.1 206 Partial Content\r\n"
+                "Content-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + std::to_string(mFile.size()) + "\r\n"
+                "Content-Length: " + std::to_string(length) + "\r\n"
+                "Connection: keep-alive\r\n\r\n";
+            response.append(reinterpret_cast<const char*>(mFile.data()) + first, length);
+            if (send(s, response.data(), response.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(response.size()))
+                break;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mOpen.erase(std::find(mOpen.begin(), mOpen.end(), s));
+        close(s);
+    }
+
+    const std::vector<uint8_t>& mFile;
+    int mListen = -1;
+    int mPort = 0;
+    std::atomic<bool> mStopping{ false };
+    std::atomic<int> mRequests{ 0 };
+    std::atomic<int> mConnections{ 0 };
+    std::mutex mMutex;
+    std::vector<int> mOpen;
+    std::vector<std::thread> mConnectionThreads;
+    std::thread mAcceptThread;
+};
+
+bool matches(const std::vector<uint8_t>& file, uint64_t offset, const uint8_t* data, size_t size) {
+    return std::equal(data, data + size, file.begin() + static_cast<ptrdiff_t>(offset));
+}
+
+int failures = 0;
+
+void report(bool ok, const std::string& what) {
+    std::printf("%s %s\n", ok ? "PASS" : "FAIL", what.c_str());
+    if (!ok) failures++;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<uint8_t> file = makeFile();
+    RangeServer server(file);
+
+    motioncam::ByteSourceOptions options;
+    options.kind = motioncam::ByteSourceKind::Http;
+    options.blockSize = kBlockSize;
+    options.cacheBytes = 64 * kBlockSize;
+    options.queueDepth = 4;
+
+    try {
+        const auto source = motioncam::openByteSource(server.url(), options);
+        report(source->size() == kFileSize && std::string(source->name()) == "http",
+            "size " + std::to_string(source->size()) + " from Content-Range");
+
+        // Cached reads inside, across and at the end of blocks; direct reads of two blocks or more.
+        struct Case { uint64_t offset; size_t size; size_t expected; };
+        const Case cases[] = {
+            { 0, 1, 1 },
+            { 100, 300, 300 },
+            { kBlockSize - 10, 20, 20 },
+            { 5 * kBlockSize + 7, 3 * kBlockSize, 3 * kBlockSize },
+            { kFileSize - 100, 1000, 100 },
+            { kFileSize, 10, 0 },
+        };
+        for (const Case& c : cases) {
+            std::vector<uint8_t> data(c.size);
+            const size_t n = source->read(c.offset, data.data(), data.size());
+            report(n == c.expected && matches(file, c.offset, data.data(), n),
+                "read " + std::to_string(c.size) + " at " + std::to_string(c.offset) + ": " + std::to_string(n) + " bytes");
+        }
+
+        // Three requests less than a block apart, given out of order, form one span; a fourth far
+        // away forms another. Each span is a single range request.
+        const uint64_t offsets[] = { 200000 + 3000, 200000, 200000 + 6000, 700000 };
+        std::vector<std::vector<uint8_t>> buffers(4, std::vector<uint8_t>(2000));
+        std::vector<motioncam::ReadRequest> batch(4);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i].offset = offsets[i];
+            batch[i].dst = buffers[i].data();
+            batch[i].size = buffers[i].size();
+        }
+        const int requestsBefore = server.requests();
+        source->readBatch(batch.data(), batch.size());
+        const int batchRequests = server.requests() - requestsBefore;
+        bool batchOk = true;
+        for (size_t i = 0; i < batch.size(); ++i)
+            batchOk = batchOk && batch[i].bytesRead == buffers[i].size() && matches(file, offsets[i], buffers[i].data(), buffers[i].size());
+        report(batchOk && batchRequests == 2, "readBatch of 4 requests in 2 spans: " + std::to_string(batchRequests) + " range requests");
+
+        // Close the pooled connections under the source; the next uncached read must still succeed.
+        server.dropConnections();
+        for (int i = 0; i < 200 && server.openConnections() > 0; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const int connectionsBefore = server.connections();
+        std::vector<uint8_t> data(500);
+        const size_t n = source->read(900000, data.data(), data.size());
+        report(n == data.size() && matches(file, 900000, data.data(), n) && server.connections() > connectionsBefore,
+            "read after the server closed pooled connections: " + std::to_string(n) + " bytes, " +
+            std::to_string(server.connections() - connectionsBefore) + " new connection(s)");
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "FAIL: %s\n", e.what());
+        return 1;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+// FILE: tests/ProxyTest.cpp
+//
+// Writes a proxy of the SyntheticClip clip with four worker threads and checks every proxy
+// frame against a reference 2x2 same-colour average of the decoded source frame, the frame
+// timestamps, and that IsProxyOf() pairs the proxy with its clip (and not the clip with itself).
+//
+// Usage: ProxyTest <synthetic.mcraw>
+#include <motioncam/Decoder.hpp>
+#include <motioncam/Proxy.hpp>
+#include <motioncam/RawData.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kBinning = 2;
+
+// Straightforward binning: output photosite (x, y) is the rounded mean of the kBinning x
+// kBinning photosites of its colour in the 2*kBinning square it covers.
+std::vector<uint16_t> referenceBin(const std::vector<uint16_t>& in, int width, int height, int& outWidth, int& outHeight) {
+    outWidth = width / (2 * kBinning) * 2;
+    outHeight = height / (2 * kBinning) * 2;
+    std::vector<uint16_t> out(static_cast<size_t>(outWidth) * outHeight);
+    for (int y = 0; y < outHeight; ++y) {
+        for (int x = 0; x < outWidth; ++x) {
+            const int originX = (x / 2) * 2 * kBinning + x % 2;
+            const int originY = (y / 2) * 2 * kBinning + y % 2;
+            uint32_t sum = 0;
+            for (int j = 0; j < kBinning; ++j)
+                for (int i = 0; i < kBinning; ++i)
+                    sum += in[static_cast<size_t>(originY + 2 * j) * width + originX + 2 * i];
+            out[static_cast<size_t>(y) * outWidth + x] = static_cast<uint16_t>((sum + kBinning * kBinning / 2) / (kBinning * kBinning));
+        }
+    }
+    return out;
+}
+
+bool decodeFrame(const motioncam::Decoder& decoder, motioncam::Timestamp timestamp, std::vector<uint16_t>& out, int& width, int& height) {
+    std::vector<uint8_t> payload, metadata;
+    int compressionType = -1;
+    if (!decoder.getRawFramePayloads(timestamp, payload, metadata, width, height, compressionType) || compressionType != 7)
+        return false;
+    out.resize(static_cast<size_t>(width) * height);
+    return motioncam::raw::Decode(out.data(), width, height, payload.data(), payload.size()) > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: ProxyTest <synthetic.mcraw>\n");
+        return 1;
+    }
+    const std::string clipPath = argv[1];
+    const std::string proxyPath = motioncam::ProxyPath(clipPath);
+
+    int failures = 0;
+    try {
+        motioncam::ProxyOptions options;
+        options.binning = kBinning;
+        options.threads = 4;
+        const motioncam::ProxyStats stats = motioncam::WriteProxy(clipPath, proxyPath, options);
+
+        const motioncam::Decoder clip(clipPath);
+        const motioncam::Decoder proxy(proxyPath);
+        const bool indexed = stats.frames == clip.getFrames().size() && proxy.getFrames() == clip.getFrames();
+        std::printf("%s %zu frames written to %s\n", indexed ? "PASS" : "FAIL", stats.frames, proxyPath.c_str());
+        if (!indexed) failures++;
+
+        std::vector<uint16_t> source, binned;
+        for (size_t i = 0; indexed && i < clip.getFrames().size(); ++i) {
+            int width = 0, height = 0, proxyWidth = 0, proxyHeight = 0, expectedWidth = 0, expectedHeight = 0;
+            const bool read = decodeFrame(clip, clip.getFrames()[i], source, width, height) &&
+                decodeFrame(proxy, proxy.getFrames()[i], binned, proxyWidth, proxyHeight);
+            const bool exact = read &&
+                referenceBin(source, width, height, expectedWidth, expectedHeight) == binned &&
+                proxyWidth == expectedWidth && proxyHeight == expectedHeight;
+            std::printf("%s frame %zu: %d x %d -> %d x %d\n", exact ? "PASS" : "FAIL", i, width, height, proxyWidth, proxyHeight);
+            if (!exact) failures++;
+        }
+
+        const bool paired = motioncam::IsProxyOf(proxy, clip) && !motioncam::IsProxyOf(clip, clip) &&
+            motioncam::IsProxyPath(proxyPath) && !motioncam::IsProxyPath(clipPath);
+        std::printf("%s IsProxyOf and IsProxyPath\n", paired ? "PASS" : "FAIL");
+        if (!paired) failures++;
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "FAIL: %s\n", e.what());
+        return 1;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
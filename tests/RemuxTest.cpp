@@ -0,0 +1,101 @@
+// FILE: tests/RemuxTest.cpp
+//
+// Remuxes the SyntheticClip clip: the whole clip must come back byte for byte, and trims and
+// concatenations must hold the selected frames' payloads under the expected timestamps, with a
+// clip that does not follow on from the previous one shifted to start one frame interval after
+// it.
+//
+// Usage: RemuxTest <synthetic.mcraw>
+#include <motioncam/Decoder.hpp>
+#include <motioncam/Remux.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<char> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::vector<uint8_t> payloadOf(const motioncam::Decoder& decoder, motioncam::Timestamp timestamp) {
+    std::vector<uint8_t> payload, metadata;
+    int width = 0, height = 0, compressionType = -1;
+    if (!decoder.getRawFramePayloads(timestamp, payload, metadata, width, height, compressionType))
+        payload.clear();
+    return payload;
+}
+
+struct Case {
+    const char* name;
+    std::vector<motioncam::RemuxInput> inputs;
+    std::vector<size_t> sourceFrames;               // Clip frame each output frame is a copy of
+    std::vector<motioncam::Timestamp> timestamps;   // Expected output timestamps
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: RemuxTest <synthetic.mcraw>\n");
+        return 1;
+    }
+    const std::string clipPath = argv[1];
+    const std::string outputPath = clipPath + ".remux.mcraw";
+
+    int failures = 0;
+    try {
+        const motioncam::Decoder clip(clipPath);
+        const std::vector<motioncam::Timestamp>& t = clip.getFrames();
+        if (t.size() != 5) {
+            std::fprintf(stderr, "FAIL: expected the 5-frame synthetic clip, got %zu frames\n", t.size());
+            return 1;
+        }
+        const motioncam::Timestamp interval = t[1] - t[0];
+
+        // The whole clip, in the record layout the clip already has, is an exact copy.
+        {
+            const motioncam::RemuxStats stats = motioncam::Remux({ { clipPath } }, outputPath);
+            const bool identical = stats.frames == t.size() && readFile(outputPath) == readFile(clipPath);
+            std::printf("%s whole clip: %zu frames, %llu bytes, %s\n", identical ? "PASS" : "FAIL", stats.frames,
+                static_cast<unsigned long long>(stats.bytesWritten), identical ? "byte-identical" : "DIFFERS");
+            if (!identical) failures++;
+        }
+
+        const Case cases[] = {
+            { "trim to frames 1-3", { { clipPath, 1, 3 } }, { 1, 2, 3 }, { t[1], t[2], t[3] } },
+            { "trim past the end", { { clipPath, 3 } }, { 3, 4 }, { t[3], t[4] } },
+            // Frames 3-4 follow frames 0-1, so the second part keeps its timestamps.
+            { "concat with a gap", { { clipPath, 0, 2 }, { clipPath, 3 } }, { 0, 1, 3, 4 }, { t[0], t[1], t[3], t[4] } },
+            // The second copy starts before the first ends and is moved to one interval after it.
+            { "concat of the clip with itself", { { clipPath }, { clipPath } }, { 0, 1, 2, 3, 4, 0, 1, 2, 3, 4 },
+                { t[0], t[1], t[2], t[3], t[4], t[4] + interval, t[4] + 2 * interval, t[4] + 3 * interval, t[4] + 4 * interval, t[4] + 5 * interval } },
+            { "concat of the end before the start", { { clipPath, 3, 2 }, { clipPath, 0, 2 } }, { 3, 4, 0, 1 },
+                { t[3], t[4], t[4] + interval, t[4] + 2 * interval } },
+        };
+        for (const Case& c : cases) {
+            const motioncam::RemuxStats stats = motioncam::Remux(c.inputs, outputPath);
+            const motioncam::Decoder output(outputPath);
+            bool ok = stats.frames == c.sourceFrames.size() && output.getFrames() == c.timestamps;
+            for (size_t i = 0; ok && i < c.sourceFrames.size(); ++i) {
+                const std::vector<uint8_t> payload = payloadOf(output, output.getFrames()[i]);
+                ok = !payload.empty() && payload == payloadOf(clip, t[c.sourceFrames[i]]);
+            }
+            std::printf("%s %s: %zu frames\n", ok ? "PASS" : "FAIL", c.name, stats.frames);
+            if (!ok) failures++;
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "FAIL: %s\n", e.what());
+        return 1;
+    }
+
+    std::remove(outputPath.c_str());
+    return failures == 0 ? 0 : 1;
+}
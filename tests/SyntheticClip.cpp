@@ -0,0 +1,155 @@
+// FILE: tests/SyntheticClip.cpp
+//
+// Writes a small MCRAW clip of type 7 frames produced by raw::Encode, then reopens it with
+// motioncam::Decoder and checks that every frame decodes back to the samples it was made from
+// and that raw::BuildBlockTable accepts it (so --verify-gpu-decode takes the GPU path for all
+// of them). The clip is left at the given path for the tests that run on it.
+//
+// Usage: SyntheticClip <output.mcraw>
+#include <motioncam/Container.hpp>
+#include <motioncam/Decoder.hpp>
+#include <motioncam/RawData.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Not a multiple of the 64-sample encoding block or of 4 rows: exercises the padded edges.
+constexpr int kWidth = 200;
+constexpr int kHeight = 122;
+constexpr int kFrames = 5;
+constexpr int64_t kFrameIntervalNs = 33333333;
+
+// One frame per kind of content the encoder has distinct layouts for.
+std::vector<uint16_t> makeFrame(int kind) {
+    std::vector<uint16_t> frame(static_cast<size_t>(kWidth) * kHeight);
+    uint32_t state = 0x1234567u + static_cast<uint32_t>(kind) * 7919u;
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            state = state * 1664525u + 1013904223u;
+            int v = 0;
+            switch (kind) {
+            case 0: v = 1024; break;                                               // Flat: zero-width residuals
+            case 1: v = 1024 + x * 40 + y * 20; break;                             // Smooth gradient
+            case 2: v = 1024 + static_cast<int>(state >> 26); break;               // Low noise
+            case 3: v = 1024 + static_cast<int>(state >> 22) + ((x / 8 + y / 8) & 1) * 9000; break; // Edges
+            default: v = static_cast<int>(state >> 16); break;                     // Full 16-bit range
+            }
+            frame[static_cast<size_t>(y) * kWidth + x] = static_cast<uint16_t>(std::clamp(v, 0, 65535));
+        }
+    }
+    return frame;
+}
+
+template <typename T>
+void put(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void putItem(std::ofstream& out, motioncam::Type type, size_t size) {
+    put(out, motioncam::Item{ type, static_cast<uint32_t>(size) });
+}
+
+// Same record layout as WriteProxy(): header, container metadata, frame records, an empty audio
+// index, the frame index data and the buffer index that points at it.
+bool writeClip(const std::string& path, const std::vector<std::vector<uint16_t>>& frames) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    motioncam::Header header{};
+    std::copy(std::begin(motioncam::CONTAINER_ID), std::end(motioncam::CONTAINER_ID), header.ident);
+    header.version = motioncam::CONTAINER_VERSION;
+    put(out, header);
+
+    const std::string containerJson = nlohmann::json{
+        { "blackLevel", { 1024, 1024, 1024, 1024 } },
+        { "whiteLevel", 65535 },
+        { "sensorArrangment", "RGGB" } }.dump();
+    putItem(out, motioncam::Type::METADATA, containerJson.size());
+    out.write(containerJson.data(), static_cast<std::streamsize>(containerJson.size()));
+
+    std::vector<motioncam::BufferOffset> frameIndex;
+    std::vector<uint8_t> payload;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (motioncam::raw::Encode(payload, frames[i].data(), kWidth, kHeight) == 0) return false;
+        const int64_t timestamp = 1000000000 + static_cast<int64_t>(i) * kFrameIntervalNs;
+        frameIndex.push_back({ static_cast<int64_t>(out.tellp()), timestamp });
+
+        putItem(out, motioncam::Type::BUFFER, payload.size());
+        out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        const std::string frameJson = nlohmann::json{
+            { "width", kWidth }, { "height", kHeight }, { "compressionType", 7 },
+            { "timestamp", timestamp }, { "asShotNeutral", { 0.5, 1.0, 0.6 } } }.dump();
+        putItem(out, motioncam::Type::METADATA, frameJson.size());
+        out.write(frameJson.data(), static_cast<std::streamsize>(frameJson.size()));
+    }
+
+    putItem(out, motioncam::Type::AUDIO_INDEX, sizeof(motioncam::AudioIndex));
+    put(out, motioncam::AudioIndex{ 0, 0 });
+
+    putItem(out, motioncam::Type::BUFFER_INDEX_DATA, frameIndex.size() * sizeof(motioncam::BufferOffset));
+    const int64_t indexDataOffset = static_cast<int64_t>(out.tellp());
+    out.write(reinterpret_cast<const char*>(frameIndex.data()), static_cast<std::streamsize>(frameIndex.size() * sizeof(motioncam::BufferOffset)));
+
+    putItem(out, motioncam::Type::BUFFER_INDEX, sizeof(motioncam::BufferIndex));
+    put(out, motioncam::BufferIndex{ static_cast<int32_t>(motioncam::INDEX_MAGIC_NUMBER), static_cast<int32_t>(frameIndex.size()), indexDataOffset });
+    return static_cast<bool>(out.flush());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: SyntheticClip <output.mcraw>\n");
+        return 1;
+    }
+    const std::string path = argv[1];
+
+    std::vector<std::vector<uint16_t>> frames;
+    for (int i = 0; i < kFrames; ++i) frames.push_back(makeFrame(i));
+    if (!writeClip(path, frames)) {
+        std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+        return 1;
+    }
+
+    int failures = 0;
+    try {
+        const motioncam::Decoder decoder(path);
+        const auto& timestamps = decoder.getFrames();
+        if (timestamps.size() != frames.size()) {
+            std::fprintf(stderr, "FAIL: %zu frames indexed, %zu written\n", timestamps.size(), frames.size());
+            return 1;
+        }
+
+        std::vector<uint8_t> payload, metadata;
+        std::vector<uint16_t> decoded(static_cast<size_t>(kWidth) * kHeight);
+        std::vector<uint32_t> blockTable;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            int width = 0, height = 0, compressionType = -1;
+            uint32_t blocksPerRow = 0, rowGroups = 0;
+            const bool read = decoder.getRawFramePayloads(timestamps[i], payload, metadata, width, height, compressionType);
+            const bool decodedOk = read && width == kWidth && height == kHeight && compressionType == 7 &&
+                motioncam::raw::Decode(decoded.data(), width, height, payload.data(), payload.size()) > 0;
+            const bool exact = decodedOk && decoded == frames[i];
+            const bool tableOk = read && motioncam::raw::BuildBlockTable(kWidth, kHeight, payload.data(), payload.size(), blockTable, blocksPerRow, rowGroups) > 0;
+
+            std::printf("%s frame %zu: %zu bytes, %s, block table %s\n", (exact && tableOk) ? "PASS" : "FAIL",
+                i, payload.size(), exact ? "lossless" : "MISMATCH", tableOk ? "ok" : "rejected");
+            if (!exact || !tableOk) failures++;
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "FAIL: %s\n", e.what());
+        return 1;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+// FILE: tests/SyntheticFrame.h
+#ifndef TESTS_SYNTHETIC_FRAME_H
+#define TESTS_SYNTHETIC_FRAME_H
+
+#include "Export/CpuImagePipeline.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Deterministic Bayer test data and processing parameters shared by the image pipeline tests.
+namespace SyntheticFrame {
+
+    /// Smooth gradient plus noise, spanning below black and above white so every clamp is exercised.
+    inline std::vector<uint16_t> makeBayer(int width, int height, uint32_t seed) {
+        std::vector<uint16_t> bayer(static_cast<size_t>(width) * height);
+        uint32_t state = seed;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                state = state * 1664525u + 1013904223u;
+                const int base = 2000 + x * 900 + y * 500;
+                const int noise = static_cast<int>(state >> 20) - 2048;
+                bayer[static_cast<size_t>(y) * width + x] = static_cast<uint16_t>(std::clamp(base + noise, 0, 65535));
+            }
+        }
+        return bayer;
+    }
+
+    /// Non-trivial black/white levels, gains, CCM and saturation.
+    inline CpuImagePipeline::Params makeParams(int cfaType, int algorithm) {
+        CpuImagePipeline::Params p;
+        p.cfaType = cfaType;
+        p.algorithm = algorithm;
+        p.exposure = 1.2f;
+        p.blackLevel = 1024.0f;
+        p.whiteLevel = 40000.0f;
+        p.invBlackWhiteRange = 1.0f / (p.whiteLevel - p.blackLevel);
+        p.gainR = 1.9f;
+        p.gainG = 1.0f;
+        p.gainB = 1.4f;
+        const float ccm[9] = { 1.6f, -0.4f, -0.2f,
+                              -0.3f, 1.5f, -0.2f,
+                               0.0f, -0.5f, 1.5f };
+        std::copy(ccm, ccm + 9, p.ccm);
+        p.saturation = 1.5f;
+        return p;
+    }
+
+} // namespace SyntheticFrame
+
+#endif // TESTS_SYNTHETIC_FRAME_H